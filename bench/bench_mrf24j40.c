@@ -0,0 +1,401 @@
+/**
+ *********************************************************************************
+ * @file    bench_mrf24j40.c
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Benchmark de throughput y latencia del driver sobre el simulador
+ *********************************************************************************
+ * @attention Corre el driver en Linux contra dos módulos simulados (uno
+ *            transmite, el otro recibe) y mide, para cada largo de datos de
+ *            1 a MAX_PAYLOAD_SIZE, tramas por segundo en el aire, bytes SPI
+ *            por trama y nanosegundos de CPU por transmisión y recepción.
+ *            Escribe los resultados en JSON y falla si alguno supera los
+ *            límites del archivo de umbrales.
+ *
+ *            Uso: bench_mrf24j40 [umbrales] [resultados.json]
+ *********************************************************************************
+ */
+
+/* === Archivos cabecera ====================================================== */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "drv_MRF24J40.h"
+#include "app_delay_unlock.h"
+#include "mrf24j40_sim.h"
+
+/* === Definición de macros privadas ========================================== */
+#define ITERACIONES       64
+#define MAX_VUELTAS_INIT  500
+#define PASO_INIT_US      1000
+#define PASO_AIRE_US      16 // medio byte a 250 kbps
+#define MAX_VUELTAS_AIRE  2000
+#define PANID_BENCH       (0x1234)
+#define DIRECCION_TX      (0x0001)
+#define DIRECCION_RX      (0x0002)
+#define NS_POR_SEGUNDO    1000000000ULL
+#define LARGO_NOMBRE      64
+#define UMBRALES_DEFECTO  "bench/bench_limits.txt"
+#define RESULTADO_DEFECTO "bench_output.txt"
+
+/* === Declaración de tipo de datos privados ================================== */
+/**
+ * @brief Resultado para un largo de datos.
+ */
+typedef struct {
+
+    uint8_t largo;
+    double tramas_por_segundo;
+    double spi_bytes_tx;
+    double spi_bytes_rx;
+    double cpu_ns_tx;
+    double cpu_ns_rx;
+} bench_punto_t;
+
+/**
+ * @brief Métrica que se compara contra los umbrales.
+ *
+ * @note  Para las métricas del aire y del SPI se toma el peor valor de todos
+ *        los largos: el mayor si mayor_es_peor, el menor si no. Las de CPU
+ *        son el promedio de todos los largos, para que el ruido de la máquina
+ *        no dispare el umbral.
+ */
+typedef struct {
+
+    const char * nombre;
+    double valor;
+    bool_t mayor_es_peor;
+} bench_metrica_t;
+
+/* === Definición de variables privadas ======================================= */
+static mrf24_sim_medio_t medio;
+static mrf24_sim_t sim_tx;
+static mrf24_sim_t sim_rx;
+static mrf24_dev_t nodo_tx;
+static mrf24_dev_t nodo_rx;
+static bench_punto_t puntos[MAX_PAYLOAD_SIZE];
+
+/* === Declaración de funciones privadas ====================================== */
+static uint64_t LeoCpuNs(void);
+static tick_t LeoReloj(void);
+static bool_t InicializoNodos(uint64_t * cpu_ns, uint64_t * virtual_us);
+static bool_t MidoLargo(uint8_t largo, bench_punto_t * punto);
+static uint8_t ArmoMetricas(bench_metrica_t * metricas, uint64_t init_us, uint64_t init_ns,
+                            uint32_t init_bytes);
+static void EscriboResultados(FILE * salida, const bench_metrica_t * metricas, uint8_t cantidad);
+static uint8_t ComparoUmbrales(FILE * umbrales, const bench_metrica_t * metricas,
+                               uint8_t cantidad);
+
+/* === Implementación de funciones del delay ================================== */
+/*
+ * El benchmark no tiene un timer: el delay no bloqueante corre sobre el reloj
+ * virtual del simulador, en milisegundos.
+ */
+void DelayInit(delayNoBloqueanteData_t * delay, tick_t duration) {
+
+    delay->duration = duration;
+    delay->running = false;
+}
+
+bool_t DelayRead(delayNoBloqueanteData_t * delay) {
+
+    if (!delay->running) {
+
+        DelayReset(delay);
+        return false;
+    }
+
+    if (LeoReloj() - delay->startTime < delay->duration)
+        return false;
+
+    delay->running = false;
+    return true;
+}
+
+void DelayWrite(delayNoBloqueanteData_t * delay, tick_t duration) {
+
+    delay->duration = duration;
+}
+
+void DelayReset(delayNoBloqueanteData_t * delay) {
+
+    delay->startTime = LeoReloj();
+    delay->running = true;
+}
+
+/* === Implementación de funciones privadas =================================== */
+static uint64_t LeoCpuNs(void) {
+
+    struct timespec ahora;
+
+    clock_gettime(CLOCK_MONOTONIC, &ahora);
+    return (uint64_t)ahora.tv_sec * NS_POR_SEGUNDO + (uint64_t)ahora.tv_nsec;
+}
+
+static tick_t LeoReloj(void) {
+
+    return (tick_t)(MRF24SimGetTiempoUs(&medio) / 1000);
+}
+
+/**
+ * @brief  Inicializo los dos módulos y espero a que terminen.
+ *
+ * @param  uint64_t * Donde se devuelve el tiempo de CPU del driver.
+ * @param  uint64_t * Donde se devuelve el tiempo virtual hasta INIT_OK.
+ * @return bool_t false si alguno no llegó a INIT_OK.
+ */
+static bool_t InicializoNodos(uint64_t * cpu_ns, uint64_t * virtual_us) {
+
+    mrf24_port_t port_tx;
+    mrf24_port_t port_rx;
+    mrf24_state_t estado_tx = INIT_IN_PROGRESS;
+    mrf24_state_t estado_rx = INIT_IN_PROGRESS;
+
+    MRF24SimMedioInit(&medio);
+    MRF24SimInit(&sim_tx, &medio, &port_tx);
+    MRF24SimInit(&sim_rx, &medio, &port_rx);
+    MRF24SetChannel(&nodo_tx, CH_15);
+    MRF24SetChannel(&nodo_rx, CH_15);
+    MRF24SetPanId(&nodo_tx, PANID_BENCH);
+    MRF24SetPanId(&nodo_rx, PANID_BENCH);
+    MRF24SetAdd(&nodo_tx, DIRECCION_TX);
+    MRF24SetAdd(&nodo_rx, DIRECCION_RX);
+
+    uint64_t inicio = LeoCpuNs();
+    MRF24J40Init(&nodo_tx, &port_tx);
+    MRF24J40Init(&nodo_rx, &port_rx);
+
+    for (uint16_t i = 0; i < MAX_VUELTAS_INIT; i++) {
+
+        if (INIT_IN_PROGRESS == estado_tx)
+            estado_tx = MRF24Poll(&nodo_tx);
+        if (INIT_IN_PROGRESS == estado_rx)
+            estado_rx = MRF24Poll(&nodo_rx);
+        if (INIT_IN_PROGRESS != estado_tx && INIT_IN_PROGRESS != estado_rx)
+            break;
+        MRF24SimAvanzar(&medio, PASO_INIT_US);
+    }
+    *cpu_ns = (LeoCpuNs() - inicio) / 2;
+    *virtual_us = MRF24SimGetTiempoUs(&medio);
+    return INIT_OK == estado_tx && INIT_OK == estado_rx;
+}
+
+/**
+ * @brief  Mido ITERACIONES tramas de un largo de datos.
+ *
+ * @param  uint8_t Largo de los datos.
+ * @param  bench_punto_t * Donde se guarda el resultado.
+ * @return bool_t false si alguna trama no llegó.
+ *
+ * @note   El tiempo de CPU de transmisión incluye la carga de la trama y la
+ *         atención de TXNIF; el de recepción, la atención de la interrupción
+ *         y la liberación del buffer. Ambos incluyen el modelo del módulo,
+ *         que sólo copia bytes. El tiempo en que el reloj virtual avanza hasta
+ *         el TXNIF (CSMA-CA, aire y ACK) no se cuenta como CPU.
+ */
+static bool_t MidoLargo(uint8_t largo, bench_punto_t * punto) {
+
+    mrf24_data_out_t salida = {PANID_BENCH, DIRECCION_RX, DIRECCION_TX, {0}, largo};
+    mrf24_perf_t perf_tx;
+    mrf24_perf_t perf_rx;
+    uint64_t cpu_tx = 0;
+    uint64_t cpu_rx = 0;
+
+    memset(salida.buffer, 'x', largo);
+    MRF24ResetPerf(&nodo_tx);
+    MRF24ResetPerf(&nodo_rx);
+    uint64_t virtual_inicio = medio.tiempo_ns;
+
+    for (uint8_t i = 0; i < ITERACIONES; i++) {
+
+        uint64_t t0 = LeoCpuNs();
+
+        if (TRANS_COMPLETED != MRF24TransmitirDato(&nodo_tx, &salida))
+            return false;
+        uint64_t t1 = LeoCpuNs();
+
+        for (uint16_t j = 0; j < MAX_VUELTAS_AIRE; j++) {
+
+            if (nodo_tx.port.is_interrupt(nodo_tx.port.ctx))
+                break;
+            MRF24SimAvanzar(&medio, PASO_AIRE_US);
+        }
+        uint64_t t2 = LeoCpuNs();
+
+        if (MSG_READ != MRF24InterruptHandler(&nodo_rx))
+            return false;
+        MRF24ReleaseDataIn(&nodo_rx);
+        uint64_t t3 = LeoCpuNs();
+
+        MRF24InterruptHandler(&nodo_tx);
+        uint64_t t4 = LeoCpuNs();
+        cpu_tx += (t1 - t0) + (t4 - t3);
+        cpu_rx += t3 - t2;
+    }
+
+    MRF24GetPerf(&nodo_tx, &perf_tx);
+    MRF24GetPerf(&nodo_rx, &perf_rx);
+    double segundos = (double)(medio.tiempo_ns - virtual_inicio) / NS_POR_SEGUNDO;
+    uint32_t bytes_tx = 0;
+    uint32_t bytes_rx = 0;
+
+    for (uint8_t i = 0; i < PERF_API_COUNT; i++) {
+
+        bytes_tx += perf_tx.spi_bytes[i];
+        bytes_rx += perf_rx.spi_bytes[i];
+    }
+    punto->largo = largo;
+    punto->tramas_por_segundo = ITERACIONES / segundos;
+    punto->spi_bytes_tx = (double)bytes_tx / ITERACIONES;
+    punto->spi_bytes_rx = (double)bytes_rx / ITERACIONES;
+    punto->cpu_ns_tx = (double)cpu_tx / ITERACIONES;
+    punto->cpu_ns_rx = (double)cpu_rx / ITERACIONES;
+    return perf_rx.rx_frames == ITERACIONES;
+}
+
+/**
+ * @brief  Resumo las mediciones en las métricas que se comparan.
+ *
+ * @return uint8_t Cantidad de métricas.
+ *
+ * @note   Los bytes SPI se comparan descontando los datos: lo que importa es
+ *         el costo fijo por trama.
+ */
+static uint8_t ArmoMetricas(bench_metrica_t * metricas, uint64_t init_us, uint64_t init_ns,
+                            uint32_t init_bytes) {
+
+    bench_metrica_t peores[] = {
+        {"tramas_por_segundo", puntos[0].tramas_por_segundo, false},
+        {"spi_bytes_tx_fijos", 0, true},
+        {"spi_bytes_rx_fijos", 0, true},
+        {"cpu_ns_tx", 0, true},
+        {"cpu_ns_rx", 0, true},
+    };
+
+    for (uint8_t i = 0; i < MAX_PAYLOAD_SIZE; i++) {
+
+        const bench_punto_t * p = &puntos[i];
+        double valores[] = {p->tramas_por_segundo, p->spi_bytes_tx - p->largo,
+                            p->spi_bytes_rx - p->largo};
+
+        for (uint8_t j = 0; j < sizeof(valores) / sizeof(valores[0]); j++) {
+
+            if (peores[j].mayor_es_peor ? valores[j] > peores[j].valor
+                                        : valores[j] < peores[j].valor)
+                peores[j].valor = valores[j];
+        }
+        peores[3].valor += p->cpu_ns_tx / MAX_PAYLOAD_SIZE;
+        peores[4].valor += p->cpu_ns_rx / MAX_PAYLOAD_SIZE;
+    }
+
+    metricas[0] = (bench_metrica_t){"init_us", (double)init_us, true};
+    metricas[1] = (bench_metrica_t){"init_cpu_ns", (double)init_ns, true};
+    metricas[2] = (bench_metrica_t){"init_spi_bytes", (double)init_bytes, true};
+    memcpy(&metricas[3], peores, sizeof(peores));
+    return 3 + sizeof(peores) / sizeof(peores[0]);
+}
+
+static void EscriboResultados(FILE * salida, const bench_metrica_t * metricas, uint8_t cantidad) {
+
+    fprintf(salida, "{\n  \"iteraciones\": %d,\n  \"resumen\": {\n", ITERACIONES);
+    for (uint8_t i = 0; i < cantidad; i++)
+        fprintf(salida, "    \"%s\": %.1f%s\n", metricas[i].nombre, metricas[i].valor,
+                (i + 1 < cantidad) ? "," : "");
+    fprintf(salida, "  },\n  \"largos\": [\n");
+
+    for (uint8_t i = 0; i < MAX_PAYLOAD_SIZE; i++) {
+
+        const bench_punto_t * p = &puntos[i];
+        fprintf(salida,
+                "    {\"largo\": %u, \"tramas_por_segundo\": %.1f, \"spi_bytes_tx\": %.1f, "
+                "\"spi_bytes_rx\": %.1f, \"cpu_ns_tx\": %.1f, \"cpu_ns_rx\": %.1f}%s\n",
+                p->largo, p->tramas_por_segundo, p->spi_bytes_tx, p->spi_bytes_rx, p->cpu_ns_tx,
+                p->cpu_ns_rx, (i + 1 < MAX_PAYLOAD_SIZE) ? "," : "");
+    }
+    fprintf(salida, "  ]\n}\n");
+}
+
+/**
+ * @brief  Comparo las métricas contra el archivo de umbrales.
+ *
+ * @return uint8_t Cantidad de métricas fuera de su umbral.
+ *
+ * @note   Cada línea del archivo es "nombre max|min valor"; las que empiezan
+ *         con # se ignoran. Una métrica sin umbral no se compara.
+ */
+static uint8_t ComparoUmbrales(FILE * umbrales, const bench_metrica_t * metricas,
+                               uint8_t cantidad) {
+
+    char linea[128];
+    char nombre[LARGO_NOMBRE];
+    char tipo[4];
+    double limite;
+    uint8_t fallas = 0;
+
+    while (NULL != fgets(linea, sizeof(linea), umbrales)) {
+
+        if ('#' == linea[0] || 3 != sscanf(linea, "%63s %3s %lf", nombre, tipo, &limite))
+            continue;
+
+        for (uint8_t i = 0; i < cantidad; i++) {
+
+            if (0 != strcmp(nombre, metricas[i].nombre))
+                continue;
+            bool_t maximo = (0 == strcmp(tipo, "max"));
+            bool_t falla = maximo ? metricas[i].valor > limite : metricas[i].valor < limite;
+            printf("%-20s %12.1f  %s %10.1f  %s\n", nombre, metricas[i].valor, tipo, limite,
+                   falla ? "FALLA" : "ok");
+            fallas += falla;
+        }
+    }
+    return fallas;
+}
+
+/* === Implementación de funciones públicas =================================== */
+int main(int argc, char * argv[]) {
+
+    const char * archivo_umbrales = (argc > 1) ? argv[1] : UMBRALES_DEFECTO;
+    const char * archivo_resultado = (argc > 2) ? argv[2] : RESULTADO_DEFECTO;
+    bench_metrica_t metricas[8];
+    mrf24_perf_t perf;
+    uint64_t init_ns;
+    uint64_t init_us;
+
+    if (!InicializoNodos(&init_ns, &init_us)) {
+
+        fprintf(stderr, "bench: la inicialización no terminó\n");
+        return 1;
+    }
+    MRF24GetPerf(&nodo_tx, &perf);
+
+    for (uint8_t largo = 1; largo <= MAX_PAYLOAD_SIZE; largo++) {
+
+        if (!MidoLargo(largo, &puntos[largo - 1])) {
+
+            fprintf(stderr, "bench: se perdieron tramas con %u bytes de datos\n", largo);
+            return 1;
+        }
+    }
+
+    uint8_t cantidad = ArmoMetricas(metricas, init_us, init_ns, perf.spi_bytes[PERF_API_INIT]);
+    FILE * salida = fopen(archivo_resultado, "w");
+
+    if (NULL == salida) {
+
+        fprintf(stderr, "bench: no se pudo escribir %s\n", archivo_resultado);
+        return 1;
+    }
+    EscriboResultados(salida, metricas, cantidad);
+    fclose(salida);
+
+    FILE * umbrales = fopen(archivo_umbrales, "r");
+
+    if (NULL == umbrales) {
+
+        fprintf(stderr, "bench: no se pudo leer %s\n", archivo_umbrales);
+        return 1;
+    }
+    uint8_t fallas = ComparoUmbrales(umbrales, metricas, cantidad);
+    fclose(umbrales);
+    printf("bench: resultados en %s, %u métricas fuera de umbral\n", archivo_resultado, fallas);
+    return (0 == fallas) ? 0 : 1;
+}
@@ -16,7 +16,7 @@
  * Macros
  */
 #define VACIO      (0X00)
-#define delay_t(x) sleep(x)
+#define delay_t(x) usleep((x) * 1000)
 #define bool_t     bool
 
 /**
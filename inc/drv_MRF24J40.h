@@ -12,14 +12,130 @@
 
 /* === Archivos cabecera ====================================================== */
 #include "compatibility.h"
+#include "drv_MRF24J40_port.h"
+#include "app_delay_unlock.h"
 
 /* === Definición de macros públicas ========================================== */
-#define BROADCAST      (0xFFFF)
-#define LARGE_MAC_SIZE 8
-#define SEC_KEY_SIZE   16
-#define BUFFER_SIZE    128
+#define BROADCAST        (0xFFFF)
+#define LARGE_MAC_SIZE   8
+#define SEC_KEY_SIZE     16
+#define BUFFER_SIZE      128
+#define MAX_PAYLOAD_SIZE 116 /* 127 bytes de trama - 9 de cabecera MAC - 2 de FCS */
+#define TX_FRAME_SIZE    127 /* 2 de largos de la FIFO + 9 de cabecera MAC + datos */
+#define SHADOW_SIZE      192 /* 64 registros cortos + 128 registros largos de control */
+#define CHANNEL_COUNT    16  /* CH_11 a CH_26 */
+
+/**
+ * @brief Comandos SPI de escritura ya codificados para los scripts de
+ *        inicialización.
+ */
+#define MRF24_SHORT_WRITE(reg) ((uint16_t)(((reg) << 1) | 0x01))
+#define MRF24_LONG_WRITE(reg)  ((uint16_t)(((reg) << 5) | 0x8010))
+
+/**
+ * @brief Cantidad de tramas que se pueden almacenar a la espera de ser leídas.
+ *
+ * @note  Debe ser una potencia de 2 menor o igual a 128.
+ */
+#ifndef RX_RING_SIZE
+#define RX_RING_SIZE 8
+#endif
+
+/**
+ * @brief Dimensiones de la cola de transmisión: cantidad de tramas, cantidad
+ *        de destinos distintos con tramas pendientes y fallos seguidos de un
+ *        destino a partir de los cuales se descartan sus tramas pendientes.
+ */
+#ifndef TX_QUEUE_SIZE
+#define TX_QUEUE_SIZE 8
+#endif
+
+#ifndef TX_QUEUE_DESTINATIONS
+#define TX_QUEUE_DESTINATIONS 4
+#endif
+
+#ifndef TX_QUEUE_MAX_FAILS
+#define TX_QUEUE_MAX_FAILS 3
+#endif
+
+/**
+ * @brief Cantidad de dispositivos cercanos que se pueden registrar.
+ *
+ * @note  Debe ser una potencia de 2 menor o igual a 1024. Conviene que sobre
+ *        lugar: con la tabla casi llena las búsquedas se alargan.
+ */
+#ifndef NEIGHBOR_TABLE_SIZE
+#define NEIGHBOR_TABLE_SIZE 128
+#endif
+
+/**
+ * @brief Modo de la capa física con el que se inicializa el módulo si no se
+ *        elige otro con MRF24SetPhyMode.
+ */
+#ifndef MRF24_PHY_MODE
+#define MRF24_PHY_MODE PHY_250KBPS
+#endif
+
+/**
+ * @brief Escucha de bajo consumo: ventana mínima de escucha en milisegundos y
+ *        cantidad de orígenes de los que se recuerda la última trama para
+ *        descartar las repetidas.
+ *
+ * @note  La ventana tiene que cubrir el hueco entre dos repeticiones de una
+ *        trama más la trama más larga, unos 8 ms a 250 kbps.
+ */
+#ifndef LPL_MIN_LISTEN
+#define LPL_MIN_LISTEN 10
+#endif
+
+#ifndef LPL_DUP_TABLE_SIZE
+#define LPL_DUP_TABLE_SIZE 4
+#endif
+
+/**
+ * @brief Transmisión indirecta: cantidad de tramas que el coordinador guarda
+ *        para dispositivos dormidos y milisegundos que espera cada una, si no
+ *        se indica otro plazo, a que su destino la pida.
+ *
+ * @note  El plazo por defecto es macTransactionPersistenceTime de IEEE
+ *        802.15.4: 500 períodos de 960 símbolos a 250 kbps.
+ */
+#ifndef INDIRECT_TABLE_SIZE
+#define INDIRECT_TABLE_SIZE 4
+#endif
+
+#ifndef INDIRECT_PERSISTENCE
+#define INDIRECT_PERSISTENCE 7680
+#endif
+
+/**
+ * @brief Contadores de rendimiento e histogramas de latencia.
+ *
+ * @note  En 0 no se compilan: ni los campos de la instancia ni el código que
+ *        los actualiza, ni las funciones MRF24*Perf*.
+ */
+#ifndef MRF24_PERF
+#define MRF24_PERF 0
+#endif
+
+#define PERF_HIST_BUCKETS 8
+
+/**
+ * @brief Dirección corta de un dispositivo que sólo usa su dirección larga.
+ */
+#define NO_SHORT_ADDRESS (0xFFFE)
+
+/**
+ * @brief Cantidad máxima de GTS de la supertrama, las que admite el beacon.
+ */
+#define SF_MAX_GTS 7
 
 /* === Declaración de tipo de datos públicos ================================== */
+/**
+ * @brief Instancia del driver, una por módulo.
+ */
+typedef struct mrf24_dev_s mrf24_dev_t;
+
 /**
  * @brief Canales disponibles para el IEEE 802.15.4.
  */
@@ -61,8 +177,96 @@ typedef enum {
     OPERATION_OK,
     UNEXPECTED_ERROR,
     INVALID_VALUE,
+    BUFFER_FULL,
+    TRANS_IN_PROGRESS,
+    INIT_IN_PROGRESS,
+    SCAN_IN_PROGRESS,
 } mrf24_state_t;
 
+/**
+ * @brief Pasos de la inicialización del módulo.
+ */
+typedef enum {
+
+    INIT_STEP_IDLE,
+    INIT_STEP_RESET_PIN,
+    INIT_STEP_RESET_RELEASE,
+    INIT_STEP_SOFT_RESET,
+    INIT_STEP_STABILIZE,
+    INIT_STEP_CONFIGURE,
+    INIT_STEP_WAIT_RX,
+    INIT_STEP_RF_RESET,
+    INIT_STEP_DONE,
+    INIT_STEP_FAILED,
+} mrf24_init_step_t;
+
+/**
+ * @brief Modos de la capa física.
+ *
+ * @note  PHY_TURBO_625KBPS es un modo propietario de Microchip: sólo se
+ *        entiende con otros módulos MRF24J40 en el mismo modo.
+ */
+typedef enum {
+
+    PHY_250KBPS,
+    PHY_TURBO_625KBPS,
+} mrf24_phy_mode_t;
+
+/**
+ * @brief Resultado de una transmisión.
+ */
+typedef enum {
+
+    TX_PENDING,
+    TX_OK,
+    TX_NO_ACK,
+    TX_CHANNEL_BUSY,
+    TX_DROPPED,
+    TX_EXPIRED,
+} mrf24_tx_status_t;
+
+/**
+ * @brief Niveles de seguridad de IEEE 802.15.4 soportados por el driver.
+ *
+ * @note  Todos cifran con AES-CCM, varía el largo del MIC (4, 8 o 16 bytes).
+ */
+typedef enum {
+
+    SEC_NONE = 0,
+    SEC_ENC_MIC_32 = 5,
+    SEC_ENC_MIC_64 = 6,
+    SEC_ENC_MIC_128 = 7,
+} mrf24_sec_level_t;
+
+/**
+ * @brief Identificador de una transmisión, nunca vale VACIO.
+ */
+typedef uint8_t mrf24_tx_handle_t;
+
+/**
+ * @brief Estructura con el resultado de una transmisión.
+ *
+ * @note  TX_OK indica que se recibió el ACK, o que la trama salió si no se
+ *        pidió ACK. TX_DROPPED indica que la trama se descartó de la cola sin
+ *        transmitirla y TX_EXPIRED que una trama indirecta venció sin que su
+ *        destino la pidiera. retries es la cantidad de reintentos que hizo el
+ *        módulo.
+ */
+typedef struct {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_status_t status;
+    uint8_t retries;
+} mrf24_tx_result_t;
+
+/**
+ * @brief Función que se llama al terminar cada transmisión.
+ *
+ * @note  Se llama desde MRF24InterruptHandler, es decir, posiblemente desde
+ *        la rutina de interrupción. Recibe el módulo que terminó de transmitir.
+ */
+typedef void (*mrf24_tx_callback_t)(mrf24_dev_t * dev, const mrf24_tx_result_t * resultado);
+
 /**
  * @brief Estructura con la información de configuración del dispositivo.
  */
@@ -89,20 +293,374 @@ typedef struct {
     uint8_t buffer_size;
 } mrf24_data_out_t;
 
+/**
+ * @brief Segmento de datos a transmitir, se envía desde donde está sin copiarlo.
+ */
+typedef struct {
+
+    const uint8_t * data;
+    uint8_t length;
+} mrf24_segment_t;
+
+/**
+ * @brief Tipo de trama que se arma con MRF24TransmitirTrama.
+ */
+typedef enum {
+
+    FRAME_BEACON = 0x00,
+    FRAME_DATA = 0x01,
+    FRAME_COMMAND = 0x03,
+} mrf24_frame_type_t;
+
+/**
+ * @brief Modo de direccionamiento del destino o del origen de una trama.
+ */
+typedef enum {
+
+    ADDR_NONE = 0x00,
+    ADDR_SHORT = 0x02,
+    ADDR_LONG = 0x03,
+} mrf24_addr_mode_t;
+
+/**
+ * @brief Opciones de una trama armada con MRF24TransmitirTrama.
+ *
+ * @note  dest_panid y src_address en VACIO toman el PAN y la dirección corta
+ *        propios; el origen largo es siempre mac[8]. dest_long va en el mismo
+ *        orden que mac[8]. Con pan_compression el PAN de origen no se manda y
+ *        vale el de destino; sin ella se manda el propio. El ACK se pide sólo
+ *        si ack es true y el destino es un único nodo: nunca a BROADCAST ni
+ *        sin destino.
+ */
+typedef struct {
+
+    mrf24_frame_type_t type;
+    bool_t ack;
+    bool_t pan_compression;
+    mrf24_addr_mode_t dest_mode;
+    mrf24_addr_mode_t src_mode;
+    uint16_t dest_panid;
+    uint16_t dest_address;
+    uint16_t src_address;
+    uint8_t dest_long[LARGE_MAC_SIZE];
+} mrf24_frame_opts_t;
+
 /**
  * @brief Estructura con la información de recepción.
+ *
+ * @note  panid es el PAN de origen. Si el origen viene con dirección larga,
+ *        address vale NO_SHORT_ADDRESS y la dirección está en long_address, en
+ *        el mismo orden que mac[8]; sin origen también vale NO_SHORT_ADDRESS.
+ *        En modo sniffer la trama no se decodifica: buffer tiene la trama
+ *        entera, del frame control al FCS, y address vale NO_SHORT_ADDRESS.
+ *        timestamp es la lectura del reloj de MRF24SetRxClock al atender la
+ *        interrupción, VACIO si no hay reloj.
  */
 typedef struct {
 
     uint16_t panid;
     uint16_t address;
+    uint8_t long_address[LARGE_MAC_SIZE];
     uint8_t rssi;
+    uint8_t lqi;
     uint8_t buffer[BUFFER_SIZE];
     uint8_t buffer_size;
+    bool_t secured;
+    uint32_t frame_counter;
+    uint32_t timestamp;
 } mrf24_data_in_t;
 
+/**
+ * @brief Fuente de tiempo para las tramas recibidas, en microsegundos.
+ */
+typedef uint32_t (*mrf24_rx_clock_t)(void);
+
+/**
+ * @brief Contadores de la recepción.
+ */
+typedef struct {
+
+    uint32_t received;
+    uint32_t overruns;
+    uint32_t errors;
+    uint32_t sec_errors;
+} mrf24_rx_stats_t;
+
+/**
+ * @brief Energía medida en un canal durante el escaneo.
+ *
+ * @note  max y average son lecturas del registro RSSI, samples la cantidad de
+ *        lecturas que se promediaron.
+ */
+typedef struct {
+
+    channel_list_t channel;
+    uint8_t max;
+    uint8_t average;
+    uint16_t samples;
+} mrf24_ed_result_t;
+
+/**
+ * @brief Pasos de la escucha de bajo consumo.
+ *
+ * @note  En LPL_STEP_WAKE se pidió despertar al módulo antes de tiempo y se
+ *        espera que avise con WAKEIF.
+ */
+typedef enum {
+
+    LPL_STEP_OFF,
+    LPL_STEP_CALIBRATE,
+    LPL_STEP_LISTEN,
+    LPL_STEP_SLEEP,
+    LPL_STEP_WAKE,
+} mrf24_lpl_step_t;
+
+/**
+ * @brief Configuración de la escucha de bajo consumo, en milisegundos.
+ *
+ * @note  max_latency es el ciclo del módulo: duerme max_latency - listen y
+ *        escucha listen. También es la demora máxima de una trama hacia un
+ *        módulo dormido, porque quien la transmite la repite durante un ciclo
+ *        entero. listen es además lo que el módulo queda despierto después de
+ *        recibir o transmitir una trama.
+ */
+typedef struct {
+
+    tick_t max_latency;
+    tick_t listen;
+} mrf24_lpl_config_t;
+
+/**
+ * @brief Contadores de la escucha de bajo consumo.
+ *
+ * @note  sleeps cuenta las veces que se durmió el módulo y early_wakes las que
+ *        se lo despertó antes de tiempo. strobes son las repeticiones de
+ *        tramas ya transmitidas y duplicates las tramas recibidas repetidas
+ *        que se descartaron.
+ */
+typedef struct {
+
+    uint32_t sleeps;
+    uint32_t early_wakes;
+    uint32_t strobes;
+    uint32_t duplicates;
+} mrf24_lpl_stats_t;
+
+/**
+ * @brief Número de secuencia de la última trama recibida de un origen.
+ */
+typedef struct {
+
+    uint16_t panid;
+    uint16_t address;
+    uint8_t long_address[LARGE_MAC_SIZE];
+    uint8_t secuencia;
+    bool_t usado;
+} mrf24_lpl_visto_t;
+
+/**
+ * @brief Papel del módulo en una red con beacons.
+ */
+typedef enum {
+
+    SF_ROLE_NONE,
+    SF_ROLE_COORDINATOR,
+    SF_ROLE_DEVICE,
+} mrf24_sf_role_t;
+
+/**
+ * @brief Sentido de una GTS, visto desde el dispositivo que la tiene asignada.
+ */
+typedef enum {
+
+    GTS_DIR_TRANSMIT,
+    GTS_DIR_RECEIVE,
+} mrf24_gts_dir_t;
+
+/**
+ * @brief Configuración de la supertrama del coordinador.
+ *
+ * @note  beacon_order fija el intervalo entre beacons, 15,36 ms * 2^BO a
+ *        250 kbps, y superframe_order la parte activa, 15,36 ms * 2^SO,
+ *        dividida en 16 slots. beacon_order va de 0 a 14 y superframe_order
+ *        no puede ser mayor.
+ */
+typedef struct {
+
+    uint8_t beacon_order;
+    uint8_t superframe_order;
+} mrf24_superframe_config_t;
+
+/**
+ * @brief Ranura garantizada (GTS) de la supertrama, en slots.
+ */
+typedef struct {
+
+    uint16_t address;
+    uint8_t start_slot;
+    uint8_t length;
+    mrf24_gts_dir_t direction;
+} mrf24_gts_t;
+
+/**
+ * @brief Estado de la supertrama.
+ *
+ * @note  cap_end es el último slot del período de contención (CAP); las GTS
+ *        ocupan los slots siguientes hasta el 15, ordenadas por start_slot, y
+ *        la GTS i es la número i + 1 para el módulo. synced indica que la
+ *        supertrama está en marcha: en el coordinador desde que se inicializa
+ *        el módulo, en un dispositivo desde que recibió un beacon de su PAN.
+ */
+typedef struct {
+
+    mrf24_sf_role_t role;
+    bool_t synced;
+    uint8_t beacon_order;
+    uint8_t superframe_order;
+    uint8_t cap_end;
+    uint8_t gts_count;
+    mrf24_gts_t gts[SF_MAX_GTS];
+} mrf24_superframe_t;
+
+/**
+ * @brief Contadores de la transmisión indirecta.
+ *
+ * @note  En el coordinador, requests son los pedidos de datos recibidos,
+ *        delivered las tramas indirectas entregadas y expired las que
+ *        vencieron. En el dispositivo, polls son los pedidos de datos enviados
+ *        y pending los que el coordinador reconoció con trama pendiente.
+ */
+typedef struct {
+
+    uint32_t requests;
+    uint32_t delivered;
+    uint32_t expired;
+    uint32_t polls;
+    uint32_t pending;
+} mrf24_indirect_stats_t;
+
+#if MRF24_PERF
+/**
+ * @brief Grupos en los que se reparte el tráfico SPI.
+ *
+ * @note  PERF_API_RX incluye todo lo que hace MRF24InterruptHandler, también
+ *        el aviso de fin de transmisión. PERF_API_OTHER es lo que no entra en
+ *        los otros grupos: configuración, escaneos, etc.
+ */
+typedef enum {
+
+    PERF_API_OTHER,
+    PERF_API_INIT,
+    PERF_API_TX,
+    PERF_API_RX,
+    PERF_API_COUNT,
+} mrf24_perf_api_t;
+
+/**
+ * @brief Fuente de ticks para las latencias, en la unidad que elija la
+ *        aplicación.
+ */
+typedef tick_t (*mrf24_perf_clock_t)(void);
+
+/**
+ * @brief Contadores de rendimiento de un módulo.
+ *
+ * @note  Los histogramas son en ticks: el casillero 0 cuenta las latencias de
+ *        0 ticks, el casillero i las de 2^(i-1) a 2^i - 1 y el último todas
+ *        las mayores. tx_latency va desde que se entrega la trama al driver
+ *        hasta TXNIF; rx_latency desde que se ve la interrupción hasta que la
+ *        trama queda leída de la FIFO.
+ */
+typedef struct {
+
+    uint32_t spi_transactions[PERF_API_COUNT];
+    uint32_t spi_bytes[PERF_API_COUNT];
+    uint32_t tx_frames;
+    uint32_t rx_frames;
+    uint32_t rx_dropped;
+    uint32_t retries;
+    uint32_t cca_failures;
+    uint32_t tx_latency[PERF_HIST_BUCKETS];
+    uint32_t rx_latency[PERF_HIST_BUCKETS];
+} mrf24_perf_t;
+#endif
+
+/**
+ * @brief Entrada de un script de inicialización.
+ *
+ * @note  command se arma con MRF24_SHORT_WRITE o MRF24_LONG_WRITE. wait_ms es
+ *        la espera en milisegundos después de escribir el registro.
+ */
+typedef struct {
+
+    uint16_t command;
+    uint8_t value;
+    uint8_t wait_ms;
+} mrf24_reg_write_t;
+
+/**
+ * @brief Perfil de inicialización: script de registros para un módulo.
+ *
+ * @note  El script adicional se ejecuta a continuación del principal, para que
+ *        un módulo que sólo agrega registros reutilice el script de otro. Puede
+ *        ser NULL con largo 0.
+ */
+typedef struct {
+
+    const mrf24_reg_write_t * script;
+    uint8_t length;
+    const mrf24_reg_write_t * extra;
+    uint8_t extra_length;
+} mrf24_init_profile_t;
+
+/**
+ * @brief Trama de la cola de transmisión, ya codificada tal como va a la FIFO.
+ */
+typedef struct {
+
+    uint8_t trama[TX_FRAME_SIZE];
+    uint8_t largo;
+    mrf24_tx_handle_t handle;
+    uint8_t siguiente;
+#if MRF24_PERF
+    tick_t perf_inicio;
+#endif
+} mrf24_tx_entrada_t;
+
+/**
+ * @brief Subcola de la cola de transmisión con las tramas para un destino.
+ */
+typedef struct {
+
+    uint16_t destino;
+    uint8_t primero;
+    uint8_t ultimo;
+    uint8_t fallos;
+} mrf24_tx_subcola_t;
+
+/**
+ * @brief Trama guardada para un dispositivo dormido, ya codificada.
+ *
+ * @note  handle en VACIO indica una entrada libre. orden es el de llegada,
+ *        para entregar primero la más antigua de cada destino. pedida indica
+ *        que su destino la pidió y sale en cuanto el módulo esté libre.
+ */
+typedef struct {
+
+    uint8_t trama[TX_FRAME_SIZE];
+    uint8_t largo;
+    uint16_t destino;
+    volatile mrf24_tx_handle_t handle;
+    uint32_t orden;
+    volatile bool_t pedida;
+    delayNoBloqueanteData_t vencimiento;
+} mrf24_indirecta_t;
+
 /**
  * @brief Estructura con la lista de dispositivos cercanos.
+ *
+ * @note  channel en VACIO indica una entrada libre. Los dispositivos que se
+ *        anuncian con dirección larga tienen short_address en NO_SHORT_ADDRESS.
  */
 typedef struct {
 
@@ -113,113 +671,846 @@ typedef struct {
     uint8_t rssi;
 } MRF24_discover_nearby_t;
 
+/**
+ * @brief Estado completo de un módulo: port, configuración, buffers y colas.
+ *
+ * @note  Los campos son de uso interno del driver. La aplicación reserva una
+ *        estructura por módulo, en cero (por ejemplo static), y la pasa a todas
+ *        las funciones públicas. Los módulos no comparten nada entre sí.
+ */
+struct mrf24_dev_s {
+
+    mrf24_port_t port;
+    mrf24_state_t estado;
+    mrf24_data_config_t config;
+    mrf24_data_out_t data_out;
+    mrf24_data_in_t rx_ring[RX_RING_SIZE];
+    volatile uint8_t rx_ring_head;
+    volatile uint8_t rx_ring_tail;
+    mrf24_rx_stats_t rx_stats;
+    mrf24_rx_clock_t rx_reloj;
+    uint8_t rxmcr;
+    volatile mrf24_tx_handle_t tx_en_curso;
+    mrf24_tx_handle_t tx_ultimo_handle;
+    mrf24_tx_result_t tx_resultados[TX_QUEUE_SIZE];
+    mrf24_tx_callback_t tx_callback;
+    mrf24_tx_entrada_t tx_entradas[TX_QUEUE_SIZE];
+    mrf24_tx_subcola_t tx_subcolas[TX_QUEUE_DESTINATIONS];
+    uint8_t tx_libres;
+    uint8_t tx_turno;
+    uint16_t tx_destino_en_curso;
+    uint16_t tx_destino_terminado;
+    mrf24_tx_status_t tx_status_terminado;
+    volatile bool_t tx_cola_bloqueada;
+    volatile bool_t tx_despacho_pendiente;
+    mrf24_init_step_t init_paso;
+    delayNoBloqueanteData_t init_delay;
+    const mrf24_init_profile_t * init_perfil;
+    uint8_t init_script_indice;
+    uint8_t shadow[SHADOW_SIZE];
+    uint8_t shadow_validos[SHADOW_SIZE / 8];
+    mrf24_sec_level_t sec_nivel;
+    uint32_t sec_contador;
+    uint8_t sec_origen[8];
+    mrf24_ed_result_t ed_tabla[CHANNEL_COUNT];
+    uint8_t scan_indice;
+    uint32_t ed_suma;
+    delayNoBloqueanteData_t scan_delay;
+    bool_t scan_activo;
+    MRF24_discover_nearby_t vecinos[NEIGHBOR_TABLE_SIZE];
+    uint16_t vecinos_cantidad;
+    mrf24_phy_mode_t phy_modo;
+    bool_t phy_elegido;
+    mrf24_lpl_config_t lpl_config;
+    volatile mrf24_lpl_step_t lpl_paso;
+    delayNoBloqueanteData_t lpl_delay;
+    delayNoBloqueanteData_t lpl_tx_delay;
+    uint32_t lpl_slpcal;
+    uint8_t lpl_txncon;
+    bool_t lpl_repito;
+    mrf24_lpl_visto_t lpl_vistos[LPL_DUP_TABLE_SIZE];
+    uint8_t lpl_turno;
+    mrf24_lpl_stats_t lpl_stats;
+    mrf24_superframe_t sf;
+    uint8_t sf_bsn;
+    volatile mrf24_tx_handle_t sf_gts_handle[2];
+    mrf24_indirecta_t ind_tabla[INDIRECT_TABLE_SIZE];
+    uint32_t ind_orden;
+    uint16_t ind_coordinador;
+    volatile bool_t ind_pidiendo;
+    volatile bool_t ind_repito;
+    mrf24_indirect_stats_t ind_stats;
+#if MRF24_PERF
+    mrf24_perf_t perf;
+    mrf24_perf_clock_t perf_reloj;
+    mrf24_perf_api_t perf_api;
+    tick_t perf_tx_inicio;
+    tick_t perf_irq;
+    bool_t perf_irq_visto;
+#endif
+};
+
+/* === Declaración de variables públicas ===================================== */
+/**
+ * @brief Perfiles de inicialización incluidos en el driver.
+ */
+extern const mrf24_init_profile_t mrf24_profile_ma;
+extern const mrf24_init_profile_t mrf24_profile_mb;
+
 /* === Declaración de funciones públicas ====================================== */
 /**
- * @brief  Inicialización del módulo MRF24J40MA.
+ * @brief  Comienzo la inicialización del módulo MRF24J40MA.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  const mrf24_port_t * Funciones del port del módulo, se copian.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, INIT_IN_PROGRESS).
+ *
+ * @note   No bloquea: la inicialización avanza con cada llamada a MRF24Poll.
+ *         La configuración cargada antes con MRF24SetChannel, MRF24SetPanId,
+ *         etc. se conserva; lo que no se cargó toma el valor por defecto.
+ */
+mrf24_state_t MRF24J40Init(mrf24_dev_t * dev, const mrf24_port_t * port);
+
+/**
+ * @brief  Avanzo las tareas pendientes del driver.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado del driver (INIT_FAIL, INIT_IN_PROGRESS, INIT_OK,
+ *                       TIME_OUT_OCURRED, SCAN_IN_PROGRESS).
+ *
+ * @note   Se llama periódicamente desde el lazo principal. Nunca se queda
+ *         esperando al módulo; las esperas se controlan con el delay no
+ *         bloqueante.
+ */
+mrf24_state_t MRF24Poll(mrf24_dev_t * dev);
+
+/**
+ * @brief  Devuelvo el paso en el que se encuentra la inicialización.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_init_step_t Paso actual, INIT_STEP_FAILED si hubo time out.
+ */
+mrf24_init_step_t MRF24GetInitStep(mrf24_dev_t * dev);
+
+/**
+ * @brief  Elijo el perfil con el que se configuran los registros al inicializar.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  const mrf24_init_profile_t * Perfil a usar, NULL para el perfil por
+ *                                      defecto (mrf24_profile_ma).
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE,
+ *                       TRANS_IN_PROGRESS, OPERATION_OK).
+ *
+ * @note   El perfil no se copia, debe existir mientras se use el driver. Se
+ *         aplica en la próxima llamada a MRF24J40Init.
+ */
+mrf24_state_t MRF24SetInitProfile(mrf24_dev_t * dev, const mrf24_init_profile_t * perfil);
+
+/**
+ * @brief  Elijo el modo de la capa física.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_phy_mode_t Modo, PHY_250KBPS para volver al estándar.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, TRANS_IN_PROGRESS,
+ *         OPERATION_FAIL, OPERATION_OK).
+ *
+ * @note   Antes de MRF24J40Init sólo se guarda, y reemplaza a MRF24_PHY_MODE.
+ *         Con el módulo inicializado se aplica en el momento: se cargan
+ *         BBREG0, BBREG3 y BBREG4, el tiempo de espera del ACK y el espaciado
+ *         entre tramas del modo, y se reinicia RF. Si hay tramas indirectas
+ *         guardadas se mantiene DRPACK. No se puede cambiar durante
+ *         la inicialización, un escaneo o una transmisión en curso.
+ */
+mrf24_state_t MRF24SetPhyMode(mrf24_dev_t * dev, mrf24_phy_mode_t modo);
+
+/**
+ * @brief  Devuelvo el modo de la capa física.
  *
- * @param  None.
- * @return mrf24_state_t Estado de la operación (TIME_OUT_OCURRIDO,
- *                       INICIALIZACION_OK).
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_phy_mode_t Modo elegido.
  */
-mrf24_state_t MRF24J40Init(void);
+mrf24_phy_mode_t MRF24GetPhyMode(mrf24_dev_t * dev);
 
 /**
  * @brief  Actualizo el canal de trabajo.
  *
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @param  channel_list_t Nuevo canal.
  * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
  *
  * @note   Se comprueba la integridad del dato.
  */
-mrf24_state_t MRF24SetChannel(channel_list_t ch);
+mrf24_state_t MRF24SetChannel(mrf24_dev_t * dev, channel_list_t ch);
 
 /**
  * @brief  Actualizo el PANID de trabajo.
  *
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @param  uint16_t Nuevo PANID (uint16_t).
  * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
  *
  * @note   Se comprueba la integridad del dato.
  */
-mrf24_state_t MRF24SetPanId(uint16_t pan_id);
+mrf24_state_t MRF24SetPanId(mrf24_dev_t * dev, uint16_t pan_id);
 
 /**
  * @brief  Actualizo la dirección corta del dispositivo.
  *
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @param  uint16_t Nueva dirección (uint16_t).
  * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
  *
  * @note   Se comprueba la integridad del dato.
  */
-mrf24_state_t MRF24SetAdd(uint16_t add);
+mrf24_state_t MRF24SetAdd(mrf24_dev_t * dev, uint16_t add);
 
 /**
  * @brief  Actualizo el número de secuancia de las comunicaciones salientes.
  *
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @param  Nuevo número de secuencia (uint16_t).
  * @return mrf24_state_t Estado de la operación (OPERATION_OK).
  */
-mrf24_state_t MRF24SetSec(uint16_t sec);
+mrf24_state_t MRF24SetSec(mrf24_dev_t * dev, uint16_t sec);
 
 /**
  * @brief  Actualizo la dirección larga del dispositivo.
  *
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @param  uint8_t Nueva dirección (8 bytes).
  * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
  *
  * @note   Se comprueba la integridad del dato.
  */
-mrf24_state_t MRF24SetMAC(uint8_t mac[8]);
+mrf24_state_t MRF24SetMAC(mrf24_dev_t * dev, uint8_t mac[8]);
 
 /**
  * @brief  Actualizo la llave de seguridad para la encriptación.
  *
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @param  uint8_t Nueva llave (16 bytes).
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_FAIL,
+ *         OPERATION_OK).
+ *
+ * @note   Se comprueba la integridad del dato. Si el módulo ya está
+ *         inicializado la llave se carga en TX_SEC_KEY y RX_SEC_KEY, si no se
+ *         carga durante la inicialización.
+ */
+mrf24_state_t MRF24SetSecurityKey(mrf24_dev_t * dev, uint8_t security_key[16]);
+
+/**
+ * @brief  Selecciono el nivel de seguridad de las tramas encriptadas.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_sec_level_t Nivel de seguridad, SEC_NONE deshabilita la
+ *                           encriptación y el descifrado de tramas recibidas.
  * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ */
+mrf24_state_t MRF24SetSecurityLevel(mrf24_dev_t * dev, mrf24_sec_level_t nivel);
+
+/**
+ * @brief  Cargo el contador de tramas que se usa en el nonce de la encriptación.
  *
- * @note   Se comprueba la integridad del dato.
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint32_t Próximo valor del contador.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK).
+ *
+ * @note   La aplicación debe guardar el contador en memoria no volátil y
+ *         restaurarlo al arrancar: repetir un nonce con la misma llave rompe la
+ *         seguridad de AES-CCM.
+ */
+mrf24_state_t MRF24SetFrameCounter(mrf24_dev_t * dev, uint32_t contador);
+
+/**
+ * @brief  Leo el contador de tramas encriptadas.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return uint32_t Valor que se usará en la próxima trama encriptada.
+ */
+uint32_t MRF24GetFrameCounter(mrf24_dev_t * dev);
+
+/**
+ * @brief  Indico la dirección MAC del dispositivo del que se reciben tramas
+ *         encriptadas.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint8_t Dirección MAC del origen (8 bytes).
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_FAIL,
+ *         OPERATION_OK).
+ *
+ * @note   El módulo arma el nonce de descifrado con la dirección cargada en
+ *         ASSOEADR0-7, por eso solo se descifran tramas de un único origen.
  */
-mrf24_state_t MRF24SetSecurityKey(uint8_t security_key[16]);
+mrf24_state_t MRF24SetSecurityPeer(mrf24_dev_t * dev, uint8_t mac[8]);
 
 /**
  * @brief  Envío la información almacenada en la estructura de salida.
  *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_data_out_t * Puntero a la estructura que contiene la información
+ *                            de envío.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, TRANS_COMPLETED,
+ *         TRANS_IN_PROGRESS, DIRECTION_EMPTY, BUFFER_EMPTY, TO_LONG_MSG).
+ *
+ * @note   TRANS_COMPLETED indica que se disparó la transmisión. Si todavía hay
+ *         una trama en el aire devuelve TRANS_IN_PROGRESS sin tocar la FIFO. La
+ *         trama pide ACK salvo que el destino sea BROADCAST.
+ */
+mrf24_state_t MRF24TransmitirDato(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s);
+
+/**
+ * @brief  Envío la información almacenada en la estructura de salida sin
+ *         esperar el resultado.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @param  mrf24_data_out_t * Puntero a la estructura que contiene la información
  *                            de envío.
- * @return mrf24_state_t Estado de la operación (OPERACION_NO_REALIZADA,
- *         TRANSMISION_REALIZADA, NO_DIRECCION, MSG_NO_PRESENTE).
+ * @param  mrf24_tx_handle_t * Puntero a la variable donde se devuelve el
+ *                             identificador de la transmisión.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, OPERATION_OK,
+ *         TRANS_IN_PROGRESS, INVALID_VALUE, DIRECTION_EMPTY, BUFFER_EMPTY,
+ *         TO_LONG_MSG).
+ *
+ * @note   El resultado se obtiene con MRF24GetTxStatus o a través de la función
+ *         registrada con MRF24SetTxCallback, cuando el módulo avisa con TXNIF.
+ */
+mrf24_state_t MRF24TransmitirAsync(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s,
+                                   mrf24_tx_handle_t * handle);
+
+/**
+ * @brief  Agrego la información de la estructura de salida a la cola de
+ *         transmisión.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_data_out_t * Puntero a la estructura que contiene la información
+ *                            de envío, se copia y puede reutilizarse.
+ * @param  mrf24_tx_handle_t * Puntero a la variable donde se devuelve el
+ *                             identificador de la transmisión.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, OPERATION_OK,
+ *         BUFFER_FULL, INVALID_VALUE, DIRECTION_EMPTY, BUFFER_EMPTY, TO_LONG_MSG).
+ *
+ * @note   Las tramas se guardan ya codificadas en una subcola por destino. Al
+ *         terminar cada transmisión, MRF24InterruptHandler carga y dispara la
+ *         siguiente, tomando los destinos por turno para que uno que no
+ *         responde no bloquee al resto. Tras TX_QUEUE_MAX_FAILS fallos seguidos
+ *         las tramas pendientes para ese destino se informan como TX_DROPPED.
+ */
+mrf24_state_t MRF24EncolarDato(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s,
+                               mrf24_tx_handle_t * handle);
+
+/**
+ * @brief  Consulto el resultado de una transmisión.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_tx_handle_t Identificador de la transmisión.
+ * @param  mrf24_tx_result_t * Puntero a la estructura donde se copia el resultado.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, TRANS_IN_PROGRESS,
+ *         OPERATION_OK).
+ *
+ * @note   Las tramas en la cola o en el aire se informan como TX_PENDING. Se
+ *         conservan los resultados de las últimas TX_QUEUE_SIZE transmisiones
+ *         terminadas, para que se pueda consultar toda una tanda encolada.
+ */
+mrf24_state_t MRF24GetTxStatus(mrf24_dev_t * dev, mrf24_tx_handle_t handle,
+                               mrf24_tx_result_t * resultado);
+
+/**
+ * @brief  Registro la función que se llama al terminar cada transmisión.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_tx_callback_t Función a llamar, NULL para no llamar a ninguna.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK).
+ */
+mrf24_state_t MRF24SetTxCallback(mrf24_dev_t * dev, mrf24_tx_callback_t callback);
+
+/**
+ * @brief  Envío un mensaje formado por varios segmentos de datos.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t PANID de destino, VACIO para usar el propio.
+ * @param  uint16_t Dirección de destino.
+ * @param  const mrf24_segment_t * Lista de segmentos a enviar, en orden.
+ * @param  uint8_t Cantidad de segmentos de la lista.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, INVALID_VALUE,
+ *         TRANS_COMPLETED, TRANS_IN_PROGRESS, DIRECTION_EMPTY, BUFFER_EMPTY,
+ *         TO_LONG_MSG).
+ *
+ * @note   Los segmentos se escriben directamente en la FIFO de transmisión, a
+ *         continuación de la cabecera y en la misma transacción SPI, sin pasar
+ *         por un buffer intermedio.
+ */
+mrf24_state_t MRF24TransmitirSegmentos(mrf24_dev_t * dev, uint16_t dest_panid,
+                                       uint16_t dest_address, const mrf24_segment_t * segmentos,
+                                       uint8_t cantidad);
+
+/**
+ * @brief  Transmito una trama con tipo, direccionamiento y ACK a elección.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  const mrf24_frame_opts_t * Opciones de la trama.
+ * @param  const mrf24_segment_t * Lista de segmentos a enviar, en orden.
+ * @param  uint8_t Cantidad de segmentos de la lista.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, INVALID_VALUE,
+ *         TRANS_COMPLETED, TRANS_IN_PROGRESS, DIRECTION_EMPTY, BUFFER_EMPTY,
+ *         TO_LONG_MSG).
+ *
+ * @note   INVALID_VALUE si falta destino y origen a la vez, si se pide
+ *         pan_compression sin alguno de los dos o si un modo o el tipo no
+ *         existen. Los datos pueden ocupar lo que deja la cabecera, ver
+ *         MRF24LargoCabecera: con direcciones cortas en el mismo PAN son
+ *         MAX_PAYLOAD_SIZE bytes.
+ */
+mrf24_state_t MRF24TransmitirTrama(mrf24_dev_t * dev, const mrf24_frame_opts_t * opciones,
+                                   const mrf24_segment_t * segmentos, uint8_t cantidad);
+
+/**
+ * @brief  Calculo el largo de la cabecera MAC que sale de unas opciones.
+ *
+ * @param  const mrf24_frame_opts_t * Opciones de la trama.
+ * @return uint8_t Largo de la cabecera, de 7 a 23 bytes.
+ */
+uint8_t MRF24LargoCabecera(const mrf24_frame_opts_t * opciones);
+
+/**
+ * @brief  Hay mensajes pendientes de lectura?
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (UNEXPECTED_ERROR, MSG_PRESENT,
+ *         BUFFER_EMPTY).
+ *
+ * @note   Devuelve MSG_PRESENT si hay tramas en el buffer de recepción o si el
+ *         módulo tiene levantada la línea de interrupción.
  */
-mrf24_state_t MRF24TransmitirDato(mrf24_data_out_t * p_info_out_s);
+mrf24_state_t MRF24IsNewMsg(mrf24_dev_t * dev);
 
 /**
- * @brief  Se levantó la bandera indicando la llegada de un mensaje?
+ * @brief  Atención de la interrupción del módulo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, OPERATION_OK,
+ *         BUFFER_EMPTY, BUFFER_FULL, MSG_READ, TRANS_COMPLETED).
  *
- * @param  None.
- * @return mrf24_state_t Estado de la operación (ERROR_INESPERADO, MSG_PRESENTE,
- *         MSG_NO_PRESENTE).
+ * @note   Pensada para llamarse desde la rutina de interrupción del pin INT.
+ *         Usa el SPI y la copia de los registros igual que el resto del
+ *         driver: el port debe tener mask_interrupt o, si no, la aplicación
+ *         debe enmascarar esa interrupción mientras llama a cualquier otra
+ *         función del driver.
+ *         Lee INTSTAT y, si llegó una trama, la guarda en el buffer circular
+ *         de recepción. Si el buffer está lleno la trama se descarta y se
+ *         cuenta como overrun. Si terminó una transmisión lee TXSTAT y avisa
+ *         el resultado; en ese caso, sin trama recibida, devuelve
+ *         TRANS_COMPLETED. Los beacons no se guardan: van a la tabla de
+ *         vecinos y se devuelve OPERATION_OK.
  */
-mrf24_state_t MRF24IsNewMsg(void);
+mrf24_state_t MRF24InterruptHandler(mrf24_dev_t * dev);
 
 /**
- * @brief  Recibir un paquete y dejarlo en el bufer de entrada en la estructura
- *         data_in_s.
+ * @brief  Recibir un paquete y dejarlo en el buffer circular de recepción.
  *
- * @param  None.
- * @return mrf24_state_t Estado de la operación (OPERACION_NO_REALIZADA, MSG_LEIDO).
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, BUFFER_EMPTY,
+ *         BUFFER_FULL, MSG_READ, TRANS_COMPLETED).
+ *
+ * @note   Para trabajar por encuesta: hace lo mismo que MRF24InterruptHandler.
+ *         La trama completa, junto con el LQI y el RSSI que agrega el módulo,
+ *         se lee de la FIFO en una sola transacción SPI.
  */
-mrf24_state_t MRF24ReciboPaquete(void);
+mrf24_state_t MRF24ReciboPaquete(mrf24_dev_t * dev);
 
 /**
- * @brief  Devuelvo el puntero a la estructura que contiene la información del
- *         mensaje de entrada.
+ * @brief  Devuelvo el puntero a la trama más antigua del buffer de recepción.
  *
- * @param  None.
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @return mrf24_data_in_t * Puntero a la estructura donde se almacena el mensaje
- *                           de llegada junto con la información del mismo.
+ *                           de llegada junto con la información del mismo, NULL
+ *                           si no hay mensajes.
+ *
+ * @note   La trama sigue en el buffer hasta llamar a MRF24ReleaseDataIn.
+ */
+mrf24_data_in_t * MRF24GetDataIn(mrf24_dev_t * dev);
+
+/**
+ * @brief  Libero la trama más antigua del buffer de recepción.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (BUFFER_EMPTY, OPERATION_OK).
+ */
+mrf24_state_t MRF24ReleaseDataIn(mrf24_dev_t * dev);
+
+/**
+ * @brief  Copio los contadores de la recepción.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_rx_stats_t * Puntero a la estructura donde se copian.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ */
+mrf24_state_t MRF24GetRxStats(mrf24_dev_t * dev, mrf24_rx_stats_t * stats);
+
+/**
+ * @brief  Activo o desactivo el modo sniffer.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  bool_t true para recibir todas las tramas, sin filtrar por PAN,
+ *                dirección ni tipo.
+ * @param  bool_t true para recibir también las tramas con el CRC mal.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE,
+ *         TRANS_IN_PROGRESS, OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   Pone PROMI, ERRPKT y NOACKRSP en RXMCR: el módulo no responde ACK ni
+ *         descifra, y las tramas, beacons y ACKs incluidos, se entregan
+ *         crudas por MRF24GetDataIn. Se puede llamar antes de MRF24J40Init y
+ *         se mantiene tras los escaneos; durante uno devuelve
+ *         TRANS_IN_PROGRESS. INVALID_VALUE si se piden las tramas con error
+ *         sin activar el modo.
  */
-mrf24_data_in_t * MRF24GetDataIn(void);
+mrf24_state_t MRF24SetSniffer(mrf24_dev_t * dev, bool_t activo, bool_t con_errores);
 
-mrf24_state_t MRF24BuscarDispositivos(void);
-mrf24_state_t MRF24TransmitirDatoEncriptado(void);
+/**
+ * @brief  Registro el reloj con el que se marca cada trama recibida.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_rx_clock_t Función que devuelve el tiempo en microsegundos,
+ *                          NULL para no marcar las tramas.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK).
+ *
+ * @note   Se lee al atender RXIF, que el módulo levanta al terminar la trama:
+ *         la marca es el fin de la trama atrasado en la latencia de la
+ *         interrupción.
+ */
+mrf24_state_t MRF24SetRxClock(mrf24_dev_t * dev, mrf24_rx_clock_t reloj);
+
+/**
+ * @brief  Envío encriptada la información almacenada en la estructura de salida.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_data_out_t * Puntero a la estructura que contiene la información
+ *                            de envío.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, INVALID_VALUE,
+ *         DIRECTION_EMPTY, BUFFER_EMPTY, TO_LONG_MSG, TRANS_IN_PROGRESS,
+ *         TRANS_COMPLETED).
+ *
+ * @note   El módulo encripta la trama con AES-CCM según el nivel seleccionado
+ *         con MRF24SetSecurityLevel. La cabecera auxiliar y el MIC ocupan lugar
+ *         en la trama, por lo que el máximo de datos es menor a MAX_PAYLOAD_SIZE.
+ *         Devuelve INVALID_VALUE si no hay nivel seleccionado o si se agotó el
+ *         contador de tramas.
+ */
+mrf24_state_t MRF24TransmitirDatoEncriptado(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s);
+
+/**
+ * @brief  Comienzo el escaneo de energía de los 16 canales.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  tick_t Tiempo de permanencia en cada canal, en milisegundos.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, INVALID_VALUE,
+ *         TRANS_IN_PROGRESS, SCAN_IN_PROGRESS).
+ *
+ * @note   No bloquea: el escaneo avanza con cada llamada a MRF24Poll y dura
+ *         CHANNEL_COUNT veces el tiempo de permanencia. En cada canal se toman
+ *         lecturas de RSSI mientras dure la permanencia, tantas como llamadas
+ *         a MRF24Poll. Mientras tanto no se puede transmitir ni recibir; al
+ *         terminar se vuelve al canal configurado y se descarta lo recibido.
+ */
+mrf24_state_t MRF24EscanearEnergia(mrf24_dev_t * dev, tick_t permanencia);
+
+/**
+ * @brief  Copio la tabla de energía del último escaneo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_ed_result_t * Tabla donde se copian los CHANNEL_COUNT canales.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, BUFFER_EMPTY,
+ *         TRANS_IN_PROGRESS, OPERATION_OK).
+ */
+mrf24_state_t MRF24GetEnergia(mrf24_dev_t * dev, mrf24_ed_result_t * tabla);
+
+/**
+ * @brief  Comienzo la búsqueda activa de dispositivos cercanos.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  tick_t Tiempo de espera de beacons en cada canal, en milisegundos.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, INVALID_VALUE,
+ *         TRANS_IN_PROGRESS, SCAN_IN_PROGRESS).
+ *
+ * @note   No bloquea: avanza con cada llamada a MRF24Poll. En cada canal se
+ *         envía un beacon request y los beacons que llegan, que se atienden en
+ *         MRF24InterruptHandler, se registran en la tabla de vecinos. La
+ *         búsqueda dura CHANNEL_COUNT veces el tiempo de espera sin importar
+ *         cuántos dispositivos respondan. La tabla se vacía al comenzar.
+ */
+mrf24_state_t MRF24BuscarDispositivos(mrf24_dev_t * dev, tick_t permanencia);
+
+/**
+ * @brief  Devuelvo la cantidad de dispositivos registrados en la tabla de
+ *         vecinos.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return uint16_t Cantidad de vecinos.
+ */
+uint16_t MRF24GetCantidadVecinos(mrf24_dev_t * dev);
+
+/**
+ * @brief  Busco un dispositivo en la tabla de vecinos.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t PANID del dispositivo.
+ * @param  uint16_t Dirección corta, o NO_SHORT_ADDRESS para buscar por la larga.
+ * @param  const uint8_t * Dirección larga (8 bytes), sólo se usa si la corta es
+ *                         NO_SHORT_ADDRESS.
+ * @return const MRF24_discover_nearby_t * Vecino encontrado, NULL si no está.
+ */
+const MRF24_discover_nearby_t * MRF24BuscarVecino(mrf24_dev_t * dev, uint16_t panid,
+                                                  uint16_t short_address,
+                                                  const uint8_t * long_address);
+
+/**
+ * @brief  Devuelvo la tabla de vecinos para recorrerla.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return const MRF24_discover_nearby_t * Tabla de NEIGHBOR_TABLE_SIZE entradas,
+ *         las libres tienen channel en VACIO.
+ */
+const MRF24_discover_nearby_t * MRF24GetVecinos(mrf24_dev_t * dev);
+
+/**
+ * @brief  Activo, cambio o desactivo la escucha de bajo consumo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  const mrf24_lpl_config_t * Configuración, se copia. NULL para dejar
+ *                                    el módulo escuchando siempre.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE,
+ *         TRANS_IN_PROGRESS, OPERATION_OK).
+ *
+ * @note   El módulo duerme con el temporizador de sleep (MAINCNT) y se
+ *         despierta cada max_latency para escuchar. Al activarla se calibra el
+ *         reloj de sleep con SLPCAL, así la demora no depende del error del
+ *         oscilador de 100 kHz. Cada trama se repite desde la FIFO hasta que
+ *         llega el ACK o pasa un ciclo y una ventana; los broadcasts se
+ *         repiten siempre durante todo ese tiempo, y el receptor descarta las
+ *         copias por el número de secuencia. Todos los módulos de la red
+ *         tienen que usar la misma configuración. Para transmitir conviene
+ *         MRF24EncolarDato: con el módulo dormido las demás funciones de envío
+ *         lo despiertan y devuelven TRANS_IN_PROGRESS hasta que WAKEIF avise
+ *         que está listo. MRF24Poll y MRF24InterruptHandler tienen que
+ *         llamarse seguido. Se puede llamar antes de MRF24J40Init; durante un
+ *         escaneo devuelve TRANS_IN_PROGRESS. INVALID_VALUE si listen es menor
+ *         a LPL_MIN_LISTEN o no es menor que max_latency, o si el módulo usa
+ *         una supertrama.
+ */
+mrf24_state_t MRF24SetLowPower(mrf24_dev_t * dev, const mrf24_lpl_config_t * config);
+
+/**
+ * @brief  Devuelvo el paso en el que se encuentra la escucha de bajo consumo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_lpl_step_t Paso actual, LPL_STEP_OFF si está desactivada.
+ */
+mrf24_lpl_step_t MRF24GetLowPowerStep(mrf24_dev_t * dev);
+
+/**
+ * @brief  Copio los contadores de la escucha de bajo consumo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_lpl_stats_t * Puntero a la estructura donde se copian.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ */
+mrf24_state_t MRF24GetLowPowerStats(mrf24_dev_t * dev, mrf24_lpl_stats_t * stats);
+
+/**
+ * @brief  Activo, cambio o desactivo la supertrama del coordinador.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  const mrf24_superframe_config_t * Configuración, se copia. NULL para
+ *                                           dejar de enviar beacons.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE,
+ *         TRANS_IN_PROGRESS, OPERATION_OK).
+ *
+ * @note   El módulo pasa a ser coordinador del PAN: envía un beacon al
+ *         comienzo de cada supertrama, con las GTS asignadas, y transmite con
+ *         CSMA-CA ranurado dentro del CAP. Cambiar la configuración borra las
+ *         GTS asignadas y las tramas que esperaban su GTS se informan con
+ *         TX_DROPPED. El período inactivo (SO < BO) no se aprovecha para
+ *         dormir. Se puede llamar antes de MRF24J40Init; durante un escaneo
+ *         devuelve TRANS_IN_PROGRESS. INVALID_VALUE si los órdenes no son
+ *         válidos, si está activa la escucha de bajo consumo o si el módulo
+ *         sigue los beacons de otro coordinador.
+ */
+mrf24_state_t MRF24SetSuperframe(mrf24_dev_t * dev, const mrf24_superframe_config_t * config);
+
+/**
+ * @brief  Sigo, o dejo de seguir, los beacons del coordinador del PAN.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  bool_t true para sincronizarse con los beacons.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE,
+ *         TRANS_IN_PROGRESS, OPERATION_OK).
+ *
+ * @note   Con cada beacon del PAN propio el módulo toma el orden de la
+ *         supertrama, el final del CAP y las GTS, y transmite con CSMA-CA
+ *         ranurado sólo dentro del CAP. Hasta recibir el primer beacon
+ *         transmite como siempre. Se puede llamar antes de MRF24J40Init;
+ *         durante un escaneo devuelve TRANS_IN_PROGRESS. INVALID_VALUE si el
+ *         módulo es coordinador o está activa la escucha de bajo consumo.
+ */
+mrf24_state_t MRF24SeguirBeacons(mrf24_dev_t * dev, bool_t activo);
+
+/**
+ * @brief  Asigno una GTS a un dispositivo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t Dirección corta del dispositivo.
+ * @param  uint8_t Largo en slots.
+ * @param  mrf24_gts_dir_t Sentido: GTS_DIR_TRANSMIT si transmite el
+ *                         dispositivo, GTS_DIR_RECEIVE si transmite el
+ *                         coordinador.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, INVALID_VALUE,
+ *         BUFFER_FULL, TRANS_IN_PROGRESS, OPERATION_OK).
+ *
+ * @note   Sólo en el coordinador. La nueva GTS se ubica justo después del CAP,
+ *         que se achica; las ya asignadas no se mueven. Sale en el próximo
+ *         beacon. BUFFER_FULL si ya hay SF_MAX_GTS o si el CAP quedaría más
+ *         corto que aMinCAPLength (440 símbolos). INVALID_VALUE si la
+ *         dirección no es de un único dispositivo o si ya tiene una GTS en ese
+ *         sentido. TRANS_IN_PROGRESS mientras el coordinador tenga una trama
+ *         esperando su GTS.
+ */
+mrf24_state_t MRF24AsignarGts(mrf24_dev_t * dev, uint16_t address, uint8_t slots,
+                              mrf24_gts_dir_t direccion);
+
+/**
+ * @brief  Libero la GTS de un dispositivo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t Dirección corta del dispositivo.
+ * @param  mrf24_gts_dir_t Sentido de la GTS.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, INVALID_VALUE,
+ *         TRANS_IN_PROGRESS, OPERATION_OK).
+ *
+ * @note   Sólo en el coordinador. Las GTS más cercanas al CAP se corren para
+ *         no dejar huecos y el CAP crece. INVALID_VALUE si el dispositivo no
+ *         tiene una GTS en ese sentido.
+ */
+mrf24_state_t MRF24LiberarGts(mrf24_dev_t * dev, uint16_t address, mrf24_gts_dir_t direccion);
+
+/**
+ * @brief  Transmito una trama en una GTS, sin contención.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_data_out_t * Puntero a la información a transmitir.
+ * @param  mrf24_tx_handle_t * Puntero donde se devuelve el identificador de
+ *                             la transmisión.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, INVALID_VALUE,
+ *         DIRECTION_EMPTY, BUFFER_EMPTY, TO_LONG_MSG, BUFFER_FULL, OPERATION_OK).
+ *
+ * @note   Un dispositivo transmite en su GTS_DIR_TRANSMIT; el coordinador en
+ *         la GTS_DIR_RECEIVE del destino. La trama va a una de las dos FIFO
+ *         de GTS y el módulo la envía al comenzar la GTS, con ACK y hasta 3
+ *         reintentos mientras quede tiempo. El resultado llega como el de
+ *         MRF24TransmitirAsync; TX_DROPPED indica que no entraba en la GTS.
+ *         INVALID_VALUE si no hay una GTS para la trama, BUFFER_FULL si las
+ *         dos FIFO de GTS están ocupadas.
+ */
+mrf24_state_t MRF24TransmitirGts(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s,
+                                 mrf24_tx_handle_t * handle);
+
+/**
+ * @brief  Copio el estado de la supertrama.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_superframe_t * Puntero a la estructura donde se copia.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ */
+mrf24_state_t MRF24GetSuperframe(mrf24_dev_t * dev, mrf24_superframe_t * superframe);
+
+/**
+ * @brief  Guardo una trama para un dispositivo dormido hasta que la pida.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_data_out_t * Puntero a la información a transmitir.
+ * @param  tick_t Milisegundos que se guarda la trama, VACIO para usar
+ *                INDIRECT_PERSISTENCE.
+ * @param  mrf24_tx_handle_t * Puntero donde se devuelve el identificador de
+ *                             la transmisión.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, INVALID_VALUE,
+ *         DIRECTION_EMPTY, BUFFER_EMPTY, TO_LONG_MSG, BUFFER_FULL, OPERATION_OK).
+ *
+ * @note   Es la transmisión indirecta del coordinador: la trama sale recién
+ *         cuando el destino manda un pedido de datos (MRF24PedirDatos), con el
+ *         bit de trama pendiente si le quedan más. Mientras haya tramas
+ *         guardadas el módulo reconoce todo pedido de datos con trama
+ *         pendiente (DRPACK), porque no puede hacerlo por destino. Si la
+ *         entrega falla la trama sigue guardada hasta el próximo pedido. El
+ *         resultado llega como el de MRF24TransmitirAsync, TX_EXPIRED si se
+ *         cumple el plazo antes de entregarla. BUFFER_FULL si las
+ *         INDIRECT_TABLE_SIZE entradas están ocupadas; INVALID_VALUE a
+ *         BROADCAST o a NO_SHORT_ADDRESS, porque el destino se reconoce por
+ *         la dirección corta de su pedido.
+ */
+mrf24_state_t MRF24EncolarIndirecto(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s,
+                                    tick_t persistencia, mrf24_tx_handle_t * handle);
+
+/**
+ * @brief  Pido al coordinador las tramas que tenga guardadas para el módulo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t Dirección corta del coordinador.
+ * @param  mrf24_tx_handle_t * Puntero donde se devuelve el identificador de
+ *                             la transmisión del pedido.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, INVALID_VALUE,
+ *         DIRECTION_EMPTY, TRANS_IN_PROGRESS, OPERATION_OK).
+ *
+ * @note   Manda el comando Data Request de IEEE 802.15.4; TRANS_IN_PROGRESS
+ *         si el módulo está transmitiendo o despertándose, y hay que volver a
+ *         llamar. Si el ACK no trae trama pendiente (FPSTAT) y el módulo usa
+ *         la escucha de bajo consumo, vuelve a dormir sin esperar la ventana
+ *         de escucha. Si la trama que llega del coordinador avisa que tiene
+ *         más, el pedido se repite solo desde MRF24Poll; su resultado se
+ *         informa a la función registrada con su propio identificador.
+ */
+mrf24_state_t MRF24PedirDatos(mrf24_dev_t * dev, uint16_t coordinador,
+                              mrf24_tx_handle_t * handle);
+
+/**
+ * @brief  Copio los contadores de la transmisión indirecta.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_indirect_stats_t * Puntero a la estructura donde se copian.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ */
+mrf24_state_t MRF24GetIndirectStats(mrf24_dev_t * dev, mrf24_indirect_stats_t * stats);
+
+#if MRF24_PERF
+/**
+ * @brief  Registro la fuente de ticks para los histogramas de latencia.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_perf_clock_t Función que devuelve el tick actual, NULL para no
+ *                            medir latencias.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK).
+ *
+ * @note   Sólo con MRF24_PERF en 1. Se puede usar la misma base de tiempo que
+ *         app_delay_unlock.h o un contador más fino.
+ */
+mrf24_state_t MRF24SetPerfClock(mrf24_dev_t * dev, mrf24_perf_clock_t reloj);
+
+/**
+ * @brief  Copio los contadores de rendimiento.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_perf_t * Puntero a la estructura donde se copian.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ */
+mrf24_state_t MRF24GetPerf(mrf24_dev_t * dev, mrf24_perf_t * perf);
+
+/**
+ * @brief  Pongo en cero los contadores de rendimiento.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK).
+ *
+ * @note   Las mediciones en curso, una transmisión en el aire o una
+ *         interrupción sin atender, se siguen contando.
+ */
+mrf24_state_t MRF24ResetPerf(mrf24_dev_t * dev);
+#endif
 
 #endif /* INC_DRV_MRF24J40_H_ */
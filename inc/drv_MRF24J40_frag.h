@@ -0,0 +1,238 @@
+/**
+ *******************************************************************************
+ * @file    drv_MRF24J40_frag.h
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Fragmentación y reensamblado de mensajes más largos que una trama
+ *******************************************************************************
+ * @attention Cada fragmento lleva una cabecera de 4 bytes delante de los datos:
+ *            FRAG_DISPATCH, la etiqueta del mensaje, el índice del fragmento y
+ *            el índice del último. Todos los fragmentos menos el último llevan
+ *            FRAG_DATA_SIZE bytes de datos, así que la posición de cada uno en
+ *            el mensaje sale de su índice y pueden llegar en cualquier orden.
+ *******************************************************************************
+ */
+#ifndef INC_DRV_MRF24J40_FRAG_H_
+#define INC_DRV_MRF24J40_FRAG_H_
+
+/* === Archivos cabecera ====================================================== */
+#include "drv_MRF24J40.h"
+
+/* === Definición de macros públicas ========================================== */
+#define FRAG_DISPATCH      (0xF0) /* libre entre los dispatch de 6LoWPAN */
+#define FRAG_HEADER_SIZE   4
+#define FRAG_DATA_SIZE     (MAX_PAYLOAD_SIZE - FRAG_HEADER_SIZE)
+#define FRAG_MAX_FRAGMENTS 256
+#define FRAG_MAX_LENGTH    (FRAG_MAX_FRAGMENTS * FRAG_DATA_SIZE)
+
+/**
+ * @brief Mensajes que se pueden reensamblar a la vez y largo máximo de cada uno.
+ *
+ * @note  Cada lugar ocupa FRAG_RX_MESSAGE_SIZE bytes más su mapa de fragmentos.
+ */
+#ifndef FRAG_RX_SLOTS
+#define FRAG_RX_SLOTS 2
+#endif
+
+#ifndef FRAG_RX_MESSAGE_SIZE
+#define FRAG_RX_MESSAGE_SIZE 4096
+#endif
+
+#if FRAG_RX_MESSAGE_SIZE > FRAG_MAX_LENGTH
+#error "FRAG_RX_MESSAGE_SIZE supera el largo que permite la cabecera de fragmento"
+#endif
+
+/**
+ * @brief Ticks que puede tardar en completarse un mensaje desde su primer
+ *        fragmento antes de descartarlo.
+ */
+#ifndef FRAG_RX_TIMEOUT
+#define FRAG_RX_TIMEOUT 2000
+#endif
+
+/**
+ * @brief Fallos seguidos de transmisión a partir de los cuales se abandona el
+ *        envío de un mensaje.
+ */
+#ifndef FRAG_TX_MAX_FAILS
+#define FRAG_TX_MAX_FAILS 6
+#endif
+
+#define FRAG_TX_MAP_SIZE (FRAG_MAX_FRAGMENTS / 8)
+#define FRAG_RX_MAP_SIZE ((FRAG_RX_MESSAGE_SIZE / FRAG_DATA_SIZE + 1 + 7) / 8)
+
+/* === Declaración de tipo de datos públicos ================================== */
+/**
+ * @brief Estado de un lugar de reensamblado.
+ */
+typedef enum {
+
+    FRAG_RX_LIBRE,
+    FRAG_RX_ARMANDO,
+    FRAG_RX_COMPLETO,
+} mrf24_frag_rx_estado_t;
+
+/**
+ * @brief Mensaje reensamblado que se entrega a la aplicación.
+ */
+typedef struct {
+
+    uint16_t address;
+    uint16_t length;
+    const uint8_t * data;
+} mrf24_frag_msg_t;
+
+/**
+ * @brief Contadores de la capa de fragmentación.
+ *
+ * @note  tx_resent cuenta los fragmentos que se vuelven a encolar porque
+ *        fallaron, se descartaron de la cola o se perdió su resultado.
+ *        rx_no_slot cuenta los fragmentos que no entraron, por falta de lugar
+ *        o por largo, y rx_invalid los de cabecera imposible.
+ */
+typedef struct {
+
+    uint32_t tx_messages;
+    uint32_t tx_failed;
+    uint32_t tx_fragments;
+    uint32_t tx_resent;
+    uint32_t rx_messages;
+    uint32_t rx_fragments;
+    uint32_t rx_duplicates;
+    uint32_t rx_timeouts;
+    uint32_t rx_no_slot;
+    uint32_t rx_invalid;
+} mrf24_frag_stats_t;
+
+/**
+ * @brief Mensaje que se está reensamblando.
+ */
+typedef struct {
+
+    mrf24_frag_rx_estado_t estado;
+    uint16_t origen;
+    uint8_t etiqueta;
+    uint8_t ultimo;
+    uint16_t recibidos;
+    uint16_t largo;
+    delayNoBloqueanteData_t vencimiento;
+    uint8_t mapa[FRAG_RX_MAP_SIZE];
+    uint8_t datos[FRAG_RX_MESSAGE_SIZE];
+} mrf24_frag_rx_t;
+
+/**
+ * @brief Estado de la capa de fragmentación de un módulo.
+ *
+ * @note  Como mrf24_dev_t, la aplicación la reserva (por ejemplo static) y la
+ *        pasa a todas las funciones. Los campos son de uso interno.
+ */
+typedef struct {
+
+    mrf24_dev_t * dev;
+    const uint8_t * tx_datos;
+    uint16_t tx_largo;
+    uint16_t tx_destino;
+    uint8_t tx_etiqueta;
+    uint8_t tx_ultimo;
+    uint16_t tx_confirmados;
+    uint8_t tx_fallos;
+    bool_t tx_activo;
+    uint8_t tx_ok[FRAG_TX_MAP_SIZE];
+    uint8_t tx_en_vuelo[FRAG_TX_MAP_SIZE];
+    mrf24_tx_handle_t vuelo_handle[TX_QUEUE_SIZE];
+    uint8_t vuelo_indice[TX_QUEUE_SIZE];
+    mrf24_frag_rx_t rx[FRAG_RX_SLOTS];
+    mrf24_frag_msg_t mensaje;
+    mrf24_frag_stats_t stats;
+} mrf24_frag_t;
+
+/* === Declaración de funciones públicas ====================================== */
+/**
+ * @brief  Inicializo la capa de fragmentación sobre un módulo.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @param  mrf24_dev_t * Módulo por el que se transmite y se recibe.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ */
+mrf24_state_t MRF24FragInit(mrf24_frag_t * frag, mrf24_dev_t * dev);
+
+/**
+ * @brief  Comienzo el envío de un mensaje fragmentado.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @param  uint16_t Dirección de destino.
+ * @param  const uint8_t * Mensaje, no se copia: debe existir hasta que
+ *                         MRF24FragPoll informe el final del envío.
+ * @param  uint16_t Largo del mensaje, hasta FRAG_MAX_LENGTH.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, DIRECTION_EMPTY,
+ *         BUFFER_EMPTY, TO_LONG_MSG, TRANS_IN_PROGRESS, OPERATION_OK).
+ *
+ * @note   Los fragmentos salen por la cola de transmisión del driver, varios
+ *         encolados a la vez: el módulo dispara cada uno al terminar el
+ *         anterior, sin pasar por la aplicación. El envío avanza con
+ *         MRF24FragPoll.
+ */
+mrf24_state_t MRF24FragEnviar(mrf24_frag_t * frag, uint16_t destino, const uint8_t * datos,
+                              uint16_t largo);
+
+/**
+ * @brief  Avanzo el envío en curso y los vencimientos del reensamblado.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @return mrf24_state_t Estado del envío (OPERATION_OK sin envío en curso,
+ *         TRANS_IN_PROGRESS, TRANS_COMPLETED, OPERATION_FAIL).
+ *
+ * @note   Se llama desde el lazo principal, junto con MRF24Poll. Recoge el
+ *         resultado de los fragmentos que terminaron, vuelve a encolar los que
+ *         fallaron y encola los siguientes mientras haya lugar en la cola.
+ *         TRANS_COMPLETED y OPERATION_FAIL se devuelven una sola vez, al
+ *         terminar el mensaje; el envío se abandona tras FRAG_TX_MAX_FAILS
+ *         fallos seguidos.
+ */
+mrf24_state_t MRF24FragPoll(mrf24_frag_t * frag);
+
+/**
+ * @brief  Proceso una trama recibida.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @param  const mrf24_data_in_t * Trama leída con MRF24GetDataIn.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE si la trama no es
+ *         un fragmento, OPERATION_OK, MSG_READ si se completó un mensaje,
+ *         BUFFER_FULL si no hay lugar para un mensaje nuevo, TO_LONG_MSG si
+ *         el mensaje no entra en FRAG_RX_MESSAGE_SIZE, OPERATION_FAIL si la
+ *         cabecera es imposible).
+ *
+ * @note   Los fragmentos repetidos se ignoran. Con INVALID_VALUE la trama es
+ *         de la aplicación y se procesa como cualquier otra. Antes de buscar
+ *         lugar se descartan los mensajes vencidos.
+ */
+mrf24_state_t MRF24FragRecibir(mrf24_frag_t * frag, const mrf24_data_in_t * trama);
+
+/**
+ * @brief  Obtengo el primer mensaje reensamblado.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @return mrf24_frag_msg_t * Mensaje, NULL si no hay ninguno completo.
+ *
+ * @note   El mensaje ocupa su lugar hasta que se libera con
+ *         MRF24FragReleaseMensaje.
+ */
+mrf24_frag_msg_t * MRF24FragGetMensaje(mrf24_frag_t * frag);
+
+/**
+ * @brief  Libero el lugar del mensaje obtenido con MRF24FragGetMensaje.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @return mrf24_state_t Estado de la operación (BUFFER_EMPTY, OPERATION_OK).
+ */
+mrf24_state_t MRF24FragReleaseMensaje(mrf24_frag_t * frag);
+
+/**
+ * @brief  Copio los contadores de la capa de fragmentación.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @param  mrf24_frag_stats_t * Donde se copian los contadores.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ */
+mrf24_state_t MRF24FragGetStats(mrf24_frag_t * frag, mrf24_frag_stats_t * stats);
+
+#endif /* INC_DRV_MRF24J40_FRAG_H_ */
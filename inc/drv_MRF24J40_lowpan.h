@@ -0,0 +1,116 @@
+/**
+ *******************************************************************************
+ * @file    drv_MRF24J40_lowpan.h
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Adaptación 6LoWPAN: compresión IPHC de IPv6 y NHC de UDP (RFC 6282)
+ *******************************************************************************
+ * @attention Sin contextos: sólo se comprimen las direcciones link-local
+ *            (fe80::/64), la no especificada y las multicast. La IID de una
+ *            dirección link-local se elide cuando coincide con la que sale de
+ *            la dirección corta de la trama, 0000:00ff:fe00:XXXX. El checksum
+ *            de UDP siempre va en la trama.
+ *******************************************************************************
+ */
+#ifndef INC_DRV_MRF24J40_LOWPAN_H_
+#define INC_DRV_MRF24J40_LOWPAN_H_
+
+/* === Archivos cabecera ====================================================== */
+#include "drv_MRF24J40.h"
+
+/* === Definición de macros públicas ========================================== */
+#define LOWPAN_IPV6_ADDRESS  16
+#define LOWPAN_IPV6_HEADER   40
+#define LOWPAN_UDP_HEADER    8
+#define LOWPAN_MAX_HEADER    48 /* IPHC y NHC con todos los campos en línea */
+#define LOWPAN_NEXT_UDP      17
+
+/* === Declaración de funciones públicas ====================================== */
+/**
+ * @brief  Comprimo la cabecera IPv6 de un paquete y, si es UDP, la de UDP.
+ *
+ * @param  const uint8_t * Paquete IPv6 completo.
+ * @param  uint16_t Largo del paquete.
+ * @param  uint16_t Dirección corta de origen de la trama.
+ * @param  uint16_t Dirección corta de destino de la trama.
+ * @param  uint8_t * Donde se escribe la cabecera comprimida, de al menos
+ *                   LOWPAN_MAX_HEADER bytes.
+ * @param  uint8_t * Donde se devuelve el largo de la cabecera comprimida.
+ * @param  uint16_t * Donde se devuelven los bytes del paquete que reemplaza la
+ *                    cabecera comprimida; el resto va sin cambios detrás.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ *
+ * @note   INVALID_VALUE si no es IPv6 o si el largo de la cabecera no coincide
+ *         con el del paquete. UDP se comprime sólo si su largo coincide con
+ *         el de IPv6, porque del otro lado se recalcula.
+ */
+mrf24_state_t MRF24LowpanComprimir(const uint8_t * paquete, uint16_t largo, uint16_t origen,
+                                   uint16_t destino, uint8_t * cabecera, uint8_t * largo_cabecera,
+                                   uint16_t * consumidos);
+
+/**
+ * @brief  Reconstruyo el paquete IPv6 de una trama comprimida con IPHC.
+ *
+ * @param  const uint8_t * Datos de la trama.
+ * @param  uint8_t Largo de los datos.
+ * @param  uint16_t Dirección corta de origen de la trama.
+ * @param  uint16_t Dirección corta de destino de la trama.
+ * @param  uint8_t * Donde se escribe el paquete.
+ * @param  uint16_t Tamaño del buffer del paquete.
+ * @param  uint16_t * Donde se devuelve el largo del paquete.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE si la trama no es
+ *         IPHC, OPERATION_FAIL si está truncada o usa contextos, BUFFER_FULL
+ *         si el paquete no entra, OPERATION_OK).
+ */
+mrf24_state_t MRF24LowpanDescomprimir(const uint8_t * datos, uint8_t largo, uint16_t origen,
+                                      uint16_t destino, uint8_t * paquete, uint16_t tamano,
+                                      uint16_t * largo_paquete);
+
+/**
+ * @brief  Envío un paquete IPv6 comprimido.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t Dirección corta de destino de la trama, BROADCAST para
+ *                  multicast.
+ * @param  const uint8_t * Paquete IPv6 completo.
+ * @param  uint16_t Largo del paquete.
+ * @return mrf24_state_t Estado de la operación (los de MRF24TransmitirSegmentos,
+ *         INVALID_VALUE si el paquete no es IPv6).
+ *
+ * @note   La cabecera comprimida y el resto del paquete se escriben en la FIFO
+ *         como dos segmentos, sin copiar los datos. El origen es la dirección
+ *         corta configurada y el PAN el propio.
+ */
+mrf24_state_t MRF24LowpanEnviar(mrf24_dev_t * dev, uint16_t destino, const uint8_t * paquete,
+                                uint16_t largo);
+
+/**
+ * @brief  Reconstruyo el paquete IPv6 de una trama recibida.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo que la recibió.
+ * @param  const mrf24_data_in_t * Trama leída con MRF24GetDataIn.
+ * @param  uint8_t * Donde se escribe el paquete.
+ * @param  uint16_t Tamaño del buffer del paquete.
+ * @param  uint16_t * Donde se devuelve el largo del paquete.
+ * @return mrf24_state_t Estado de la operación (los de MRF24LowpanDescomprimir).
+ *
+ * @note   Las direcciones elididas se completan con la dirección de origen de
+ *         la trama y con la dirección corta propia.
+ */
+mrf24_state_t MRF24LowpanRecibir(mrf24_dev_t * dev, const mrf24_data_in_t * trama,
+                                 uint8_t * paquete, uint16_t tamano, uint16_t * largo);
+
+/**
+ * @brief  Armo la dirección link-local del módulo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  bool_t true para la IID de la dirección larga, false para la de la
+ *                dirección corta.
+ * @param  uint8_t * Donde se escriben los 16 bytes de la dirección.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ *
+ * @note   La IID larga es la EUI-64 de mac[8] con el bit U/L invertido; mac[0]
+ *         es el byte menos significativo, como se carga en EADR0.
+ */
+mrf24_state_t MRF24LowpanDireccionLocal(mrf24_dev_t * dev, bool_t desde_mac, uint8_t * direccion);
+
+#endif /* INC_DRV_MRF24J40_LOWPAN_H_ */
@@ -0,0 +1,170 @@
+/**
+ *******************************************************************************
+ * @file    drv_MRF24J40_pcap.h
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Captura en formato pcap de las tramas recibidas en modo sniffer
+ *******************************************************************************
+ * @attention El archivo es pcap clásico con LINKTYPE_IEEE802_15_4_TAP: cada
+ *            trama va con el FCS y delante una cabecera TAP con el tipo de FCS,
+ *            el RSSI en dBm, el canal y el LQI, que Wireshark muestra junto a
+ *            la trama. Las tramas se acumulan en dos buffers: mientras la
+ *            aplicación escribe uno, las nuevas entran en el otro.
+ *******************************************************************************
+ */
+#ifndef INC_DRV_MRF24J40_PCAP_H_
+#define INC_DRV_MRF24J40_PCAP_H_
+
+/* === Archivos cabecera ====================================================== */
+#include "drv_MRF24J40.h"
+
+/* === Definición de macros públicas ========================================== */
+#define PCAP_LINKTYPE      283 /* LINKTYPE_IEEE802_15_4_TAP */
+#define PCAP_GLOBAL_HEADER 24
+#define PCAP_RECORD_HEADER 16
+#define PCAP_TAP_HEADER    36 /* cabecera y TLVs de FCS, RSS, canal y LQI */
+#define PCAP_MAX_FRAME     127
+#define PCAP_MAX_RECORD    (PCAP_RECORD_HEADER + PCAP_TAP_HEADER + PCAP_MAX_FRAME)
+
+/**
+ * @brief Tamaño de cada uno de los dos buffers de captura.
+ *
+ * @note  A 250 kbps el peor caso es una ráfaga de ACKs: 57 bytes de captura
+ *        cada 352 us. Con 2048 bytes la aplicación tiene más de 12 ms para
+ *        escribir un buffer mientras se llena el otro.
+ */
+#ifndef PCAP_BUFFER_SIZE
+#define PCAP_BUFFER_SIZE 2048
+#endif
+
+#if PCAP_BUFFER_SIZE < PCAP_MAX_RECORD
+#error "PCAP_BUFFER_SIZE no alcanza para la trama más larga"
+#endif
+
+/**
+ * @brief Potencia en dBm que corresponde a las lecturas 0 y 255 del RSSI.
+ *
+ * @note  El RSSI del módulo se pasa a dBm con una recta entre estos dos
+ *        puntos, una aproximación de la curva de la hoja de datos.
+ */
+#ifndef PCAP_RSSI_DBM_MIN
+#define PCAP_RSSI_DBM_MIN (-100)
+#endif
+
+#ifndef PCAP_RSSI_DBM_MAX
+#define PCAP_RSSI_DBM_MAX (-20)
+#endif
+
+/* === Declaración de tipo de datos públicos ================================== */
+/**
+ * @brief Función de la aplicación que escribe un bloque de la captura: en un
+ *        archivo, una UART, un socket, etc.
+ *
+ * @note  Devuelve false si no pudo escribir. El bloque ya no se usa al volver.
+ */
+typedef bool_t (*mrf24_pcap_write_t)(void * ctx, const uint8_t * datos, uint16_t largo);
+
+/**
+ * @brief Contadores de la captura.
+ *
+ * @note  frames cuenta las tramas que entraron en un buffer y dropped las que
+ *        no, con los dos llenos. bytes es lo entregado a la función de
+ *        escritura, cabecera global incluida.
+ */
+typedef struct {
+
+    uint32_t frames;
+    uint32_t dropped;
+    uint32_t bytes;
+    uint32_t flushes;
+    uint32_t write_errors;
+} mrf24_pcap_stats_t;
+
+/**
+ * @brief Uno de los dos buffers de captura.
+ */
+typedef struct {
+
+    uint8_t datos[PCAP_BUFFER_SIZE];
+    uint16_t largo;
+    volatile bool_t lleno;
+} mrf24_pcap_buffer_t;
+
+/**
+ * @brief Estado de una captura.
+ *
+ * @note  Como mrf24_dev_t, la aplicación la reserva (por ejemplo static) y la
+ *        pasa a todas las funciones. Los campos son de uso interno.
+ */
+typedef struct {
+
+    mrf24_pcap_write_t escribir;
+    void * ctx;
+    uint16_t canal;
+    mrf24_pcap_buffer_t buffers[2];
+    volatile uint8_t activo;
+    uint32_t ultimo_us;
+    uint32_t vueltas;
+    mrf24_pcap_stats_t stats;
+} mrf24_pcap_t;
+
+/* === Declaración de funciones públicas ====================================== */
+/**
+ * @brief  Comienzo una captura.
+ *
+ * @param  mrf24_pcap_t * Puntero a la captura.
+ * @param  channel_list_t Canal en el que escucha el módulo, va en cada trama.
+ * @param  mrf24_pcap_write_t Función que escribe los bloques de la captura.
+ * @param  void * Contexto que se le pasa a la función de escritura.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ *
+ * @note   La cabecera global del archivo queda en el primer buffer y sale con
+ *         la primera escritura.
+ */
+mrf24_state_t MRF24PcapInit(mrf24_pcap_t * pcap, channel_list_t canal, mrf24_pcap_write_t escribir,
+                            void * ctx);
+
+/**
+ * @brief  Agrego una trama a la captura.
+ *
+ * @param  mrf24_pcap_t * Puntero a la captura.
+ * @param  const mrf24_data_in_t * Trama leída con MRF24GetDataIn en modo sniffer.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, BUFFER_FULL,
+ *         OPERATION_OK).
+ *
+ * @note   No escribe nada: sólo copia la trama en el buffer activo. Si no
+ *         entra, el buffer queda listo para MRF24PcapVolcar y se pasa al
+ *         otro; con los dos llenos la trama se descarta y devuelve
+ *         BUFFER_FULL. El timestamp de 32 bits se extiende contando las
+ *         vueltas, así que la captura no puede estar más de 71 minutos sin
+ *         tramas.
+ */
+mrf24_state_t MRF24PcapAgregar(mrf24_pcap_t * pcap, const mrf24_data_in_t * trama);
+
+/**
+ * @brief  Escribo los buffers llenos de la captura.
+ *
+ * @param  mrf24_pcap_t * Puntero a la captura.
+ * @param  bool_t true para escribir también el buffer activo aunque no esté
+ *                lleno, por ejemplo al cerrar la captura.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, BUFFER_EMPTY si
+ *         no había nada para escribir, OPERATION_FAIL si falló la escritura,
+ *         OPERATION_OK).
+ *
+ * @note   Se llama desde el lazo principal. MRF24PcapAgregar puede correr en
+ *         una interrupción mientras se escribe un buffer lleno, pero no con el
+ *         parcial en true: ese buffer es el que está llenando. Un buffer cuya
+ *         escritura falla se descarta igual, para no frenar la captura, y el
+ *         parcial queda para la próxima llamada.
+ */
+mrf24_state_t MRF24PcapVolcar(mrf24_pcap_t * pcap, bool_t parcial);
+
+/**
+ * @brief  Copio los contadores de la captura.
+ *
+ * @param  mrf24_pcap_t * Puntero a la captura.
+ * @param  mrf24_pcap_stats_t * Donde se copian los contadores.
+ * @return mrf24_state_t Estado de la operación (INVALID_VALUE, OPERATION_OK).
+ */
+mrf24_state_t MRF24PcapGetStats(mrf24_pcap_t * pcap, mrf24_pcap_stats_t * stats);
+
+#endif /* INC_DRV_MRF24J40_PCAP_H_ */
@@ -30,69 +30,140 @@ typedef enum {
     SPI_COMM_ERROR,
 } spi_state_t;
 
+/**
+ * @brief Funciones del port de un módulo.
+ *
+ * @note  Cada módulo tiene su propia tabla. Todas las funciones reciben ctx,
+ *        que el driver no usa y sirve para distinguir el SPI y los pines de
+ *        cada módulo. Las funciones declaradas abajo tienen la misma forma, así
+ *        que un port de un solo módulo puede armar la tabla con ellas.
+ *        mask_interrupt es opcional: si está, el driver enmascara la
+ *        interrupción del pin INT durante cada transacción SPI, para que
+ *        MRF24InterruptHandler no la corte a la mitad.
+ */
+typedef struct {
+
+    void * ctx;
+    void (*init_pins)(void * ctx);
+    void (*set_cs)(void * ctx, bool_t estado);
+    void (*set_wake)(void * ctx, bool_t estado);
+    void (*set_reset)(void * ctx, bool_t estado);
+    bool_t (*is_interrupt)(void * ctx);
+    spi_state_t (*write_byte)(void * ctx, uint8_t * dato);
+    spi_state_t (*write_2_bytes)(void * ctx, uint16_t * dato);
+    spi_state_t (*write_block)(void * ctx, const uint8_t * datos, uint16_t largo);
+    spi_state_t (*read_byte)(void * ctx, uint8_t * respuesta);
+    spi_state_t (*read_block)(void * ctx, uint8_t * datos, uint16_t largo);
+    void (*mask_interrupt)(void * ctx, bool_t estado);
+} mrf24_port_t;
+
 /* === Declaración de funciones públicas ====================================== */
 /**
  * @brief  Inicialización del hardware relacionado con el módulo.
  *
- * @param  None.
+ * @param  void * Contexto del port del módulo.
  * @return None.
  */
-void InicializoPines(void);
+void InicializoPines(void * ctx);
 
 /**
  * @brief  Escribo en el pin destinado a CS.
  *
+ * @param  void * Contexto del port del módulo.
  * @param  bool_t Estado de salida.
  * @return None.
  */
-void SetCSPin(bool_t estado);
+void SetCSPin(void * ctx, bool_t estado);
 
 /**
  * @brief  Escribo en el pin destinado a Wake.
  *
+ * @param  void * Contexto del port del módulo.
  * @param  bool_t Estado de salida.
  * @return None.
  */
-void SetWakePin(bool_t estado);
+void SetWakePin(void * ctx, bool_t estado);
 
 /**
  * @brief  Escribo en el pin destinado a Reset.
  *
+ * @param  void * Contexto del port del módulo.
  * @param  bool_t Estado de salida.
  * @return None.
  */
-void SetResetPin(bool_t estado);
+void SetResetPin(void * ctx, bool_t estado);
 
 /**
  * @brief  Devuelvo el estado del pin interrup del módulo.
  *
- * @param  None.
+ * @param  void * Contexto del port del módulo.
  * @return bool_t Estado del pin.
  */
-bool_t IsMRF24Interrup(void);
+bool_t IsMRF24Interrup(void * ctx);
+
+/**
+ * @brief  Enmascaro o habilito la interrupción del pin interrup del módulo.
+ *
+ * @param  void * Contexto del port del módulo.
+ * @param  bool_t true para enmascararla, false para volver a habilitarla.
+ * @return None.
+ *
+ * @note   Las interrupciones que llegan enmascaradas deben quedar pendientes,
+ *         no perderse.
+ */
+void MaskMRF24Interrup(void * ctx, bool_t estado);
 
 /**
  * @brief  Escribo en el puerto SPI 1 byte.
  *
+ * @param  void * Contexto del port del módulo.
  * @param  uint8_t * Puntero al dato a enviar por el puerto.
  * @return spi_state_t Estado del envío.
  */
-spi_state_t WriteByteSPIPort(uint8_t * dato);
+spi_state_t WriteByteSPIPort(void * ctx, uint8_t * dato);
 
 /**
  * @brief  Escribo en el puerto SPI 2 bytes.
  *
+ * @param  void * Contexto del port del módulo.
  * @param  uint16_t * Puntero al dato a enviar por el puerto.
  * @return spi_state_t Estado del envío.
  */
-spi_state_t Write2ByteSPIPort(uint16_t * dato);
+spi_state_t Write2ByteSPIPort(void * ctx, uint16_t * dato);
+
+/**
+ * @brief  Escribo en el puerto SPI un bloque de bytes consecutivos.
+ *
+ * @param  void * Contexto del port del módulo.
+ * @param  const uint8_t * Puntero al primer dato a enviar por el puerto.
+ * @param  uint16_t Cantidad de bytes a enviar.
+ * @return spi_state_t Estado del envío.
+ *
+ * @note   Se llama con el CS ya habilitado, a continuación de la dirección
+ *         del registro, por lo que el port puede resolverla por DMA.
+ */
+spi_state_t WriteBlockSPIPort(void * ctx, const uint8_t * datos, uint16_t largo);
 
 /**
  * @brief  Leo en el puerto SPI.
  *
+ * @param  void * Contexto del port del módulo.
  * @param  uint8_t Puntero a la variable que almacena la respuesta.
  * @return spi_state_t Estado del envío.
  */
-spi_state_t ReadByteSPIPort(uint8_t * respuesta);
+spi_state_t ReadByteSPIPort(void * ctx, uint8_t * respuesta);
+
+/**
+ * @brief  Leo del puerto SPI un bloque de bytes consecutivos.
+ *
+ * @param  void * Contexto del port del módulo.
+ * @param  uint8_t * Puntero al buffer que almacena la respuesta.
+ * @param  uint16_t Cantidad de bytes a leer.
+ * @return spi_state_t Estado de la lectura.
+ *
+ * @note   Se llama con el CS ya habilitado, a continuación de la dirección
+ *         del registro, por lo que el port puede resolverla por DMA.
+ */
+spi_state_t ReadBlockSPIPort(void * ctx, uint8_t * datos, uint16_t largo);
 
 #endif /* INC_DRV_MRF24J40_PORT_H_ */
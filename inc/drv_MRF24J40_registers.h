@@ -11,7 +11,7 @@
 #ifndef XC_HEADER_TEMPLATE_H
 #define XC_HEADER_TEMPLATE_H
 
-enum {
+typedef enum {
 
     EADR0 = 0x05,
     EADR1,
@@ -135,6 +135,16 @@ enum {
 #define BCNONLY       (0X02)
 #define RXFLUSH_RESET (0X01)
 
+/* Definiciones del registro ORDER -------------------------------------------*/
+#define BO3 (0X80)
+#define BO2 (0X40)
+#define BO1 (0X20)
+#define BO0 (0X10)
+#define SO3 (0X08)
+#define SO2 (0X04)
+#define SO1 (0X02)
+#define SO0 (0X01)
+
 /* Definiciones del registro TXMCR -------------------------------------------*/
 #define NOCSMA    (0X80)
 #define BATLIFEXT (0X40)
@@ -159,6 +169,16 @@ enum {
 #define TXBSECEN (0X02)
 #define TXBTRIG  (0X01)
 
+/* Definiciones de los registros TXG1CON y TXG2CON ---------------------------*/
+#define TXGRETRY1 (0X80)
+#define TXGRETRY0 (0X40)
+#define TXGSLOT2  (0X20)
+#define TXGSLOT1  (0X10)
+#define TXGSLOT0  (0X08)
+#define TXGACKREQ (0X04)
+#define TXGSECEN  (0X02)
+#define TXGTRIG   (0X01)
+
 /* Definiciones del registro TXNCON ------------------------------------------*/
 #define FPSTAT    (0X10)
 #define INDIRECT  (0X08)
@@ -257,6 +277,10 @@ enum {
 #define TXG1IE_DIS    (0X02)
 #define TXNIE_DIS     (0X01)
 
+/* Definiciones del registro SLPACK ------------------------------------------*/
+#define SLPACK_SLEEP (0X80)
+#define WAKECNT_MASK (0X7F)
+
 /* Definiciones del registro RFCTL -------------------------------------------*/
 #define WAKECNT8   (0X10)
 #define WAKECNT7   (0X08)
@@ -296,6 +320,7 @@ enum {
 /* Definiciones del registro BBREG6 ------------------------------------------*/
 #define RSSIMODE1 (0X80)
 #define RSSIMODE2 (0X40)
+#define RSSIRDY   (0X01)
 
 /* Definiciones del registro CCAEDTH -----------------------------------------*/
 #define CCAEDTH7 (0X80)
@@ -375,6 +400,11 @@ enum {
 #define CALFIL   (0X20)
 #define RF_RESET (0X00)
 
+/* Definiciones del registro SLPCAL2 -----------------------------------------*/
+#define SLPCALRDY  (0X80)
+#define SLPCALEN   (0X10)
+#define SLPCAL_MSB (0X0F)
+
 /* Definiciones del registro SLPCON0 -----------------------------------------*/
 #define INTEDGE_RISISNG (0X02)
 #define SLPCLKDIS       (0X01)
@@ -387,6 +417,10 @@ enum {
 #define SLPCLKDIV1 (0X02)
 #define SLPCLKDIV0 (0X01)
 
+/* Definiciones del registro MAINCNT3 ----------------------------------------*/
+#define STARTCNT    (0X80)
+#define MAINCNT_MSB (0X03)
+
 /* Definiciones del registro TESTMODE ----------------------------------------*/
 #define RSSIWAIT1 (0X10)
 #define RSSIWAIT0 (0X08)
@@ -395,6 +429,7 @@ enum {
 #define TESTMODE0 (0X01)
 
 /* LSB */
+#define BEACON     (0X00)
 #define DATA       (0X01)
 #define ACK        (0X02)
 #define MAC_COMM   (0X03)
@@ -413,6 +448,7 @@ enum {
 #define TX_CBC_MAC32  (0x07)
 #define SHORT_D_ADD   (0X08)
 #define LONG_D_ADD    (0X0C)
+#define FRAME_V2006   (0X10)
 #define SHORT_S_ADD   (0X80)
 #define LONG_S_ADD    (0XC0)
 
@@ -0,0 +1,445 @@
+/**
+ *********************************************************************************
+ * @file    red_mrf24j40.c
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Simulación de una red de N nodos para ver cómo escala el driver
+ *********************************************************************************
+ * @attention Corre N instancias del driver, cada una con su módulo simulado,
+ *            sobre un mismo medio con CSMA-CA, colisiones, ACK y pérdidas por
+ *            enlace. El nodo 0 es el colector y el resto le manda datos con
+ *            una tasa fija por nodo, así que la carga crece con N. Para cada
+ *            N informa goodput, reintentos por trama, entregas y percentiles
+ *            de latencia, en pantalla y en JSON.
+ *
+ *            Todos los nodos avanzan en un mismo lazo sobre el reloj virtual
+ *            del medio: el resultado es el mismo en cada corrida.
+ *
+ *            Uso: red_mrf24j40 [resultados.json]
+ *********************************************************************************
+ */
+
+/* === Archivos cabecera ====================================================== */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "drv_MRF24J40.h"
+#include "app_delay_unlock.h"
+#include "mrf24j40_sim.h"
+
+/* === Definición de macros privadas ========================================== */
+#define SEGUNDOS_RED      10
+#define PERIODO_US        1000000 // intervalo medio entre tramas de un nodo
+#define LARGO_DATOS       24
+#define PERDIDA_MAX       5 // porcentaje máximo de pérdida de un enlace
+#define PASO_US           100
+#define MAX_VUELTAS_INIT  500
+#define PASO_INIT_US      1000
+#define PANID_RED         (0x1234)
+#define DIRECCION_BASE    (0x0100)
+#define MAX_MUESTRAS      (SIM_MAX_NODES * SEGUNDOS_RED * 2)
+#define SEMILLA_RED       (0x9E3779B9)
+#define RESULTADO_DEFECTO "red_output.txt"
+
+/* === Declaración de tipo de datos privados ================================== */
+/**
+ * @brief Estado de la aplicación de un nodo.
+ */
+typedef struct {
+
+    uint64_t proximo_us;
+    uint16_t secuencia;
+    uint16_t ultima_recibida;
+    bool_t recibio;
+} red_nodo_t;
+
+/**
+ * @brief Resultado de una corrida con N nodos.
+ */
+typedef struct {
+
+    uint16_t nodos;
+    uint32_t transmitidas;
+    uint32_t reintentos;
+    uint32_t sin_ack;
+    uint32_t canal_ocupado;
+    uint32_t entregadas;
+    uint32_t duplicadas;
+    uint32_t colisiones;
+    double goodput_bps;
+    uint32_t p50_us;
+    uint32_t p90_us;
+    uint32_t p99_us;
+} red_resultado_t;
+
+/* === Definición de variables privadas ======================================= */
+static const uint16_t cantidades[] = {2, 5, 10, 20, 50, 100, 200};
+static mrf24_sim_medio_t medio;
+static mrf24_sim_t sims[SIM_MAX_NODES];
+static mrf24_dev_t nodos[SIM_MAX_NODES];
+static red_nodo_t apps[SIM_MAX_NODES];
+static uint32_t latencias[MAX_MUESTRAS];
+static uint32_t muestras;
+static red_resultado_t * actual;
+static uint32_t semilla;
+
+/* === Declaración de funciones privadas ====================================== */
+static tick_t LeoReloj(void);
+static uint32_t Sorteo(void);
+static uint64_t AhoraUs(void);
+static void ProgramoEnvio(red_nodo_t * app);
+static void TerminoTx(mrf24_dev_t * dev, const mrf24_tx_result_t * resultado);
+static bool_t InicializoRed(uint16_t cantidad);
+static void EnvioDato(uint16_t i);
+static void ReciboDatos(uint16_t i);
+static int ComparoLatencias(const void * a, const void * b);
+static uint32_t Percentil(uint8_t porcentaje);
+static bool_t CorroRed(uint16_t cantidad, red_resultado_t * resultado);
+static void EscriboResultados(FILE * salida, const red_resultado_t * resultados, uint8_t cantidad);
+
+/* === Implementación de funciones del delay ================================== */
+/*
+ * Como en el benchmark, el delay no bloqueante corre sobre el reloj virtual
+ * del medio, en milisegundos.
+ */
+void DelayInit(delayNoBloqueanteData_t * delay, tick_t duration) {
+
+    delay->duration = duration;
+    delay->running = false;
+}
+
+bool_t DelayRead(delayNoBloqueanteData_t * delay) {
+
+    if (!delay->running) {
+
+        DelayReset(delay);
+        return false;
+    }
+
+    if (LeoReloj() - delay->startTime < delay->duration)
+        return false;
+
+    delay->running = false;
+    return true;
+}
+
+void DelayWrite(delayNoBloqueanteData_t * delay, tick_t duration) {
+
+    delay->duration = duration;
+}
+
+void DelayReset(delayNoBloqueanteData_t * delay) {
+
+    delay->startTime = LeoReloj();
+    delay->running = true;
+}
+
+/* === Implementación de funciones privadas =================================== */
+static tick_t LeoReloj(void) {
+
+    return (tick_t)(MRF24SimGetTiempoUs(&medio) / 1000);
+}
+
+/**
+ * @brief  Sorteo un número con el generador de la red.
+ *
+ * @return uint32_t Número pseudoaleatorio (xorshift32).
+ *
+ * @note   Es independiente del generador del medio, que sortea backoffs y
+ *         pérdidas.
+ */
+static uint32_t Sorteo(void) {
+
+    semilla ^= semilla << 13;
+    semilla ^= semilla >> 17;
+    semilla ^= semilla << 5;
+    return semilla;
+}
+
+static uint64_t AhoraUs(void) {
+
+    return MRF24SimGetTiempoUs(&medio);
+}
+
+/**
+ * @brief  Programo la próxima trama de un nodo.
+ *
+ * @param  red_nodo_t * Estado de la aplicación del nodo.
+ * @return None.
+ *
+ * @note   El intervalo es uniforme entre la mitad y una vez y media
+ *         PERIODO_US, para que los nodos no queden sincronizados.
+ */
+static void ProgramoEnvio(red_nodo_t * app) {
+
+    app->proximo_us += PERIODO_US / 2 + Sorteo() % PERIODO_US;
+}
+
+/**
+ * @brief  Cuento el resultado de cada transmisión.
+ *
+ * @param  mrf24_dev_t * Nodo que terminó de transmitir.
+ * @param  const mrf24_tx_result_t * Resultado de la transmisión.
+ * @return None.
+ */
+static void TerminoTx(mrf24_dev_t * dev, const mrf24_tx_result_t * resultado) {
+
+    (void)dev;
+    actual->reintentos += resultado->retries;
+
+    if (TX_NO_ACK == resultado->status)
+        actual->sin_ack++;
+    else if (TX_CHANNEL_BUSY == resultado->status)
+        actual->canal_ocupado++;
+}
+
+/**
+ * @brief  Armo el medio con N nodos y espero a que todos inicialicen.
+ *
+ * @param  uint16_t Cantidad de nodos.
+ * @return bool_t false si alguno no llegó a INIT_OK.
+ *
+ * @note   Cada enlace con el colector pierde entre 0 y PERDIDA_MAX por ciento
+ *         de las tramas, sorteado por nodo e igual en los dos sentidos.
+ */
+static bool_t InicializoRed(uint16_t cantidad) {
+
+    uint16_t listos = 0;
+
+    MRF24SimMedioInit(&medio);
+    memset(nodos, 0, sizeof(nodos));
+    memset(apps, 0, sizeof(apps));
+
+    for (uint16_t i = 0; i < cantidad; i++) {
+
+        mrf24_port_t port;
+
+        MRF24SimInit(&sims[i], &medio, &port);
+        MRF24SetChannel(&nodos[i], CH_15);
+        MRF24SetPanId(&nodos[i], PANID_RED);
+        MRF24SetAdd(&nodos[i], DIRECCION_BASE + i);
+        MRF24J40Init(&nodos[i], &port);
+        MRF24SetTxCallback(&nodos[i], TerminoTx);
+    }
+
+    for (uint16_t i = 1; i < cantidad; i++) {
+
+        uint8_t perdida = Sorteo() % (PERDIDA_MAX + 1);
+
+        MRF24SimSetPerdida(&sims[i], &sims[0], perdida);
+        MRF24SimSetPerdida(&sims[0], &sims[i], perdida);
+    }
+
+    for (uint16_t vuelta = 0; vuelta < MAX_VUELTAS_INIT && listos < cantidad; vuelta++) {
+
+        listos = 0;
+
+        for (uint16_t i = 0; i < cantidad; i++)
+            listos += (INIT_OK == MRF24Poll(&nodos[i]));
+        MRF24SimAvanzar(&medio, PASO_INIT_US);
+    }
+
+    for (uint16_t i = 1; i < cantidad; i++) {
+
+        apps[i].proximo_us = AhoraUs();
+        ProgramoEnvio(&apps[i]);
+    }
+    return listos == cantidad;
+}
+
+/**
+ * @brief  Mando al colector la trama pendiente de un nodo, si le toca.
+ *
+ * @param  uint16_t Índice del nodo.
+ * @return None.
+ *
+ * @note   Los datos llevan el instante programado y un número de secuencia.
+ *         Si el módulo todavía está transmitiendo, la trama espera a la
+ *         próxima vuelta y esa espera cuenta en la latencia.
+ */
+static void EnvioDato(uint16_t i) {
+
+    red_nodo_t * app = &apps[i];
+    mrf24_data_out_t salida = {PANID_RED, DIRECCION_BASE, DIRECCION_BASE + i, {0}, LARGO_DATOS};
+    uint32_t marca = (uint32_t)app->proximo_us;
+
+    if (AhoraUs() < app->proximo_us)
+        return;
+
+    memcpy(&salida.buffer[0], &marca, sizeof(marca));
+    memcpy(&salida.buffer[sizeof(marca)], &app->secuencia, sizeof(app->secuencia));
+
+    if (TRANS_COMPLETED != MRF24TransmitirDato(&nodos[i], &salida))
+        return;
+
+    app->secuencia++;
+    actual->transmitidas++;
+    ProgramoEnvio(app);
+}
+
+/**
+ * @brief  Atiendo un nodo: fin de transmisión y tramas recibidas.
+ *
+ * @param  uint16_t Índice del nodo.
+ * @return None.
+ *
+ * @note   El colector descarta los duplicados (la trama llegó pero se perdió
+ *         el ACK) con el último número de secuencia de cada origen.
+ */
+static void ReciboDatos(uint16_t i) {
+
+    mrf24_data_in_t * recibido = NULL;
+
+    if (MSG_PRESENT != MRF24IsNewMsg(&nodos[i]))
+        return;
+    MRF24ReciboPaquete(&nodos[i]);
+
+    while (NULL != (recibido = MRF24GetDataIn(&nodos[i]))) {
+
+        uint16_t origen = recibido->address - DIRECCION_BASE;
+        uint32_t marca;
+        uint16_t secuencia;
+
+        memcpy(&marca, &recibido->buffer[0], sizeof(marca));
+        memcpy(&secuencia, &recibido->buffer[sizeof(marca)], sizeof(secuencia));
+
+        if (0 == i && origen < SIM_MAX_NODES) {
+
+            red_nodo_t * app = &apps[origen];
+
+            if (app->recibio && app->ultima_recibida == secuencia) {
+
+                actual->duplicadas++;
+            } else {
+
+                app->recibio = true;
+                app->ultima_recibida = secuencia;
+                actual->entregadas++;
+                if (muestras < MAX_MUESTRAS)
+                    latencias[muestras++] = (uint32_t)AhoraUs() - marca;
+            }
+        }
+        MRF24ReleaseDataIn(&nodos[i]);
+    }
+}
+
+static int ComparoLatencias(const void * a, const void * b) {
+
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static uint32_t Percentil(uint8_t porcentaje) {
+
+    if (0 == muestras)
+        return 0;
+    return latencias[(uint32_t)((uint64_t)(muestras - 1) * porcentaje / 100)];
+}
+
+/**
+ * @brief  Corro SEGUNDOS_RED segundos de tráfico con N nodos.
+ *
+ * @param  uint16_t Cantidad de nodos, contando al colector.
+ * @param  red_resultado_t * Donde se guarda el resultado.
+ * @return bool_t false si la red no inicializó.
+ */
+static bool_t CorroRed(uint16_t cantidad, red_resultado_t * resultado) {
+
+    memset(resultado, 0, sizeof(*resultado));
+    resultado->nodos = cantidad;
+    actual = resultado;
+    muestras = 0;
+
+    if (!InicializoRed(cantidad))
+        return false;
+
+    uint64_t fin_us = AhoraUs() + (uint64_t)SEGUNDOS_RED * 1000000;
+
+    while (AhoraUs() < fin_us) {
+
+        for (uint16_t i = 0; i < cantidad; i++) {
+
+            ReciboDatos(i);
+            if (0 != i)
+                EnvioDato(i);
+        }
+        MRF24SimAvanzar(&medio, PASO_US);
+    }
+
+    for (uint16_t i = 0; i < cantidad; i++) {
+
+        resultado->colisiones += sims[i].stats.rx_colisiones;
+    }
+    qsort(latencias, muestras, sizeof(latencias[0]), ComparoLatencias);
+    resultado->goodput_bps = (double)resultado->entregadas * LARGO_DATOS * 8 / SEGUNDOS_RED;
+    resultado->p50_us = Percentil(50);
+    resultado->p90_us = Percentil(90);
+    resultado->p99_us = Percentil(99);
+    return true;
+}
+
+static void EscriboResultados(FILE * salida, const red_resultado_t * resultados, uint8_t cantidad) {
+
+    fprintf(salida, "{\n  \"segundos\": %d,\n  \"periodo_us\": %d,\n  \"largo_datos\": %d,\n",
+            SEGUNDOS_RED, PERIODO_US, LARGO_DATOS);
+    fprintf(salida, "  \"redes\": [\n");
+
+    for (uint8_t i = 0; i < cantidad; i++) {
+
+        const red_resultado_t * r = &resultados[i];
+        fprintf(salida,
+                "    {\"nodos\": %u, \"transmitidas\": %u, \"entregadas\": %u, "
+                "\"duplicadas\": %u, \"reintentos\": %u, \"sin_ack\": %u, \"canal_ocupado\": %u, "
+                "\"colisiones\": %u, \"goodput_bps\": %.1f, \"latencia_us\": "
+                "{\"p50\": %u, \"p90\": %u, \"p99\": %u}}%s\n",
+                r->nodos, r->transmitidas, r->entregadas, r->duplicadas, r->reintentos,
+                r->sin_ack, r->canal_ocupado, r->colisiones, r->goodput_bps, r->p50_us, r->p90_us,
+                r->p99_us, (i + 1 < cantidad) ? "," : "");
+    }
+    fprintf(salida, "  ]\n}\n");
+}
+
+/* === Implementación de funciones públicas =================================== */
+int main(int argc, char * argv[]) {
+
+    const char * archivo_resultado = (argc > 1) ? argv[1] : RESULTADO_DEFECTO;
+    red_resultado_t resultados[sizeof(cantidades) / sizeof(cantidades[0])];
+    uint8_t corridas = 0;
+
+    printf("%6s %8s %8s %9s %8s %10s %8s %8s %8s\n", "nodos", "tx", "entrega", "reint/tx",
+           "fallas", "goodput", "p50_us", "p90_us", "p99_us");
+
+    for (uint8_t i = 0; i < sizeof(cantidades) / sizeof(cantidades[0]); i++) {
+
+        red_resultado_t * r = &resultados[corridas];
+
+        if (cantidades[i] > SIM_MAX_NODES)
+            break;
+
+        semilla = SEMILLA_RED;
+        if (!CorroRed(cantidades[i], r)) {
+
+            fprintf(stderr, "red: la red de %u nodos no inicializó\n", cantidades[i]);
+            return 1;
+        }
+        corridas++;
+
+        double transmitidas = (r->transmitidas > 0) ? r->transmitidas : 1;
+        printf("%6u %8u %7.1f%% %9.2f %8u %10.1f %8u %8u %8u\n", r->nodos, r->transmitidas,
+               100.0 * r->entregadas / transmitidas, r->reintentos / transmitidas,
+               r->sin_ack + r->canal_ocupado, r->goodput_bps, r->p50_us, r->p90_us, r->p99_us);
+    }
+
+    FILE * salida = fopen(archivo_resultado, "w");
+
+    if (NULL == salida) {
+
+        fprintf(stderr, "red: no se pudo escribir %s\n", archivo_resultado);
+        return 1;
+    }
+    EscriboResultados(salida, resultados, corridas);
+    fclose(salida);
+    printf("red: resultados en %s\n", archivo_resultado);
+    return 0;
+}
@@ -22,7 +22,20 @@
 #define WAIT_50_MS       50
 #define ENABLE           true
 #define DISABLE          false
-#define HEAD_LENGTH      (0X0B)
+#define MHR_LENGTH       (0X09)
+#define FIFO_TX_HEADER   (0X02)
+#define TX_HEADER_SIZE   (FIFO_TX_HEADER + MHR_LENGTH)
+#define MHR_MIN_LENGTH   (0X03)
+#define MHR_ADDR_LENGTH  (0X07) /* una sola dirección corta con su PAN */
+#define MAX_MHR_LENGTH   (0X17)
+#define POS_FRAME_CTRL   (FIFO_TX_HEADER)
+#define ADDR_MODE_MASK   (0X03)
+#define SHIFT_DEST_MODE  (0X02)
+#define SHIFT_SRC_MODE   (0X06)
+#define FCS_LENGTH       (0X02)
+#define LQI_RSSI_LENGTH  (0X02)
+#define MAX_FRAME_LENGTH (0X7F)
+#define RX_FRAME_SIZE    (MAX_FRAME_LENGTH + LQI_RSSI_LENGTH)
 #define WRITE_16_BITS    (0X8010)
 #define READ_16_BITS     (0X8000)
 #define WRITE_8_BITS     (0x01)
@@ -30,7 +43,70 @@
 #define SHIFT_LONG_ADDR  (0X05)
 #define SHIFT_SHORT_ADDR (0X01)
 #define SHIFT_BYTE       (0X08)
-#define FCS_LQI_RSSI     (0x04)
+#define SHIFT_TXNRETRY   (0X06)
+#define TX_QUEUE_NONE    (0XFF)
+#define SHORT_REG_COUNT  (0X40)
+#define LONG_CTRL_FIRST  (0X200)
+#define LONG_CTRL_COUNT  (0X80)
+#define SHADOW_NONE      (-1)
+#define SCRIPT_BATCH     (0X10)
+#define SEC_AUX_LENGTH   (0X05)
+#define SEC_LEVEL_MASK   (0X07)
+#define SEC_LEVEL_COUNT  (0X03)
+#define SEC_MAX_COUNTER  (0XFFFFFFFF)
+#define SHIFT_CHANNEL    (0X04)
+#define FRAME_TYPE_MASK  (0X07)
+#define BEACON_REQUEST   (0X07)
+#define DATA_REQUEST     (0X04)
+#define BEACON_REQ_MHR   (0X07)
+#define BEACON_SRC_ADDR  (0X05)
+#define FNV_OFFSET       (0X811C9DC5)
+#define FNV_PRIME        (0X01000193)
+#define CANAL(i)         ((channel_list_t)(CH_11 + ((i) << SHIFT_CHANNEL)))
+#define POS_SEQUENCE     (0X02)
+
+/**
+ * @brief Temporizador de sleep: arranque del oscilador (WAKECNT) y momento en
+ *        que se lo enciende antes del final de la cuenta (WAKETIME), en ciclos
+ *        del reloj de sleep. WAKETIME tiene que ser mayor que WAKECNT.
+ *
+ * @note  SLPCAL cuenta ciclos de 50 ns durante 16 períodos del reloj de sleep,
+ *        que con SLPCLKDIV0 es de 50 kHz: 6400 si el oscilador es exacto.
+ */
+#define LPL_WAKECNT      (0X5F)
+#define LPL_WAKETIME     (0XD2)
+#define SLPCAL_NOMINAL   (6400)
+#define SLPCAL_NS_CICLO  (50)
+#define SLPCAL_PERIODOS  (16)
+#define MAINCNT_MAX      (0X3FFFFFF)
+#define MAINCNT_BYTES    (0X04)
+#define NS_POR_MS        (1000000)
+
+/**
+ * @brief Supertrama: ORDER sin beacons, slots por supertrama, largo de un slot
+ *        con SO en 0 y largo mínimo del CAP (aMinCAPLength), en símbolos.
+ *
+ * @note  El beacon lleva origen corto y ningún GTS pendiente: cabecera de 7
+ *        bytes, 2 de especificación de la supertrama, 1 de GTS, 1 de sentidos,
+ *        3 por GTS y 1 de direcciones pendientes.
+ */
+#define ORDER_SIN_BEACON (0XFF)
+#define SHIFT_ORDER      (0X04)
+#define NIBBLE           (0X0F)
+#define BO_MAXIMO        (0X0E)
+#define SF_SLOTS         (0X10)
+#define SLOT_SIMBOLOS    (60)
+#define MIN_CAP_SIMBOLOS (440)
+#define SF_PAN_COORD     (0X40)
+#define GTS_PERMIT       (0X80)
+#define GTS_COUNT_MASK   (0X07)
+#define GTS_DESCRIPTOR   (0X03)
+#define GTS_FIFOS        (0X02)
+#define SHIFT_TXGSLOT    (0X03)
+#define SHIFT_TXGRETRY   (0X06)
+#define BEACON_MHR       (0X07)
+#define BEACON_SPEC_MIN  (0X04)
+#define BEACON_MAX       (BEACON_MHR + 0X05 + SF_MAX_GTS * GTS_DESCRIPTOR)
 
 /**
  * @brief Definiciones de la configuración por defecto.
@@ -40,11 +116,35 @@
 #define MY_DEFAULT_PAN_ID  (0x9999)
 #define MY_DEFAULT_ADDRESS (0xFFFE)
 
+/**
+ * @brief Código de los contadores de rendimiento, desaparece con MRF24_PERF en 0.
+ */
+#if MRF24_PERF
+#define PERF(...) __VA_ARGS__
+#else
+#define PERF(...)
+#endif
+
 /* === Definición de variables privadas ======================================= */
-mrf24_state_t estadoActual = INIT_FAIL;
-static mrf24_data_config_t data_config_s = {0};
-static mrf24_data_out_t data_out_s = {0};
-static mrf24_data_in_t data_in_s = {0};
+#if (RX_RING_SIZE & (RX_RING_SIZE - 1)) || (128 < RX_RING_SIZE)
+#error "RX_RING_SIZE debe ser una potencia de 2 menor o igual a 128"
+#endif
+
+#if (TX_QUEUE_NONE <= TX_QUEUE_SIZE)
+#error "TX_QUEUE_SIZE debe ser menor a 255"
+#endif
+
+#if (NEIGHBOR_TABLE_SIZE & (NEIGHBOR_TABLE_SIZE - 1)) || (1024 < NEIGHBOR_TABLE_SIZE)
+#error "NEIGHBOR_TABLE_SIZE debe ser una potencia de 2 menor o igual a 1024"
+#endif
+
+#if (TX_HEADER_SIZE + MAX_PAYLOAD_SIZE != TX_FRAME_SIZE)
+#error "TX_FRAME_SIZE no coincide con la cabecera y MAX_PAYLOAD_SIZE"
+#endif
+
+#if (SHORT_REG_COUNT + LONG_CTRL_COUNT != SHADOW_SIZE)
+#error "SHADOW_SIZE no coincide con la cantidad de registros copiados"
+#endif
 
 /**
  * @brief MAC address por defecto del dispositivo.
@@ -57,99 +157,614 @@ static const uint8_t default_mac_address[] = {0x11, 0x28, 0x35, 0x44, 0x56, 0x66
 static const uint8_t default_security_key[] = {0x00, 0x10, 0x25, 0x37, 0x04, 0x55, 0x06, 0x79,
                                                0x08, 0x09, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15};
 
+/**
+ * @brief Largo del MIC y cifrado de SECCON0 para cada nivel de seguridad,
+ *        desde SEC_ENC_MIC_32.
+ */
+static const uint8_t sec_largo_mic[SEC_LEVEL_COUNT] = {4, 8, 16};
+static const uint8_t sec_cifrado_tx[SEC_LEVEL_COUNT] = {TX_AES_CCM_32, TX_AES_CCM_64,
+                                                        TX_AES_CCM_128};
+static const uint8_t sec_cifrado_rx[SEC_LEVEL_COUNT] = {RX_AES_CCM_32, RX_AES_CCM_64,
+                                                        RX_AES_CCM_128};
+
+/**
+ * @brief Script de configuración del MRF24J40MA.
+ *
+ * @note  Los registros largos consecutivos van seguidos para que se escriban
+ *        en una sola transacción.
+ */
+static const mrf24_reg_write_t script_ma[] = {
+    {MRF24_SHORT_WRITE(RXFLUSH), RXFLUSH_RESET, 0},
+    {MRF24_LONG_WRITE(RFCON1), VCOOPT1 | VCOOPT0, 0},
+    {MRF24_LONG_WRITE(RFCON2), PLLEN, 0},
+    {MRF24_LONG_WRITE(RFCON3), P20dBm | P0dBm, 0},
+    {MRF24_LONG_WRITE(RFCON6), TXFIL | _20MRECVR, 0},
+    {MRF24_LONG_WRITE(RFCON7), SLPCLK100KHZ, 0},
+    {MRF24_LONG_WRITE(RFCON8), RFVCO, 0},
+    {MRF24_LONG_WRITE(SLPCON1), CLKOUTDIS | SLPCLKDIV0, 0},
+    {MRF24_SHORT_WRITE(BBREG2), CCA_MODE_1, 0},
+    {MRF24_SHORT_WRITE(BBREG6), RSSIMODE2, 0},
+    {MRF24_SHORT_WRITE(CCAEDTH), CCAEDTH2 | CCAEDTH1, 0},
+    {MRF24_SHORT_WRITE(PACON2), FIFOEN | TXONTS2 | TXONTS1, 0},
+    {MRF24_SHORT_WRITE(TXSTBL), RFSTBL3 | RFSTBL0 | MSIFS2 | MSIFS0, 0},
+    {MRF24_SHORT_WRITE(MRFINTCON), SLPIE_DIS | WAKEIE_DIS | HSYMTMRIE_DIS | TXG2IE_DIS, 0},
+    {MRF24_SHORT_WRITE(ACKTMOUT), MAWD5 | MAWD4 | MAWD3 | MAWD0, 0},
+};
+
+/**
+ * @brief Registros que el MRF24J40MB, con PA y LNA externos, agrega al script
+ *        del MRF24J40MA.
+ *
+ * @note  Se dejan los GPIO como salidas en 0 y se habilita el manejo
+ *        automático del PA y el LNA (TESTMODE).
+ */
+static const mrf24_reg_write_t script_mb[] = {
+    {MRF24_SHORT_WRITE(GPIO), VACIO, 0},
+    {MRF24_SHORT_WRITE(TRISGPIO), VACIO, 0},
+    {MRF24_LONG_WRITE(TESTMODE), RSSIWAIT0 | TESTMODE2 | TESTMODE1 | TESTMODE0, 0},
+};
+
+/**
+ * @brief Scripts de los modos de la capa física.
+ *
+ * @note  Los valores de BBREG0, BBREG3 y BBREG4 son los de la hoja de datos.
+ *        En modo turbo la trama y el ACK duran 2,5 veces menos, por lo que la
+ *        espera del ACK (MAWD) y el espaciado corto entre tramas (MSIFS) se
+ *        reducen en la misma proporción.
+ */
+static const mrf24_reg_write_t script_250kbps[] = {
+    {MRF24_SHORT_WRITE(BBREG0), VACIO, 0},
+    {MRF24_SHORT_WRITE(BBREG3), IEEE_802_15_4 | PREDETTH2, 0},
+    {MRF24_SHORT_WRITE(BBREG4), IEEE_250KBPS | PRECNT2 | PRECNT1 | PRECNT0, 0},
+    {MRF24_SHORT_WRITE(ACKTMOUT), MAWD5 | MAWD4 | MAWD3 | MAWD0, 0},
+    {MRF24_SHORT_WRITE(TXSTBL), RFSTBL3 | RFSTBL0 | MSIFS2 | MSIFS0, 0},
+};
+
+static const mrf24_reg_write_t script_turbo[] = {
+    {MRF24_SHORT_WRITE(BBREG0), TURBO, 0},
+    {MRF24_SHORT_WRITE(BBREG3), TURBO_MODE | PREDETTH2, 0},
+    {MRF24_SHORT_WRITE(BBREG4), TURBO_625KBPS | PRECNT2 | PRECNT1 | PRECNT0, 0},
+    {MRF24_SHORT_WRITE(ACKTMOUT), MAWD4 | MAWD2 | MAWD1 | MAWD0, 0},
+    {MRF24_SHORT_WRITE(TXSTBL), RFSTBL3 | RFSTBL0 | MSIFS1, 0},
+};
+
+const mrf24_init_profile_t mrf24_profile_ma = {script_ma, sizeof(script_ma) / sizeof(script_ma[0]),
+                                               NULL, 0};
+const mrf24_init_profile_t mrf24_profile_mb = {script_ma, sizeof(script_ma) / sizeof(script_ma[0]),
+                                               script_mb, sizeof(script_mb) / sizeof(script_mb[0])};
+
 /* === Declaración de funciones privadas ====================================== */
-void InicializoVariables(void);
-mrf24_state_t InicializoMRF24(void);
-mrf24_state_t SetShortAddr(uint8_t reg_address, uint8_t valor);
-mrf24_state_t GetShortAddr(uint8_t reg_address, uint8_t * respuesta);
-mrf24_state_t SetLongAddr(uint16_t reg_address, uint8_t valor);
-mrf24_state_t GetLongAddr(uint16_t reg_address, uint8_t * respuesta);
-mrf24_state_t ApplyDeviceAddress(void);
-mrf24_state_t ApplyChannel(void);
-mrf24_state_t ApplyDeviceMACAddress(void);
+void InicializoVariables(mrf24_dev_t * dev);
+void InicializoColas(mrf24_dev_t * dev);
+mrf24_state_t AvanzoInicializacion(mrf24_dev_t * dev);
+uint8_t EjecutoScript(mrf24_dev_t * dev, const mrf24_reg_write_t * script, uint8_t largo,
+                      uint8_t * indice);
+uint8_t EjecutoPerfil(mrf24_dev_t * dev);
+void EsperoInicializacion(mrf24_dev_t * dev, mrf24_init_step_t paso, tick_t duracion);
+void InvalidoShadow(mrf24_dev_t * dev);
+int16_t IndiceShadow(uint16_t reg_address, bool_t largo);
+bool_t LeoShadow(mrf24_dev_t * dev, int16_t indice, uint8_t * valor);
+void GuardoShadow(mrf24_dev_t * dev, int16_t indice, uint8_t valor);
+void TomoBus(mrf24_dev_t * dev);
+void LiberoBus(mrf24_dev_t * dev);
+mrf24_state_t SetShortAddr(mrf24_dev_t * dev, uint8_t reg_address, uint8_t valor);
+mrf24_state_t GetShortAddr(mrf24_dev_t * dev, uint8_t reg_address, uint8_t * respuesta);
+mrf24_state_t SetLongAddr(mrf24_dev_t * dev, uint16_t reg_address, uint8_t valor);
+mrf24_state_t GetLongAddr(mrf24_dev_t * dev, uint16_t reg_address, uint8_t * respuesta);
+mrf24_state_t SetLongAddrBlock(mrf24_dev_t * dev, uint16_t reg_address, const uint8_t * datos,
+                               uint16_t largo);
+mrf24_state_t GetRxFifo(mrf24_dev_t * dev, uint8_t * trama, uint8_t * largo);
+mrf24_state_t LeoTramaRx(mrf24_dev_t * dev, mrf24_data_in_t * data_in);
+mrf24_state_t CargoFifoTx(mrf24_dev_t * dev, const uint8_t * cabecera, uint8_t largo_cabecera,
+                          const mrf24_segment_t * segmentos, uint8_t cantidad);
+mrf24_state_t ValidoDatoSalida(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s);
+mrf24_frame_opts_t OpcionesDato(uint16_t dest_panid, uint16_t dest_address,
+                                uint16_t origin_address);
+bool_t PidoAck(const mrf24_frame_opts_t * opciones);
+uint8_t CodificoDireccion(uint8_t * cabecera, uint8_t pos, mrf24_addr_mode_t modo, uint16_t corta,
+                          const uint8_t * larga);
+uint8_t CodificoCabecera(mrf24_dev_t * dev, uint8_t * cabecera, const mrf24_frame_opts_t * opciones,
+                         uint8_t largo);
+uint8_t UbicoDirecciones(const uint8_t * trama, uint8_t * pan, uint8_t * direccion);
+uint8_t DecodificoCabecera(const uint8_t * trama, uint8_t largo, mrf24_data_in_t * data_in);
+mrf24_tx_handle_t NuevoHandle(mrf24_dev_t * dev);
+bool_t HandleEnUso(mrf24_dev_t * dev, mrf24_tx_handle_t handle);
+mrf24_state_t DisparoTransmision(mrf24_dev_t * dev, mrf24_tx_handle_t handle, uint16_t destino,
+                                 uint8_t opciones);
+void InformoResultado(mrf24_dev_t * dev, mrf24_tx_handle_t handle, mrf24_tx_status_t status,
+                      uint8_t retries);
+mrf24_state_t TransmitoTrama(mrf24_dev_t * dev, const mrf24_frame_opts_t * opciones,
+                             const mrf24_segment_t * segmentos, uint8_t cantidad, uint8_t largo,
+                             mrf24_sec_level_t nivel, mrf24_tx_handle_t * handle);
+mrf24_state_t TerminoTransmision(mrf24_dev_t * dev);
+void InicializoColaTx(mrf24_dev_t * dev);
+mrf24_state_t EncoloTrama(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s,
+                          mrf24_tx_handle_t * handle);
+mrf24_state_t DespachoColaTx(mrf24_dev_t * dev);
+void DespachoColaBloqueada(mrf24_dev_t * dev);
+void DescartoSubcola(mrf24_dev_t * dev, mrf24_tx_subcola_t * subcola);
+void ActualizoSubcola(mrf24_dev_t * dev, uint16_t destino, mrf24_tx_status_t status);
+mrf24_state_t ApplyDeviceAddress(mrf24_dev_t * dev);
+mrf24_state_t ReinicioRf(mrf24_dev_t * dev);
+mrf24_state_t SintonizoCanal(mrf24_dev_t * dev, channel_list_t ch);
+mrf24_state_t ApplyChannel(mrf24_dev_t * dev);
+mrf24_state_t ApplyPhyMode(mrf24_dev_t * dev);
+mrf24_state_t ApplyDeviceMACAddress(mrf24_dev_t * dev);
+mrf24_state_t ApplyRxMode(mrf24_dev_t * dev);
+bool_t NivelSeguridadValido(mrf24_sec_level_t nivel);
+uint8_t CodificoSeguridad(mrf24_dev_t * dev, uint8_t * cabecera, uint8_t pos,
+                          mrf24_sec_level_t nivel);
+mrf24_state_t AtiendoSeguridad(mrf24_dev_t * dev);
+mrf24_state_t ApplySecurityKey(mrf24_dev_t * dev);
+mrf24_state_t ApplySecurityPeer(mrf24_dev_t * dev);
+void ComienzoCanalED(mrf24_dev_t * dev);
+mrf24_state_t AvanzoScanED(mrf24_dev_t * dev);
+mrf24_state_t TerminoScan(mrf24_dev_t * dev);
+void ComienzoCanalActivo(mrf24_dev_t * dev);
+mrf24_state_t AvanzoScanActivo(mrf24_dev_t * dev);
+uint16_t HashVecino(uint16_t panid, uint16_t short_address, const uint8_t * long_address);
+MRF24_discover_nearby_t * UbicoVecino(mrf24_dev_t * dev, uint16_t panid, uint16_t short_address,
+                                      const uint8_t * long_address);
+mrf24_state_t RegistroBeacon(mrf24_dev_t * dev, const uint8_t * trama, uint8_t largo);
+void ComienzoLpl(mrf24_dev_t * dev);
+void ApagoLpl(mrf24_dev_t * dev);
+void EscuchoLpl(mrf24_dev_t * dev);
+void AvanzoLpl(mrf24_dev_t * dev);
+mrf24_state_t DuermoRadio(mrf24_dev_t * dev);
+mrf24_state_t DespiertoRadio(mrf24_dev_t * dev);
+void AtiendoDespertar(mrf24_dev_t * dev);
+bool_t RepitoTransmision(mrf24_dev_t * dev, mrf24_tx_status_t status);
+bool_t TramaRepetida(mrf24_dev_t * dev, const mrf24_data_in_t * data_in, uint8_t secuencia);
+uint8_t NumeroGts(mrf24_dev_t * dev, uint16_t address, mrf24_gts_dir_t direccion);
+void UbicoGts(mrf24_dev_t * dev);
+mrf24_state_t CargoBeacon(mrf24_dev_t * dev);
+mrf24_state_t ApplyGts(mrf24_dev_t * dev);
+mrf24_state_t ApplySuperframe(mrf24_dev_t * dev);
+void ComienzoSupertrama(mrf24_dev_t * dev);
+void ApagoSupertrama(mrf24_dev_t * dev);
+mrf24_state_t ActualizoGts(mrf24_dev_t * dev);
+void DescartoGts(mrf24_dev_t * dev);
+void SigoBeacon(mrf24_dev_t * dev, const uint8_t * trama, uint8_t largo);
+void TerminoGts(mrf24_dev_t * dev, uint8_t fifo);
+mrf24_state_t ApplyPendientes(mrf24_dev_t * dev);
+uint8_t CuentoIndirectas(mrf24_dev_t * dev, uint16_t destino);
+void AtiendoPedidoDatos(mrf24_dev_t * dev, uint16_t origen);
+mrf24_state_t DespachoIndirecta(mrf24_dev_t * dev);
+bool_t TerminoIndirecta(mrf24_dev_t * dev, mrf24_tx_handle_t handle, mrf24_tx_status_t status);
+mrf24_state_t EnvioPedido(mrf24_dev_t * dev, uint16_t coordinador, mrf24_tx_handle_t * handle);
+void TerminoPedido(mrf24_dev_t * dev, mrf24_tx_status_t status);
+void AvanzoIndirectas(mrf24_dev_t * dev);
+mrf24_state_t AtiendoInterrupcion(mrf24_dev_t * dev);
+#if MRF24_PERF
+tick_t PerfTick(mrf24_dev_t * dev);
+void PerfHistograma(uint32_t * histograma, tick_t latencia);
+mrf24_perf_api_t PerfEntro(mrf24_dev_t * dev, mrf24_perf_api_t api);
+void PerfSpi(mrf24_dev_t * dev, uint16_t bytes);
+void PerfTerminoTx(mrf24_dev_t * dev, uint8_t txstat);
+void PerfVeoIrq(mrf24_dev_t * dev);
+void PerfLeoRx(mrf24_dev_t * dev);
+#endif
 
 /* === Implementación de funciones privadas =================================== */
 /**
  * @brief  Inicialización de variables de configuración.
  *
- * @param  None.
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @return None.
  *
  * @note   Si no se inicializa previamente las variables se carga la configuración
  * 		   por defecto de fábrica.
  */
-void InicializoVariables(void) {
+void InicializoVariables(mrf24_dev_t * dev) {
 
-    if (VACIO == data_config_s.channel) {
+    if (NULL == dev->init_perfil)
+        dev->init_perfil = &mrf24_profile_ma;
 
-        memcpy(data_config_s.security_key, default_security_key, SEC_KEY_SIZE);
-        memcpy(data_config_s.mac, default_mac_address, LARGE_MAC_SIZE);
-        data_config_s.sequence_number = DEFAULT_SEC_NUMBER;
-        data_config_s.channel = DEFAULT_CHANNEL;
-        data_config_s.panid = MY_DEFAULT_PAN_ID;
-        data_config_s.address = MY_DEFAULT_ADDRESS;
+    if (!dev->phy_elegido)
+        dev->phy_modo = MRF24_PHY_MODE;
+
+    if (VACIO == dev->config.channel) {
+
+        memcpy(dev->config.security_key, default_security_key, SEC_KEY_SIZE);
+        memcpy(dev->config.mac, default_mac_address, LARGE_MAC_SIZE);
+        dev->config.sequence_number = DEFAULT_SEC_NUMBER;
+        dev->config.channel = DEFAULT_CHANNEL;
+        dev->config.panid = MY_DEFAULT_PAN_ID;
+        dev->config.address = MY_DEFAULT_ADDRESS;
     }
     return;
 }
 
 /**
- * @brief  Inicialización del módulo MRF24J40MA.
+ * @brief  Vacío el buffer de recepción y olvido la transmisión en curso.
  *
- * @param  None.
- * @return mrf24_state_t Estado de la operación (TIME_OUT_OCURRIDO, INICIALIZACION_OK).
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
  */
-mrf24_state_t InicializoMRF24(void) {
+void InicializoColas(mrf24_dev_t * dev) {
 
-    uint8_t lectura;
-    delayNoBloqueanteData_t delay_time_out;
-    DelayInit(&delay_time_out, MRF_TIME_OUT);
-    SetShortAddr(SOFTRST, RSTPWR | RSTBB | RSTMAC);
-    DelayReset(&delay_time_out);
+    dev->rx_ring_head = dev->rx_ring_tail;
+    memset(&dev->rx_stats, 0, sizeof(dev->rx_stats));
+    dev->tx_en_curso = VACIO;
+    dev->sf_gts_handle[0] = VACIO;
+    dev->sf_gts_handle[1] = VACIO;
+    dev->ind_pidiendo = false;
+    dev->ind_repito = false;
 
-    do {
+    for (uint8_t i = 0; i < INDIRECT_TABLE_SIZE; i++) {
 
-        GetShortAddr(SOFTRST, &lectura);
-        if (DelayRead(&delay_time_out))
-            return TIME_OUT_OCURRED;
-    } while (VACIO != (lectura & (RSTPWR | RSTBB | RSTMAC)));
-    delay_t(WAIT_50_MS);
-    SetShortAddr(RXFLUSH, RXFLUSH_RESET);
-    ApplyDeviceAddress();
-    ApplyDeviceMACAddress();
-    SetLongAddr(RFCON1, VCOOPT1 | VCOOPT0);
-    SetLongAddr(RFCON2, PLLEN);
-    SetLongAddr(RFCON3, P20dBm | P0dBm);
-    SetLongAddr(RFCON6, TXFIL | _20MRECVR);
-    SetLongAddr(RFCON7, SLPCLK100KHZ);
-    SetLongAddr(RFCON8, RFVCO);
-    SetLongAddr(SLPCON1, CLKOUTDIS | SLPCLKDIV0);
-    SetShortAddr(BBREG2, CCA_MODE_1);
-    SetShortAddr(BBREG6, RSSIMODE2);
-    SetShortAddr(CCAEDTH, CCAEDTH2 | CCAEDTH1);
-    SetShortAddr(PACON2, FIFOEN | TXONTS2 | TXONTS1);
-    SetShortAddr(TXSTBL, RFSTBL3 | RFSTBL0 | MSIFS2 | MSIFS0);
-    DelayReset(&delay_time_out);
+        dev->ind_tabla[i].handle = VACIO;
+        dev->ind_tabla[i].pedida = false;
+    }
+    InicializoColaTx(dev);
+    return;
+}
 
-    do {
+/**
+ * @brief  Paso a un nuevo paso de la inicialización y arranco su temporizador.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_init_step_t Nuevo paso.
+ * @param  tick_t Duración de la espera o del time out del paso.
+ * @return None.
+ */
+void EsperoInicializacion(mrf24_dev_t * dev, mrf24_init_step_t paso, tick_t duracion) {
 
-        GetLongAddr(RFSTATE, &lectura);
-        lectura &= RX;
-        if (DelayRead(&delay_time_out))
-            return TIME_OUT_OCURRED;
-    } while (RX != lectura);
-    SetShortAddr(MRFINTCON,
-                 SLPIE_DIS | WAKEIE_DIS | HSYMTMRIE_DIS | SECIE_DIS | TXG2IE_DIS | TXNIE_DIS);
-    SetShortAddr(ACKTMOUT, DRPACK | MAWD5 | MAWD4 | MAWD3 | MAWD0);
-    ApplyChannel();
-    SetShortAddr(RXMCR, VACIO);
-    GetShortAddr(INTSTAT, &lectura);
-    return INIT_OK;
+    dev->init_paso = paso;
+    DelayWrite(&dev->init_delay, duracion);
+    DelayReset(&dev->init_delay);
+    return;
+}
+
+/**
+ * @brief  Ejecuto un script de escritura de registros.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  const mrf24_reg_write_t * Script a ejecutar.
+ * @param  uint8_t Cantidad de entradas del script.
+ * @param  uint8_t * Entrada desde la que se ejecuta, queda en la siguiente a
+ *                   la última ejecutada.
+ * @return uint8_t Milisegundos a esperar antes de seguir, 0 si terminó.
+ *
+ * @note   Las entradas de registros largos consecutivos se escriben en una
+ *         sola transacción aprovechando el autoincremento de la dirección.
+ *         Los comandos ya vienen codificados, solo se decodifican para
+ *         mantener la copia de los registros.
+ */
+uint8_t EjecutoScript(mrf24_dev_t * dev, const mrf24_reg_write_t * script, uint8_t largo,
+                      uint8_t * indice) {
+
+    uint8_t valores[SCRIPT_BATCH];
+    uint8_t espera = VACIO;
+
+    while (*indice < largo && VACIO == espera) {
+
+        const mrf24_reg_write_t * entrada = &script[*indice];
+        uint16_t comando = entrada->command;
+        bool_t es_largo = (WRITE_16_BITS == (comando & WRITE_16_BITS));
+        uint16_t registro = es_largo ? (uint16_t)((comando >> SHIFT_LONG_ADDR) & 0x3FF)
+                                     : (uint16_t)(comando >> SHIFT_SHORT_ADDR);
+        uint8_t cantidad = 0;
+        bool_t cambia = false;
+
+        do {
+
+            uint8_t anterior;
+            int16_t indice_shadow = IndiceShadow(registro + cantidad, es_largo);
+
+            valores[cantidad] = script[*indice].value;
+            if (!LeoShadow(dev, indice_shadow, &anterior) || anterior != valores[cantidad])
+                cambia = true;
+            espera = script[*indice].wait_ms;
+            cantidad++;
+            (*indice)++;
+        } while (es_largo && VACIO == espera && SCRIPT_BATCH > cantidad && *indice < largo &&
+                 script[*indice].command ==
+                     (uint16_t)(comando + (cantidad << SHIFT_LONG_ADDR)));
+
+        if (!cambia)
+            continue;
+
+        bool_t error = false;
+        TomoBus(dev);
+        if (SOFTRST == registro || SLPACK == registro)
+            InvalidoShadow(dev);
+        if (es_largo) {
+
+            if (SPI_COMM_ERROR == dev->port.write_2_bytes(dev->port.ctx, &comando))
+                error = true;
+            if (SPI_COMM_ERROR == dev->port.write_block(dev->port.ctx, valores, cantidad))
+                error = true;
+        } else {
+
+            uint8_t comando_corto = (uint8_t)comando;
+            if (SPI_COMM_ERROR == dev->port.write_byte(dev->port.ctx, &comando_corto))
+                error = true;
+            if (SPI_COMM_ERROR == dev->port.write_byte(dev->port.ctx, &valores[0]))
+                error = true;
+        }
+        PERF(PerfSpi(dev, es_largo ? _2_BYTES + cantidad : _2_BYTES));
+
+        for (uint8_t i = 0; i < cantidad; i++) {
+
+            if (error)
+                InvalidoShadow(dev);
+            else
+                GuardoShadow(dev, IndiceShadow(registro + i, es_largo), valores[i]);
+        }
+        LiberoBus(dev);
+    }
+    return espera;
+}
+
+/**
+ * @brief  Ejecuto el script del perfil de inicialización y después su script
+ *         adicional.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return uint8_t Milisegundos a esperar antes de seguir, 0 si terminó.
+ *
+ * @note   init_script_indice recorre los dos scripts como si fueran uno solo,
+ *         así una espera en cualquiera de ellos retoma donde quedó.
+ */
+uint8_t EjecutoPerfil(mrf24_dev_t * dev) {
+
+    const mrf24_init_profile_t * perfil = dev->init_perfil;
+    uint8_t espera = EjecutoScript(dev, perfil->script, perfil->length, &dev->init_script_indice);
+    uint8_t indice;
+
+    if (VACIO != espera)
+        return espera;
+    indice = dev->init_script_indice - perfil->length;
+    espera = EjecutoScript(dev, perfil->extra, perfil->extra_length, &indice);
+    dev->init_script_indice = perfil->length + indice;
+    return espera;
+}
+
+/**
+ * @brief  Avanzo un paso en la inicialización del módulo MRF24J40MA.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (INIT_IN_PROGRESS, INIT_OK,
+ *                       TIME_OUT_OCURRED).
+ *
+ * @note   Nunca se queda esperando: las esperas y los time out se controlan con
+ *         el delay no bloqueante y se vuelve a consultar en la próxima llamada.
+ */
+mrf24_state_t AvanzoInicializacion(mrf24_dev_t * dev) {
+
+    uint8_t lectura = VACIO;
+
+    switch (dev->init_paso) {
+
+    case INIT_STEP_RESET_PIN:
+        if (DelayRead(&dev->init_delay)) {
+
+            dev->port.set_reset(dev->port.ctx, 1);
+            EsperoInicializacion(dev, INIT_STEP_RESET_RELEASE, WAIT_1_MS);
+        }
+        break;
+
+    case INIT_STEP_RESET_RELEASE:
+        if (DelayRead(&dev->init_delay)) {
+
+            SetShortAddr(dev, SOFTRST, RSTPWR | RSTBB | RSTMAC);
+            EsperoInicializacion(dev, INIT_STEP_SOFT_RESET, MRF_TIME_OUT);
+        }
+        break;
+
+    case INIT_STEP_SOFT_RESET:
+        GetShortAddr(dev, SOFTRST, &lectura);
+
+        if (VACIO == (lectura & (RSTPWR | RSTBB | RSTMAC)))
+            EsperoInicializacion(dev, INIT_STEP_STABILIZE, WAIT_50_MS);
+        else if (DelayRead(&dev->init_delay))
+            dev->init_paso = INIT_STEP_FAILED;
+        break;
+
+    case INIT_STEP_STABILIZE:
+        if (DelayRead(&dev->init_delay)) {
+
+            ApplyDeviceAddress(dev);
+            ApplyDeviceMACAddress(dev);
+            ApplySecurityKey(dev);
+            ApplySecurityPeer(dev);
+            dev->init_script_indice = 0;
+            EsperoInicializacion(dev, INIT_STEP_CONFIGURE, VACIO);
+        }
+        break;
+
+    case INIT_STEP_CONFIGURE:
+        if (DelayRead(&dev->init_delay)) {
+
+            lectura = EjecutoPerfil(dev);
+
+            if (VACIO != lectura)
+                EsperoInicializacion(dev, INIT_STEP_CONFIGURE, lectura);
+            else
+                EsperoInicializacion(dev, INIT_STEP_WAIT_RX, MRF_TIME_OUT);
+        }
+        break;
+
+    case INIT_STEP_WAIT_RX:
+        GetLongAddr(dev, RFSTATE, &lectura);
+
+        if (RX == (lectura & RX)) {
+
+            ApplyPhyMode(dev);
+            ApplyChannel(dev);
+            EsperoInicializacion(dev, INIT_STEP_RF_RESET, WAIT_1_MS);
+        } else if (DelayRead(&dev->init_delay)) {
+
+            dev->init_paso = INIT_STEP_FAILED;
+        }
+        break;
+
+    case INIT_STEP_RF_RESET:
+        if (DelayRead(&dev->init_delay)) {
+
+            ApplyRxMode(dev);
+            GetShortAddr(dev, INTSTAT, &lectura);
+            dev->init_paso = INIT_STEP_DONE;
+
+            if (VACIO != dev->lpl_config.max_latency)
+                ComienzoLpl(dev);
+
+            if (SF_ROLE_COORDINATOR == dev->sf.role)
+                ComienzoSupertrama(dev);
+            dev->sf.synced = (SF_ROLE_COORDINATOR == dev->sf.role);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (INIT_STEP_DONE == dev->init_paso)
+        return INIT_OK;
+
+    if (INIT_STEP_FAILED == dev->init_paso)
+        return TIME_OUT_OCURRED;
+    return INIT_IN_PROGRESS;
+}
+
+/**
+ * @brief  Olvido todos los valores guardados en la copia de los registros.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ *
+ * @note   Se llama cada vez que el módulo puede haber vuelto sus registros a
+ *         los valores por defecto (reset por pin o por software, sleep).
+ */
+void InvalidoShadow(mrf24_dev_t * dev) {
+
+    memset(dev->shadow_validos, 0, sizeof(dev->shadow_validos));
+    return;
+}
+
+/**
+ * @brief  Obtengo la posición de un registro en la copia de los registros.
+ *
+ * @param  uint16_t Dirección del registro.
+ * @param  bool_t true si es una dirección larga.
+ * @return int16_t Posición en la copia, SHADOW_NONE si el registro no se copia.
+ *
+ * @note   Solo se copian los registros de control que el módulo no modifica
+ *         por su cuenta. Los de estado, los contadores y los que tienen bits
+ *         que se borran solos (disparos, flush, reset) siempre van al módulo.
+ */
+int16_t IndiceShadow(uint16_t reg_address, bool_t largo) {
+
+    if (!largo) {
+
+        switch (reg_address) {
+
+        case RXFLUSH:
+        case TXBCON0:
+        case TXNCON:
+        case TXG1CON:
+        case TXG2CON:
+        case TXPEND:
+        case WAKECON:
+        case TXSTAT:
+        case HSYMTMRL:
+        case HSYMTMRH:
+        case SOFTRST:
+        case SECCON0:
+        case RXSR:
+        case INTSTAT:
+        case GPIO:
+        case SLPACK:
+        case RFCTL:
+        case SECCR2:
+        case BBREG6:
+            return SHADOW_NONE;
+        default:
+            break;
+        }
+        return (SHORT_REG_COUNT > reg_address) ? (int16_t)reg_address : SHADOW_NONE;
+    }
+
+    if (LONG_CTRL_FIRST > reg_address || LONG_CTRL_FIRST + LONG_CTRL_COUNT <= reg_address)
+        return SHADOW_NONE;
+
+    if ((SLPCAL0 <= reg_address && RSSI >= reg_address) ||
+        (REMCNTL <= reg_address && MAINCNT3 >= reg_address))
+        return SHADOW_NONE;
+    return (int16_t)(SHORT_REG_COUNT + reg_address - LONG_CTRL_FIRST);
+}
+
+/**
+ * @brief  Leo el valor de un registro de la copia.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  int16_t Posición en la copia.
+ * @param  uint8_t * Puntero a la variable donde se guarda el valor.
+ * @return bool_t true si el valor estaba en la copia.
+ */
+bool_t LeoShadow(mrf24_dev_t * dev, int16_t indice, uint8_t * valor) {
+
+    if (SHADOW_NONE == indice || !(dev->shadow_validos[indice >> 3] & (1 << (indice & 0x07))))
+        return false;
+    *valor = dev->shadow[indice];
+    return true;
+}
+
+/**
+ * @brief  Guardo el valor de un registro en la copia.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  int16_t Posición en la copia.
+ * @param  uint8_t Valor del registro.
+ * @return None.
+ */
+void GuardoShadow(mrf24_dev_t * dev, int16_t indice, uint8_t valor) {
+
+    if (SHADOW_NONE == indice)
+        return;
+    dev->shadow[indice] = valor;
+    dev->shadow_validos[indice >> 3] |= (uint8_t)(1 << (indice & 0x07));
+    return;
+}
+
+/**
+ * @brief  Comienzo una transacción SPI.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ *
+ * @note   Si el port lo permite se enmascara antes la interrupción del módulo,
+ *         así MRF24InterruptHandler no intercala sus bytes en el bus ni cambia
+ *         la copia de los registros hasta LiberoBus.
+ */
+void TomoBus(mrf24_dev_t * dev) {
+
+    if (NULL != dev->port.mask_interrupt)
+        dev->port.mask_interrupt(dev->port.ctx, true);
+    dev->port.set_cs(dev->port.ctx, DISABLE);
+    return;
+}
+
+/**
+ * @brief  Termino una transacción SPI y vuelvo a habilitar la interrupción.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ */
+void LiberoBus(mrf24_dev_t * dev) {
+
+    dev->port.set_cs(dev->port.ctx, ENABLE);
+    if (NULL != dev->port.mask_interrupt)
+        dev->port.mask_interrupt(dev->port.ctx, false);
+    return;
 }
 
 /**
  * @brief  Escribo en módulo MRF24J40 mediante SPI un registro de 1 byte y un
  *         dato de 1 byte.
  *
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @param  uint8_t Dirección del registro.
  * @param  uint8_t Dato a enviar.
  * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
@@ -158,22 +773,36 @@ mrf24_state_t InicializoMRF24(void) {
  *         con el MSB en 0 indicando una dirección corta, 6 bits con la
  *         dirección del registro, y 1 bit indicando la lectura o escritura.
  */
-mrf24_state_t SetShortAddr(uint8_t reg_address, uint8_t valor) {
+mrf24_state_t SetShortAddr(mrf24_dev_t * dev, uint8_t reg_address, uint8_t valor) {
 
     mrf24_state_t estado = OPERATION_OK;
+    int16_t indice = IndiceShadow(reg_address, false);
+    uint8_t anterior;
+
+    if (LeoShadow(dev, indice, &anterior) && anterior == valor)
+        return OPERATION_OK;
+
+    TomoBus(dev);
+    if (SOFTRST == reg_address || SLPACK == reg_address)
+        InvalidoShadow(dev);
     reg_address = (uint8_t)(reg_address << SHIFT_SHORT_ADDR) | WRITE_8_BITS;
-    SetCSPin(DISABLE);
-    if (SPI_COMM_ERROR == WriteByteSPIPort(&reg_address))
+    if (SPI_COMM_ERROR == dev->port.write_byte(dev->port.ctx, &reg_address))
         estado = OPERATION_FAIL;
-    if (SPI_COMM_ERROR == WriteByteSPIPort(&valor))
+    if (SPI_COMM_ERROR == dev->port.write_byte(dev->port.ctx, &valor))
         estado = OPERATION_FAIL;
-    SetCSPin(ENABLE);
+    PERF(PerfSpi(dev, _2_BYTES));
+    if (OPERATION_OK == estado)
+        GuardoShadow(dev, indice, valor);
+    else
+        InvalidoShadow(dev);
+    LiberoBus(dev);
     return estado;
 }
 
 /**
  * @brief  Leo en registro de 1 byte un dato de 1 byte.
  *
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @param  Dirección del registro - 1 byte
  * @param  uint8_t * Puntero a la variable donde se guardará el dato leído.
  * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL, INVALID_VALUE).
@@ -182,24 +811,32 @@ mrf24_state_t SetShortAddr(uint8_t reg_address, uint8_t valor) {
  *         con el MSB en 0 indicando una dirección corta, 6 bits con la
  *         dirección del registro, y 1 bit indicando la lectura o escritura.
  */
-mrf24_state_t GetShortAddr(uint8_t reg_address, uint8_t * respuesta) {
+mrf24_state_t GetShortAddr(mrf24_dev_t * dev, uint8_t reg_address, uint8_t * respuesta) {
 
     if (NULL == respuesta)
         return INVALID_VALUE;
     mrf24_state_t estado = OPERATION_OK;
+    int16_t indice = IndiceShadow(reg_address, false);
+
+    if (LeoShadow(dev, indice, respuesta))
+        return OPERATION_OK;
     reg_address = (uint8_t)(reg_address << SHIFT_SHORT_ADDR) & READ_8_BITS;
-    SetCSPin(DISABLE);
-    if (SPI_COMM_ERROR == WriteByteSPIPort(&reg_address))
+    TomoBus(dev);
+    if (SPI_COMM_ERROR == dev->port.write_byte(dev->port.ctx, &reg_address))
         estado = OPERATION_FAIL;
-    if (SPI_COMM_ERROR == ReadByteSPIPort(respuesta))
+    if (SPI_COMM_ERROR == dev->port.read_byte(dev->port.ctx, respuesta))
         estado = OPERATION_FAIL;
-    SetCSPin(ENABLE);
+    PERF(PerfSpi(dev, _2_BYTES));
+    if (OPERATION_OK == estado)
+        GuardoShadow(dev, indice, *respuesta);
+    LiberoBus(dev);
     return estado;
 }
 
 /**
  * @brief  Escribo de en registro de 2 bytes un dato de 1 byte.
  *
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @param  uint16_t Dirección del registro.
  * @return uint8_t Valor devuelto por el módulo.
  * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
@@ -209,22 +846,33 @@ mrf24_state_t GetShortAddr(uint8_t reg_address, uint8_t * respuesta) {
  *         dirección del registro, y 1 bit indicando la lectura o escritura. En
  *         los 4 bits restantes (LSB) no importa el valor.
  */
-mrf24_state_t SetLongAddr(uint16_t reg_address, uint8_t valor) {
+mrf24_state_t SetLongAddr(mrf24_dev_t * dev, uint16_t reg_address, uint8_t valor) {
 
     mrf24_state_t estado = OPERATION_OK;
+    int16_t indice = IndiceShadow(reg_address, true);
+    uint8_t anterior;
+
+    if (LeoShadow(dev, indice, &anterior) && anterior == valor)
+        return OPERATION_OK;
     reg_address = (reg_address << SHIFT_LONG_ADDR) | WRITE_16_BITS;
-    SetCSPin(DISABLE);
-    if (SPI_COMM_ERROR == Write2ByteSPIPort(&reg_address))
+    TomoBus(dev);
+    if (SPI_COMM_ERROR == dev->port.write_2_bytes(dev->port.ctx, &reg_address))
         estado = OPERATION_FAIL;
-    if (SPI_COMM_ERROR == WriteByteSPIPort(&valor))
+    if (SPI_COMM_ERROR == dev->port.write_byte(dev->port.ctx, &valor))
         estado = OPERATION_FAIL;
-    SetCSPin(ENABLE);
+    PERF(PerfSpi(dev, _2_BYTES + _1_BYTE));
+    if (OPERATION_OK == estado)
+        GuardoShadow(dev, indice, valor);
+    else
+        InvalidoShadow(dev);
+    LiberoBus(dev);
     return estado;
 }
 
 /**
  * @brief  Leo en registro de 2 bytes un dato de 1 byte.
  *
+ * @param  mrf24_dev_t * Puntero al módulo.
  * @param  uint16_t Dirección del registro.
  * @param  uint8_t * Puntero a la variable donde se guardará el dato leído.
  * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL, INVALID_VALUE).
@@ -234,252 +882,3256 @@ mrf24_state_t SetLongAddr(uint16_t reg_address, uint8_t valor) {
  *         dirección del registro, y 1 bit indicando la lectura o escritura. En
  *         los 4 bits restantes (LSB) no importa el valor.
  */
-mrf24_state_t GetLongAddr(uint16_t reg_address, uint8_t * respuesta) {
+mrf24_state_t GetLongAddr(mrf24_dev_t * dev, uint16_t reg_address, uint8_t * respuesta) {
 
     if (NULL == respuesta)
         return INVALID_VALUE;
     mrf24_state_t estado = OPERATION_OK;
+    int16_t indice = IndiceShadow(reg_address, true);
+
+    if (LeoShadow(dev, indice, respuesta))
+        return OPERATION_OK;
     reg_address = (reg_address << SHIFT_LONG_ADDR) | READ_16_BITS;
-    SetCSPin(DISABLE);
-    if (SPI_COMM_ERROR == Write2ByteSPIPort(&reg_address))
+    TomoBus(dev);
+    if (SPI_COMM_ERROR == dev->port.write_2_bytes(dev->port.ctx, &reg_address))
         estado = OPERATION_FAIL;
-    if (SPI_COMM_ERROR == ReadByteSPIPort(respuesta))
+    if (SPI_COMM_ERROR == dev->port.read_byte(dev->port.ctx, respuesta))
         estado = OPERATION_FAIL;
-    SetCSPin(ENABLE);
+    PERF(PerfSpi(dev, _2_BYTES + _1_BYTE));
+    if (OPERATION_OK == estado)
+        GuardoShadow(dev, indice, *respuesta);
+    LiberoBus(dev);
     return estado;
 }
 
 /**
- * @brief  Seteo en el módulo en canal guardado en mrf24_data_config.
+ * @brief  Escribo en módulo MRF24J40 un bloque de datos a partir de un
+ *         registro de 2 bytes, en una única transacción SPI.
  *
- * @param  None.
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t Dirección del primer registro.
+ * @param  const uint8_t * Puntero a los datos a escribir.
+ * @param  uint16_t Cantidad de bytes a escribir.
  * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   El módulo incrementa la dirección larga con cada byte mientras el
+ *         CS se mantiene habilitado, por lo que se envía la dirección una sola
+ *         vez. Se usa para cargar las FIFO.
  */
-mrf24_state_t ApplyChannel(void) {
+mrf24_state_t SetLongAddrBlock(mrf24_dev_t * dev, uint16_t reg_address, const uint8_t * datos,
+                               uint16_t largo) {
 
-    if (OPERATION_FAIL == SetLongAddr(RFCON0, data_config_s.channel))
-        return OPERATION_FAIL;
-    if (OPERATION_FAIL == SetShortAddr(RFCTL, RFRST_HOLD))
-        return OPERATION_FAIL;
-    if (OPERATION_FAIL == SetShortAddr(RFCTL, VACIO))
-        return OPERATION_FAIL;
-    delay_t(WAIT_1_MS);
-    return OPERATION_OK;
+    mrf24_state_t estado = OPERATION_OK;
+
+    TomoBus(dev);
+    if (LONG_CTRL_FIRST + LONG_CTRL_COUNT > reg_address && LONG_CTRL_FIRST < reg_address + largo)
+        InvalidoShadow(dev);
+    reg_address = (reg_address << SHIFT_LONG_ADDR) | WRITE_16_BITS;
+    if (SPI_COMM_ERROR == dev->port.write_2_bytes(dev->port.ctx, &reg_address))
+        estado = OPERATION_FAIL;
+    if (SPI_COMM_ERROR == dev->port.write_block(dev->port.ctx, datos, largo))
+        estado = OPERATION_FAIL;
+    PERF(PerfSpi(dev, _2_BYTES + largo));
+    LiberoBus(dev);
+    return estado;
 }
 
 /**
- * @brief  Seteo en el módulo la dirección corta guardada en mrf24_data_config.
+ * @brief  Leo la trama recibida de la FIFO de recepción en una única
+ *         transacción SPI.
  *
- * @param  None.
- * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint8_t * Buffer donde se guarda la trama, de al menos RX_FRAME_SIZE
+ *                   bytes.
+ * @param  uint8_t * Puntero a la variable donde se guarda el largo de la trama.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL,
+ *                       INVALID_VALUE).
+ *
+ * @note   El primer byte de la FIFO es el largo de la trama (cabecera, datos y
+ *         FCS). Con el CS todavía habilitado se leen a continuación la trama y
+ *         los dos bytes de LQI y RSSI que el módulo agrega al final.
  */
-mrf24_state_t ApplyDeviceAddress(void) {
+mrf24_state_t GetRxFifo(mrf24_dev_t * dev, uint8_t * trama, uint8_t * largo) {
 
-    if (OPERATION_FAIL == SetShortAddr(SADRH, (uint8_t)(data_config_s.address >> SHIFT_BYTE)))
-        return OPERATION_FAIL;
-    if (OPERATION_FAIL == SetShortAddr(SADRL, (uint8_t)(data_config_s.address)))
-        return OPERATION_FAIL;
-    if (OPERATION_FAIL == SetShortAddr(PANIDH, (uint8_t)(data_config_s.panid >> SHIFT_BYTE)))
-        return OPERATION_FAIL;
-    if (OPERATION_FAIL == SetShortAddr(PANIDL, (uint8_t)(data_config_s.panid)))
-        return OPERATION_FAIL;
-    return OPERATION_OK;
+    if (NULL == trama || NULL == largo)
+        return INVALID_VALUE;
+    mrf24_state_t estado = OPERATION_OK;
+    uint8_t minimo = ((dev->rxmcr & PROMI) ? MHR_MIN_LENGTH : MHR_ADDR_LENGTH) + FCS_LENGTH;
+    uint16_t reg_address = (RX_FIFO << SHIFT_LONG_ADDR) | READ_16_BITS;
+    TomoBus(dev);
+    if (SPI_COMM_ERROR == dev->port.write_2_bytes(dev->port.ctx, &reg_address))
+        estado = OPERATION_FAIL;
+    if (SPI_COMM_ERROR == dev->port.read_byte(dev->port.ctx, largo))
+        estado = OPERATION_FAIL;
+
+    if (OPERATION_OK == estado &&
+        (minimo > *largo || MAX_FRAME_LENGTH < *largo))
+        estado = INVALID_VALUE;
+
+    if (OPERATION_OK == estado &&
+        SPI_COMM_ERROR == dev->port.read_block(dev->port.ctx, trama, *largo + LQI_RSSI_LENGTH))
+        estado = OPERATION_FAIL;
+    PERF(PerfSpi(dev, _2_BYTES + _1_BYTE +
+                      ((INVALID_VALUE == estado) ? VACIO : *largo + LQI_RSSI_LENGTH)));
+    LiberoBus(dev);
+    return estado;
 }
 
 /**
- * @brief  Seteo en el módulo la dirección mac guardada en mrf24_data_config.
+ * @brief  Cargo en la FIFO de transmisión la cabecera y los segmentos de datos
+ *         en una única transacción SPI.
  *
- * @param  None.
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  const uint8_t * Puntero a la cabecera (largos y cabecera MAC).
+ * @param  uint8_t Largo de la cabecera.
+ * @param  const mrf24_segment_t * Lista de segmentos de datos.
+ * @param  uint8_t Cantidad de segmentos.
  * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   Cada segmento se pasa al port como un bloque independiente, sin
+ *         copiarlo, mientras el CS se mantiene habilitado.
  */
-mrf24_state_t ApplyDeviceMACAddress(void) {
+mrf24_state_t CargoFifoTx(mrf24_dev_t * dev, const uint8_t * cabecera, uint8_t largo_cabecera,
+                          const mrf24_segment_t * segmentos, uint8_t cantidad) {
 
-    for (uint8_t i = 0; i < LARGE_MAC_SIZE; i++) {
+    mrf24_state_t estado = OPERATION_OK;
+    uint16_t reg_address = (TX_NORMAL_FIFO << SHIFT_LONG_ADDR) | WRITE_16_BITS;
+    PERF(uint16_t bytes = _2_BYTES + largo_cabecera);
+    TomoBus(dev);
+    if (SPI_COMM_ERROR == dev->port.write_2_bytes(dev->port.ctx, &reg_address))
+        estado = OPERATION_FAIL;
+    if (SPI_COMM_ERROR == dev->port.write_block(dev->port.ctx, cabecera, largo_cabecera))
+        estado = OPERATION_FAIL;
 
-        if (OPERATION_FAIL == SetShortAddr(EADR0 + i, data_config_s.mac[i]))
-            return OPERATION_FAIL;
+    for (uint8_t i = 0; i < cantidad; i++) {
+
+        if (VACIO == segmentos[i].length)
+            continue;
+        if (SPI_COMM_ERROR == dev->port.write_block(dev->port.ctx, segmentos[i].data,
+                                                    segmentos[i].length))
+            estado = OPERATION_FAIL;
+        PERF(bytes += segmentos[i].length);
     }
-    return OPERATION_OK;
+    PERF(PerfSpi(dev, bytes));
+    LiberoBus(dev);
+    return estado;
 }
 
-/* === Implementación de funciones públicas =================================== */
-mrf24_state_t MRF24J40Init(void) {
-
-    InicializoVariables();
-    InicializoPines();
-    delay_t(WAIT_1_MS);
-    SetResetPin(1);
-    delay_t(WAIT_1_MS);
-    estadoActual = InicializoMRF24();
-    return estadoActual;
-}
+/**
+ * @brief  Compruebo la información de salida y completo los campos vacíos con
+ *         la configuración del dispositivo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_data_out_t * Puntero a la estructura con la información de envío.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, OPERATION_OK,
+ *         INVALID_VALUE, DIRECTION_EMPTY, BUFFER_EMPTY, TO_LONG_MSG).
+ */
+mrf24_state_t ValidoDatoSalida(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s) {
 
-mrf24_state_t MRF24SetChannel(channel_list_t ch) {
+    if (INIT_OK != dev->estado)
+        return OPERATION_FAIL;
 
-    if (CH_11 > ch || CH_26 < ch)
+    if (NULL == p_info_out_s)
         return INVALID_VALUE;
-    data_config_s.channel = ch;
-    return OPERATION_OK;
-}
 
-mrf24_state_t MRF24SetPanId(uint16_t pan_id) {
+    if (VACIO == p_info_out_s->dest_address)
+        return DIRECTION_EMPTY;
 
-    if (BROADCAST == pan_id)
-        return INVALID_VALUE;
-    data_config_s.panid = pan_id;
-    return OPERATION_OK;
-}
+    if (VACIO == p_info_out_s->buffer_size)
+        return BUFFER_EMPTY;
 
-mrf24_state_t MRF24SetAdd(uint16_t add) {
+    if (MAX_PAYLOAD_SIZE < p_info_out_s->buffer_size)
+        return TO_LONG_MSG;
 
-    if (BROADCAST == add)
-        return INVALID_VALUE;
-    data_config_s.address = add;
+    if (VACIO == p_info_out_s->dest_panid)
+        p_info_out_s->dest_panid = dev->config.panid;
+
+    if (VACIO == p_info_out_s->origin_address)
+        p_info_out_s->origin_address = dev->config.address;
     return OPERATION_OK;
 }
 
-mrf24_state_t MRF24SetSec(uint16_t sec) {
+/**
+ * @brief  Armo las opciones de una trama de datos común: direcciones cortas en
+ *         el mismo PAN y ACK.
+ *
+ * @param  uint16_t PANID de destino.
+ * @param  uint16_t Dirección de destino.
+ * @param  uint16_t Dirección de origen.
+ * @return mrf24_frame_opts_t Opciones de la trama.
+ */
+mrf24_frame_opts_t OpcionesDato(uint16_t dest_panid, uint16_t dest_address,
+                                uint16_t origin_address) {
 
-    data_config_s.sequence_number = sec;
-    return OPERATION_OK;
+    mrf24_frame_opts_t opciones = {FRAME_DATA, true, true, ADDR_SHORT, ADDR_SHORT, dest_panid,
+                                   dest_address, origin_address, {0}};
+    return opciones;
 }
 
-mrf24_state_t MRF24SetMAC(uint8_t mac[8]) {
+/**
+ * @brief  Decido si la trama pide ACK.
+ *
+ * @param  const mrf24_frame_opts_t * Opciones de la trama.
+ * @return bool_t true si se pidió y el destino es un único nodo.
+ *
+ * @note   A BROADCAST nadie responde: pedir ACK sólo gasta los reintentos.
+ */
+bool_t PidoAck(const mrf24_frame_opts_t * opciones) {
 
-    bool_t dif_cero = false;
+    if (!opciones->ack || ADDR_NONE == opciones->dest_mode)
+        return false;
+    return ADDR_LONG == opciones->dest_mode || BROADCAST != opciones->dest_address;
+}
 
-    for (uint8_t i = 0; i < LARGE_MAC_SIZE; i++) {
+/**
+ * @brief  Codifico una dirección corta o larga, primero el byte menos
+ *         significativo.
+ *
+ * @param  uint8_t * Buffer de la cabecera.
+ * @param  uint8_t Posición donde se codifica.
+ * @param  mrf24_addr_mode_t Modo de la dirección.
+ * @param  uint16_t Dirección corta.
+ * @param  const uint8_t * Dirección larga, en el orden de mac[8].
+ * @return uint8_t Posición siguiente a la dirección.
+ */
+uint8_t CodificoDireccion(uint8_t * cabecera, uint8_t pos, mrf24_addr_mode_t modo, uint16_t corta,
+                          const uint8_t * larga) {
 
-        if (VACIO != mac[i]) {
+    if (ADDR_LONG == modo) {
 
-            dif_cero = true;
-            break;
-        }
+        memcpy(&cabecera[pos], larga, LARGE_MAC_SIZE);
+        return pos + LARGE_MAC_SIZE;
     }
-
-    if (!dif_cero)
-        return INVALID_VALUE;
-    memcpy(data_config_s.mac, mac, sizeof(data_config_s.mac));
-    return OPERATION_OK;
+    cabecera[pos++] = (uint8_t)corta;
+    cabecera[pos++] = (uint8_t)(corta >> SHIFT_BYTE);
+    return pos;
 }
 
-mrf24_state_t MRF24SetSecurityKey(uint8_t security_key[16]) {
+/**
+ * @brief  Codifico el encabezado de la FIFO y la cabecera MAC de una trama.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint8_t * Buffer donde se codifica, de al menos
+ *                   FIFO_TX_HEADER + MAX_MHR_LENGTH bytes.
+ * @param  const mrf24_frame_opts_t * Opciones de la trama, con el PAN y el
+ *                                    origen ya resueltos.
+ * @param  uint8_t Largo de los datos que siguen a la cabecera.
+ * @return uint8_t Cantidad de bytes codificados.
+ *
+ * @note   Las tramas con direcciones cortas en el mismo PAN, que son todas las
+ *         de MRF24TransmitirDato y de la cola, se codifican sin pasar por los
+ *         casos generales.
+ */
+uint8_t CodificoCabecera(mrf24_dev_t * dev, uint8_t * cabecera, const mrf24_frame_opts_t * opciones,
+                         uint8_t largo) {
+
+    uint8_t pos = 0;
+    uint8_t mhr = MRF24LargoCabecera(opciones);
+    cabecera[pos++] = mhr;
+    cabecera[pos++] = mhr + largo;
+    cabecera[pos++] = (uint8_t)opciones->type | (PidoAck(opciones) ? ACK_REQ : VACIO) |
+                      (opciones->pan_compression ? INTRA_PAN : VACIO); // LSB.
+    cabecera[pos++] = (uint8_t)((opciones->dest_mode << SHIFT_DEST_MODE) |
+                                (opciones->src_mode << SHIFT_SRC_MODE)); // MSB.
+    cabecera[pos++] = dev->config.sequence_number++;
+
+    if (MHR_LENGTH == mhr && opciones->pan_compression) {
+
+        cabecera[pos++] = (uint8_t)opciones->dest_panid;
+        cabecera[pos++] = (uint8_t)(opciones->dest_panid >> SHIFT_BYTE);
+        cabecera[pos++] = (uint8_t)opciones->dest_address;
+        cabecera[pos++] = (uint8_t)(opciones->dest_address >> SHIFT_BYTE);
+        cabecera[pos++] = (uint8_t)opciones->src_address;
+        cabecera[pos++] = (uint8_t)(opciones->src_address >> SHIFT_BYTE);
+        return pos;
+    }
+
+    if (ADDR_NONE != opciones->dest_mode) {
+
+        pos = CodificoDireccion(cabecera, pos, ADDR_SHORT, opciones->dest_panid, NULL);
+        pos = CodificoDireccion(cabecera, pos, opciones->dest_mode, opciones->dest_address,
+                                opciones->dest_long);
+    }
+
+    if (ADDR_NONE != opciones->src_mode) {
+
+        if (!opciones->pan_compression)
+            pos = CodificoDireccion(cabecera, pos, ADDR_SHORT, dev->config.panid, NULL);
+        pos = CodificoDireccion(cabecera, pos, opciones->src_mode, opciones->src_address,
+                                dev->config.mac);
+    }
+    return pos;
+}
+
+/**
+ * @brief  Ubico el PAN y la dirección de origen en la cabecera MAC de una
+ *         trama recibida.
+ *
+ * @param  const uint8_t * Trama desde el frame control; sólo se leen sus dos
+ *                         primeros bytes.
+ * @param  uint8_t * Donde se guarda la posición del PAN de origen, o del de
+ *                   destino si el origen no lleva PAN.
+ * @param  uint8_t * Donde se guarda la posición de la dirección de origen.
+ * @return uint8_t Largo de la cabecera, VACIO si no tiene direcciones o usa
+ *         un modo de direccionamiento reservado.
+ */
+uint8_t UbicoDirecciones(const uint8_t * trama, uint8_t * pan, uint8_t * direccion) {
+
+    uint8_t destino = (trama[1] >> SHIFT_DEST_MODE) & ADDR_MODE_MASK;
+    uint8_t origen = (trama[1] >> SHIFT_SRC_MODE) & ADDR_MODE_MASK;
+    uint8_t pos = MHR_MIN_LENGTH;
+    *pan = pos;
+
+    if (ADDR_NONE == destino && ADDR_NONE == origen)
+        return VACIO;
+
+    if (ADDR_SHORT > destino && ADDR_NONE != destino)
+        return VACIO;
+
+    if (ADDR_SHORT > origen && ADDR_NONE != origen)
+        return VACIO;
+
+    if (ADDR_NONE != destino)
+        pos += sizeof(uint16_t) + ((ADDR_LONG == destino) ? LARGE_MAC_SIZE : sizeof(uint16_t));
+
+    if (ADDR_NONE != origen && (!(trama[0] & INTRA_PAN) || ADDR_NONE == destino)) {
+
+        *pan = pos;
+        pos += sizeof(uint16_t);
+    }
+    *direccion = pos;
+
+    if (ADDR_NONE != origen)
+        pos += (ADDR_LONG == origen) ? LARGE_MAC_SIZE : sizeof(uint16_t);
+    return pos;
+}
+
+/**
+ * @brief  Decodifico el direccionamiento de la cabecera MAC de una trama
+ *         recibida.
+ *
+ * @param  const uint8_t * Trama desde el frame control.
+ * @param  uint8_t Largo de la trama, sin el FCS.
+ * @param  mrf24_data_in_t * Donde se guardan el PAN y la dirección de origen.
+ * @return uint8_t Largo de la cabecera, VACIO si la trama no la contiene
+ *         entera o usa un modo de direccionamiento reservado.
+ */
+uint8_t DecodificoCabecera(const uint8_t * trama, uint8_t largo, mrf24_data_in_t * data_in) {
+
+    uint8_t origen = (trama[1] >> SHIFT_SRC_MODE) & ADDR_MODE_MASK;
+    uint8_t pan = VACIO;
+    uint8_t direccion = VACIO;
+    uint8_t pos = UbicoDirecciones(trama, &pan, &direccion);
+
+    if (VACIO == pos || pos > largo)
+        return VACIO;
+    data_in->panid = (uint16_t)(trama[pan + 1] << SHIFT_BYTE) | trama[pan];
+    data_in->address = NO_SHORT_ADDRESS;
+    memset(data_in->long_address, 0, LARGE_MAC_SIZE);
+
+    if (ADDR_SHORT == origen)
+        data_in->address = (uint16_t)(trama[direccion + 1] << SHIFT_BYTE) | trama[direccion];
+    else if (ADDR_LONG == origen)
+        memcpy(data_in->long_address, &trama[direccion], LARGE_MAC_SIZE);
+    return pos;
+}
+
+/**
+ * @brief  Genero un nuevo identificador de transmisión.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_tx_handle_t Identificador, nunca VACIO.
+ *
+ * @note   El contador da la vuelta a las 255 transmisiones, antes de que
+ *         venza una trama indirecta, así que se saltean los identificadores
+ *         que siguen pendientes para no confundir sus resultados.
+ */
+mrf24_tx_handle_t NuevoHandle(mrf24_dev_t * dev) {
+
+    do {
+
+        if (VACIO == ++dev->tx_ultimo_handle)
+            dev->tx_ultimo_handle++;
+    } while (HandleEnUso(dev, dev->tx_ultimo_handle));
+    return dev->tx_ultimo_handle;
+}
+
+/**
+ * @brief  Verifico si una transmisión sigue pendiente.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_tx_handle_t Identificador de la transmisión.
+ * @return bool_t true si está en curso, en la cola, en una GTS o guardada
+ *         para un dispositivo dormido.
+ */
+bool_t HandleEnUso(mrf24_dev_t * dev, mrf24_tx_handle_t handle) {
+
+    bool_t pendiente = (handle == dev->tx_en_curso || handle == dev->sf_gts_handle[0] ||
+                        handle == dev->sf_gts_handle[1]);
+
+    for (uint8_t i = 0; i < TX_QUEUE_SIZE && !pendiente; i++) {
+
+        pendiente = (handle == dev->tx_entradas[i].handle);
+    }
+
+    for (uint8_t i = 0; i < INDIRECT_TABLE_SIZE && !pendiente; i++) {
+
+        pendiente = (handle == dev->ind_tabla[i].handle);
+    }
+    return pendiente;
+}
+
+/**
+ * @brief  Disparo la transmisión de la trama cargada en la FIFO.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_tx_handle_t Identificador de la transmisión.
+ * @param  uint16_t Dirección de destino de la trama.
+ * @param  uint8_t Bits adicionales de TXNCON, por ejemplo TXNACKREQ o TXNSECEN.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   Con la escucha de bajo consumo se anota cómo repetir la trama y hasta
+ *         cuándo. La FIFO ya queda cifrada, así que la repetición va sin
+ *         TXNSECEN.
+ */
+mrf24_state_t DisparoTransmision(mrf24_dev_t * dev, mrf24_tx_handle_t handle, uint16_t destino,
+                                 uint8_t opciones) {
+
+    dev->tx_destino_en_curso = destino;
+    dev->tx_en_curso = handle;
+    dev->lpl_repito = (LPL_STEP_OFF != dev->lpl_paso);
+
+    if (dev->lpl_repito) {
+
+        dev->lpl_txncon = opciones & (uint8_t)~TXNSECEN;
+        DelayWrite(&dev->lpl_tx_delay, dev->lpl_config.max_latency + dev->lpl_config.listen);
+        DelayReset(&dev->lpl_tx_delay);
+        DelayReset(&dev->lpl_delay);
+    }
+
+    if (OPERATION_FAIL == SetShortAddr(dev, TXNCON, TXNTRIG | opciones)) {
+
+        dev->tx_en_curso = VACIO;
+        return OPERATION_FAIL;
+    }
+    return OPERATION_OK;
+}
+
+/**
+ * @brief  Guardo el resultado de una transmisión y llamo a la función
+ *         registrada.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_tx_handle_t Identificador de la transmisión.
+ * @param  mrf24_tx_status_t Resultado.
+ * @param  uint8_t Cantidad de reintentos.
+ * @return None.
+ */
+void InformoResultado(mrf24_dev_t * dev, mrf24_tx_handle_t handle, mrf24_tx_status_t status,
+                      uint8_t retries) {
+
+    mrf24_tx_result_t * resultado = &dev->tx_resultados[handle % TX_QUEUE_SIZE];
+
+    resultado->handle = handle;
+    resultado->status = status;
+    resultado->retries = retries;
+
+    if (NULL != dev->tx_callback)
+        dev->tx_callback(dev, resultado);
+    return;
+}
+
+/**
+ * @brief  Armo la cabecera de una trama, la cargo en la FIFO junto con los
+ *         segmentos y disparo la transmisión.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  const mrf24_frame_opts_t * Opciones de la trama, con el PAN y el
+ *                                    origen ya resueltos.
+ * @param  const mrf24_segment_t * Lista de segmentos de datos.
+ * @param  uint8_t Cantidad de segmentos.
+ * @param  uint8_t Largo total de los datos.
+ * @param  mrf24_sec_level_t Nivel de seguridad, SEC_NONE para una trama sin
+ *                           encriptar.
+ * @param  mrf24_tx_handle_t * Puntero donde se devuelve el identificador de la
+ *                             transmisión, puede ser NULL.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, TRANS_COMPLETED,
+ *         TRANS_IN_PROGRESS).
+ *
+ * @note   Mientras el módulo no avise con TXNIF que terminó la transmisión
+ *         anterior no se toca la FIFO. Si el módulo está dormido se lo
+ *         despierta y se devuelve TRANS_IN_PROGRESS.
+ */
+mrf24_state_t TransmitoTrama(mrf24_dev_t * dev, const mrf24_frame_opts_t * opciones,
+                             const mrf24_segment_t * segmentos, uint8_t cantidad, uint8_t largo,
+                             mrf24_sec_level_t nivel, mrf24_tx_handle_t * handle) {
+
+    if (VACIO != dev->tx_en_curso || OPERATION_OK != DespiertoRadio(dev))
+        return TRANS_IN_PROGRESS;
+    uint8_t cabecera[FIFO_TX_HEADER + MAX_MHR_LENGTH + SEC_AUX_LENGTH];
+    uint8_t pos = CodificoCabecera(dev, cabecera, opciones, largo);
+    uint8_t txncon = PidoAck(opciones) ? TXNACKREQ : VACIO;
+    uint16_t destino = (ADDR_SHORT == opciones->dest_mode) ? opciones->dest_address
+                                                          : NO_SHORT_ADDRESS;
+
+    if (SEC_NONE != nivel) {
+
+        pos = CodificoSeguridad(dev, cabecera, pos, nivel);
+        uint8_t cifrado = sec_cifrado_rx[nivel - SEC_ENC_MIC_32] |
+                          sec_cifrado_tx[nivel - SEC_ENC_MIC_32];
+
+        if (OPERATION_FAIL == SetShortAddr(dev, SECCON0, cifrado))
+            return OPERATION_FAIL;
+        txncon |= TXNSECEN;
+    }
+
+    PERF(dev->perf_tx_inicio = PerfTick(dev));
+
+    if (OPERATION_FAIL == CargoFifoTx(dev, cabecera, pos, segmentos, cantidad))
+        return OPERATION_FAIL;
+    mrf24_tx_handle_t nuevo = NuevoHandle(dev);
+
+    if (OPERATION_FAIL == DisparoTransmision(dev, nuevo, destino, txncon))
+        return OPERATION_FAIL;
+
+    if (NULL != handle)
+        *handle = nuevo;
+    return TRANS_COMPLETED;
+}
+
+/**
+ * @brief  Leo el resultado de la transmisión que terminó y lo informo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, TRANS_COMPLETED).
+ *
+ * @note   Se llama al ver TXNIF en INTSTAT. En TXSTAT, TXNSTAT indica que la
+ *         transmisión falló, CCAFAIL que fue por canal ocupado y TXNRETRY1:0
+ *         la cantidad de reintentos. Si hay tramas en la cola se dispara la
+ *         siguiente sin esperar a la aplicación. Con la escucha de bajo
+ *         consumo la trama puede repetirse antes de informar el resultado, y
+ *         el de una trama indirecta que no se entregó queda para después. Una
+ *         trama sin identificador, como el beacon request, no cuenta para los
+ *         fallos de ningún destino.
+ */
+mrf24_state_t TerminoTransmision(mrf24_dev_t * dev) {
+
+    uint8_t txstat = VACIO;
+    mrf24_state_t estado = GetShortAddr(dev, TXSTAT, &txstat);
+    mrf24_tx_handle_t handle = dev->tx_en_curso;
+    mrf24_tx_status_t status = TX_OK;
+
+    if (txstat & TXNSTAT)
+        status = (txstat & CCAFAIL) ? TX_CHANNEL_BUSY : TX_NO_ACK;
+
+    if (VACIO == handle) {
+
+        if (!dev->tx_cola_bloqueada)
+            DespachoColaTx(dev);
+        return (OPERATION_OK == estado) ? TRANS_COMPLETED : OPERATION_FAIL;
+    }
+
+    if (RepitoTransmision(dev, status))
+        return (OPERATION_OK == estado) ? TRANS_COMPLETED : OPERATION_FAIL;
+    dev->tx_destino_terminado = dev->tx_destino_en_curso;
+    dev->tx_status_terminado = status;
+    dev->tx_en_curso = VACIO;
+
+    if (dev->ind_pidiendo)
+        TerminoPedido(dev, status);
+    PERF(PerfTerminoTx(dev, txstat));
+
+    if (!TerminoIndirecta(dev, handle, status))
+        InformoResultado(dev, handle, status,
+                         (uint8_t)(txstat & (TXNRETRY1 | TXNRETRY0)) >> SHIFT_TXNRETRY);
+
+    if (dev->tx_cola_bloqueada) {
+
+        dev->tx_despacho_pendiente = true;
+    } else {
+
+        ActualizoSubcola(dev, dev->tx_destino_terminado, dev->tx_status_terminado);
+        DespachoColaTx(dev);
+    }
+    return (OPERATION_OK == estado) ? TRANS_COMPLETED : OPERATION_FAIL;
+}
+
+/**
+ * @brief  Vacío la cola de transmisión.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ */
+void InicializoColaTx(mrf24_dev_t * dev) {
+
+    dev->tx_libres = TX_QUEUE_NONE;
+
+    for (uint8_t i = 0; i < TX_QUEUE_SIZE; i++) {
+
+        dev->tx_entradas[i].handle = VACIO;
+        dev->tx_entradas[i].siguiente = dev->tx_libres;
+        dev->tx_libres = i;
+    }
+
+    for (uint8_t i = 0; i < TX_QUEUE_DESTINATIONS; i++) {
+
+        dev->tx_subcolas[i].primero = TX_QUEUE_NONE;
+        dev->tx_subcolas[i].ultimo = TX_QUEUE_NONE;
+        dev->tx_subcolas[i].fallos = VACIO;
+    }
+    dev->tx_turno = 0;
+    dev->tx_cola_bloqueada = false;
+    dev->tx_despacho_pendiente = false;
+    return;
+}
+
+/**
+ * @brief  Codifico una trama y la agrego al final de la subcola de su destino.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_data_out_t * Puntero a la estructura con la información de envío.
+ * @param  mrf24_tx_handle_t * Puntero donde se devuelve el identificador.
+ * @return mrf24_state_t Estado de la operación (BUFFER_FULL, OPERATION_OK).
+ *
+ * @note   Si el destino no tiene subcola se toma una vacía. Sin entradas o
+ *         subcolas libres devuelve BUFFER_FULL.
+ */
+mrf24_state_t EncoloTrama(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s,
+                          mrf24_tx_handle_t * handle) {
+
+    mrf24_tx_subcola_t * subcola = NULL;
+
+    for (uint8_t i = 0; i < TX_QUEUE_DESTINATIONS; i++) {
+
+        if (TX_QUEUE_NONE == dev->tx_subcolas[i].primero) {
+
+            if (NULL == subcola)
+                subcola = &dev->tx_subcolas[i];
+        } else if (p_info_out_s->dest_address == dev->tx_subcolas[i].destino) {
+
+            subcola = &dev->tx_subcolas[i];
+            break;
+        }
+    }
+
+    if (NULL == subcola || TX_QUEUE_NONE == dev->tx_libres)
+        return BUFFER_FULL;
+
+    if (TX_QUEUE_NONE == subcola->primero && p_info_out_s->dest_address != subcola->destino) {
+
+        subcola->destino = p_info_out_s->dest_address;
+        subcola->fallos = VACIO;
+    }
+    uint8_t indice = dev->tx_libres;
+    mrf24_tx_entrada_t * entrada = &dev->tx_entradas[indice];
+    dev->tx_libres = entrada->siguiente;
+    mrf24_frame_opts_t opciones = OpcionesDato(
+        p_info_out_s->dest_panid, p_info_out_s->dest_address, p_info_out_s->origin_address);
+    entrada->largo = CodificoCabecera(dev, entrada->trama, &opciones, p_info_out_s->buffer_size);
+    memcpy(&entrada->trama[entrada->largo], p_info_out_s->buffer, p_info_out_s->buffer_size);
+    entrada->largo += p_info_out_s->buffer_size;
+    entrada->handle = NuevoHandle(dev);
+    entrada->siguiente = TX_QUEUE_NONE;
+    PERF(entrada->perf_inicio = PerfTick(dev));
+
+    if (TX_QUEUE_NONE == subcola->primero)
+        subcola->primero = indice;
+    else
+        dev->tx_entradas[subcola->ultimo].siguiente = indice;
+    subcola->ultimo = indice;
+    *handle = entrada->handle;
+    return OPERATION_OK;
+}
+
+/**
+ * @brief  Si el módulo está libre, cargo en la FIFO la próxima trama de la cola
+ *         y disparo la transmisión.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (TRANS_IN_PROGRESS, BUFFER_EMPTY,
+ *         OPERATION_FAIL, OPERATION_OK).
+ *
+ * @note   Las subcolas se atienden por turno, una trama por vez, para que un
+ *         destino que no responde no frene al resto. Antes que ellas sale la
+ *         trama indirecta que haya pedido su destino, que lo está esperando.
+ *         Con tramas pendientes y el módulo dormido sólo se lo despierta: la
+ *         trama sale cuando avisa con WAKEIF.
+ */
+mrf24_state_t DespachoColaTx(mrf24_dev_t * dev) {
+
+    if (VACIO != dev->tx_en_curso || SCAN_IN_PROGRESS == dev->estado)
+        return TRANS_IN_PROGRESS;
+    mrf24_state_t indirecta = DespachoIndirecta(dev);
+
+    if (BUFFER_EMPTY != indirecta)
+        return indirecta;
+
+    for (uint8_t i = 1; i <= TX_QUEUE_DESTINATIONS; i++) {
+
+        uint8_t n = (uint8_t)((dev->tx_turno + i) % TX_QUEUE_DESTINATIONS);
+        mrf24_tx_subcola_t * subcola = &dev->tx_subcolas[n];
+
+        if (TX_QUEUE_NONE == subcola->primero)
+            continue;
+
+        if (OPERATION_OK != DespiertoRadio(dev))
+            return TRANS_IN_PROGRESS;
+        uint8_t indice = subcola->primero;
+        mrf24_tx_entrada_t * entrada = &dev->tx_entradas[indice];
+        subcola->primero = entrada->siguiente;
+        dev->tx_turno = n;
+        mrf24_state_t estado = CargoFifoTx(dev, entrada->trama, entrada->largo, NULL, 0);
+        PERF(dev->perf_tx_inicio = entrada->perf_inicio);
+
+        if (OPERATION_OK == estado)
+            estado = DisparoTransmision(
+                dev, entrada->handle, subcola->destino,
+                (entrada->trama[POS_FRAME_CTRL] & ACK_REQ) ? TXNACKREQ : VACIO);
+
+        if (OPERATION_OK != estado)
+            InformoResultado(dev, entrada->handle, TX_DROPPED, VACIO);
+        entrada->handle = VACIO;
+        entrada->siguiente = dev->tx_libres;
+        dev->tx_libres = indice;
+        return estado;
+    }
+    return BUFFER_EMPTY;
+}
+
+/**
+ * @brief  Despacho la cola desde el lazo principal sin competir con la
+ *         interrupción.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ *
+ * @note   Mientras la cola está bloqueada, el fin de transmisión que atiende
+ *         la interrupción sólo deja anotado el despacho, y se hace acá.
+ */
+void DespachoColaBloqueada(mrf24_dev_t * dev) {
+
+    dev->tx_cola_bloqueada = true;
+    DespachoColaTx(dev);
+    dev->tx_cola_bloqueada = false;
+
+    while (dev->tx_despacho_pendiente) {
+
+        dev->tx_cola_bloqueada = true;
+        dev->tx_despacho_pendiente = false;
+        ActualizoSubcola(dev, dev->tx_destino_terminado, dev->tx_status_terminado);
+        DespachoColaTx(dev);
+        dev->tx_cola_bloqueada = false;
+    }
+    return;
+}
+
+/**
+ * @brief  Descarto todas las tramas de una subcola avisando a la aplicación.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_tx_subcola_t * Puntero a la subcola.
+ * @return None.
+ */
+void DescartoSubcola(mrf24_dev_t * dev, mrf24_tx_subcola_t * subcola) {
+
+    while (TX_QUEUE_NONE != subcola->primero) {
+
+        uint8_t indice = subcola->primero;
+        subcola->primero = dev->tx_entradas[indice].siguiente;
+        InformoResultado(dev, dev->tx_entradas[indice].handle, TX_DROPPED, VACIO);
+        dev->tx_entradas[indice].handle = VACIO;
+        dev->tx_entradas[indice].siguiente = dev->tx_libres;
+        dev->tx_libres = indice;
+    }
+    return;
+}
+
+/**
+ * @brief  Actualizo los fallos consecutivos del destino de la última trama.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t Dirección de destino de la trama.
+ * @param  mrf24_tx_status_t Resultado de la transmisión.
+ * @return None.
+ *
+ * @note   Al llegar a TX_QUEUE_MAX_FAILS fallos seguidos se descartan las
+ *         tramas pendientes para ese destino.
+ */
+void ActualizoSubcola(mrf24_dev_t * dev, uint16_t destino, mrf24_tx_status_t status) {
+
+    for (uint8_t i = 0; i < TX_QUEUE_DESTINATIONS; i++) {
+
+        mrf24_tx_subcola_t * subcola = &dev->tx_subcolas[i];
+
+        if (destino != subcola->destino)
+            continue;
+
+        if (TX_OK == status) {
+
+            subcola->fallos = VACIO;
+        } else if (TX_QUEUE_MAX_FAILS <= ++subcola->fallos) {
+
+            subcola->fallos = VACIO;
+            DescartoSubcola(dev, subcola);
+        }
+        return;
+    }
+    return;
+}
+
+/**
+ * @brief  Leo la trama de la FIFO de recepción y la decodifico.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_data_in_t * Puntero a la estructura donde se guarda la trama.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, INVALID_VALUE,
+ *         OPERATION_OK, MSG_READ).
+ *
+ * @note   Mientras se lee la FIFO se bloquea la recepción de nuevas tramas
+ *         con RXDECINV, como pide la hoja de datos. Sólo si el largo es
+ *         inválido se vacía la FIFO. INVALID_VALUE indica una trama encriptada
+ *         que no se pudo descifrar y se descarta. OPERATION_OK indica que la
+ *         trama la consumió el driver: un beacon, que va a la tabla de
+ *         vecinos, cualquier otra durante la búsqueda de dispositivos, una
+ *         copia repetida con la escucha de bajo consumo o un pedido de datos
+ *         con origen corto para la transmisión indirecta; el de un dispositivo
+ *         que todavía no tiene dirección corta queda para la aplicación. En
+ *         modo sniffer, fuera de los escaneos, la trama se copia entera sin
+ *         decodificarla.
+ */
+mrf24_state_t LeoTramaRx(mrf24_dev_t * dev, mrf24_data_in_t * data_in) {
+
+    uint8_t trama[RX_FRAME_SIZE];
+    uint8_t largo = VACIO;
+    data_in->timestamp = (NULL == dev->rx_reloj) ? VACIO : dev->rx_reloj();
+    SetShortAddr(dev, BBREG1, RXDECINV);
+    mrf24_state_t estado = GetRxFifo(dev, trama, &largo);
+    SetShortAddr(dev, BBREG1, VACIO);
+
+    if (INVALID_VALUE == estado)
+        SetShortAddr(dev, RXFLUSH, RXFLUSH_RESET);
+
+    if (OPERATION_OK != estado)
+        return OPERATION_FAIL;
+    data_in->lqi = trama[largo];
+    data_in->rssi = trama[largo + 1];
+
+    if ((dev->rxmcr & PROMI) && SCAN_IN_PROGRESS != dev->estado) {
+
+        data_in->panid = VACIO;
+        data_in->address = NO_SHORT_ADDRESS;
+        data_in->secured = (trama[0] & SECURITY) ? true : false;
+        data_in->frame_counter = VACIO;
+        data_in->buffer_size = largo;
+        memcpy(data_in->buffer, trama, largo);
+        return MSG_READ;
+    }
+
+    if (BEACON == (trama[0] & FRAME_TYPE_MASK)) {
+
+        if (OPERATION_FAIL != RegistroBeacon(dev, trama, largo) &&
+            SF_ROLE_DEVICE == dev->sf.role && SCAN_IN_PROGRESS != dev->estado)
+            SigoBeacon(dev, trama, largo);
+        return OPERATION_OK;
+    }
+
+    if (SCAN_IN_PROGRESS == dev->estado)
+        return OPERATION_OK;
+    uint8_t fin = largo - FCS_LENGTH;
+    uint8_t inicio = DecodificoCabecera(trama, fin, data_in);
+
+    if (VACIO == inicio)
+        return OPERATION_FAIL;
+
+    if (LPL_STEP_OFF != dev->lpl_paso && TramaRepetida(dev, data_in, trama[POS_SEQUENCE]))
+        return OPERATION_OK;
+
+    if (MAC_COMM == (trama[0] & (FRAME_TYPE_MASK | SECURITY)) && inicio < fin &&
+        DATA_REQUEST == trama[inicio] &&
+        ADDR_SHORT == ((trama[1] >> SHIFT_SRC_MODE) & ADDR_MODE_MASK)) {
+
+        AtiendoPedidoDatos(dev, data_in->address);
+        return OPERATION_OK;
+    }
+
+    if (DATA == (trama[0] & FRAME_TYPE_MASK) && (trama[0] & FRAME_PEND) &&
+        VACIO != dev->ind_coordinador && data_in->address == dev->ind_coordinador)
+        dev->ind_repito = true;
+    data_in->secured = (trama[0] & SECURITY) ? true : false;
+    data_in->frame_counter = VACIO;
+
+    if (data_in->secured) {
+
+        uint8_t rxsr = SECDECERR;
+        uint8_t auxiliar = inicio;
+        mrf24_sec_level_t nivel = (mrf24_sec_level_t)(trama[auxiliar] & SEC_LEVEL_MASK);
+        GetShortAddr(dev, RXSR, &rxsr);
+
+        if (SEC_NONE == dev->sec_nivel || !NivelSeguridadValido(nivel) || (rxsr & SECDECERR))
+            return INVALID_VALUE;
+        inicio += SEC_AUX_LENGTH;
+
+        if (inicio + sec_largo_mic[nivel - SEC_ENC_MIC_32] > fin)
+            return INVALID_VALUE;
+        fin -= sec_largo_mic[nivel - SEC_ENC_MIC_32];
+
+        for (uint8_t i = SEC_AUX_LENGTH - 1; i > 0; i--)
+            data_in->frame_counter = (data_in->frame_counter << SHIFT_BYTE) | trama[auxiliar + i];
+    }
+    data_in->buffer_size = fin - inicio;
+    memcpy(data_in->buffer, &trama[inicio], data_in->buffer_size);
+    return MSG_READ;
+}
+
+/**
+ * @brief  Reinicio la máquina de estados de RF.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   El módulo queda listo para recibir 192 us después.
+ */
+mrf24_state_t ReinicioRf(mrf24_dev_t * dev) {
+
+    if (OPERATION_FAIL == SetShortAddr(dev, RFCTL, RFRST_HOLD))
+        return OPERATION_FAIL;
+    return SetShortAddr(dev, RFCTL, VACIO);
+}
+
+/**
+ * @brief  Cambio el canal del módulo y reinicio la máquina de estados de RF.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  channel_list_t Canal.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ */
+mrf24_state_t SintonizoCanal(mrf24_dev_t * dev, channel_list_t ch) {
+
+    if (OPERATION_FAIL == SetLongAddr(dev, RFCON0, ch))
+        return OPERATION_FAIL;
+    return ReinicioRf(dev);
+}
+
+/**
+ * @brief  Seteo en el módulo en canal guardado en mrf24_data_config.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ */
+mrf24_state_t ApplyChannel(mrf24_dev_t * dev) {
+
+    return SintonizoCanal(dev, dev->config.channel);
+}
+
+/**
+ * @brief  Cargo en el módulo los registros del modo de la capa física guardado
+ *         en phy_modo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   No reinicia RF, eso queda a cargo de ApplyChannel. Los scripts son
+ *         sólo de registros cortos, así que se escriben con SetShortAddr para
+ *         saber si alguno falló. ACKTMOUT queda sin DRPACK.
+ */
+mrf24_state_t ApplyPhyMode(mrf24_dev_t * dev) {
+
+    const mrf24_reg_write_t * script = script_250kbps;
+    uint8_t largo = sizeof(script_250kbps) / sizeof(script_250kbps[0]);
+
+    if (PHY_TURBO_625KBPS == dev->phy_modo) {
+
+        script = script_turbo;
+        largo = sizeof(script_turbo) / sizeof(script_turbo[0]);
+    }
+
+    for (uint8_t i = 0; i < largo; i++) {
+
+        if (OPERATION_OK !=
+            SetShortAddr(dev, (uint8_t)(script[i].command >> SHIFT_SHORT_ADDR), script[i].value))
+            return OPERATION_FAIL;
+    }
+    return OPERATION_OK;
+}
+
+/**
+ * @brief  Seteo en el módulo la dirección corta guardada en mrf24_data_config.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ */
+mrf24_state_t ApplyDeviceAddress(mrf24_dev_t * dev) {
+
+    if (OPERATION_FAIL == SetShortAddr(dev, SADRH, (uint8_t)(dev->config.address >> SHIFT_BYTE)))
+        return OPERATION_FAIL;
+    if (OPERATION_FAIL == SetShortAddr(dev, SADRL, (uint8_t)(dev->config.address)))
+        return OPERATION_FAIL;
+    if (OPERATION_FAIL == SetShortAddr(dev, PANIDH, (uint8_t)(dev->config.panid >> SHIFT_BYTE)))
+        return OPERATION_FAIL;
+    if (OPERATION_FAIL == SetShortAddr(dev, PANIDL, (uint8_t)(dev->config.panid)))
+        return OPERATION_FAIL;
+    return OPERATION_OK;
+}
+
+/**
+ * @brief  Seteo en el módulo la dirección mac guardada en mrf24_data_config.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ */
+mrf24_state_t ApplyDeviceMACAddress(mrf24_dev_t * dev) {
+
+    for (uint8_t i = 0; i < LARGE_MAC_SIZE; i++) {
+
+        if (OPERATION_FAIL == SetShortAddr(dev, EADR0 + i, dev->config.mac[i]))
+            return OPERATION_FAIL;
+    }
+    return OPERATION_OK;
+}
+
+/**
+ * @brief  Cargo en RXMCR el filtro de recepción guardado en rxmcr.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   Fuera del modo sniffer y de la supertrama del coordinador rxmcr vale
+ *         VACIO, como lo deja el reset.
+ */
+mrf24_state_t ApplyRxMode(mrf24_dev_t * dev) {
+
+    return SetShortAddr(dev, RXMCR, dev->rxmcr);
+}
+
+/**
+ * @brief  Compruebo que el nivel de seguridad sea uno de los soportados.
+ *
+ * @param  mrf24_sec_level_t Nivel de seguridad.
+ * @return bool_t true si el nivel cifra con AES-CCM.
+ */
+bool_t NivelSeguridadValido(mrf24_sec_level_t nivel) {
+
+    return (SEC_ENC_MIC_32 <= nivel && SEC_ENC_MIC_128 >= nivel) ? true : false;
+}
+
+/**
+ * @brief  Convierto la cabecera codificada en la de una trama encriptada.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint8_t * Cabecera codificada, con lugar para SEC_AUX_LENGTH bytes
+ *                   más.
+ * @param  uint8_t Largo de la cabecera codificada.
+ * @param  mrf24_sec_level_t Nivel de seguridad.
+ * @return uint8_t Largo de la cabecera con la cabecera auxiliar de seguridad.
+ *
+ * @note   Se marca la trama como encriptada y de la versión 2006 del estándar,
+ *         se suma el MIC al largo de la trama y se agrega la cabecera auxiliar
+ *         (control de seguridad sin identificador de llave y contador de
+ *         tramas). El módulo encripta los datos que siguen a la cabecera.
+ */
+uint8_t CodificoSeguridad(mrf24_dev_t * dev, uint8_t * cabecera, uint8_t pos,
+                          mrf24_sec_level_t nivel) {
+
+    uint32_t contador = dev->sec_contador++;
+    cabecera[0] += SEC_AUX_LENGTH;
+    cabecera[1] += SEC_AUX_LENGTH + sec_largo_mic[nivel - SEC_ENC_MIC_32];
+    cabecera[2] |= SECURITY;
+    cabecera[3] |= FRAME_V2006;
+    cabecera[pos++] = (uint8_t)nivel;
+
+    for (uint8_t i = 1; i < SEC_AUX_LENGTH; i++) {
+
+        cabecera[pos++] = (uint8_t)contador;
+        contador >>= SHIFT_BYTE;
+    }
+    return pos;
+}
+
+/**
+ * @brief  Atiendo el pedido de descifrado de una trama recibida.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   Se llama al ver SECIF en INTSTAT. Se lee el control de seguridad de
+ *         la trama en la FIFO, detrás de la cabecera MAC del largo que indique
+ *         su frame control: si la seguridad está habilitada y el nivel es
+ *         válido se arranca el descifrado con SECSTART, si no se ignora con
+ *         SECIGNORE. En ambos casos el módulo avisa la recepción con RXIF. En
+ *         modo sniffer siempre se ignora, para capturar la trama cifrada.
+ */
+mrf24_state_t AtiendoSeguridad(mrf24_dev_t * dev) {
+
+    uint8_t frame_control[2] = {VACIO, VACIO};
+    uint8_t control = VACIO;
+    uint8_t pan = VACIO;
+    uint8_t direccion = VACIO;
+
+    for (uint8_t i = 0; i < sizeof(frame_control); i++) {
+
+        if (OPERATION_OK != GetLongAddr(dev, RX_FIFO + 1 + i, &frame_control[i]))
+            return OPERATION_FAIL;
+    }
+    uint8_t mhr = UbicoDirecciones(frame_control, &pan, &direccion);
+
+    if (VACIO != mhr && OPERATION_OK != GetLongAddr(dev, RX_FIFO + 1 + mhr, &control))
+        return OPERATION_FAIL;
+    mrf24_sec_level_t nivel = (mrf24_sec_level_t)(control & SEC_LEVEL_MASK);
+
+    if (SEC_NONE == dev->sec_nivel || !NivelSeguridadValido(nivel) || (dev->rxmcr & PROMI))
+        return SetShortAddr(dev, SECCON0, SECIGNORE);
+    return SetShortAddr(dev, SECCON0, sec_cifrado_rx[nivel - SEC_ENC_MIC_32] | SECSTART);
+}
+
+/**
+ * @brief  Cargo en el módulo la llave guardada en mrf24_data_config, para
+ *         transmisión y recepción.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ */
+mrf24_state_t ApplySecurityKey(mrf24_dev_t * dev) {
+
+    if (OPERATION_FAIL ==
+        SetLongAddrBlock(dev, TX_SEC_KEY, dev->config.security_key, SEC_KEY_SIZE))
+        return OPERATION_FAIL;
+    return SetLongAddrBlock(dev, RX_SEC_KEY, dev->config.security_key, SEC_KEY_SIZE);
+}
+
+/**
+ * @brief  Cargo en el módulo la dirección MAC del origen de las tramas
+ *         encriptadas, que se usa en el nonce de descifrado.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ */
+mrf24_state_t ApplySecurityPeer(mrf24_dev_t * dev) {
+
+    for (uint8_t i = 0; i < LARGE_MAC_SIZE; i++) {
+
+        if (OPERATION_FAIL == SetLongAddr(dev, ASSOEADR0 + i, dev->sec_origen[i]))
+            return OPERATION_FAIL;
+    }
+    return OPERATION_OK;
+}
+
+/**
+ * @brief  Paso al canal que indica scan_indice y arranco la primera lectura de
+ *         energía.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ */
+void ComienzoCanalED(mrf24_dev_t * dev) {
+
+    mrf24_ed_result_t * canal = &dev->ed_tabla[dev->scan_indice];
+    canal->channel = CANAL(dev->scan_indice);
+    canal->max = VACIO;
+    canal->average = VACIO;
+    canal->samples = VACIO;
+    dev->ed_suma = VACIO;
+    SintonizoCanal(dev, canal->channel);
+    SetShortAddr(dev, BBREG6, RSSIMODE1 | RSSIMODE2);
+    DelayReset(&dev->scan_delay);
+    return;
+}
+
+/**
+ * @brief  Avanzo el escaneo de energía.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado del driver (SCAN_IN_PROGRESS, INIT_OK).
+ *
+ * @note   Si el módulo terminó de medir (RSSIRDY) se acumula la lectura y se
+ *         pide la siguiente. Cumplida la permanencia se pasa al siguiente
+ *         canal sin esperas: sólo se cambia RFCON0 y se reinicia RF.
+ */
+mrf24_state_t AvanzoScanED(mrf24_dev_t * dev) {
+
+    mrf24_ed_result_t * canal = &dev->ed_tabla[dev->scan_indice];
+    uint8_t bbreg6 = VACIO;
+    uint8_t rssi = VACIO;
+
+    if (OPERATION_OK == GetShortAddr(dev, BBREG6, &bbreg6) && (bbreg6 & RSSIRDY) &&
+        OPERATION_OK == GetLongAddr(dev, RSSI, &rssi)) {
+
+        dev->ed_suma += rssi;
+        canal->samples++;
+        if (canal->max < rssi)
+            canal->max = rssi;
+        SetShortAddr(dev, BBREG6, RSSIMODE1 | RSSIMODE2);
+    }
+
+    if (!DelayRead(&dev->scan_delay))
+        return SCAN_IN_PROGRESS;
+
+    if (VACIO != canal->samples)
+        canal->average = (uint8_t)(dev->ed_suma / canal->samples);
+
+    if (CHANNEL_COUNT > ++dev->scan_indice) {
+
+        ComienzoCanalED(dev);
+        return SCAN_IN_PROGRESS;
+    }
+    return TerminoScan(dev);
+}
+
+/**
+ * @brief  Termino un escaneo y dejo el módulo como estaba.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado del driver (INIT_OK).
+ *
+ * @note   Se vuelve al canal configurado, se restauran BBREG6 o RXMCR según el
+ *         escaneo y se vacía la FIFO de recepción, que pudo recibir tramas de
+ *         otros canales. También se lee INTSTAT, para que un RXIF de esas
+ *         tramas no lleve a leer la FIFO vacía. Después se despacha la cola de
+ *         transmisión, que quedó detenida durante el escaneo.
+ */
+mrf24_state_t TerminoScan(mrf24_dev_t * dev) {
+
+    uint8_t intstat;
+
+    ApplyChannel(dev);
+
+    if (dev->scan_activo)
+        ApplyRxMode(dev);
+    else
+        SetShortAddr(dev, BBREG6, RSSIMODE2);
+    SetShortAddr(dev, RXFLUSH, RXFLUSH_RESET);
+    GetShortAddr(dev, INTSTAT, &intstat);
+    dev->estado = INIT_OK;
+    DespachoColaTx(dev);
+    return INIT_OK;
+}
+
+/**
+ * @brief  Paso al canal que indica scan_indice y envío un beacon request.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ *
+ * @note   El beacon request es un comando MAC a broadcast sin dirección de
+ *         origen ni ACK. No ocupa tx_en_curso: su TXNIF no se informa.
+ */
+void ComienzoCanalActivo(mrf24_dev_t * dev) {
+
+    uint8_t pos = 0;
+    uint8_t trama[FIFO_TX_HEADER + BEACON_REQ_MHR + 1];
+    trama[pos++] = BEACON_REQ_MHR;
+    trama[pos++] = BEACON_REQ_MHR + 1;
+    trama[pos++] = MAC_COMM;
+    trama[pos++] = SHORT_D_ADD;
+    trama[pos++] = dev->config.sequence_number++;
+    trama[pos++] = (uint8_t)BROADCAST;
+    trama[pos++] = (uint8_t)(BROADCAST >> SHIFT_BYTE);
+    trama[pos++] = (uint8_t)BROADCAST;
+    trama[pos++] = (uint8_t)(BROADCAST >> SHIFT_BYTE);
+    trama[pos++] = BEACON_REQUEST;
+    SintonizoCanal(dev, CANAL(dev->scan_indice));
+
+    if (OPERATION_OK == CargoFifoTx(dev, trama, pos, NULL, 0))
+        SetShortAddr(dev, TXNCON, TXNTRIG);
+    DelayReset(&dev->scan_delay);
+    return;
+}
+
+/**
+ * @brief  Avanzo la búsqueda activa de dispositivos.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado del driver (SCAN_IN_PROGRESS, INIT_OK).
+ *
+ * @note   Los beacons se registran desde MRF24InterruptHandler; acá sólo se
+ *         cambia de canal al cumplirse la espera.
+ */
+mrf24_state_t AvanzoScanActivo(mrf24_dev_t * dev) {
+
+    if (!DelayRead(&dev->scan_delay))
+        return SCAN_IN_PROGRESS;
+
+    if (CHANNEL_COUNT > ++dev->scan_indice) {
+
+        ComienzoCanalActivo(dev);
+        return SCAN_IN_PROGRESS;
+    }
+    return TerminoScan(dev);
+}
+
+/**
+ * @brief  Calculo la posición inicial de un vecino en la tabla.
+ *
+ * @param  uint16_t PANID del vecino.
+ * @param  uint16_t Dirección corta del vecino.
+ * @param  const uint8_t * Dirección larga, sólo se usa si la corta es
+ *                         NO_SHORT_ADDRESS.
+ * @return uint16_t Posición en la tabla.
+ *
+ * @note   FNV-1a sobre los bytes de la clave, plegado al tamaño de la tabla.
+ */
+uint16_t HashVecino(uint16_t panid, uint16_t short_address, const uint8_t * long_address) {
+
+    uint8_t clave[4 + LARGE_MAC_SIZE];
+    uint8_t largo = 0;
+    uint32_t hash = FNV_OFFSET;
+    clave[largo++] = (uint8_t)panid;
+    clave[largo++] = (uint8_t)(panid >> SHIFT_BYTE);
+    clave[largo++] = (uint8_t)short_address;
+    clave[largo++] = (uint8_t)(short_address >> SHIFT_BYTE);
+
+    if (NO_SHORT_ADDRESS == short_address) {
+
+        memcpy(&clave[largo], long_address, LARGE_MAC_SIZE);
+        largo += LARGE_MAC_SIZE;
+    }
+
+    for (uint8_t i = 0; i < largo; i++)
+        hash = (hash ^ clave[i]) * FNV_PRIME;
+    return (uint16_t)(hash ^ (hash >> 16)) & (NEIGHBOR_TABLE_SIZE - 1);
+}
+
+/**
+ * @brief  Busco la entrada de un vecino, o la libre donde se debe guardar.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t PANID del vecino.
+ * @param  uint16_t Dirección corta del vecino.
+ * @param  const uint8_t * Dirección larga, sólo se usa si la corta es
+ *                         NO_SHORT_ADDRESS.
+ * @return MRF24_discover_nearby_t * Entrada del vecino, una libre (channel en
+ *         VACIO) si no está, o NULL si no está y la tabla está llena.
+ *
+ * @note   Direccionamiento abierto con sondeo lineal. Como las entradas sólo
+ *         se borran vaciando toda la tabla, la primera libre corta la búsqueda.
+ */
+MRF24_discover_nearby_t * UbicoVecino(mrf24_dev_t * dev, uint16_t panid, uint16_t short_address,
+                                      const uint8_t * long_address) {
+
+    uint16_t indice = HashVecino(panid, short_address, long_address);
+
+    for (uint16_t i = 0; i < NEIGHBOR_TABLE_SIZE; i++) {
+
+        MRF24_discover_nearby_t * vecino = &dev->vecinos[indice];
+
+        if (VACIO == vecino->channel)
+            return vecino;
+
+        if (panid == vecino->panid && short_address == vecino->short_address &&
+            (NO_SHORT_ADDRESS != short_address ||
+             0 == memcmp(long_address, vecino->long_address, LARGE_MAC_SIZE)))
+            return vecino;
+        indice = (indice + 1) & (NEIGHBOR_TABLE_SIZE - 1);
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Registro en la tabla de vecinos el origen de un beacon recibido.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  const uint8_t * Trama tal como sale de la FIFO, seguida del LQI y el
+ *                         RSSI.
+ * @param  uint8_t Largo de la trama, con el FCS.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL, BUFFER_FULL,
+ *         OPERATION_OK).
+ *
+ * @note   Un vecino ya registrado sólo actualiza el canal y el RSSI.
+ */
+mrf24_state_t RegistroBeacon(mrf24_dev_t * dev, const uint8_t * trama, uint8_t largo) {
+
+    uint8_t modo = trama[1] & LONG_S_ADD;
+    uint8_t largo_direccion = (LONG_S_ADD == modo) ? LARGE_MAC_SIZE : sizeof(uint16_t);
+    uint8_t long_address[LARGE_MAC_SIZE] = {0};
+    uint16_t short_address = NO_SHORT_ADDRESS;
+
+    if ((SHORT_S_ADD != modo && LONG_S_ADD != modo) ||
+        largo < BEACON_SRC_ADDR + largo_direccion + FCS_LENGTH)
+        return OPERATION_FAIL;
+    uint16_t panid = (uint16_t)(trama[4] << SHIFT_BYTE) | trama[3];
+
+    if (LONG_S_ADD == modo)
+        memcpy(long_address, &trama[BEACON_SRC_ADDR], LARGE_MAC_SIZE);
+    else
+        short_address = (uint16_t)(trama[BEACON_SRC_ADDR + 1] << SHIFT_BYTE) |
+                        trama[BEACON_SRC_ADDR];
+    MRF24_discover_nearby_t * vecino = UbicoVecino(dev, panid, short_address, long_address);
+
+    if (NULL == vecino)
+        return BUFFER_FULL;
+
+    if (VACIO == vecino->channel) {
+
+        vecino->panid = panid;
+        vecino->short_address = short_address;
+        memcpy(vecino->long_address, long_address, LARGE_MAC_SIZE);
+        dev->vecinos_cantidad++;
+    }
+    vecino->channel = (SCAN_IN_PROGRESS == dev->estado) ? CANAL(dev->scan_indice)
+                                                        : dev->config.channel;
+    vecino->rssi = trama[largo + 1];
+    return OPERATION_OK;
+}
+
+/**
+ * @brief  Preparo el temporizador de sleep y comienzo la calibración del
+ *         reloj de sleep.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ *
+ * @note   Habilita WAKEIE para enterarse por interrupción de cada despertar, y
+ *         IMMWAKE para poder despertar al módulo con REGWAKE.
+ */
+void ComienzoLpl(mrf24_dev_t * dev) {
+
+    uint8_t intcon = VACIO;
+
+    SetShortAddr(dev, SLPACK, LPL_WAKECNT);
+    SetLongAddr(dev, WAKETIMEL, (uint8_t)LPL_WAKETIME);
+    SetLongAddr(dev, WAKETIMEH, (uint8_t)(LPL_WAKETIME >> SHIFT_BYTE));
+    SetShortAddr(dev, WAKECON, IMMWAKE);
+    GetShortAddr(dev, MRFINTCON, &intcon);
+    SetShortAddr(dev, MRFINTCON, intcon & (uint8_t)~WAKEIE_DIS);
+    SetLongAddr(dev, SLPCAL2, SLPCALEN);
+    dev->lpl_paso = LPL_STEP_CALIBRATE;
+    DelayWrite(&dev->lpl_delay, MRF_TIME_OUT);
+    DelayReset(&dev->lpl_delay);
+    return;
+}
+
+/**
+ * @brief  Dejo el módulo escuchando siempre, como sin la escucha de bajo
+ *         consumo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ *
+ * @note   El módulo tiene que estar despierto.
+ */
+void ApagoLpl(mrf24_dev_t * dev) {
+
+    uint8_t intcon = VACIO;
+
+    dev->lpl_paso = LPL_STEP_OFF;
+    dev->lpl_repito = false;
+    SetShortAddr(dev, WAKECON, VACIO);
+    GetShortAddr(dev, MRFINTCON, &intcon);
+    SetShortAddr(dev, MRFINTCON, intcon | WAKEIE_DIS);
+    return;
+}
+
+/**
+ * @brief  Abro la ventana de escucha de la escucha de bajo consumo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ */
+void EscuchoLpl(mrf24_dev_t * dev) {
+
+    dev->lpl_paso = LPL_STEP_LISTEN;
+    DelayWrite(&dev->lpl_delay, dev->lpl_config.listen);
+    DelayReset(&dev->lpl_delay);
+    return;
+}
+
+/**
+ * @brief  Avanzo la escucha de bajo consumo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ *
+ * @note   Se llama desde MRF24Poll con el módulo inicializado. Al terminar la
+ *         calibración, o si no termina a tiempo, se guarda la cuenta de SLPCAL
+ *         (la nominal si no hay una). Escuchando, despacha la cola y al
+ *         vencer la ventana, sin transmisiones en curso, duerme al módulo.
+ *         Si un despertar pedido no llega a tiempo se vuelve a pedir.
+ */
+void AvanzoLpl(mrf24_dev_t * dev) {
+
+    uint8_t slpcal[3] = {VACIO, VACIO, VACIO};
+
+    switch (dev->lpl_paso) {
+
+    case LPL_STEP_CALIBRATE:
+        GetLongAddr(dev, SLPCAL2, &slpcal[2]);
+
+        if (slpcal[2] & SLPCALRDY) {
+
+            GetLongAddr(dev, SLPCAL0, &slpcal[0]);
+            GetLongAddr(dev, SLPCAL1, &slpcal[1]);
+        } else if (!DelayRead(&dev->lpl_delay)) {
+
+            break;
+        }
+        dev->lpl_slpcal = ((uint32_t)(slpcal[2] & SLPCAL_MSB) << 16) |
+                          ((uint32_t)slpcal[1] << SHIFT_BYTE) | slpcal[0];
+
+        if (VACIO == dev->lpl_slpcal)
+            dev->lpl_slpcal = SLPCAL_NOMINAL;
+        EscuchoLpl(dev);
+        break;
+
+    case LPL_STEP_LISTEN:
+        DespachoColaBloqueada(dev);
+
+        if (VACIO == dev->tx_en_curso && DelayRead(&dev->lpl_delay))
+            DuermoRadio(dev);
+        break;
+
+    case LPL_STEP_WAKE:
+        if (DelayRead(&dev->lpl_delay)) {
+
+            dev->lpl_paso = LPL_STEP_SLEEP;
+            DespiertoRadio(dev);
+        }
+        break;
+
+    default:
+        break;
+    }
+    return;
+}
+
+/**
+ * @brief  Duermo al módulo hasta el próximo ciclo con el temporizador de sleep.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   MAINCNT es la duración del sleep en períodos del reloj de sleep,
+ *         pasada de milisegundos con la calibración. STARTCNT va en el último
+ *         byte de la misma transacción y arranca la cuenta: el módulo se
+ *         duerme y, al terminar, levanta WAKEIF. Como toda escritura en los
+ *         registros de control en bloque, invalida la copia de los registros.
+ */
+mrf24_state_t DuermoRadio(mrf24_dev_t * dev) {
+
+    uint64_t ns = (uint64_t)(dev->lpl_config.max_latency - dev->lpl_config.listen) * NS_POR_MS;
+    uint64_t ciclos = ns * SLPCAL_PERIODOS / ((uint64_t)dev->lpl_slpcal * SLPCAL_NS_CICLO);
+    uint8_t maincnt[MAINCNT_BYTES];
+
+    if (MAINCNT_MAX < ciclos)
+        ciclos = MAINCNT_MAX;
+    maincnt[0] = (uint8_t)ciclos;
+    maincnt[1] = (uint8_t)(ciclos >> SHIFT_BYTE);
+    maincnt[2] = (uint8_t)(ciclos >> 16);
+    maincnt[3] = (uint8_t)((ciclos >> 24) & MAINCNT_MSB) | STARTCNT;
+    dev->lpl_paso = LPL_STEP_SLEEP;
+
+    if (OPERATION_FAIL == SetLongAddrBlock(dev, MAINCNT0, maincnt, MAINCNT_BYTES)) {
+
+        EscuchoLpl(dev);
+        return OPERATION_FAIL;
+    }
+    dev->lpl_stats.sleeps++;
+    return OPERATION_OK;
+}
+
+/**
+ * @brief  Despierto al módulo antes de tiempo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK si el módulo está
+ *         despierto, TRANS_IN_PROGRESS si se está despertando).
+ *
+ * @note   Un pulso de REGWAKE, con IMMWAKE ya habilitado, enciende el
+ *         oscilador; el módulo avisa con WAKEIF cuando está listo.
+ */
+mrf24_state_t DespiertoRadio(mrf24_dev_t * dev) {
+
+    if (LPL_STEP_WAKE == dev->lpl_paso)
+        return TRANS_IN_PROGRESS;
+
+    if (LPL_STEP_SLEEP != dev->lpl_paso)
+        return OPERATION_OK;
+    dev->lpl_paso = LPL_STEP_WAKE;
+    dev->lpl_stats.early_wakes++;
+    DelayWrite(&dev->lpl_delay, MRF_TIME_OUT);
+    DelayReset(&dev->lpl_delay);
+    SetShortAddr(dev, WAKECON, IMMWAKE | REGWAKE);
+    SetShortAddr(dev, WAKECON, IMMWAKE);
+    return TRANS_IN_PROGRESS;
+}
+
+/**
+ * @brief  Atiendo el aviso de WAKEIF de que el módulo se despertó.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ *
+ * @note   Después del sleep hay que reiniciar la máquina de estados de RF.
+ *         Si mientras dormía se desactivó la escucha de bajo consumo, queda
+ *         escuchando siempre.
+ */
+void AtiendoDespertar(mrf24_dev_t * dev) {
+
+    if (LPL_STEP_SLEEP != dev->lpl_paso && LPL_STEP_WAKE != dev->lpl_paso)
+        return;
+    ReinicioRf(dev);
+
+    if (VACIO == dev->lpl_config.max_latency)
+        ApagoLpl(dev);
+    else
+        EscuchoLpl(dev);
+    return;
+}
+
+/**
+ * @brief  Vuelvo a disparar la trama que sigue en la FIFO si todavía no llegó
+ *         a destino.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_tx_status_t Resultado de la transmisión que terminó.
+ * @return bool_t true si la trama se repitió y el resultado queda para más
+ *         adelante.
+ *
+ * @note   Una trama con ACK se repite hasta recibirlo; un broadcast, durante
+ *         todo el plazo, porque no hay forma de saber quién lo escuchó. El
+ *         plazo es un ciclo más una ventana, para cubrir el error entre los
+ *         relojes de sleep de los dos módulos.
+ */
+bool_t RepitoTransmision(mrf24_dev_t * dev, mrf24_tx_status_t status) {
+
+    if (!dev->lpl_repito || (TX_OK == status && (dev->lpl_txncon & TXNACKREQ)))
+        return false;
+
+    if (DelayRead(&dev->lpl_tx_delay))
+        return false;
+
+    if (OPERATION_OK != SetShortAddr(dev, TXNCON, TXNTRIG | dev->lpl_txncon))
+        return false;
+    dev->lpl_stats.strobes++;
+
+    if (LPL_STEP_LISTEN == dev->lpl_paso)
+        DelayReset(&dev->lpl_delay);
+    return true;
+}
+
+/**
+ * @brief  Veo si una trama recibida es copia de la última de su origen.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  const mrf24_data_in_t * Trama con el origen ya decodificado.
+ * @param  uint8_t Número de secuencia de la trama.
+ * @return bool_t true si es una copia y hay que descartarla.
+ *
+ * @note   Se recuerda el último número de secuencia de LPL_DUP_TABLE_SIZE
+ *         orígenes; un origen nuevo reemplaza al más antiguo.
+ */
+bool_t TramaRepetida(mrf24_dev_t * dev, const mrf24_data_in_t * data_in, uint8_t secuencia) {
+
+    for (uint8_t i = 0; i < LPL_DUP_TABLE_SIZE; i++) {
+
+        mrf24_lpl_visto_t * visto = &dev->lpl_vistos[i];
+
+        if (!visto->usado || data_in->panid != visto->panid ||
+            data_in->address != visto->address ||
+            0 != memcmp(data_in->long_address, visto->long_address, LARGE_MAC_SIZE))
+            continue;
+
+        if (secuencia == visto->secuencia) {
+
+            dev->lpl_stats.duplicates++;
+            return true;
+        }
+        visto->secuencia = secuencia;
+        return false;
+    }
+    mrf24_lpl_visto_t * visto = &dev->lpl_vistos[dev->lpl_turno];
+    dev->lpl_turno = (uint8_t)((dev->lpl_turno + 1) % LPL_DUP_TABLE_SIZE);
+    visto->panid = data_in->panid;
+    visto->address = data_in->address;
+    memcpy(visto->long_address, data_in->long_address, LARGE_MAC_SIZE);
+    visto->secuencia = secuencia;
+    visto->usado = true;
+    return false;
+}
+
+/**
+ * @brief  Busco la GTS de un dispositivo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t Dirección corta del dispositivo.
+ * @param  mrf24_gts_dir_t Sentido de la GTS.
+ * @return uint8_t Número de la GTS, de 1 a SF_MAX_GTS, VACIO si no la tiene.
+ */
+uint8_t NumeroGts(mrf24_dev_t * dev, uint16_t address, mrf24_gts_dir_t direccion) {
+
+    for (uint8_t i = 0; i < dev->sf.gts_count; i++) {
+
+        if (address == dev->sf.gts[i].address && direccion == dev->sf.gts[i].direction)
+            return i + 1;
+    }
+    return VACIO;
+}
+
+/**
+ * @brief  Ubico las GTS al final de la supertrama, una detrás de otra, y
+ *         calculo el último slot del CAP.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ */
+void UbicoGts(mrf24_dev_t * dev) {
+
+    uint8_t inicio = SF_SLOTS;
+
+    for (uint8_t i = dev->sf.gts_count; i > 0; i--) {
+
+        inicio -= dev->sf.gts[i - 1].length;
+        dev->sf.gts[i - 1].start_slot = inicio;
+    }
+    dev->sf.cap_end = inicio - 1;
+    return;
+}
+
+/**
+ * @brief  Armo el beacon del coordinador y lo cargo en la FIFO de beacons.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   El módulo repite el beacon de la FIFO en cada supertrama, así que el
+ *         número de secuencia sólo avanza cuando cambia el contenido.
+ */
+mrf24_state_t CargoBeacon(mrf24_dev_t * dev) {
+
+    uint8_t beacon[FIFO_TX_HEADER + BEACON_MAX];
+    uint8_t pos = FIFO_TX_HEADER;
+
+    beacon[pos++] = BEACON;
+    beacon[pos++] = SHORT_S_ADD;
+    beacon[pos++] = dev->sf_bsn++;
+    pos = CodificoDireccion(beacon, pos, ADDR_SHORT, dev->config.panid, NULL);
+    pos = CodificoDireccion(beacon, pos, ADDR_SHORT, dev->config.address, NULL);
+    beacon[pos++] = (uint8_t)(dev->sf.beacon_order | (dev->sf.superframe_order << SHIFT_ORDER));
+    beacon[pos++] = dev->sf.cap_end | SF_PAN_COORD;
+    beacon[pos++] = dev->sf.gts_count | GTS_PERMIT;
+
+    if (VACIO != dev->sf.gts_count) {
+
+        uint8_t sentidos = pos++;
+        beacon[sentidos] = VACIO;
+
+        for (uint8_t i = 0; i < dev->sf.gts_count; i++) {
+
+            const mrf24_gts_t * gts = &dev->sf.gts[i];
+
+            if (GTS_DIR_RECEIVE == gts->direction)
+                beacon[sentidos] |= (uint8_t)(1 << i);
+            pos = CodificoDireccion(beacon, pos, ADDR_SHORT, gts->address, NULL);
+            beacon[pos++] = gts->start_slot | (uint8_t)(gts->length << SHIFT_ORDER);
+        }
+    }
+    beacon[pos++] = VACIO;
+    beacon[0] = BEACON_MHR;
+    beacon[1] = pos - FIFO_TX_HEADER;
+    return SetLongAddrBlock(dev, TX_BEACON_FIFO, beacon, pos);
+}
+
+/**
+ * @brief  Cargo en el módulo el final del CAP y de cada GTS.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   ESLOTG1 tiene el último slot del CAP y el de la GTS 1; ESLOTG23,
+ *         ESLOTG45 y ESLOTG67 los de las siguientes, de a dos. Una GTS sin
+ *         usar termina en el slot 0. GTSON enciende el reloj de las FIFO de
+ *         GTS.
+ */
+mrf24_state_t ApplyGts(mrf24_dev_t * dev) {
+
+    mrf24_state_t estado = OPERATION_OK;
+    uint8_t fines[SF_MAX_GTS + 1] = {0};
+    fines[0] = dev->sf.cap_end;
+
+    for (uint8_t i = 0; i < dev->sf.gts_count; i++)
+        fines[i + 1] = dev->sf.gts[i].start_slot + dev->sf.gts[i].length - 1;
+
+    for (uint8_t i = 0; i <= SF_MAX_GTS; i += 2) {
+
+        uint8_t reg = (0 == i) ? ESLOTG1 : (uint8_t)(ESLOTG23 + i / 2 - 1);
+
+        if (OPERATION_FAIL ==
+            SetShortAddr(dev, reg, fines[i] | (uint8_t)(fines[i + 1] << SHIFT_ORDER)))
+            estado = OPERATION_FAIL;
+    }
+
+    if (OPERATION_FAIL == SetShortAddr(dev, GATECLK, dev->sf.gts_count ? GTSON : VACIO))
+        estado = OPERATION_FAIL;
+    return estado;
+}
+
+/**
+ * @brief  Cargo en el módulo la supertrama: CSMA-CA ranurado, interrupciones
+ *         de las GTS, slots y, al final, el orden.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   Lo usan el coordinador al arrancar y los dispositivos con cada
+ *         beacon; si nada cambió la copia de los registros evita el SPI.
+ */
+mrf24_state_t ApplySuperframe(mrf24_dev_t * dev) {
+
+    uint8_t txmcr = VACIO;
+    uint8_t intcon = VACIO;
+
+    GetShortAddr(dev, TXMCR, &txmcr);
+    SetShortAddr(dev, TXMCR, txmcr | SLOTTED);
+    GetShortAddr(dev, MRFINTCON, &intcon);
+    SetShortAddr(dev, MRFINTCON, intcon & (uint8_t)~(TXG1IE_DIS | TXG2IE_DIS));
+    ApplyGts(dev);
+    return SetShortAddr(dev, ORDER, (uint8_t)(dev->sf.beacon_order << SHIFT_ORDER) |
+                                        dev->sf.superframe_order);
+}
+
+/**
+ * @brief  Arranco la supertrama del coordinador.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ *
+ * @note   Sigue el orden de la hoja de datos: PANCOORD, beacon en la FIFO,
+ *         TXBMSK para que el envío de cada beacon no dé TXNIF, y ORDER al
+ *         final, que hace salir el primer beacon.
+ */
+void ComienzoSupertrama(mrf24_dev_t * dev) {
+
+    uint8_t txbcon1 = VACIO;
+
+    dev->rxmcr |= PANCOORD;
+    ApplyRxMode(dev);
+    CargoBeacon(dev);
+    GetShortAddr(dev, TXBCON1, &txbcon1);
+    SetShortAddr(dev, TXBCON1, txbcon1 | TXBMSK);
+    ApplySuperframe(dev);
+    return;
+}
+
+/**
+ * @brief  Vuelvo al modo sin beacons.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ */
+void ApagoSupertrama(mrf24_dev_t * dev) {
+
+    uint8_t txmcr = VACIO;
+
+    SetShortAddr(dev, ORDER, ORDER_SIN_BEACON);
+    GetShortAddr(dev, TXMCR, &txmcr);
+    SetShortAddr(dev, TXMCR, txmcr & (uint8_t)~SLOTTED);
+    SetShortAddr(dev, GATECLK, VACIO);
+    dev->rxmcr &= (uint8_t)~PANCOORD;
+    ApplyRxMode(dev);
+    return;
+}
+
+/**
+ * @brief  Llevo al módulo un cambio en las GTS del coordinador.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ */
+mrf24_state_t ActualizoGts(mrf24_dev_t * dev) {
+
+    if (INIT_OK != dev->estado)
+        return OPERATION_OK;
+
+    if (OPERATION_FAIL == CargoBeacon(dev))
+        return OPERATION_FAIL;
+    return ApplyGts(dev);
+}
+
+/**
+ * @brief  Informo como descartadas las tramas que esperaban su GTS.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ */
+void DescartoGts(mrf24_dev_t * dev) {
+
+    for (uint8_t i = 0; i < GTS_FIFOS; i++) {
+
+        mrf24_tx_handle_t handle = dev->sf_gts_handle[i];
+        dev->sf_gts_handle[i] = VACIO;
+
+        if (VACIO != handle)
+            InformoResultado(dev, handle, TX_DROPPED, VACIO);
+    }
+    return;
+}
+
+/**
+ * @brief  Tomo la supertrama de un beacon del coordinador del PAN.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  const uint8_t * Trama tal como sale de la FIFO.
+ * @param  uint8_t Largo de la trama, con el FCS.
+ * @return None.
+ *
+ * @note   Los beacons de otros PAN, sin supertrama o incompletos no cambian
+ *         nada. Las GTS del beacon tienen que venir ordenadas por slot, como
+ *         las arma el coordinador de este driver.
+ */
+void SigoBeacon(mrf24_dev_t * dev, const uint8_t * trama, uint8_t largo) {
+
+    uint8_t pos = BEACON_SRC_ADDR +
+                  ((LONG_S_ADD == (trama[1] & LONG_S_ADD)) ? LARGE_MAC_SIZE : sizeof(uint16_t));
+    uint8_t fin = largo - FCS_LENGTH;
+    uint16_t panid = (uint16_t)(trama[4] << SHIFT_BYTE) | trama[3];
+
+    if (panid != dev->config.panid || pos + BEACON_SPEC_MIN > fin)
+        return;
+    mrf24_superframe_t sf = {SF_ROLE_DEVICE, true, trama[pos] & NIBBLE,
+                             (uint8_t)(trama[pos] >> SHIFT_ORDER), trama[pos + 1] & NIBBLE,
+                             trama[pos + 2] & GTS_COUNT_MASK, {{0}}};
+    pos += 3;
+
+    if (BO_MAXIMO < sf.beacon_order || sf.superframe_order > sf.beacon_order)
+        return;
+
+    if (VACIO != sf.gts_count) {
+
+        if (pos + 1 + sf.gts_count * GTS_DESCRIPTOR > fin)
+            return;
+        uint8_t sentidos = trama[pos++];
+
+        for (uint8_t i = 0; i < sf.gts_count; i++, pos += GTS_DESCRIPTOR) {
+
+            sf.gts[i].address = (uint16_t)(trama[pos + 1] << SHIFT_BYTE) | trama[pos];
+            sf.gts[i].start_slot = trama[pos + 2] & NIBBLE;
+            sf.gts[i].length = trama[pos + 2] >> SHIFT_ORDER;
+            sf.gts[i].direction = ((sentidos >> i) & 1) ? GTS_DIR_RECEIVE : GTS_DIR_TRANSMIT;
+        }
+    }
+    memcpy(&dev->sf, &sf, sizeof(sf));
+    ApplySuperframe(dev);
+    return;
+}
+
+/**
+ * @brief  Leo el resultado de una transmisión en GTS y lo informo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint8_t FIFO de GTS que terminó, 0 o 1.
+ * @return None.
+ *
+ * @note   Se llama al ver TXG1IF o TXG2IF. TXGxSTAT indica que falló y
+ *         TXGxFNT que fue porque la trama no entraba en lo que quedaba de la
+ *         GTS; TXGRETRY1:0 de TXGxCON la cantidad de reintentos.
+ */
+void TerminoGts(mrf24_dev_t * dev, uint8_t fifo) {
+
+    uint8_t txstat = VACIO;
+    uint8_t txgcon = VACIO;
+    mrf24_tx_handle_t handle = dev->sf_gts_handle[fifo];
+    mrf24_tx_status_t status = TX_OK;
+
+    GetShortAddr(dev, TXSTAT, &txstat);
+    GetShortAddr(dev, fifo ? TXG2CON : TXG1CON, &txgcon);
+    dev->sf_gts_handle[fifo] = VACIO;
+
+    if (VACIO == handle)
+        return;
+
+    if (txstat & (fifo ? TXG2STAT : TXG1STAT))
+        status = (txstat & (fifo ? TXG2FNT : TXG1FNT)) ? TX_DROPPED : TX_NO_ACK;
+    InformoResultado(dev, handle, status,
+                     (uint8_t)(txgcon & (TXGRETRY1 | TXGRETRY0)) >> SHIFT_TXGRETRY);
+    return;
+}
+
+/**
+ * @brief  Reflejo en DRPACK si hay tramas indirectas guardadas.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ *
+ * @note   Con DRPACK el módulo reconoce todo pedido de datos con el bit de
+ *         trama pendiente. Los scripts de la capa física lo dejan en 0 y, con
+ *         la tabla vacía, ACKTMOUT no se vuelve a escribir.
+ */
+mrf24_state_t ApplyPendientes(mrf24_dev_t * dev) {
+
+    uint8_t acktmout = VACIO;
+    bool_t guardadas = false;
+
+    for (uint8_t i = 0; i < INDIRECT_TABLE_SIZE && !guardadas; i++) {
+
+        guardadas = (VACIO != dev->ind_tabla[i].handle);
+    }
+
+    if (OPERATION_OK != GetShortAddr(dev, ACKTMOUT, &acktmout))
+        return OPERATION_FAIL;
+    return SetShortAddr(dev, ACKTMOUT,
+                        guardadas ? acktmout | DRPACK : acktmout & (uint8_t)~DRPACK);
+}
+
+/**
+ * @brief  Cuento las tramas indirectas guardadas para un destino.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t Dirección corta del destino.
+ * @return uint8_t Cantidad de tramas.
+ */
+uint8_t CuentoIndirectas(mrf24_dev_t * dev, uint16_t destino) {
+
+    uint8_t cantidad = 0;
+
+    for (uint8_t i = 0; i < INDIRECT_TABLE_SIZE; i++) {
+
+        if (VACIO != dev->ind_tabla[i].handle && destino == dev->ind_tabla[i].destino)
+            cantidad++;
+    }
+    return cantidad;
+}
+
+/**
+ * @brief  Atiendo el pedido de datos de un dispositivo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t Dirección corta del dispositivo.
+ * @return None.
+ *
+ * @note   Se llama desde MRF24InterruptHandler. Cada pedido entrega una sola
+ *         trama, la más antigua para ese destino: si ya hay una pedida no se
+ *         marca otra. La trama sale enseguida si el módulo está libre y la
+ *         cola no está bloqueada; si no, al terminar la transmisión en curso
+ *         o desde MRF24Poll.
+ */
+void AtiendoPedidoDatos(mrf24_dev_t * dev, uint16_t origen) {
+
+    mrf24_indirecta_t * elegida = NULL;
+
+    dev->ind_stats.requests++;
+
+    for (uint8_t i = 0; i < INDIRECT_TABLE_SIZE; i++) {
+
+        mrf24_indirecta_t * entrada = &dev->ind_tabla[i];
+
+        if (VACIO == entrada->handle || origen != entrada->destino)
+            continue;
+
+        if (entrada->pedida)
+            return;
+
+        if (NULL == elegida || (int32_t)(entrada->orden - elegida->orden) < 0)
+            elegida = entrada;
+    }
+
+    if (NULL == elegida)
+        return;
+    elegida->pedida = true;
+
+    if (!dev->tx_cola_bloqueada)
+        DespachoColaTx(dev);
+    return;
+}
+
+/**
+ * @brief  Cargo en la FIFO la trama indirecta que pidió su destino y disparo
+ *         la transmisión.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo, sin transmisiones en curso.
+ * @return mrf24_state_t Estado de la operación (BUFFER_EMPTY si no hay una
+ *         trama pedida, TRANS_IN_PROGRESS, OPERATION_FAIL, OPERATION_OK).
+ *
+ * @note   El bit de trama pendiente va si quedan otras para el mismo destino.
+ *         La trama no pasa por las subcolas, así que su resultado no cuenta
+ *         como fallo de ese destino en la cola.
+ */
+mrf24_state_t DespachoIndirecta(mrf24_dev_t * dev) {
+
+    for (uint8_t i = 0; i < INDIRECT_TABLE_SIZE; i++) {
+
+        mrf24_indirecta_t * entrada = &dev->ind_tabla[i];
+
+        if (VACIO == entrada->handle || !entrada->pedida)
+            continue;
+
+        if (OPERATION_OK != DespiertoRadio(dev))
+            return TRANS_IN_PROGRESS;
+
+        if (1 < CuentoIndirectas(dev, entrada->destino))
+            entrada->trama[POS_FRAME_CTRL] |= FRAME_PEND;
+        else
+            entrada->trama[POS_FRAME_CTRL] &= (uint8_t)~FRAME_PEND;
+        mrf24_state_t estado = CargoFifoTx(dev, entrada->trama, entrada->largo, NULL, 0);
+        PERF(dev->perf_tx_inicio = PerfTick(dev));
+
+        if (OPERATION_OK == estado)
+            estado = DisparoTransmision(dev, entrada->handle, NO_SHORT_ADDRESS, TXNACKREQ);
+
+        if (OPERATION_OK != estado)
+            entrada->pedida = false;
+        return estado;
+    }
+    return BUFFER_EMPTY;
+}
+
+/**
+ * @brief  Anoto el resultado de la entrega de una trama indirecta.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_tx_handle_t Identificador de la transmisión que terminó.
+ * @param  mrf24_tx_status_t Resultado.
+ * @return bool_t true si la trama sigue guardada y el resultado queda para más
+ *         adelante.
+ *
+ * @note   Entregada, se libera la entrada. Si no, vuelve a esperar un pedido
+ *         de su destino hasta vencer.
+ */
+bool_t TerminoIndirecta(mrf24_dev_t * dev, mrf24_tx_handle_t handle, mrf24_tx_status_t status) {
+
+    for (uint8_t i = 0; i < INDIRECT_TABLE_SIZE; i++) {
+
+        mrf24_indirecta_t * entrada = &dev->ind_tabla[i];
+
+        if (handle != entrada->handle)
+            continue;
+        entrada->pedida = false;
+
+        if (TX_OK != status)
+            return true;
+        entrada->handle = VACIO;
+        dev->ind_stats.delivered++;
+        ApplyPendientes(dev);
+        return false;
+    }
+    return false;
+}
+
+/**
+ * @brief  Mando un pedido de datos al coordinador.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t Dirección corta del coordinador.
+ * @param  mrf24_tx_handle_t * Puntero donde se devuelve el identificador de
+ *                             la transmisión, puede ser NULL.
+ * @return mrf24_state_t Estado de la operación (OPERATION_FAIL,
+ *         TRANS_IN_PROGRESS, OPERATION_OK).
+ *
+ * @note   El comando va con ACK, direcciones cortas y el PAN propio, como
+ *         pide IEEE 802.15.4 para un dispositivo asociado.
+ */
+mrf24_state_t EnvioPedido(mrf24_dev_t * dev, uint16_t coordinador, mrf24_tx_handle_t * handle) {
+
+    const uint8_t comando = DATA_REQUEST;
+    mrf24_segment_t segmento = {&comando, sizeof(comando)};
+    mrf24_frame_opts_t opciones = {FRAME_COMMAND, true, true, ADDR_SHORT, ADDR_SHORT,
+                                   dev->config.panid, coordinador, dev->config.address, {0}};
+
+    if (VACIO != dev->tx_en_curso)
+        return TRANS_IN_PROGRESS;
+    dev->ind_coordinador = coordinador;
+    dev->ind_pidiendo = true;
+    mrf24_state_t estado =
+        TransmitoTrama(dev, &opciones, &segmento, 1, segmento.length, SEC_NONE, handle);
+
+    if (TRANS_COMPLETED != estado) {
+
+        dev->ind_pidiendo = false;
+        return estado;
+    }
+    dev->ind_stats.polls++;
+    return OPERATION_OK;
+}
+
+/**
+ * @brief  Veo si el coordinador tiene tramas para el módulo al terminar un
+ *         pedido de datos.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_tx_status_t Resultado del pedido.
+ * @return None.
+ *
+ * @note   FPSTAT en TXNCON es el bit de trama pendiente del ACK recibido.
+ *         Sin tramas pendientes y con la escucha de bajo consumo se vence la
+ *         ventana de escucha, para que el módulo vuelva a dormir enseguida.
+ */
+void TerminoPedido(mrf24_dev_t * dev, mrf24_tx_status_t status) {
+
+    uint8_t txncon = VACIO;
+
+    dev->ind_pidiendo = false;
+
+    if (TX_OK != status || OPERATION_OK != GetShortAddr(dev, TXNCON, &txncon))
+        return;
+
+    if (txncon & FPSTAT) {
+
+        dev->ind_stats.pending++;
+        return;
+    }
+
+    if (LPL_STEP_LISTEN == dev->lpl_paso)
+        DelayWrite(&dev->lpl_delay, VACIO);
+    return;
+}
+
+/**
+ * @brief  Avanzo la transmisión indirecta.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ *
+ * @note   Se llama desde MRF24Poll con el módulo inicializado. Descarta las
+ *         tramas vencidas, salvo la que se está entregando, despacha las
+ *         pedidas que no pudieron salir desde la interrupción y repite el
+ *         pedido de datos si el coordinador avisó que tiene más.
+ */
+void AvanzoIndirectas(mrf24_dev_t * dev) {
+
+    bool_t vencidas = false;
+    bool_t pedidas = false;
+
+    for (uint8_t i = 0; i < INDIRECT_TABLE_SIZE; i++) {
+
+        mrf24_indirecta_t * entrada = &dev->ind_tabla[i];
+        mrf24_tx_handle_t handle = entrada->handle;
+
+        if (VACIO == handle || handle == dev->tx_en_curso)
+            continue;
+
+        if (DelayRead(&entrada->vencimiento)) {
+
+            entrada->handle = VACIO;
+            entrada->pedida = false;
+            dev->ind_stats.expired++;
+            InformoResultado(dev, handle, TX_EXPIRED, VACIO);
+            vencidas = true;
+        } else if (entrada->pedida) {
+
+            pedidas = true;
+        }
+    }
+
+    if (vencidas)
+        ApplyPendientes(dev);
+
+    if (pedidas)
+        DespachoColaBloqueada(dev);
+
+    if (dev->ind_repito && VACIO == dev->tx_en_curso) {
+
+        dev->ind_repito = false;
+
+        if (TRANS_IN_PROGRESS == EnvioPedido(dev, dev->ind_coordinador, NULL))
+            dev->ind_repito = true;
+    }
+    return;
+}
+
+/**
+ * @brief  Atiendo la interrupción del módulo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return mrf24_state_t Estado de la operación, el mismo que devuelve
+ *         MRF24InterruptHandler.
+ *
+ * @note   MRF24InterruptHandler la envuelve para contar su tráfico SPI como
+ *         recepción. Durante un escaneo de energía el receptor sigue
+ *         encendido: INTSTAT se lee igual, para liberar la línea INT, y lo
+ *         recibido se descarta.
+ */
+mrf24_state_t AtiendoInterrupcion(mrf24_dev_t * dev) {
+
+    if (INIT_OK != dev->estado && SCAN_IN_PROGRESS != dev->estado)
+        return OPERATION_FAIL;
+    uint8_t intstat = VACIO;
+
+    if (OPERATION_OK != GetShortAddr(dev, INTSTAT, &intstat))
+        return OPERATION_FAIL;
+
+    if (SCAN_IN_PROGRESS == dev->estado && !dev->scan_activo)
+        return OPERATION_FAIL;
+
+    if (intstat & WAKEIF)
+        AtiendoDespertar(dev);
+
+    if (LPL_STEP_LISTEN == dev->lpl_paso && (intstat & (TXNIF | RXIF)))
+        DelayReset(&dev->lpl_delay);
+
+    if (intstat & TXNIF)
+        TerminoTransmision(dev);
+
+    if (intstat & TXG1IF)
+        TerminoGts(dev, 0);
+
+    if (intstat & TXG2IF)
+        TerminoGts(dev, 1);
+
+    if (intstat & SECIF)
+        AtiendoSeguridad(dev);
+
+    if (!(intstat & RXIF))
+        return (intstat & (TXNIF | TXG1IF | TXG2IF)) ? TRANS_COMPLETED : BUFFER_EMPTY;
+
+    if (RX_RING_SIZE == (uint8_t)(dev->rx_ring_tail - dev->rx_ring_head)) {
+
+        SetShortAddr(dev, RXFLUSH, RXFLUSH_RESET);
+        dev->rx_stats.overruns++;
+        PERF(dev->perf.rx_dropped++);
+        return BUFFER_FULL;
+    }
+
+    mrf24_state_t estado = LeoTramaRx(dev, &dev->rx_ring[dev->rx_ring_tail % RX_RING_SIZE]);
+
+    if (OPERATION_OK == estado)
+        return OPERATION_OK;
+
+    if (INVALID_VALUE == estado) {
+
+        dev->rx_stats.sec_errors++;
+        PERF(dev->perf.rx_dropped++);
+        return OPERATION_FAIL;
+    }
+
+    if (MSG_READ != estado) {
+
+        dev->rx_stats.errors++;
+        PERF(dev->perf.rx_dropped++);
+        return OPERATION_FAIL;
+    }
+    dev->rx_ring_tail++;
+    dev->rx_stats.received++;
+    PERF(PerfLeoRx(dev));
+    return MSG_READ;
+}
+
+#if MRF24_PERF
+/**
+ * @brief  Leo la fuente de ticks de la aplicación.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return tick_t Tick actual, VACIO si no se registró una fuente.
+ */
+tick_t PerfTick(mrf24_dev_t * dev) {
+
+    return (NULL != dev->perf_reloj) ? dev->perf_reloj() : VACIO;
+}
+
+/**
+ * @brief  Sumo una latencia a un histograma.
+ *
+ * @param  uint32_t * Histograma de PERF_HIST_BUCKETS casilleros.
+ * @param  tick_t Latencia en ticks.
+ * @return None.
+ *
+ * @note   El casillero es la cantidad de bits significativos de la latencia,
+ *         limitada al último.
+ */
+void PerfHistograma(uint32_t * histograma, tick_t latencia) {
+
+    uint8_t casillero = 0;
+
+    while (VACIO != latencia && PERF_HIST_BUCKETS - 1 > casillero) {
+
+        latencia >>= 1;
+        casillero++;
+    }
+    histograma[casillero]++;
+}
+
+/**
+ * @brief  Paso a contar el tráfico SPI en otro grupo.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_perf_api_t Grupo nuevo.
+ * @return mrf24_perf_api_t Grupo anterior, para restaurarlo al salir.
+ */
+mrf24_perf_api_t PerfEntro(mrf24_dev_t * dev, mrf24_perf_api_t api) {
+
+    mrf24_perf_api_t anterior = dev->perf_api;
+
+    dev->perf_api = api;
+    return anterior;
+}
+
+/**
+ * @brief  Cuento una transacción SPI en el grupo actual.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint16_t Bytes de la transacción, comando incluido.
+ * @return None.
+ */
+void PerfSpi(mrf24_dev_t * dev, uint16_t bytes) {
+
+    dev->perf.spi_transactions[dev->perf_api]++;
+    dev->perf.spi_bytes[dev->perf_api] += bytes;
+}
+
+/**
+ * @brief  Cuento una transmisión terminada y su latencia.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  uint8_t Valor leído de TXSTAT.
+ * @return None.
+ */
+void PerfTerminoTx(mrf24_dev_t * dev, uint8_t txstat) {
+
+    dev->perf.tx_frames++;
+    dev->perf.retries += (uint8_t)(txstat & (TXNRETRY1 | TXNRETRY0)) >> SHIFT_TXNRETRY;
+
+    if ((txstat & TXNSTAT) && (txstat & CCAFAIL))
+        dev->perf.cca_failures++;
+
+    if (NULL != dev->perf_reloj)
+        PerfHistograma(dev->perf.tx_latency, PerfTick(dev) - dev->perf_tx_inicio);
+}
+
+/**
+ * @brief  Marco el momento en que se vio la interrupción, si no estaba marcado.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ */
+void PerfVeoIrq(mrf24_dev_t * dev) {
+
+    if (dev->perf_irq_visto)
+        return;
+    dev->perf_irq = PerfTick(dev);
+    dev->perf_irq_visto = true;
+}
+
+/**
+ * @brief  Cuento una trama recibida y su latencia desde la interrupción.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @return None.
+ */
+void PerfLeoRx(mrf24_dev_t * dev) {
+
+    dev->perf.rx_frames++;
+
+    if (NULL != dev->perf_reloj)
+        PerfHistograma(dev->perf.rx_latency, PerfTick(dev) - dev->perf_irq);
+}
+#endif
+
+/* === Implementación de funciones públicas =================================== */
+mrf24_state_t MRF24J40Init(mrf24_dev_t * dev, const mrf24_port_t * port) {
+
+    if (NULL == dev || NULL == port || NULL == port->init_pins || NULL == port->set_cs ||
+        NULL == port->set_reset || NULL == port->is_interrupt || NULL == port->write_byte ||
+        NULL == port->write_2_bytes || NULL == port->write_block || NULL == port->read_byte ||
+        NULL == port->read_block)
+        return INVALID_VALUE;
+    dev->port = *port;
+    dev->lpl_paso = LPL_STEP_OFF;
+    dev->lpl_repito = false;
+    InicializoVariables(dev);
+    InicializoColas(dev);
+    InvalidoShadow(dev);
+    dev->port.init_pins(dev->port.ctx);
+    DelayInit(&dev->init_delay, WAIT_1_MS);
+    EsperoInicializacion(dev, INIT_STEP_RESET_PIN, WAIT_1_MS);
+    dev->estado = INIT_IN_PROGRESS;
+    return dev->estado;
+}
+
+mrf24_state_t MRF24Poll(mrf24_dev_t * dev) {
+
+    if (INIT_IN_PROGRESS == dev->estado) {
+
+        PERF(mrf24_perf_api_t perf_anterior = PerfEntro(dev, PERF_API_INIT));
+        dev->estado = AvanzoInicializacion(dev);
+        PERF(dev->perf_api = perf_anterior);
+    } else if (SCAN_IN_PROGRESS == dev->estado)
+        dev->estado = dev->scan_activo ? AvanzoScanActivo(dev) : AvanzoScanED(dev);
+    else if (INIT_OK == dev->estado && LPL_STEP_OFF != dev->lpl_paso)
+        AvanzoLpl(dev);
+
+    if (INIT_OK == dev->estado)
+        AvanzoIndirectas(dev);
+    return dev->estado;
+}
+
+mrf24_init_step_t MRF24GetInitStep(mrf24_dev_t * dev) {
+
+    return dev->init_paso;
+}
+
+mrf24_state_t MRF24SetInitProfile(mrf24_dev_t * dev, const mrf24_init_profile_t * perfil) {
+
+    if (INIT_IN_PROGRESS == dev->estado)
+        return TRANS_IN_PROGRESS;
+
+    if (NULL != perfil && (NULL == perfil->script || VACIO == perfil->length ||
+                           (NULL == perfil->extra && VACIO != perfil->extra_length)))
+        return INVALID_VALUE;
+    dev->init_perfil = (NULL == perfil) ? &mrf24_profile_ma : perfil;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24SetPhyMode(mrf24_dev_t * dev, mrf24_phy_mode_t modo) {
+
+    if (PHY_250KBPS != modo && PHY_TURBO_625KBPS != modo)
+        return INVALID_VALUE;
+
+    if (INIT_IN_PROGRESS == dev->estado || SCAN_IN_PROGRESS == dev->estado ||
+        VACIO != dev->tx_en_curso)
+        return TRANS_IN_PROGRESS;
+    dev->phy_modo = modo;
+    dev->phy_elegido = true;
+
+    if (INIT_OK != dev->estado)
+        return OPERATION_OK;
+
+    if (OPERATION_OK != ApplyPhyMode(dev) || OPERATION_OK != ApplyPendientes(dev))
+        return OPERATION_FAIL;
+    return ReinicioRf(dev);
+}
+
+mrf24_phy_mode_t MRF24GetPhyMode(mrf24_dev_t * dev) {
+
+    return dev->phy_modo;
+}
+
+mrf24_state_t MRF24SetChannel(mrf24_dev_t * dev, channel_list_t ch) {
+
+    if (CH_11 > ch || CH_26 < ch)
+        return INVALID_VALUE;
+    dev->config.channel = ch;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24SetPanId(mrf24_dev_t * dev, uint16_t pan_id) {
+
+    if (BROADCAST == pan_id)
+        return INVALID_VALUE;
+    dev->config.panid = pan_id;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24SetAdd(mrf24_dev_t * dev, uint16_t add) {
+
+    if (BROADCAST == add)
+        return INVALID_VALUE;
+    dev->config.address = add;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24SetSec(mrf24_dev_t * dev, uint16_t sec) {
+
+    dev->config.sequence_number = sec;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24SetMAC(mrf24_dev_t * dev, uint8_t mac[8]) {
+
+    bool_t dif_cero = false;
+
+    for (uint8_t i = 0; i < LARGE_MAC_SIZE; i++) {
+
+        if (VACIO != mac[i]) {
+
+            dif_cero = true;
+            break;
+        }
+    }
+
+    if (!dif_cero)
+        return INVALID_VALUE;
+    memcpy(dev->config.mac, mac, sizeof(dev->config.mac));
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24SetSecurityKey(mrf24_dev_t * dev, uint8_t security_key[16]) {
+
+    bool_t dif_cero = false;
+
+    for (uint8_t i = 0; i < SEC_KEY_SIZE; i++) {
+
+        if (VACIO != security_key[i]) {
+
+            dif_cero = true;
+            break;
+        }
+    }
+
+    if (!dif_cero)
+        return INVALID_VALUE;
+    memcpy(dev->config.security_key, security_key, sizeof(dev->config.security_key));
+
+    if (INIT_OK == dev->estado)
+        return ApplySecurityKey(dev);
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24SetSecurityLevel(mrf24_dev_t * dev, mrf24_sec_level_t nivel) {
+
+    if (SEC_NONE != nivel && !NivelSeguridadValido(nivel))
+        return INVALID_VALUE;
+    dev->sec_nivel = nivel;
+    return OPERATION_OK;
+}
 
-    bool_t dif_cero = false;
+mrf24_state_t MRF24SetFrameCounter(mrf24_dev_t * dev, uint32_t contador) {
 
-    for (uint8_t i = 0; i < SEC_KEY_SIZE; i++) {
+    dev->sec_contador = contador;
+    return OPERATION_OK;
+}
 
-        if (VACIO != security_key[i]) {
+uint32_t MRF24GetFrameCounter(mrf24_dev_t * dev) {
 
-            dif_cero = true;
-            break;
-        }
+    return dev->sec_contador;
+}
+
+mrf24_state_t MRF24SetSecurityPeer(mrf24_dev_t * dev, uint8_t mac[8]) {
+
+    if (NULL == mac)
+        return INVALID_VALUE;
+    memcpy(dev->sec_origen, mac, sizeof(dev->sec_origen));
+
+    if (INIT_OK == dev->estado)
+        return ApplySecurityPeer(dev);
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24TransmitirDato(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s) {
+
+    mrf24_state_t estado = ValidoDatoSalida(dev, p_info_out_s);
+
+    if (OPERATION_OK != estado)
+        return estado;
+    mrf24_segment_t segmento = {(const uint8_t *)p_info_out_s->buffer, p_info_out_s->buffer_size};
+    PERF(mrf24_perf_api_t perf_anterior = PerfEntro(dev, PERF_API_TX));
+    mrf24_frame_opts_t opciones = OpcionesDato(
+        p_info_out_s->dest_panid, p_info_out_s->dest_address, p_info_out_s->origin_address);
+    estado = TransmitoTrama(dev, &opciones, &segmento, 1, segmento.length, SEC_NONE, NULL);
+    PERF(dev->perf_api = perf_anterior);
+    return estado;
+}
+
+mrf24_state_t MRF24TransmitirDatoEncriptado(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s) {
+
+    if (SEC_NONE == dev->sec_nivel || SEC_MAX_COUNTER == dev->sec_contador)
+        return INVALID_VALUE;
+    mrf24_state_t estado = ValidoDatoSalida(dev, p_info_out_s);
+
+    if (OPERATION_OK != estado)
+        return estado;
+    uint8_t sobrecarga = SEC_AUX_LENGTH + sec_largo_mic[dev->sec_nivel - SEC_ENC_MIC_32];
+
+    if (MAX_PAYLOAD_SIZE - sobrecarga < p_info_out_s->buffer_size)
+        return TO_LONG_MSG;
+    mrf24_segment_t segmento = {(const uint8_t *)p_info_out_s->buffer, p_info_out_s->buffer_size};
+    PERF(mrf24_perf_api_t perf_anterior = PerfEntro(dev, PERF_API_TX));
+    mrf24_frame_opts_t opciones = OpcionesDato(
+        p_info_out_s->dest_panid, p_info_out_s->dest_address, p_info_out_s->origin_address);
+    estado = TransmitoTrama(dev, &opciones, &segmento, 1, segmento.length, dev->sec_nivel, NULL);
+    PERF(dev->perf_api = perf_anterior);
+    return estado;
+}
+
+mrf24_state_t MRF24TransmitirAsync(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s,
+                                   mrf24_tx_handle_t * handle) {
+
+    if (NULL == handle)
+        return INVALID_VALUE;
+    mrf24_state_t estado = ValidoDatoSalida(dev, p_info_out_s);
+
+    if (OPERATION_OK != estado)
+        return estado;
+    mrf24_segment_t segmento = {(const uint8_t *)p_info_out_s->buffer, p_info_out_s->buffer_size};
+    PERF(mrf24_perf_api_t perf_anterior = PerfEntro(dev, PERF_API_TX));
+    mrf24_frame_opts_t opciones = OpcionesDato(
+        p_info_out_s->dest_panid, p_info_out_s->dest_address, p_info_out_s->origin_address);
+    estado = TransmitoTrama(dev, &opciones, &segmento, 1, segmento.length, SEC_NONE, handle);
+    PERF(dev->perf_api = perf_anterior);
+    return (TRANS_COMPLETED == estado) ? OPERATION_OK : estado;
+}
+
+mrf24_state_t MRF24EncolarDato(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s,
+                               mrf24_tx_handle_t * handle) {
+
+    if (NULL == handle)
+        return INVALID_VALUE;
+    mrf24_state_t estado = ValidoDatoSalida(dev, p_info_out_s);
+
+    if (OPERATION_OK != estado)
+        return estado;
+    PERF(mrf24_perf_api_t perf_anterior = PerfEntro(dev, PERF_API_TX));
+    dev->tx_cola_bloqueada = true;
+    estado = EncoloTrama(dev, p_info_out_s, handle);
+    DespachoColaBloqueada(dev);
+    PERF(dev->perf_api = perf_anterior);
+    return estado;
+}
+
+mrf24_state_t MRF24GetTxStatus(mrf24_dev_t * dev, mrf24_tx_handle_t handle,
+                               mrf24_tx_result_t * resultado) {
+
+    if (NULL == resultado || VACIO == handle)
+        return INVALID_VALUE;
+
+    if (HandleEnUso(dev, handle)) {
+
+        resultado->handle = handle;
+        resultado->status = TX_PENDING;
+        resultado->retries = VACIO;
+        return TRANS_IN_PROGRESS;
     }
 
-    if (!dif_cero)
+    const mrf24_tx_result_t * guardado = &dev->tx_resultados[handle % TX_QUEUE_SIZE];
+
+    if (handle != guardado->handle)
         return INVALID_VALUE;
-    memcpy(data_config_s.security_key, security_key, sizeof(data_config_s.security_key));
+    memcpy(resultado, guardado, sizeof(*guardado));
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24SetTxCallback(mrf24_dev_t * dev, mrf24_tx_callback_t callback) {
+
+    dev->tx_callback = callback;
     return OPERATION_OK;
 }
 
-mrf24_state_t MRF24TransmitirDato(mrf24_data_out_t * p_info_out_s) {
+mrf24_state_t MRF24TransmitirSegmentos(mrf24_dev_t * dev, uint16_t dest_panid,
+                                       uint16_t dest_address, const mrf24_segment_t * segmentos,
+                                       uint8_t cantidad) {
 
-    if (INIT_OK != estadoActual)
+    if (INIT_OK != dev->estado)
         return OPERATION_FAIL;
 
-    if (VACIO == p_info_out_s->dest_address)
+    if (NULL == segmentos)
+        return INVALID_VALUE;
+
+    if (VACIO == dest_address)
         return DIRECTION_EMPTY;
+    uint16_t largo = 0;
 
-    if (VACIO == p_info_out_s->buffer_size)
+    for (uint8_t i = 0; i < cantidad; i++) {
+
+        if (NULL == segmentos[i].data && VACIO != segmentos[i].length)
+            return INVALID_VALUE;
+        largo += segmentos[i].length;
+    }
+
+    if (VACIO == largo)
         return BUFFER_EMPTY;
 
-    if (BUFFER_SIZE < p_info_out_s->buffer_size)
+    if (MAX_PAYLOAD_SIZE < largo)
         return TO_LONG_MSG;
-    uint8_t pos_mem = 0;
-    SetLongAddr(pos_mem++, HEAD_LENGTH);
-    SetLongAddr(pos_mem++, p_info_out_s->buffer_size + HEAD_LENGTH);
-    SetLongAddr(pos_mem++, DATA | ACK_REQ | INTRA_PAN); // LSB.
-    SetLongAddr(pos_mem++, SHORT_S_ADD | SHORT_D_ADD);  // MSB.
-    SetLongAddr(pos_mem++, data_config_s.sequence_number++);
 
-    if (VACIO == p_info_out_s->dest_panid)
-        p_info_out_s->dest_panid = data_config_s.panid;
-    SetLongAddr(pos_mem++, (uint8_t)p_info_out_s->dest_panid);
-    SetLongAddr(pos_mem++, (uint8_t)(p_info_out_s->dest_panid >> SHIFT_BYTE));
-    SetLongAddr(pos_mem++, (uint8_t)p_info_out_s->dest_address);
-    SetLongAddr(pos_mem++, (uint8_t)(p_info_out_s->dest_address >> SHIFT_BYTE));
+    if (VACIO == dest_panid)
+        dest_panid = dev->config.panid;
+    PERF(mrf24_perf_api_t perf_anterior = PerfEntro(dev, PERF_API_TX));
+    mrf24_frame_opts_t opciones = OpcionesDato(dest_panid, dest_address, dev->config.address);
+    mrf24_state_t estado = TransmitoTrama(dev, &opciones, segmentos, cantidad, (uint8_t)largo,
+                                          SEC_NONE, NULL);
+    PERF(dev->perf_api = perf_anterior);
+    return estado;
+}
 
-    if (VACIO == p_info_out_s->origin_address)
-        p_info_out_s->origin_address = data_config_s.address;
-    SetLongAddr(pos_mem++, (uint8_t)p_info_out_s->origin_address);
-    SetLongAddr(pos_mem++, (uint8_t)(p_info_out_s->origin_address >> SHIFT_BYTE));
+mrf24_state_t MRF24TransmitirTrama(mrf24_dev_t * dev, const mrf24_frame_opts_t * opciones,
+                                   const mrf24_segment_t * segmentos, uint8_t cantidad) {
+
+    if (INIT_OK != dev->estado)
+        return OPERATION_FAIL;
+
+    if (NULL == opciones || NULL == segmentos)
+        return INVALID_VALUE;
+
+    if (FRAME_BEACON != opciones->type && FRAME_DATA != opciones->type &&
+        FRAME_COMMAND != opciones->type)
+        return INVALID_VALUE;
+
+    if ((ADDR_NONE != opciones->dest_mode && ADDR_SHORT > opciones->dest_mode) ||
+        ADDR_LONG < opciones->dest_mode)
+        return INVALID_VALUE;
+
+    if ((ADDR_NONE != opciones->src_mode && ADDR_SHORT > opciones->src_mode) ||
+        ADDR_LONG < opciones->src_mode)
+        return INVALID_VALUE;
+
+    if (ADDR_NONE == opciones->dest_mode && ADDR_NONE == opciones->src_mode)
+        return INVALID_VALUE;
+
+    if (opciones->pan_compression &&
+        (ADDR_NONE == opciones->dest_mode || ADDR_NONE == opciones->src_mode))
+        return INVALID_VALUE;
+
+    if (ADDR_SHORT == opciones->dest_mode && VACIO == opciones->dest_address)
+        return DIRECTION_EMPTY;
+    uint16_t largo = 0;
 
-    for (int8_t i = 0; i < p_info_out_s->buffer_size; i++) {
+    for (uint8_t i = 0; i < cantidad; i++) {
 
-        SetLongAddr(pos_mem++, p_info_out_s->buffer[i]);
+        if (NULL == segmentos[i].data && VACIO != segmentos[i].length)
+            return INVALID_VALUE;
+        largo += segmentos[i].length;
     }
-    SetLongAddr(pos_mem++, VACIO);
-    SetShortAddr(TXNCON, TXNACKREQ | TXNTRIG);
-    return TRANS_COMPLETED;
+
+    if (VACIO == largo)
+        return BUFFER_EMPTY;
+
+    if (MAX_FRAME_LENGTH - FCS_LENGTH - MRF24LargoCabecera(opciones) < largo)
+        return TO_LONG_MSG;
+    mrf24_frame_opts_t resueltas = *opciones;
+
+    if (VACIO == resueltas.dest_panid)
+        resueltas.dest_panid = dev->config.panid;
+
+    if (VACIO == resueltas.src_address)
+        resueltas.src_address = dev->config.address;
+    PERF(mrf24_perf_api_t perf_anterior = PerfEntro(dev, PERF_API_TX));
+    mrf24_state_t estado = TransmitoTrama(dev, &resueltas, segmentos, cantidad, (uint8_t)largo,
+                                          SEC_NONE, NULL);
+    PERF(dev->perf_api = perf_anterior);
+    return estado;
+}
+
+uint8_t MRF24LargoCabecera(const mrf24_frame_opts_t * opciones) {
+
+    uint8_t largo = MHR_MIN_LENGTH;
+
+    if (ADDR_NONE != opciones->dest_mode)
+        largo += sizeof(uint16_t) +
+                 ((ADDR_LONG == opciones->dest_mode) ? LARGE_MAC_SIZE : sizeof(uint16_t));
+
+    if (ADDR_NONE != opciones->src_mode && !opciones->pan_compression)
+        largo += sizeof(uint16_t);
+
+    if (ADDR_NONE != opciones->src_mode)
+        largo += (ADDR_LONG == opciones->src_mode) ? LARGE_MAC_SIZE : sizeof(uint16_t);
+    return largo;
 }
 
-mrf24_state_t MRF24IsNewMsg(void) {
+mrf24_state_t MRF24IsNewMsg(mrf24_dev_t * dev) {
 
-    if (INIT_OK != estadoActual)
+    if (INIT_OK != dev->estado)
         return UNEXPECTED_ERROR;
 
-    if (IsMRF24Interrup())
+    if (dev->rx_ring_head != dev->rx_ring_tail)
         return MSG_PRESENT;
-    return BUFFER_EMPTY;
+
+    if (!dev->port.is_interrupt(dev->port.ctx))
+        return BUFFER_EMPTY;
+    PERF(PerfVeoIrq(dev));
+    return MSG_PRESENT;
+}
+
+mrf24_state_t MRF24InterruptHandler(mrf24_dev_t * dev) {
+
+    PERF(mrf24_perf_api_t perf_anterior = PerfEntro(dev, PERF_API_RX));
+    PERF(PerfVeoIrq(dev));
+    mrf24_state_t estado = AtiendoInterrupcion(dev);
+    PERF(dev->perf_irq_visto = false);
+    PERF(dev->perf_api = perf_anterior);
+    return estado;
+}
+
+mrf24_state_t MRF24ReciboPaquete(mrf24_dev_t * dev) {
+
+    return MRF24InterruptHandler(dev);
+}
+
+mrf24_data_in_t * MRF24GetDataIn(mrf24_dev_t * dev) {
+
+    if (dev->rx_ring_head == dev->rx_ring_tail)
+        return NULL;
+    return &dev->rx_ring[dev->rx_ring_head % RX_RING_SIZE];
+}
+
+mrf24_state_t MRF24ReleaseDataIn(mrf24_dev_t * dev) {
+
+    if (dev->rx_ring_head == dev->rx_ring_tail)
+        return BUFFER_EMPTY;
+    dev->rx_ring_head++;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24GetRxStats(mrf24_dev_t * dev, mrf24_rx_stats_t * stats) {
+
+    if (NULL == stats)
+        return INVALID_VALUE;
+    memcpy(stats, &dev->rx_stats, sizeof(dev->rx_stats));
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24SetSniffer(mrf24_dev_t * dev, bool_t activo, bool_t con_errores) {
+
+    if (con_errores && !activo)
+        return INVALID_VALUE;
+
+    if (SCAN_IN_PROGRESS == dev->estado)
+        return TRANS_IN_PROGRESS;
+    dev->rxmcr &= (uint8_t)~(PROMI | ERRPKT | NOACKRSP);
+
+    if (activo)
+        dev->rxmcr |= PROMI | NOACKRSP | (con_errores ? ERRPKT : VACIO);
+
+    if (INIT_OK != dev->estado)
+        return OPERATION_OK;
+    return ApplyRxMode(dev);
+}
+
+mrf24_state_t MRF24SetRxClock(mrf24_dev_t * dev, mrf24_rx_clock_t reloj) {
+
+    dev->rx_reloj = reloj;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24EscanearEnergia(mrf24_dev_t * dev, tick_t permanencia) {
+
+    if (INIT_OK != dev->estado)
+        return OPERATION_FAIL;
+
+    if (VACIO == permanencia)
+        return INVALID_VALUE;
+
+    if (VACIO != dev->tx_en_curso || OPERATION_OK != DespiertoRadio(dev))
+        return TRANS_IN_PROGRESS;
+    dev->scan_indice = 0;
+    dev->scan_activo = false;
+    DelayWrite(&dev->scan_delay, permanencia);
+    ComienzoCanalED(dev);
+    dev->estado = SCAN_IN_PROGRESS;
+    return dev->estado;
+}
+
+mrf24_state_t MRF24GetEnergia(mrf24_dev_t * dev, mrf24_ed_result_t * tabla) {
+
+    if (NULL == tabla)
+        return INVALID_VALUE;
+
+    if (SCAN_IN_PROGRESS == dev->estado)
+        return TRANS_IN_PROGRESS;
+
+    if (VACIO == dev->ed_tabla[0].channel)
+        return BUFFER_EMPTY;
+    memcpy(tabla, dev->ed_tabla, sizeof(dev->ed_tabla));
+    return OPERATION_OK;
 }
 
-mrf24_state_t MRF24ReciboPaquete(void) {
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+mrf24_state_t MRF24BuscarDispositivos(mrf24_dev_t * dev, tick_t permanencia) {
 
-    /*
-     * agregar la lectura del rssi y del lq, vienen en el paquete del mensaje.
-     */
+    uint8_t rxmcr = VACIO;
 
-    if (INIT_OK != estadoActual)
+    if (INIT_OK != dev->estado)
         return OPERATION_FAIL;
-    SetLongAddr(BBREG1, RXDECINV);
-    SetShortAddr(RXFLUSH, DATAONLY);
-    GetLongAddr(RX_FIFO, &data_in_s.buffer_size);
-    uint8_t add = VACIO;
-    GetLongAddr(RX_FIFO + 9, &add);
-    data_in_s.address = (uint16_t)(add << SHIFT_BYTE);
-    GetLongAddr(RX_FIFO + 8, &add);
-    data_in_s.address |= (uint16_t)add;
 
-    for (uint8_t i = 0; i < data_in_s.buffer_size - FCS_LQI_RSSI; i++) {
+    if (VACIO == permanencia)
+        return INVALID_VALUE;
+
+    if (VACIO != dev->tx_en_curso || OPERATION_OK != DespiertoRadio(dev))
+        return TRANS_IN_PROGRESS;
+    memset(dev->vecinos, 0, sizeof(dev->vecinos));
+    dev->vecinos_cantidad = 0;
+    dev->scan_indice = 0;
+    dev->scan_activo = true;
+    dev->estado = SCAN_IN_PROGRESS;
+    GetShortAddr(dev, RXMCR, &rxmcr);
+    SetShortAddr(dev, RXMCR, rxmcr | PROMI);
+    DelayWrite(&dev->scan_delay, permanencia);
+    ComienzoCanalActivo(dev);
+    return dev->estado;
+}
+
+uint16_t MRF24GetCantidadVecinos(mrf24_dev_t * dev) {
+
+    return dev->vecinos_cantidad;
+}
+
+const MRF24_discover_nearby_t * MRF24BuscarVecino(mrf24_dev_t * dev, uint16_t panid,
+                                                  uint16_t short_address,
+                                                  const uint8_t * long_address) {
+
+    if (NO_SHORT_ADDRESS == short_address && NULL == long_address)
+        return NULL;
+    const MRF24_discover_nearby_t * vecino = UbicoVecino(dev, panid, short_address, long_address);
+    return (NULL == vecino || VACIO == vecino->channel) ? NULL : vecino;
+}
+
+const MRF24_discover_nearby_t * MRF24GetVecinos(mrf24_dev_t * dev) {
+
+    return dev->vecinos;
+}
+
+mrf24_state_t MRF24SetLowPower(mrf24_dev_t * dev, const mrf24_lpl_config_t * config) {
+
+    if (NULL != config && (LPL_MIN_LISTEN > config->listen ||
+                           config->listen >= config->max_latency || SF_ROLE_NONE != dev->sf.role))
+        return INVALID_VALUE;
+
+    if (SCAN_IN_PROGRESS == dev->estado)
+        return TRANS_IN_PROGRESS;
+
+    if (NULL == config)
+        memset(&dev->lpl_config, 0, sizeof(dev->lpl_config));
+    else
+        memcpy(&dev->lpl_config, config, sizeof(dev->lpl_config));
+
+    if (INIT_OK != dev->estado)
+        return OPERATION_OK;
+
+    if (NULL != config) {
+
+        if (LPL_STEP_OFF == dev->lpl_paso)
+            ComienzoLpl(dev);
+    } else if (OPERATION_OK == DespiertoRadio(dev) && LPL_STEP_OFF != dev->lpl_paso) {
 
-        GetLongAddr(RX_FIFO + HEAD_LENGTH + i - 1, &data_in_s.buffer[i]);
+        ApagoLpl(dev);
     }
-    SetLongAddr(BBREG1, VACIO);
-    GetShortAddr(INTSTAT, &add);
-    return MSG_READ;
+    return OPERATION_OK;
+}
+
+mrf24_lpl_step_t MRF24GetLowPowerStep(mrf24_dev_t * dev) {
+
+    return dev->lpl_paso;
+}
+
+mrf24_state_t MRF24GetLowPowerStats(mrf24_dev_t * dev, mrf24_lpl_stats_t * stats) {
+
+    if (NULL == stats)
+        return INVALID_VALUE;
+    memcpy(stats, &dev->lpl_stats, sizeof(dev->lpl_stats));
+    return OPERATION_OK;
 }
 
-mrf24_data_in_t * MRF24GetDataIn(void) {
+mrf24_state_t MRF24SetSuperframe(mrf24_dev_t * dev, const mrf24_superframe_config_t * config) {
+
+    if (NULL != config && (BO_MAXIMO < config->beacon_order ||
+                           config->superframe_order > config->beacon_order))
+        return INVALID_VALUE;
+
+    if (SF_ROLE_DEVICE == dev->sf.role || (NULL != config && VACIO != dev->lpl_config.max_latency))
+        return INVALID_VALUE;
+
+    if (SCAN_IN_PROGRESS == dev->estado)
+        return TRANS_IN_PROGRESS;
+    bool_t activa = (SF_ROLE_COORDINATOR == dev->sf.role);
+    DescartoGts(dev);
+    memset(&dev->sf, 0, sizeof(dev->sf));
+
+    if (NULL == config) {
 
-    return &data_in_s;
+        if (activa && INIT_OK == dev->estado)
+            ApagoSupertrama(dev);
+        return OPERATION_OK;
+    }
+    dev->sf.role = SF_ROLE_COORDINATOR;
+    dev->sf.beacon_order = config->beacon_order;
+    dev->sf.superframe_order = config->superframe_order;
+    UbicoGts(dev);
+
+    if (INIT_OK != dev->estado)
+        return OPERATION_OK;
+    dev->sf.synced = true;
+    ComienzoSupertrama(dev);
+    return OPERATION_OK;
 }
 
-mrf24_state_t MRF24BuscarDispositivos(void) {
+mrf24_state_t MRF24SeguirBeacons(mrf24_dev_t * dev, bool_t activo) {
+
+    if (SF_ROLE_COORDINATOR == dev->sf.role || (activo && VACIO != dev->lpl_config.max_latency))
+        return INVALID_VALUE;
+
+    if (SCAN_IN_PROGRESS == dev->estado)
+        return TRANS_IN_PROGRESS;
+
+    if (activo) {
+
+        dev->sf.role = SF_ROLE_DEVICE;
+        return OPERATION_OK;
+    }
+    bool_t activa = (SF_ROLE_DEVICE == dev->sf.role);
+    DescartoGts(dev);
+    memset(&dev->sf, 0, sizeof(dev->sf));
+
+    if (activa && INIT_OK == dev->estado)
+        ApagoSupertrama(dev);
+    return OPERATION_OK;
+}
 
-    //   static MRF24_discover_nearby_t algo[10];
+mrf24_state_t MRF24AsignarGts(mrf24_dev_t * dev, uint16_t address, uint8_t slots,
+                              mrf24_gts_dir_t direccion) {
 
-    if (INIT_OK != estadoActual)
+    if (SF_ROLE_COORDINATOR != dev->sf.role)
         return OPERATION_FAIL;
 
-    data_out_s.dest_address = 1;
+    if (VACIO == slots || VACIO == address || BROADCAST == address ||
+        NO_SHORT_ADDRESS == address || GTS_DIR_RECEIVE < direccion ||
+        VACIO != NumeroGts(dev, address, direccion))
+        return INVALID_VALUE;
+    uint32_t slot = (uint32_t)SLOT_SIMBOLOS << dev->sf.superframe_order;
+    uint8_t minimo = (uint8_t)((MIN_CAP_SIMBOLOS + slot - 1) / slot);
 
-    SetShortAddr(TXNCON, TXNACKREQ | TXNTRIG);
+    if (SF_MAX_GTS == dev->sf.gts_count || dev->sf.cap_end + 1 < minimo + slots)
+        return BUFFER_FULL;
 
-    return MSG_READ;
+    if (VACIO != dev->sf_gts_handle[0] || VACIO != dev->sf_gts_handle[1])
+        return TRANS_IN_PROGRESS;
+    memmove(&dev->sf.gts[1], &dev->sf.gts[0], dev->sf.gts_count * sizeof(mrf24_gts_t));
+    dev->sf.gts[0].address = address;
+    dev->sf.gts[0].length = slots;
+    dev->sf.gts[0].direction = direccion;
+    dev->sf.gts_count++;
+    UbicoGts(dev);
+    return ActualizoGts(dev);
+}
+
+mrf24_state_t MRF24LiberarGts(mrf24_dev_t * dev, uint16_t address, mrf24_gts_dir_t direccion) {
+
+    if (SF_ROLE_COORDINATOR != dev->sf.role)
+        return OPERATION_FAIL;
+    uint8_t numero = NumeroGts(dev, address, direccion);
+
+    if (VACIO == numero)
+        return INVALID_VALUE;
+
+    if (VACIO != dev->sf_gts_handle[0] || VACIO != dev->sf_gts_handle[1])
+        return TRANS_IN_PROGRESS;
+    memmove(&dev->sf.gts[numero - 1], &dev->sf.gts[numero],
+            (dev->sf.gts_count - numero) * sizeof(mrf24_gts_t));
+    dev->sf.gts_count--;
+    UbicoGts(dev);
+    return ActualizoGts(dev);
+}
+
+mrf24_state_t MRF24TransmitirGts(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s,
+                                 mrf24_tx_handle_t * handle) {
+
+    if (NULL == handle)
+        return INVALID_VALUE;
+    mrf24_state_t estado = ValidoDatoSalida(dev, p_info_out_s);
+
+    if (OPERATION_OK != estado)
+        return estado;
+    uint8_t numero = VACIO;
+
+    if (SF_ROLE_COORDINATOR == dev->sf.role)
+        numero = NumeroGts(dev, p_info_out_s->dest_address, GTS_DIR_RECEIVE);
+    else if (dev->sf.synced)
+        numero = NumeroGts(dev, dev->config.address, GTS_DIR_TRANSMIT);
+
+    if (VACIO == numero)
+        return INVALID_VALUE;
+    uint8_t fifo = (VACIO == dev->sf_gts_handle[0]) ? 0 : 1;
+
+    if (VACIO != dev->sf_gts_handle[fifo])
+        return BUFFER_FULL;
+    PERF(mrf24_perf_api_t perf_anterior = PerfEntro(dev, PERF_API_TX));
+    uint8_t trama[TX_FRAME_SIZE];
+    mrf24_frame_opts_t opciones = OpcionesDato(
+        p_info_out_s->dest_panid, p_info_out_s->dest_address, p_info_out_s->origin_address);
+    uint8_t pos = CodificoCabecera(dev, trama, &opciones, p_info_out_s->buffer_size);
+    uint8_t txgcon = (uint8_t)(numero << SHIFT_TXGSLOT) | TXGTRIG |
+                     (PidoAck(&opciones) ? TXGACKREQ : VACIO);
+    memcpy(&trama[pos], p_info_out_s->buffer, p_info_out_s->buffer_size);
+    estado = SetLongAddrBlock(dev, fifo ? TX_GTS2_FIFO : TX_GTS1_FIFO, trama,
+                              pos + p_info_out_s->buffer_size);
+
+    if (OPERATION_OK == estado) {
+
+        dev->sf_gts_handle[fifo] = NuevoHandle(dev);
+        *handle = dev->sf_gts_handle[fifo];
+        estado = SetShortAddr(dev, fifo ? TXG2CON : TXG1CON, txgcon);
+
+        if (OPERATION_OK != estado)
+            dev->sf_gts_handle[fifo] = VACIO;
+    }
+    PERF(dev->perf_api = perf_anterior);
+    return estado;
+}
+
+mrf24_state_t MRF24GetSuperframe(mrf24_dev_t * dev, mrf24_superframe_t * superframe) {
+
+    if (NULL == superframe)
+        return INVALID_VALUE;
+    memcpy(superframe, &dev->sf, sizeof(dev->sf));
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24EncolarIndirecto(mrf24_dev_t * dev, mrf24_data_out_t * p_info_out_s,
+                                    tick_t persistencia, mrf24_tx_handle_t * handle) {
+
+    mrf24_indirecta_t * libre = NULL;
+
+    if (NULL == handle)
+        return INVALID_VALUE;
+    mrf24_state_t estado = ValidoDatoSalida(dev, p_info_out_s);
+
+    if (OPERATION_OK != estado)
+        return estado;
+
+    if (BROADCAST == p_info_out_s->dest_address || NO_SHORT_ADDRESS == p_info_out_s->dest_address)
+        return INVALID_VALUE;
+
+    for (uint8_t i = 0; i < INDIRECT_TABLE_SIZE && NULL == libre; i++) {
+
+        if (VACIO == dev->ind_tabla[i].handle)
+            libre = &dev->ind_tabla[i];
+    }
+
+    if (NULL == libre)
+        return BUFFER_FULL;
+    PERF(mrf24_perf_api_t perf_anterior = PerfEntro(dev, PERF_API_TX));
+    mrf24_frame_opts_t opciones = OpcionesDato(
+        p_info_out_s->dest_panid, p_info_out_s->dest_address, p_info_out_s->origin_address);
+    libre->largo = CodificoCabecera(dev, libre->trama, &opciones, p_info_out_s->buffer_size);
+    memcpy(&libre->trama[libre->largo], p_info_out_s->buffer, p_info_out_s->buffer_size);
+    libre->largo += p_info_out_s->buffer_size;
+    libre->destino = p_info_out_s->dest_address;
+    libre->orden = dev->ind_orden++;
+    libre->pedida = false;
+    DelayInit(&libre->vencimiento, (VACIO == persistencia) ? INDIRECT_PERSISTENCE : persistencia);
+    DelayReset(&libre->vencimiento);
+    libre->handle = NuevoHandle(dev);
+    *handle = libre->handle;
+    estado = ApplyPendientes(dev);
+    PERF(dev->perf_api = perf_anterior);
+    return estado;
+}
+
+mrf24_state_t MRF24PedirDatos(mrf24_dev_t * dev, uint16_t coordinador,
+                              mrf24_tx_handle_t * handle) {
+
+    if (INIT_OK != dev->estado)
+        return OPERATION_FAIL;
+
+    if (NULL == handle || BROADCAST == coordinador || NO_SHORT_ADDRESS == coordinador)
+        return INVALID_VALUE;
+
+    if (VACIO == coordinador)
+        return DIRECTION_EMPTY;
+    PERF(mrf24_perf_api_t perf_anterior = PerfEntro(dev, PERF_API_TX));
+    mrf24_state_t estado = EnvioPedido(dev, coordinador, handle);
+    PERF(dev->perf_api = perf_anterior);
+    return estado;
+}
+
+mrf24_state_t MRF24GetIndirectStats(mrf24_dev_t * dev, mrf24_indirect_stats_t * stats) {
+
+    if (NULL == stats)
+        return INVALID_VALUE;
+    memcpy(stats, &dev->ind_stats, sizeof(dev->ind_stats));
+    return OPERATION_OK;
+}
+
+#if MRF24_PERF
+mrf24_state_t MRF24SetPerfClock(mrf24_dev_t * dev, mrf24_perf_clock_t reloj) {
+
+    dev->perf_reloj = reloj;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24GetPerf(mrf24_dev_t * dev, mrf24_perf_t * perf) {
+
+    if (NULL == perf)
+        return INVALID_VALUE;
+    memcpy(perf, &dev->perf, sizeof(dev->perf));
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24ResetPerf(mrf24_dev_t * dev) {
+
+    memset(&dev->perf, 0, sizeof(dev->perf));
+    return OPERATION_OK;
 }
+#endif
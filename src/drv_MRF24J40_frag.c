@@ -0,0 +1,393 @@
+/**
+ *********************************************************************************
+ * @file    drv_MRF24J40_frag.c
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Implementación de la fragmentación y el reensamblado de mensajes
+ *********************************************************************************
+ */
+
+/* === Archivos cabecera ====================================================== */
+#include <string.h>
+#include "drv_MRF24J40_frag.h"
+#include "app_delay_unlock.h"
+
+/* === Definición de macros privadas ========================================== */
+#define POS_DISPATCH  (0X00)
+#define POS_ETIQUETA  (0X01)
+#define POS_INDICE    (0X02)
+#define POS_ULTIMO    (0X03)
+#define SHIFT_MAPA    (0X03)
+#define MASCARA_MAPA  (0X07)
+#define SIN_FRAGMENTO (-1)
+
+/* === Declaración de funciones privadas ====================================== */
+bool_t LeoMapa(const uint8_t * mapa, uint16_t indice);
+void MarcoMapa(uint8_t * mapa, uint16_t indice, bool_t valor);
+void RecojoResultados(mrf24_frag_t * frag);
+int16_t ProximoFragmento(mrf24_frag_t * frag);
+bool_t EncoloFragmento(mrf24_frag_t * frag);
+void VencoMensajes(mrf24_frag_t * frag);
+mrf24_frag_rx_t * UbicoMensaje(mrf24_frag_t * frag, uint16_t origen, uint8_t etiqueta,
+                               uint8_t ultimo);
+mrf24_frag_rx_t * PrimerCompleto(mrf24_frag_t * frag);
+
+/* === Implementación de funciones privadas =================================== */
+bool_t LeoMapa(const uint8_t * mapa, uint16_t indice) {
+
+    return 0 != (mapa[indice >> SHIFT_MAPA] & (1U << (indice & MASCARA_MAPA)));
+}
+
+void MarcoMapa(uint8_t * mapa, uint16_t indice, bool_t valor) {
+
+    if (valor)
+        mapa[indice >> SHIFT_MAPA] |= (uint8_t)(1U << (indice & MASCARA_MAPA));
+    else
+        mapa[indice >> SHIFT_MAPA] &= (uint8_t)~(1U << (indice & MASCARA_MAPA));
+}
+
+/**
+ * @brief  Recojo el resultado de los fragmentos en vuelo que terminaron.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @return None.
+ *
+ * @note   Un fragmento sin ACK o con el canal ocupado suma un fallo seguido; uno
+ *         descartado de la cola o cuyo resultado ya no está en el driver sólo
+ *         se vuelve a encolar. Un ACK pone los fallos en cero.
+ */
+void RecojoResultados(mrf24_frag_t * frag) {
+
+    for (uint8_t i = 0; i < TX_QUEUE_SIZE; i++) {
+
+        mrf24_tx_result_t resultado;
+        mrf24_tx_handle_t handle = frag->vuelo_handle[i];
+
+        if (VACIO == handle)
+            continue;
+        mrf24_state_t estado = MRF24GetTxStatus(frag->dev, handle, &resultado);
+
+        if (TRANS_IN_PROGRESS == estado)
+            continue;
+        uint8_t indice = frag->vuelo_indice[i];
+
+        frag->vuelo_handle[i] = VACIO;
+        MarcoMapa(frag->tx_en_vuelo, indice, false);
+
+        if (OPERATION_OK == estado && TX_OK == resultado.status) {
+
+            MarcoMapa(frag->tx_ok, indice, true);
+            frag->tx_confirmados++;
+            frag->tx_fallos = 0;
+            continue;
+        }
+
+        if (OPERATION_OK == estado && TX_DROPPED != resultado.status)
+            frag->tx_fallos++;
+        frag->stats.tx_resent++;
+    }
+}
+
+/**
+ * @brief  Busco el primer fragmento sin confirmar que no esté en vuelo.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @return int16_t Índice del fragmento, SIN_FRAGMENTO si no queda ninguno.
+ */
+int16_t ProximoFragmento(mrf24_frag_t * frag) {
+
+    for (uint16_t i = 0; i <= frag->tx_ultimo; i++) {
+
+        if (!LeoMapa(frag->tx_ok, i) && !LeoMapa(frag->tx_en_vuelo, i))
+            return (int16_t)i;
+    }
+    return SIN_FRAGMENTO;
+}
+
+/**
+ * @brief  Encolo en el driver el próximo fragmento pendiente.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @return bool_t false si no queda fragmento, lugar en vuelo o lugar en la cola.
+ *
+ * @note   Los datos se copian del mensaje a la entrada de la cola, detrás de
+ *         la cabecera de fragmento.
+ */
+bool_t EncoloFragmento(mrf24_frag_t * frag) {
+
+    uint8_t lugar = TX_QUEUE_SIZE;
+    int16_t indice = ProximoFragmento(frag);
+
+    for (uint8_t i = 0; i < TX_QUEUE_SIZE && TX_QUEUE_SIZE == lugar; i++) {
+
+        if (VACIO == frag->vuelo_handle[i])
+            lugar = i;
+    }
+
+    if (SIN_FRAGMENTO == indice || TX_QUEUE_SIZE == lugar)
+        return false;
+    uint16_t desde = (uint16_t)indice * FRAG_DATA_SIZE;
+    uint16_t largo = (indice == frag->tx_ultimo) ? frag->tx_largo - desde : FRAG_DATA_SIZE;
+    mrf24_data_out_t salida = {VACIO, frag->tx_destino, VACIO, {0}, FRAG_HEADER_SIZE + largo};
+    mrf24_tx_handle_t handle = VACIO;
+
+    salida.buffer[POS_DISPATCH] = (char)FRAG_DISPATCH;
+    salida.buffer[POS_ETIQUETA] = (char)frag->tx_etiqueta;
+    salida.buffer[POS_INDICE] = (char)indice;
+    salida.buffer[POS_ULTIMO] = (char)frag->tx_ultimo;
+    memcpy(&salida.buffer[FRAG_HEADER_SIZE], &frag->tx_datos[desde], largo);
+    mrf24_state_t estado = MRF24EncolarDato(frag->dev, &salida, &handle);
+
+    if (BUFFER_FULL == estado)
+        return false;
+
+    if (OPERATION_OK != estado) {
+
+        frag->tx_fallos++;
+        return false;
+    }
+
+    frag->vuelo_handle[lugar] = handle;
+    frag->vuelo_indice[lugar] = (uint8_t)indice;
+    MarcoMapa(frag->tx_en_vuelo, (uint16_t)indice, true);
+    frag->stats.tx_fragments++;
+    return true;
+}
+
+/**
+ * @brief  Libero los mensajes que no se completaron a tiempo.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @return None.
+ */
+void VencoMensajes(mrf24_frag_t * frag) {
+
+    for (uint8_t i = 0; i < FRAG_RX_SLOTS; i++) {
+
+        mrf24_frag_rx_t * mensaje = &frag->rx[i];
+
+        if (FRAG_RX_ARMANDO == mensaje->estado && DelayRead(&mensaje->vencimiento)) {
+
+            mensaje->estado = FRAG_RX_LIBRE;
+            frag->stats.rx_timeouts++;
+        }
+    }
+}
+
+/**
+ * @brief  Busco el mensaje al que pertenece un fragmento o le doy un lugar.
+ *
+ * @param  mrf24_frag_t * Puntero a la capa de fragmentación.
+ * @param  uint16_t Dirección de origen.
+ * @param  uint8_t Etiqueta del mensaje.
+ * @param  uint8_t Índice del último fragmento.
+ * @return mrf24_frag_rx_t * Mensaje, NULL si es nuevo y no hay lugar.
+ *
+ * @note   Un mensaje nuevo empieza a contar FRAG_RX_TIMEOUT desde ahora.
+ */
+mrf24_frag_rx_t * UbicoMensaje(mrf24_frag_t * frag, uint16_t origen, uint8_t etiqueta,
+                               uint8_t ultimo) {
+
+    mrf24_frag_rx_t * libre = NULL;
+
+    for (uint8_t i = 0; i < FRAG_RX_SLOTS; i++) {
+
+        mrf24_frag_rx_t * mensaje = &frag->rx[i];
+
+        if (FRAG_RX_LIBRE == mensaje->estado) {
+
+            if (NULL == libre)
+                libre = mensaje;
+        } else if (origen == mensaje->origen && etiqueta == mensaje->etiqueta) {
+
+            return mensaje;
+        }
+    }
+
+    if (NULL == libre)
+        return NULL;
+
+    libre->estado = FRAG_RX_ARMANDO;
+    libre->origen = origen;
+    libre->etiqueta = etiqueta;
+    libre->ultimo = ultimo;
+    libre->recibidos = 0;
+    libre->largo = 0;
+    memset(libre->mapa, 0, sizeof(libre->mapa));
+    DelayInit(&libre->vencimiento, FRAG_RX_TIMEOUT);
+    DelayReset(&libre->vencimiento);
+    return libre;
+}
+
+mrf24_frag_rx_t * PrimerCompleto(mrf24_frag_t * frag) {
+
+    for (uint8_t i = 0; i < FRAG_RX_SLOTS; i++) {
+
+        if (FRAG_RX_COMPLETO == frag->rx[i].estado)
+            return &frag->rx[i];
+    }
+    return NULL;
+}
+
+/* === Implementación de funciones públicas =================================== */
+mrf24_state_t MRF24FragInit(mrf24_frag_t * frag, mrf24_dev_t * dev) {
+
+    if (NULL == frag || NULL == dev)
+        return INVALID_VALUE;
+    memset(frag, 0, sizeof(*frag));
+    frag->dev = dev;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24FragEnviar(mrf24_frag_t * frag, uint16_t destino, const uint8_t * datos,
+                              uint16_t largo) {
+
+    if (NULL == datos)
+        return INVALID_VALUE;
+
+    if (VACIO == destino)
+        return DIRECTION_EMPTY;
+
+    if (VACIO == largo)
+        return BUFFER_EMPTY;
+
+    if (FRAG_MAX_LENGTH < largo)
+        return TO_LONG_MSG;
+
+    if (frag->tx_activo)
+        return TRANS_IN_PROGRESS;
+
+    frag->tx_datos = datos;
+    frag->tx_largo = largo;
+    frag->tx_destino = destino;
+    frag->tx_etiqueta++;
+    frag->tx_ultimo = (uint8_t)((largo - 1) / FRAG_DATA_SIZE);
+    frag->tx_confirmados = 0;
+    frag->tx_fallos = 0;
+    memset(frag->tx_ok, 0, sizeof(frag->tx_ok));
+    memset(frag->tx_en_vuelo, 0, sizeof(frag->tx_en_vuelo));
+    memset(frag->vuelo_handle, VACIO, sizeof(frag->vuelo_handle));
+    frag->tx_activo = true;
+
+    while (EncoloFragmento(frag))
+        continue;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24FragPoll(mrf24_frag_t * frag) {
+
+    VencoMensajes(frag);
+
+    if (!frag->tx_activo)
+        return OPERATION_OK;
+    RecojoResultados(frag);
+
+    if (FRAG_TX_MAX_FAILS <= frag->tx_fallos) {
+
+        frag->tx_activo = false;
+        frag->stats.tx_failed++;
+        return OPERATION_FAIL;
+    }
+
+    if (frag->tx_confirmados > frag->tx_ultimo) {
+
+        frag->tx_activo = false;
+        frag->stats.tx_messages++;
+        return TRANS_COMPLETED;
+    }
+
+    while (EncoloFragmento(frag))
+        continue;
+    return TRANS_IN_PROGRESS;
+}
+
+mrf24_state_t MRF24FragRecibir(mrf24_frag_t * frag, const mrf24_data_in_t * trama) {
+
+    if (NULL == trama || FRAG_HEADER_SIZE > trama->buffer_size ||
+        FRAG_DISPATCH != trama->buffer[POS_DISPATCH])
+        return INVALID_VALUE;
+    uint8_t indice = trama->buffer[POS_INDICE];
+    uint8_t ultimo = trama->buffer[POS_ULTIMO];
+    uint8_t largo = trama->buffer_size - FRAG_HEADER_SIZE;
+    uint32_t desde = (uint32_t)indice * FRAG_DATA_SIZE;
+
+    frag->stats.rx_fragments++;
+
+    if (indice > ultimo || VACIO == largo || (indice < ultimo && FRAG_DATA_SIZE != largo)) {
+
+        frag->stats.rx_invalid++;
+        return OPERATION_FAIL;
+    }
+
+    if ((uint32_t)ultimo * FRAG_DATA_SIZE >= FRAG_RX_MESSAGE_SIZE ||
+        desde + largo > FRAG_RX_MESSAGE_SIZE) {
+
+        frag->stats.rx_no_slot++;
+        return TO_LONG_MSG;
+    }
+
+    VencoMensajes(frag);
+    mrf24_frag_rx_t * mensaje =
+        UbicoMensaje(frag, trama->address, trama->buffer[POS_ETIQUETA], ultimo);
+
+    if (NULL == mensaje) {
+
+        frag->stats.rx_no_slot++;
+        return BUFFER_FULL;
+    }
+
+    if (ultimo != mensaje->ultimo) {
+
+        frag->stats.rx_invalid++;
+        return OPERATION_FAIL;
+    }
+
+    if (FRAG_RX_COMPLETO == mensaje->estado || LeoMapa(mensaje->mapa, indice)) {
+
+        frag->stats.rx_duplicates++;
+        return OPERATION_OK;
+    }
+
+    memcpy(&mensaje->datos[desde], &trama->buffer[FRAG_HEADER_SIZE], largo);
+    MarcoMapa(mensaje->mapa, indice, true);
+    mensaje->recibidos++;
+
+    if (indice == ultimo)
+        mensaje->largo = (uint16_t)(desde + largo);
+
+    if (mensaje->recibidos <= ultimo)
+        return OPERATION_OK;
+
+    mensaje->estado = FRAG_RX_COMPLETO;
+    frag->stats.rx_messages++;
+    return MSG_READ;
+}
+
+mrf24_frag_msg_t * MRF24FragGetMensaje(mrf24_frag_t * frag) {
+
+    mrf24_frag_rx_t * mensaje = PrimerCompleto(frag);
+
+    if (NULL == mensaje)
+        return NULL;
+    frag->mensaje.address = mensaje->origen;
+    frag->mensaje.length = mensaje->largo;
+    frag->mensaje.data = mensaje->datos;
+    return &frag->mensaje;
+}
+
+mrf24_state_t MRF24FragReleaseMensaje(mrf24_frag_t * frag) {
+
+    mrf24_frag_rx_t * mensaje = PrimerCompleto(frag);
+
+    if (NULL == mensaje)
+        return BUFFER_EMPTY;
+    mensaje->estado = FRAG_RX_LIBRE;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24FragGetStats(mrf24_frag_t * frag, mrf24_frag_stats_t * stats) {
+
+    if (NULL == stats)
+        return INVALID_VALUE;
+    memcpy(stats, &frag->stats, sizeof(frag->stats));
+    return OPERATION_OK;
+}
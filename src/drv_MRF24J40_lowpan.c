@@ -0,0 +1,566 @@
+/**
+ *********************************************************************************
+ * @file    drv_MRF24J40_lowpan.c
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Implementación de la compresión 6LoWPAN IPHC y NHC (RFC 6282)
+ *********************************************************************************
+ */
+
+/* === Archivos cabecera ====================================================== */
+#include <string.h>
+#include "drv_MRF24J40_lowpan.h"
+
+/* === Definición de macros privadas ========================================== */
+#define IPHC_DISPATCH      (0X60)
+#define IPHC_MASCARA       (0XE0)
+#define IPHC_SHIFT_TF      (0X03)
+#define IPHC_NH            (0X04)
+#define IPHC_SAC           (0X40)
+#define IPHC_SHIFT_SAM     (0X04)
+#define IPHC_M             (0X08)
+#define IPHC_DAC           (0X04)
+#define IPHC_CID           (0X80)
+#define IPHC_MODO          (0X03)
+#define IPHC_MINIMO        (0X02)
+
+#define TF_COMPLETO        (0X00) /* ECN, DSCP y flow label */
+#define TF_SIN_DSCP        (0X01) /* ECN y flow label */
+#define TF_SIN_FLOW        (0X02) /* ECN y DSCP */
+#define TF_ELIDIDO         (0X03)
+
+#define HLIM_EN_LINEA      (0X00)
+#define HLIM_1             (0X01)
+#define HLIM_64            (0X02)
+#define HLIM_255           (0X03)
+
+#define DIR_EN_LINEA       (0X00)
+#define DIR_64             (0X01)
+#define DIR_16             (0X02)
+#define DIR_ELIDIDA        (0X03)
+
+#define NHC_UDP            (0XF0)
+#define NHC_UDP_MASCARA    (0XF8)
+#define NHC_UDP_CHECKSUM   (0X04)
+#define NHC_PUERTOS_4      (0X03)
+#define NHC_PUERTO_DST_8   (0X01)
+#define NHC_PUERTO_SRC_8   (0X02)
+#define PUERTO_8           (0XF000)
+#define PUERTO_8_MASCARA   (0XFF00)
+#define PUERTO_4           (0XF0B0)
+#define PUERTO_4_MASCARA   (0XFFF0)
+
+#define IPV6_VERSION       (0X60)
+#define IPV6_VERSION_MASK  (0XF0)
+#define POS_LARGO          (0X04)
+#define POS_NEXT           (0X06)
+#define POS_HLIM           (0X07)
+#define POS_ORIGEN         (0X08)
+#define POS_DESTINO        (0X18)
+#define POS_IID            (0X08)
+#define MULTICAST          (0XFF)
+#define MULTICAST_LOCAL    (0X02)
+#define BIT_UL             (0X02)
+#define ECN_SHIFT          (0X06)
+#define DSCP_MASCARA       (0X3F)
+#define FLOW_MASCARA       (0X0F)
+#define LARGO_MAC          (0X08)
+
+/* === Declaración de funciones privadas ====================================== */
+uint16_t LeoU16(const uint8_t * datos);
+void EscriboU16(uint8_t * datos, uint16_t valor);
+bool_t EsCero(const uint8_t * datos, uint8_t largo);
+void IidCorta(uint16_t corta, uint8_t * iid);
+uint8_t ComprimoUnicast(const uint8_t * ip, uint16_t corta, bool_t es_origen, uint8_t * salida,
+                        uint8_t * modo);
+uint8_t ComprimoMulticast(const uint8_t * ip, uint8_t * salida, uint8_t * modo);
+bool_t ExpandoUnicast(uint8_t modo, bool_t contexto, uint16_t corta, const uint8_t * datos,
+                      uint8_t largo, uint8_t * pos, uint8_t * ip);
+bool_t ExpandoMulticast(uint8_t modo, const uint8_t * datos, uint8_t largo, uint8_t * pos,
+                        uint8_t * ip);
+
+/* === Implementación de funciones privadas =================================== */
+uint16_t LeoU16(const uint8_t * datos) {
+
+    return (uint16_t)((datos[0] << 8) | datos[1]);
+}
+
+void EscriboU16(uint8_t * datos, uint16_t valor) {
+
+    datos[0] = (uint8_t)(valor >> 8);
+    datos[1] = (uint8_t)valor;
+}
+
+bool_t EsCero(const uint8_t * datos, uint8_t largo) {
+
+    for (uint8_t i = 0; i < largo; i++) {
+
+        if (VACIO != datos[i])
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief  Armo la IID que corresponde a una dirección corta, 0000:00ff:fe00:XXXX.
+ *
+ * @param  uint16_t Dirección corta.
+ * @param  uint8_t * Donde se escriben los 8 bytes de la IID.
+ * @return None.
+ */
+void IidCorta(uint16_t corta, uint8_t * iid) {
+
+    memset(iid, 0, LARGO_MAC);
+    iid[3] = 0xFF;
+    iid[4] = 0xFE;
+    EscriboU16(&iid[6], corta);
+}
+
+/**
+ * @brief  Comprimo una dirección unicast o la no especificada.
+ *
+ * @param  const uint8_t * Dirección IPv6.
+ * @param  uint16_t Dirección corta de la trama del mismo lado.
+ * @param  bool_t true si es la dirección de origen.
+ * @param  uint8_t * Donde se escriben los bytes en línea.
+ * @param  uint8_t * Donde se devuelve el modo (SAM/DAM), con IPHC_SAC si es
+ *                   la dirección no especificada.
+ * @return uint8_t Bytes escritos.
+ *
+ * @note   La IID sólo se elide si la dirección corta identifica a un nodo; con
+ *         BROADCAST del lado del destino no hay de dónde sacarla.
+ */
+uint8_t ComprimoUnicast(const uint8_t * ip, uint16_t corta, bool_t es_origen, uint8_t * salida,
+                        uint8_t * modo) {
+
+    static const uint8_t prefijo_local[LARGO_MAC] = {0xFE, 0x80, 0, 0, 0, 0, 0, 0};
+    uint8_t iid[LARGO_MAC];
+
+    if (es_origen && EsCero(ip, LOWPAN_IPV6_ADDRESS)) {
+
+        *modo = IPHC_SAC | DIR_EN_LINEA;
+        return 0;
+    }
+
+    if (memcmp(ip, prefijo_local, sizeof(prefijo_local))) {
+
+        *modo = DIR_EN_LINEA;
+        memcpy(salida, ip, LOWPAN_IPV6_ADDRESS);
+        return LOWPAN_IPV6_ADDRESS;
+    }
+    IidCorta(corta, iid);
+
+    if (BROADCAST != corta && !memcmp(&ip[POS_IID], iid, LARGO_MAC)) {
+
+        *modo = DIR_ELIDIDA;
+        return 0;
+    }
+
+    if (!memcmp(&ip[POS_IID], iid, LARGO_MAC - sizeof(corta))) {
+
+        *modo = DIR_16;
+        memcpy(salida, &ip[LOWPAN_IPV6_ADDRESS - sizeof(corta)], sizeof(corta));
+        return sizeof(corta);
+    }
+
+    *modo = DIR_64;
+    memcpy(salida, &ip[POS_IID], LARGO_MAC);
+    return LARGO_MAC;
+}
+
+/**
+ * @brief  Comprimo una dirección multicast de destino.
+ *
+ * @param  const uint8_t * Dirección IPv6.
+ * @param  uint8_t * Donde se escriben los bytes en línea.
+ * @param  uint8_t * Donde se devuelve el modo DAM.
+ * @return uint8_t Bytes escritos.
+ *
+ * @note   ff02::00XX va en 1 byte, ffXX::00XX:XXXX en 4 y ffXX::00XX:XXXX:XXXX
+ *         en 6. El resto va completa.
+ */
+uint8_t ComprimoMulticast(const uint8_t * ip, uint8_t * salida, uint8_t * modo) {
+
+    if (MULTICAST_LOCAL == ip[1] && EsCero(&ip[2], 13)) {
+
+        *modo = DIR_ELIDIDA;
+        salida[0] = ip[15];
+        return 1;
+    }
+
+    if (EsCero(&ip[2], 11)) {
+
+        *modo = DIR_16;
+        salida[0] = ip[1];
+        memcpy(&salida[1], &ip[13], 3);
+        return 4;
+    }
+
+    if (EsCero(&ip[2], 9)) {
+
+        *modo = DIR_64;
+        salida[0] = ip[1];
+        memcpy(&salida[1], &ip[11], 5);
+        return 6;
+    }
+
+    *modo = DIR_EN_LINEA;
+    memcpy(salida, ip, LOWPAN_IPV6_ADDRESS);
+    return LOWPAN_IPV6_ADDRESS;
+}
+
+/**
+ * @brief  Reconstruyo una dirección unicast.
+ *
+ * @param  uint8_t Modo (SAM/DAM).
+ * @param  bool_t Valor de SAC/DAC.
+ * @param  uint16_t Dirección corta de la trama del mismo lado.
+ * @param  const uint8_t * Datos de la trama.
+ * @param  uint8_t Largo de los datos.
+ * @param  uint8_t * Posición de lectura, se avanza.
+ * @param  uint8_t * Donde se escriben los 16 bytes de la dirección.
+ * @return bool_t false si la trama está truncada o usa un contexto.
+ */
+bool_t ExpandoUnicast(uint8_t modo, bool_t contexto, uint16_t corta, const uint8_t * datos,
+                      uint8_t largo, uint8_t * pos, uint8_t * ip) {
+
+    static const uint8_t en_linea[] = {LOWPAN_IPV6_ADDRESS, LARGO_MAC, sizeof(corta), 0};
+    uint8_t bytes = contexto ? 0 : en_linea[modo];
+
+    if (contexto && DIR_EN_LINEA != modo)
+        return false;
+
+    if (*pos + bytes > largo)
+        return false;
+    memset(ip, 0, LOWPAN_IPV6_ADDRESS);
+
+    if (contexto)
+        return true;
+
+    if (DIR_EN_LINEA == modo) {
+
+        memcpy(ip, &datos[*pos], LOWPAN_IPV6_ADDRESS);
+        *pos += bytes;
+        return true;
+    }
+    ip[0] = 0xFE;
+    ip[1] = 0x80;
+    IidCorta(corta, &ip[POS_IID]);
+    memcpy(&ip[LOWPAN_IPV6_ADDRESS - bytes], &datos[*pos], bytes);
+    *pos += bytes;
+    return true;
+}
+
+/**
+ * @brief  Reconstruyo una dirección multicast.
+ *
+ * @param  uint8_t Modo DAM.
+ * @param  const uint8_t * Datos de la trama.
+ * @param  uint8_t Largo de los datos.
+ * @param  uint8_t * Posición de lectura, se avanza.
+ * @param  uint8_t * Donde se escriben los 16 bytes de la dirección.
+ * @return bool_t false si la trama está truncada.
+ */
+bool_t ExpandoMulticast(uint8_t modo, const uint8_t * datos, uint8_t largo, uint8_t * pos,
+                        uint8_t * ip) {
+
+    static const uint8_t en_linea[] = {LOWPAN_IPV6_ADDRESS, 6, 4, 1};
+    uint8_t bytes = en_linea[modo];
+
+    if (*pos + bytes > largo)
+        return false;
+    const uint8_t * fuente = &datos[*pos];
+
+    *pos += bytes;
+    memset(ip, 0, LOWPAN_IPV6_ADDRESS);
+    ip[0] = MULTICAST;
+
+    if (DIR_EN_LINEA == modo) {
+
+        memcpy(ip, fuente, LOWPAN_IPV6_ADDRESS);
+    } else if (DIR_ELIDIDA == modo) {
+
+        ip[1] = MULTICAST_LOCAL;
+        ip[15] = fuente[0];
+    } else {
+
+        ip[1] = fuente[0];
+        memcpy(&ip[LOWPAN_IPV6_ADDRESS - bytes + 1], &fuente[1], bytes - 1);
+    }
+    return true;
+}
+
+/* === Implementación de funciones públicas =================================== */
+mrf24_state_t MRF24LowpanComprimir(const uint8_t * paquete, uint16_t largo, uint16_t origen,
+                                   uint16_t destino, uint8_t * cabecera, uint8_t * largo_cabecera,
+                                   uint16_t * consumidos) {
+
+    if (NULL == paquete || NULL == cabecera || NULL == largo_cabecera || NULL == consumidos)
+        return INVALID_VALUE;
+
+    if (LOWPAN_IPV6_HEADER > largo || IPV6_VERSION != (paquete[0] & IPV6_VERSION_MASK))
+        return INVALID_VALUE;
+    uint16_t carga = LeoU16(&paquete[POS_LARGO]);
+
+    if (LOWPAN_IPV6_HEADER + carga != largo)
+        return INVALID_VALUE;
+    uint8_t clase = (uint8_t)((paquete[0] << 4) | (paquete[1] >> 4));
+    uint32_t flujo = ((uint32_t)(paquete[1] & FLOW_MASCARA) << 16) | LeoU16(&paquete[2]);
+    uint8_t ecn = (uint8_t)((clase & IPHC_MODO) << ECN_SHIFT);
+    uint8_t dscp = clase >> 2;
+    uint8_t siguiente = paquete[POS_NEXT];
+    uint8_t hlim = paquete[POS_HLIM];
+    bool_t udp = LOWPAN_NEXT_UDP == siguiente && LOWPAN_UDP_HEADER <= carga
+                 && carga == LeoU16(&paquete[LOWPAN_IPV6_HEADER + POS_LARGO]);
+    uint8_t pos = IPHC_MINIMO;
+    uint8_t modo;
+
+    cabecera[0] = IPHC_DISPATCH;
+    cabecera[1] = VACIO;
+
+    if (VACIO == flujo && VACIO == clase) {
+
+        cabecera[0] |= TF_ELIDIDO << IPHC_SHIFT_TF;
+    } else if (VACIO == flujo) {
+
+        cabecera[0] |= TF_SIN_FLOW << IPHC_SHIFT_TF;
+        cabecera[pos++] = ecn | dscp;
+    } else if (VACIO == dscp) {
+
+        cabecera[0] |= TF_SIN_DSCP << IPHC_SHIFT_TF;
+        cabecera[pos++] = ecn | (uint8_t)(flujo >> 16);
+        EscriboU16(&cabecera[pos], (uint16_t)flujo);
+        pos += 2;
+    } else {
+
+        cabecera[0] |= TF_COMPLETO << IPHC_SHIFT_TF;
+        cabecera[pos++] = ecn | dscp;
+        cabecera[pos++] = (uint8_t)(flujo >> 16);
+        EscriboU16(&cabecera[pos], (uint16_t)flujo);
+        pos += 2;
+    }
+
+    if (udp)
+        cabecera[0] |= IPHC_NH;
+    else
+        cabecera[pos++] = siguiente;
+
+    if (1 == hlim)
+        cabecera[0] |= HLIM_1;
+    else if (64 == hlim)
+        cabecera[0] |= HLIM_64;
+    else if (255 == hlim)
+        cabecera[0] |= HLIM_255;
+    else
+        cabecera[pos++] = hlim;
+
+    pos += ComprimoUnicast(&paquete[POS_ORIGEN], origen, true, &cabecera[pos], &modo);
+    cabecera[1] |= (uint8_t)((modo & IPHC_SAC) | ((modo & IPHC_MODO) << IPHC_SHIFT_SAM));
+
+    if (MULTICAST == paquete[POS_DESTINO]) {
+
+        pos += ComprimoMulticast(&paquete[POS_DESTINO], &cabecera[pos], &modo);
+        cabecera[1] |= IPHC_M | modo;
+    } else {
+
+        pos += ComprimoUnicast(&paquete[POS_DESTINO], destino, false, &cabecera[pos], &modo);
+        cabecera[1] |= modo;
+    }
+    *consumidos = LOWPAN_IPV6_HEADER;
+
+    if (udp) {
+
+        const uint8_t * cabecera_udp = &paquete[LOWPAN_IPV6_HEADER];
+        uint16_t puerto_origen = LeoU16(&cabecera_udp[0]);
+        uint16_t puerto_destino = LeoU16(&cabecera_udp[2]);
+        uint8_t * nhc = &cabecera[pos++];
+
+        *nhc = NHC_UDP;
+
+        if (PUERTO_4 == (puerto_origen & PUERTO_4_MASCARA)
+            && PUERTO_4 == (puerto_destino & PUERTO_4_MASCARA)) {
+
+            *nhc |= NHC_PUERTOS_4;
+            cabecera[pos++] = (uint8_t)(((puerto_origen & 0x0F) << 4) | (puerto_destino & 0x0F));
+        } else if (PUERTO_8 == (puerto_destino & PUERTO_8_MASCARA)) {
+
+            *nhc |= NHC_PUERTO_DST_8;
+            EscriboU16(&cabecera[pos], puerto_origen);
+            cabecera[pos + 2] = (uint8_t)puerto_destino;
+            pos += 3;
+        } else if (PUERTO_8 == (puerto_origen & PUERTO_8_MASCARA)) {
+
+            *nhc |= NHC_PUERTO_SRC_8;
+            cabecera[pos] = (uint8_t)puerto_origen;
+            EscriboU16(&cabecera[pos + 1], puerto_destino);
+            pos += 3;
+        } else {
+
+            memcpy(&cabecera[pos], cabecera_udp, 4);
+            pos += 4;
+        }
+        memcpy(&cabecera[pos], &cabecera_udp[6], 2);
+        pos += 2;
+        *consumidos += LOWPAN_UDP_HEADER;
+    }
+
+    *largo_cabecera = pos;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24LowpanDescomprimir(const uint8_t * datos, uint8_t largo, uint16_t origen,
+                                      uint16_t destino, uint8_t * paquete, uint16_t tamano,
+                                      uint16_t * largo_paquete) {
+
+    if (NULL == datos || NULL == paquete || NULL == largo_paquete)
+        return INVALID_VALUE;
+
+    if (IPHC_MINIMO > largo || IPHC_DISPATCH != (datos[0] & IPHC_MASCARA))
+        return INVALID_VALUE;
+
+    if (datos[1] & (IPHC_CID | IPHC_DAC))
+        return OPERATION_FAIL;
+    uint8_t tf = (datos[0] >> IPHC_SHIFT_TF) & IPHC_MODO;
+    bool_t nhc = 0 != (datos[0] & IPHC_NH);
+    uint8_t hlim = datos[0] & IPHC_MODO;
+    uint8_t pos = IPHC_MINIMO;
+    uint8_t clase = VACIO;
+    uint32_t flujo = VACIO;
+    uint8_t cabecera[LOWPAN_IPV6_HEADER + LOWPAN_UDP_HEADER];
+    static const uint8_t largo_tf[] = {4, 3, 1, 0};
+    static const uint8_t valor_hlim[] = {VACIO, 1, 64, 255};
+
+    if (pos + largo_tf[tf] + !nhc + (HLIM_EN_LINEA == hlim) > largo)
+        return OPERATION_FAIL;
+
+    if (TF_ELIDIDO != tf) {
+
+        uint8_t ecn = datos[pos] >> ECN_SHIFT;
+
+        clase = ecn;
+
+        if (TF_SIN_DSCP != tf)
+            clase |= (uint8_t)((datos[pos] & DSCP_MASCARA) << 2);
+
+        if (TF_COMPLETO == tf)
+            pos++;
+
+        if (TF_SIN_FLOW != tf)
+            flujo = ((uint32_t)(datos[pos] & FLOW_MASCARA) << 16) | LeoU16(&datos[pos + 1]);
+        pos += (TF_SIN_FLOW == tf) ? 1 : 3;
+    }
+    cabecera[0] = IPV6_VERSION | (clase >> 4);
+    cabecera[1] = (uint8_t)((clase << 4) | (flujo >> 16));
+    EscriboU16(&cabecera[2], (uint16_t)flujo);
+    cabecera[POS_NEXT] = nhc ? LOWPAN_NEXT_UDP : datos[pos++];
+    cabecera[POS_HLIM] = (HLIM_EN_LINEA == hlim) ? datos[pos++] : valor_hlim[hlim];
+
+    if (!ExpandoUnicast((datos[1] >> IPHC_SHIFT_SAM) & IPHC_MODO, 0 != (datos[1] & IPHC_SAC),
+                        origen, datos, largo, &pos, &cabecera[POS_ORIGEN]))
+        return OPERATION_FAIL;
+
+    if (datos[1] & IPHC_M) {
+
+        if (!ExpandoMulticast(datos[1] & IPHC_MODO, datos, largo, &pos, &cabecera[POS_DESTINO]))
+            return OPERATION_FAIL;
+    } else if (!ExpandoUnicast(datos[1] & IPHC_MODO, false, destino, datos, largo, &pos,
+                               &cabecera[POS_DESTINO])) {
+
+        return OPERATION_FAIL;
+    }
+    uint8_t largo_cabecera = LOWPAN_IPV6_HEADER;
+
+    if (nhc) {
+
+        static const uint8_t largo_puertos[] = {4, 3, 3, 1};
+        uint8_t * cabecera_udp = &cabecera[LOWPAN_IPV6_HEADER];
+
+        if (pos >= largo || NHC_UDP != (datos[pos] & NHC_UDP_MASCARA)
+            || (datos[pos] & NHC_UDP_CHECKSUM))
+            return OPERATION_FAIL;
+        uint8_t puertos = datos[pos++] & IPHC_MODO;
+
+        if (pos + largo_puertos[puertos] + 2 > largo)
+            return OPERATION_FAIL;
+
+        if (NHC_PUERTOS_4 == puertos) {
+
+            EscriboU16(&cabecera_udp[0], PUERTO_4 | (datos[pos] >> 4));
+            EscriboU16(&cabecera_udp[2], PUERTO_4 | (datos[pos] & 0x0F));
+        } else if (NHC_PUERTO_DST_8 == puertos) {
+
+            memcpy(cabecera_udp, &datos[pos], 2);
+            EscriboU16(&cabecera_udp[2], PUERTO_8 | datos[pos + 2]);
+        } else if (NHC_PUERTO_SRC_8 == puertos) {
+
+            EscriboU16(&cabecera_udp[0], PUERTO_8 | datos[pos]);
+            memcpy(&cabecera_udp[2], &datos[pos + 1], 2);
+        } else {
+
+            memcpy(cabecera_udp, &datos[pos], 4);
+        }
+        pos += largo_puertos[puertos];
+        memcpy(&cabecera_udp[6], &datos[pos], 2);
+        pos += 2;
+        EscriboU16(&cabecera_udp[POS_LARGO], (uint16_t)(LOWPAN_UDP_HEADER + largo - pos));
+        largo_cabecera += LOWPAN_UDP_HEADER;
+    }
+    uint16_t total = (uint16_t)(largo_cabecera + largo - pos);
+
+    if (total > tamano)
+        return BUFFER_FULL;
+    EscriboU16(&cabecera[POS_LARGO], (uint16_t)(total - LOWPAN_IPV6_HEADER));
+    memcpy(paquete, cabecera, largo_cabecera);
+    memcpy(&paquete[largo_cabecera], &datos[pos], largo - pos);
+    *largo_paquete = total;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24LowpanEnviar(mrf24_dev_t * dev, uint16_t destino, const uint8_t * paquete,
+                                uint16_t largo) {
+
+    uint8_t cabecera[LOWPAN_MAX_HEADER];
+    uint8_t largo_cabecera;
+    uint16_t consumidos;
+    mrf24_state_t estado = MRF24LowpanComprimir(paquete, largo, dev->config.address, destino,
+                                                cabecera, &largo_cabecera, &consumidos);
+
+    if (OPERATION_OK != estado)
+        return estado;
+
+    if (MAX_PAYLOAD_SIZE < largo_cabecera + largo - consumidos)
+        return TO_LONG_MSG;
+    mrf24_segment_t segmentos[] = {{cabecera, largo_cabecera},
+                                   {&paquete[consumidos], (uint8_t)(largo - consumidos)}};
+
+    return MRF24TransmitirSegmentos(dev, VACIO, destino, segmentos, 2);
+}
+
+mrf24_state_t MRF24LowpanRecibir(mrf24_dev_t * dev, const mrf24_data_in_t * trama,
+                                 uint8_t * paquete, uint16_t tamano, uint16_t * largo) {
+
+    if (NULL == trama)
+        return INVALID_VALUE;
+
+    return MRF24LowpanDescomprimir(trama->buffer, trama->buffer_size, trama->address,
+                                   dev->config.address, paquete, tamano, largo);
+}
+
+mrf24_state_t MRF24LowpanDireccionLocal(mrf24_dev_t * dev, bool_t desde_mac, uint8_t * direccion) {
+
+    if (NULL == direccion)
+        return INVALID_VALUE;
+    memset(direccion, 0, LOWPAN_IPV6_ADDRESS);
+    direccion[0] = 0xFE;
+    direccion[1] = 0x80;
+
+    if (!desde_mac) {
+
+        IidCorta(dev->config.address, &direccion[POS_IID]);
+        return OPERATION_OK;
+    }
+
+    for (uint8_t i = 0; i < LARGO_MAC; i++)
+        direccion[POS_IID + i] = dev->config.mac[LARGO_MAC - 1 - i];
+    direccion[POS_IID] ^= BIT_UL;
+    return OPERATION_OK;
+}
@@ -0,0 +1,233 @@
+/**
+ *********************************************************************************
+ * @file    drv_MRF24J40_pcap.c
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Implementación de la captura pcap con doble buffer
+ *********************************************************************************
+ */
+
+/* === Archivos cabecera ====================================================== */
+#include <string.h>
+#include "drv_MRF24J40_pcap.h"
+
+/* === Definición de macros privadas ========================================== */
+#define PCAP_MAGIC         (0XA1B2C3D4) /* marcas de tiempo en microsegundos */
+#define PCAP_VERSION_MAJOR (0X0002)
+#define PCAP_VERSION_MINOR (0X0004)
+#define US_POR_SEGUNDO     (1000000U)
+#define RSSI_MAXIMO        (255.0f)
+#define CANAL_BASE         (11)
+#define SHIFT_CANAL        (0X04)
+#define TAP_VERSION        (0X00)
+#define TAP_TLV_HEADER     (0X04)
+#define TLV_FCS_TYPE       (0X0000)
+#define TLV_RSS            (0X0001)
+#define TLV_CHANNEL        (0X0003)
+#define TLV_LQI            (0X000A)
+#define FCS_16_BITS        (0X01)
+#define LARGO_FCS_TYPE     (0X01)
+#define LARGO_RSS          (0X04)
+#define LARGO_CHANNEL      (0X03)
+#define LARGO_LQI          (0X01)
+#define PAGINA_2450MHZ     (0X00)
+
+/* === Declaración de funciones privadas ====================================== */
+uint16_t AnotoU16(uint8_t * datos, uint16_t valor);
+uint16_t AnotoU32(uint8_t * datos, uint32_t valor);
+uint16_t AnotoTlv(uint8_t * datos, uint16_t tipo, const uint8_t * valor, uint16_t largo);
+uint16_t AnotoTap(mrf24_pcap_t * pcap, uint8_t * datos, const mrf24_data_in_t * trama);
+mrf24_pcap_buffer_t * BufferConLugar(mrf24_pcap_t * pcap, uint16_t largo);
+mrf24_state_t EscriboBuffer(mrf24_pcap_t * pcap, mrf24_pcap_buffer_t * buffer);
+
+/* === Implementación de funciones privadas =================================== */
+uint16_t AnotoU16(uint8_t * datos, uint16_t valor) {
+
+    datos[0] = (uint8_t)valor;
+    datos[1] = (uint8_t)(valor >> 8);
+    return 2;
+}
+
+uint16_t AnotoU32(uint8_t * datos, uint32_t valor) {
+
+    AnotoU16(datos, (uint16_t)valor);
+    AnotoU16(&datos[2], (uint16_t)(valor >> 16));
+    return 4;
+}
+
+/**
+ * @brief  Escribo un TLV de la cabecera TAP, con el relleno hasta múltiplo de 4.
+ *
+ * @param  uint8_t * Donde se escribe el TLV.
+ * @param  uint16_t Tipo.
+ * @param  const uint8_t * Valor.
+ * @param  uint16_t Largo del valor, sin relleno.
+ * @return uint16_t Bytes del TLV completo.
+ */
+uint16_t AnotoTlv(uint8_t * datos, uint16_t tipo, const uint8_t * valor, uint16_t largo) {
+
+    uint16_t completo = TAP_TLV_HEADER + ((largo + 3) & (uint16_t)~3);
+    memset(datos, VACIO, completo);
+    AnotoU16(datos, tipo);
+    AnotoU16(&datos[2], largo);
+    memcpy(&datos[TAP_TLV_HEADER], valor, largo);
+    return completo;
+}
+
+/**
+ * @brief  Escribo la cabecera TAP de una trama.
+ *
+ * @param  mrf24_pcap_t * Puntero a la captura.
+ * @param  uint8_t * Donde se escribe, PCAP_TAP_HEADER bytes.
+ * @param  const mrf24_data_in_t * Trama.
+ * @return uint16_t Bytes escritos.
+ *
+ * @note   El RSS del TAP es un float en dBm, que sale de la recta entre
+ *         PCAP_RSSI_DBM_MIN y PCAP_RSSI_DBM_MAX.
+ */
+uint16_t AnotoTap(mrf24_pcap_t * pcap, uint8_t * datos, const mrf24_data_in_t * trama) {
+
+    const uint8_t fcs = FCS_16_BITS;
+    uint8_t valor[LARGO_RSS];
+    uint32_t bits = 0;
+    uint16_t pos = 0;
+    float dbm = PCAP_RSSI_DBM_MIN +
+                trama->rssi * (PCAP_RSSI_DBM_MAX - PCAP_RSSI_DBM_MIN) / RSSI_MAXIMO;
+    memcpy(&bits, &dbm, sizeof(bits));
+
+    datos[pos++] = TAP_VERSION;
+    datos[pos++] = VACIO;
+    pos += AnotoU16(&datos[pos], PCAP_TAP_HEADER);
+    pos += AnotoTlv(&datos[pos], TLV_FCS_TYPE, &fcs, LARGO_FCS_TYPE);
+    AnotoU32(valor, bits);
+    pos += AnotoTlv(&datos[pos], TLV_RSS, valor, LARGO_RSS);
+    AnotoU16(valor, pcap->canal);
+    valor[2] = PAGINA_2450MHZ;
+    pos += AnotoTlv(&datos[pos], TLV_CHANNEL, valor, LARGO_CHANNEL);
+    pos += AnotoTlv(&datos[pos], TLV_LQI, &trama->lqi, LARGO_LQI);
+    return pos;
+}
+
+/**
+ * @brief  Busco lugar para un registro, pasando al otro buffer si hace falta.
+ *
+ * @param  mrf24_pcap_t * Puntero a la captura.
+ * @param  uint16_t Largo del registro.
+ * @return mrf24_pcap_buffer_t * Buffer donde entra, NULL si los dos están llenos.
+ */
+mrf24_pcap_buffer_t * BufferConLugar(mrf24_pcap_t * pcap, uint16_t largo) {
+
+    mrf24_pcap_buffer_t * buffer = &pcap->buffers[pcap->activo];
+
+    if (buffer->largo + largo <= PCAP_BUFFER_SIZE)
+        return buffer;
+    mrf24_pcap_buffer_t * otro = &pcap->buffers[pcap->activo ^ 1];
+
+    if (otro->lleno)
+        return NULL;
+    buffer->lleno = true;
+    pcap->activo ^= 1;
+    return otro;
+}
+
+/**
+ * @brief  Entrego un buffer a la función de escritura y lo dejo vacío.
+ *
+ * @param  mrf24_pcap_t * Puntero a la captura.
+ * @param  mrf24_pcap_buffer_t * Buffer.
+ * @return mrf24_state_t Estado de la operación (OPERATION_OK, OPERATION_FAIL).
+ */
+mrf24_state_t EscriboBuffer(mrf24_pcap_t * pcap, mrf24_pcap_buffer_t * buffer) {
+
+    mrf24_state_t estado = OPERATION_OK;
+
+    if (pcap->escribir(pcap->ctx, buffer->datos, buffer->largo)) {
+
+        pcap->stats.bytes += buffer->largo;
+        pcap->stats.flushes++;
+    } else {
+
+        pcap->stats.write_errors++;
+        estado = OPERATION_FAIL;
+    }
+    buffer->largo = 0;
+    buffer->lleno = false;
+    return estado;
+}
+
+/* === Implementación de funciones públicas =================================== */
+mrf24_state_t MRF24PcapInit(mrf24_pcap_t * pcap, channel_list_t canal, mrf24_pcap_write_t escribir,
+                            void * ctx) {
+
+    if (NULL == pcap || NULL == escribir || CH_11 > canal || CH_26 < canal)
+        return INVALID_VALUE;
+    memset(pcap, 0, sizeof(*pcap));
+    pcap->escribir = escribir;
+    pcap->ctx = ctx;
+    pcap->canal = CANAL_BASE + ((canal - CH_11) >> SHIFT_CANAL);
+
+    uint8_t * datos = pcap->buffers[0].datos;
+    uint16_t pos = AnotoU32(datos, PCAP_MAGIC);
+    pos += AnotoU16(&datos[pos], PCAP_VERSION_MAJOR);
+    pos += AnotoU16(&datos[pos], PCAP_VERSION_MINOR);
+    pos += AnotoU32(&datos[pos], VACIO);
+    pos += AnotoU32(&datos[pos], VACIO);
+    pos += AnotoU32(&datos[pos], PCAP_TAP_HEADER + PCAP_MAX_FRAME);
+    pos += AnotoU32(&datos[pos], PCAP_LINKTYPE);
+    pcap->buffers[0].largo = pos;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24PcapAgregar(mrf24_pcap_t * pcap, const mrf24_data_in_t * trama) {
+
+    if (NULL == pcap || NULL == trama || PCAP_MAX_FRAME < trama->buffer_size)
+        return INVALID_VALUE;
+    uint16_t largo = PCAP_TAP_HEADER + trama->buffer_size;
+    mrf24_pcap_buffer_t * buffer = BufferConLugar(pcap, PCAP_RECORD_HEADER + largo);
+
+    if (NULL == buffer) {
+
+        pcap->stats.dropped++;
+        return BUFFER_FULL;
+    }
+
+    if (trama->timestamp < pcap->ultimo_us)
+        pcap->vueltas++;
+    pcap->ultimo_us = trama->timestamp;
+    uint64_t us = ((uint64_t)pcap->vueltas << 32) | trama->timestamp;
+
+    uint8_t * datos = &buffer->datos[buffer->largo];
+    uint16_t pos = AnotoU32(datos, (uint32_t)(us / US_POR_SEGUNDO));
+    pos += AnotoU32(&datos[pos], (uint32_t)(us % US_POR_SEGUNDO));
+    pos += AnotoU32(&datos[pos], largo);
+    pos += AnotoU32(&datos[pos], largo);
+    pos += AnotoTap(pcap, &datos[pos], trama);
+    memcpy(&datos[pos], trama->buffer, trama->buffer_size);
+    buffer->largo += PCAP_RECORD_HEADER + largo;
+    pcap->stats.frames++;
+    return OPERATION_OK;
+}
+
+mrf24_state_t MRF24PcapVolcar(mrf24_pcap_t * pcap, bool_t parcial) {
+
+    mrf24_state_t estado = BUFFER_EMPTY;
+
+    if (NULL == pcap)
+        return INVALID_VALUE;
+    mrf24_pcap_buffer_t * lleno = &pcap->buffers[pcap->activo ^ 1];
+
+    if (lleno->lleno)
+        estado = EscriboBuffer(pcap, lleno);
+    mrf24_pcap_buffer_t * activo = &pcap->buffers[pcap->activo];
+
+    if (parcial && VACIO != activo->largo && OPERATION_FAIL != estado)
+        estado = EscriboBuffer(pcap, activo);
+    return estado;
+}
+
+mrf24_state_t MRF24PcapGetStats(mrf24_pcap_t * pcap, mrf24_pcap_stats_t * stats) {
+
+    if (NULL == pcap || NULL == stats)
+        return INVALID_VALUE;
+    memcpy(stats, &pcap->stats, sizeof(pcap->stats));
+    return OPERATION_OK;
+}
@@ -0,0 +1,110 @@
+/**
+ *********************************************************************************
+ * @file    mrf24j40_fixture.c
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Base común de los tests que corren el driver sobre el modelo
+ *********************************************************************************
+ */
+
+/* === Archivos cabecera ====================================================== */
+#include <string.h>
+#include "mrf24j40_fixture.h"
+
+/* === Definición de variables privadas ======================================= */
+static mrf24_sim_medio_t * medio_fixture;
+static mrf24_dev_t * nodos_fixture[SIM_MAX_NODES];
+static uint8_t cantidad_fixture;
+
+/* === Declaración de funciones privadas ====================================== */
+static tick_t LeoReloj(void);
+
+/* === Implementación de funciones del delay ================================== */
+/*
+ * Los tiempos del driver se miden en milisegundos del reloj virtual, así que
+ * avanzan sólo cuando el test avanza el medio.
+ */
+void DelayInit(delayNoBloqueanteData_t * delay, tick_t duration) {
+
+    delay->duration = duration;
+    delay->running = false;
+}
+
+bool_t DelayRead(delayNoBloqueanteData_t * delay) {
+
+    if (!delay->running) {
+
+        DelayReset(delay);
+        return false;
+    }
+
+    if (LeoReloj() - delay->startTime < delay->duration)
+        return false;
+
+    delay->running = false;
+    return true;
+}
+
+void DelayWrite(delayNoBloqueanteData_t * delay, tick_t duration) {
+
+    delay->duration = duration;
+}
+
+void DelayReset(delayNoBloqueanteData_t * delay) {
+
+    delay->startTime = LeoReloj();
+    delay->running = true;
+}
+
+/* === Implementación de funciones privadas =================================== */
+static tick_t LeoReloj(void) {
+
+    return (tick_t)(MRF24SimGetTiempoUs(medio_fixture) / 1000);
+}
+
+/* === Implementación de funciones públicas =================================== */
+void MRF24FixtureInit(mrf24_sim_medio_t * medio) {
+
+    medio_fixture = medio;
+    cantidad_fixture = 0;
+    MRF24SimMedioInit(medio);
+}
+
+void MRF24FixturePrepararNodo(mrf24_dev_t * nodo, mrf24_sim_t * sim, uint16_t direccion,
+                              mrf24_fixture_config_t configurar) {
+
+    mrf24_port_t port;
+
+    memset(nodo, 0, sizeof(*nodo));
+    MRF24SimInit(sim, medio_fixture, &port);
+    MRF24SetChannel(nodo, FIXTURE_CANAL);
+    MRF24SetPanId(nodo, FIXTURE_PANID);
+    MRF24SetAdd(nodo, direccion);
+
+    if (NULL != configurar)
+        configurar(nodo);
+    MRF24J40Init(nodo, &port);
+    nodos_fixture[cantidad_fixture++] = nodo;
+}
+
+mrf24_state_t MRF24FixtureEsperarInicio(void) {
+
+    mrf24_state_t estado = INIT_IN_PROGRESS;
+
+    for (uint16_t vuelta = 0; vuelta < FIXTURE_MAX_VUELTAS; vuelta++) {
+
+        estado = INIT_OK;
+
+        for (uint8_t i = 0; i < cantidad_fixture; i++) {
+
+            mrf24_state_t nodo = MRF24Poll(nodos_fixture[i]);
+
+            if (INIT_OK != nodo)
+                estado = nodo;
+        }
+
+        if (INIT_IN_PROGRESS != estado)
+            break;
+        MRF24SimAvanzar(medio_fixture, FIXTURE_PASO_US);
+    }
+    return estado;
+}
@@ -0,0 +1,72 @@
+/**
+ *********************************************************************************
+ * @file    mrf24j40_fixture.h
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Base común de los tests que corren el driver sobre el modelo
+ *********************************************************************************
+ * @attention Implementa el delay no bloqueante de app_delay_unlock.h sobre el
+ *            reloj virtual del medio, así que los tests que la usan no lo
+ *            simulan con mocks. También levanta los nodos en el canal y el PAN
+ *            de la red de prueba y espera a que terminen de inicializarse.
+ *********************************************************************************
+ */
+#ifndef TEST_SUPPORT_MRF24J40_FIXTURE_H_
+#define TEST_SUPPORT_MRF24J40_FIXTURE_H_
+
+/* === Archivos cabecera ====================================================== */
+#include "drv_MRF24J40.h"
+#include "mrf24j40_sim.h"
+
+/* === Definición de macros públicas ========================================== */
+#define FIXTURE_PANID       (0x1234)
+#define FIXTURE_CANAL       CH_15
+#define FIXTURE_MAX_VUELTAS 500
+#define FIXTURE_PASO_US     1000
+
+/* === Declaración de tipo de datos públicos ================================== */
+/**
+ * @brief Configuración propia de un test que se aplica a un nodo antes de
+ *        inicializarlo, por ejemplo la escucha de bajo consumo.
+ */
+typedef void (*mrf24_fixture_config_t)(mrf24_dev_t * nodo);
+
+/* === Declaración de funciones públicas ====================================== */
+/**
+ * @brief  Inicializo el medio y lo tomo como reloj del delay no bloqueante.
+ *
+ * @param  mrf24_sim_medio_t * Puntero al medio.
+ * @return None.
+ *
+ * @note   Se llama desde setUp, antes de preparar los nodos. Olvida los nodos
+ *         del test anterior.
+ */
+void MRF24FixtureInit(mrf24_sim_medio_t * medio);
+
+/**
+ * @brief  Preparo un nodo de la red de prueba y arranco su inicialización.
+ *
+ * @param  mrf24_dev_t * Puntero al módulo.
+ * @param  mrf24_sim_t * Modelo del módulo, se conecta al medio de
+ *                       MRF24FixtureInit.
+ * @param  uint16_t Dirección corta del nodo.
+ * @param  mrf24_fixture_config_t Configuración propia del test, NULL si no
+ *                                tiene.
+ * @return None.
+ *
+ * @note   Entran hasta SIM_MAX_NODES nodos, los que atiende
+ *         MRF24FixtureEsperarInicio.
+ */
+void MRF24FixturePrepararNodo(mrf24_dev_t * nodo, mrf24_sim_t * sim, uint16_t direccion,
+                              mrf24_fixture_config_t configurar);
+
+/**
+ * @brief  Atiendo los nodos preparados hasta que terminen de inicializarse.
+ *
+ * @return mrf24_state_t INIT_OK si todos se inicializaron, si no el estado del
+ *         último que no lo hizo.
+ *
+ * @note   Se rinde a las FIXTURE_MAX_VUELTAS vueltas de FIXTURE_PASO_US.
+ */
+mrf24_state_t MRF24FixtureEsperarInicio(void);
+
+#endif /* TEST_SUPPORT_MRF24J40_FIXTURE_H_ */
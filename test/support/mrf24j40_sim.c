@@ -0,0 +1,1416 @@
+/**
+ *********************************************************************************
+ * @file    mrf24j40_sim.c
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Modelo del MRF24J40 para correr el driver en la PC
+ *********************************************************************************
+ * @attention Modela lo que el driver usa del módulo: la decodificación de los
+ *            comandos SPI, los registros cortos y largos, las FIFOs, INTSTAT y
+ *            el pin de interrupción y los tiempos de reset. El aire es un
+ *            único dominio de colisión con CSMA-CA no ranurado, ACK,
+ *            reintentos y pérdidas por enlace; todo avanza con el reloj
+ *            virtual del medio. El sleep con el temporizador (MAINCNT) y el
+ *            despertar con REGWAKE también, con el reloj de sleep que mide
+ *            SLPCAL. Con ORDER se modela la supertrama: el coordinador manda
+ *            el beacon de su FIFO en cada intervalo y quien lo sigue se
+ *            sincroniza al recibirlo; la FIFO normal sólo sale dentro del CAP
+ *            (si no entra, el CSMA-CA vuelve a empezar en el próximo) y las
+ *            de GTS salen sin contención al comienzo de su GTS. El ACK de un
+ *            pedido de datos lleva trama pendiente si quien lo recibe tiene
+ *            DRPACK. La seguridad por hardware no está modelada.
+ *********************************************************************************
+ */
+
+/* === Archivos cabecera ====================================================== */
+#include <string.h>
+#include "mrf24j40_sim.h"
+#include "drv_MRF24J40_registers.h"
+
+/* === Definición de macros privadas ========================================== */
+#define LONG_COMMAND     (0x80)
+#define LONG_WRITE       (0x10)
+#define SHORT_WRITE      (0x01)
+#define SHIFT_LONG_HIGH  (0x03)
+#define SHIFT_LONG_LOW   (0x05)
+#define SHORT_MASK       (0x3F)
+#define TX_FIFO          (0x000)
+#define LONG_CONTROL_END (0x280)
+#define TX_FIFO_HEADER   (0x02)
+#define FCS_LENGTH       (0x02)
+#define MAX_FRAME_LENGTH (0x7F)
+#define FRAME_TYPE_MASK  (0x07)
+#define ADDR_MODE_MASK   (0x0C)
+#define BROADCAST        (0xFFFF)
+#define SHR_PHR_BYTES    6 // preámbulo, SFD y largo
+#define ACK_BYTES        (SHR_PHR_BYTES + 5)
+#define ACK_FRAME_LENGTH 3 // frame control y número de secuencia, sin FCS
+#define NS_BYTE_250KBPS  32000
+#define NS_BYTE_TURBO    12800
+#define NS_RESET         2000000 // el módulo pide 2 ms después del reset
+#define NS_RF_RESET      192000
+#define NS_SOFT_RESET    10000
+#define NS_BACKOFF       320000 // 20 símbolos
+#define NS_CCA           128000 // 8 símbolos
+#define NS_TURNAROUND    192000 // 12 símbolos
+#define NS_ACK_WAIT      864000 // 54 símbolos
+#define MIN_BE           3
+#define MAX_BE           5
+#define MAX_CSMA_BACKOFFS 4
+#define MAX_FRAME_RETRIES 3
+#define SHIFT_TXNRETRY   6
+#define SEMILLA_DEFECTO  (0x2545F491)
+#define CHANNEL_SHIFT    4
+#define CANAL(sim)       ((sim)->largos[RFCON0] >> CHANNEL_SHIFT)
+#define NUNCA            UINT64_MAX
+#define SLPCAL_NS_CICLO  50
+#define SLPCAL_PERIODOS  16
+#define SHIFT_WAKECNT    4
+#define NS_SUPERTRAMA    15360000 // 960 símbolos
+#define NS_SLOT          960000   // 60 símbolos
+#define SHIFT_ORDER      4
+#define NIBBLE           0x0F
+#define ORDER_SIN_BEACON 15
+#define SHIFT_TXGSLOT    3
+#define TXGSLOT_MASK     0x07
+#define SHIFT_TXGRETRY   6
+#define MHR_MIN_LENGTH   3
+#define DATA_REQUEST     (0x04)
+
+/* === Declaración de funciones privadas ====================================== */
+static void ReinicioRegistros(mrf24_sim_t * sim, uint64_t listo_ns);
+static uint8_t LeoRegistro(mrf24_sim_t * sim);
+static void EscriboRegistro(mrf24_sim_t * sim, uint8_t valor);
+static void ProcesoByte(mrf24_sim_t * sim, uint8_t * dato, bool_t lectura);
+static bool_t AceptoTrama(const mrf24_sim_t * sim, const uint8_t * trama, uint8_t largo);
+static bool_t CargoTramaRx(mrf24_sim_t * sim, const uint8_t * trama, uint8_t largo);
+static uint64_t Escalo(const mrf24_sim_t * sim, uint64_t ns);
+static uint32_t Sorteo(mrf24_sim_medio_t * medio);
+static bool_t MismoCanal(const mrf24_sim_t * a, const mrf24_sim_t * b);
+static bool_t CanalOcupado(const mrf24_sim_t * sim);
+static void ProgramoBackoff(mrf24_sim_t * sim);
+static void ComienzoCsma(mrf24_sim_t * sim);
+static void TerminoTx(mrf24_sim_t * sim, uint8_t txstat);
+static uint64_t Aire(const mrf24_sim_t * sim, uint8_t largo);
+static bool_t MarcoColisiones(mrf24_sim_t * sim);
+static void SaloAlAire(mrf24_sim_t * sim);
+static bool_t PedidoDatos(const uint8_t * trama, uint8_t largo);
+static bool_t EntregoTrama(mrf24_sim_t * sim, uint16_t fifo, uint8_t largo, bool_t colision);
+static void EntregoAck(mrf24_sim_t * sim, uint16_t fifo);
+static bool_t EnSupertrama(const mrf24_sim_t * sim);
+static uint64_t Intervalo(const mrf24_sim_t * sim);
+static uint64_t Slot(const mrf24_sim_t * sim);
+static uint64_t InicioSupertrama(const mrf24_sim_t * sim);
+static uint8_t FinSlot(const mrf24_sim_t * sim, uint8_t numero);
+static uint64_t ProximoCap(const mrf24_sim_t * sim);
+static void SigoBeacon(mrf24_sim_t * sim, const uint8_t * trama, uint8_t largo, uint64_t aire);
+static void SaleBeacon(mrf24_sim_t * sim);
+static void ProgramoGts(mrf24_sim_t * sim);
+static void TerminoGts(mrf24_sim_t * sim, bool_t fallo, bool_t sin_lugar);
+static void AvanzoGts(mrf24_sim_t * sim);
+static uint64_t PeriodoSleep(const mrf24_sim_t * sim, uint64_t ciclos);
+static void Duermo(mrf24_sim_t * sim);
+static void Despierto(mrf24_sim_t * sim);
+static uint64_t ProximoEvento(const mrf24_sim_t * sim);
+static void AtiendoEvento(mrf24_sim_t * sim);
+static void AvanzoHasta(mrf24_sim_medio_t * medio, uint64_t hasta);
+static void Transmito(mrf24_sim_t * sim, bool_t espero_ack);
+
+static void SimInitPins(void * ctx);
+static void SimSetCS(void * ctx, bool_t estado);
+static void SimSetWake(void * ctx, bool_t estado);
+static void SimSetReset(void * ctx, bool_t estado);
+static bool_t SimIsInterrupt(void * ctx);
+static spi_state_t SimWriteByte(void * ctx, uint8_t * dato);
+static spi_state_t SimWrite2Bytes(void * ctx, uint16_t * dato);
+static spi_state_t SimWriteBlock(void * ctx, const uint8_t * datos, uint16_t largo);
+static spi_state_t SimReadByte(void * ctx, uint8_t * respuesta);
+static spi_state_t SimReadBlock(void * ctx, uint8_t * datos, uint16_t largo);
+
+/* === Implementación de funciones privadas =================================== */
+/**
+ * @brief  Llevo los registros a su valor de reset.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @param  uint64_t Instante en el que la radio queda lista para recibir.
+ * @return None.
+ *
+ * @note   Las FIFOs no se borran, igual que en el módulo.
+ */
+static void ReinicioRegistros(mrf24_sim_t * sim, uint64_t listo_ns) {
+
+    memset(sim->cortos, VACIO, sizeof(sim->cortos));
+    memset(&sim->largos[RFCON0], VACIO, LONG_CONTROL_END - RFCON0);
+    sim->cortos[MRFINTCON] = 0xFF;
+    sim->rx_ocupado = false;
+    sim->rf_listo_ns = listo_ns;
+    sim->tx_fase = SIM_TX_LIBRE;
+    sim->evento_ns = NUNCA;
+    sim->slpcal_listo_ns = NUNCA;
+    sim->dormido = false;
+    sim->despertar_ns = NUNCA;
+    sim->cortos[ORDER] = 0xFF;
+    sim->supertrama_ns = NUNCA;
+    sim->beacon_ns = NUNCA;
+    sim->beacon_dur_ns = VACIO;
+    sim->gts_fase = SIM_TX_LIBRE;
+    sim->gts_evento_ns = NUNCA;
+    sim->gts_pendientes = VACIO;
+}
+
+/**
+ * @brief  Leo el registro direccionado, con los efectos de una lectura por SPI.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @return uint8_t Valor leído.
+ */
+static uint8_t LeoRegistro(mrf24_sim_t * sim) {
+
+    uint64_t ahora = sim->medio->tiempo_ns;
+    uint8_t valor = VACIO;
+
+    if (!sim->comando_largo) {
+
+        valor = sim->cortos[sim->direccion];
+
+        if (INTSTAT == sim->direccion)
+            sim->cortos[INTSTAT] = VACIO;
+        else if (SOFTRST == sim->direccion && ahora >= sim->softrst_hasta_ns)
+            valor = sim->cortos[SOFTRST] = VACIO;
+        return valor;
+    }
+
+    if (RFSTATE == sim->direccion)
+        return (ahora >= sim->rf_listo_ns) ? RX : VACIO;
+
+    if (SLPCAL2 == sim->direccion && ahora >= sim->slpcal_listo_ns)
+        return sim->largos[SLPCAL2] | SLPCALRDY;
+
+    return sim->largos[sim->direccion];
+}
+
+/**
+ * @brief  Escribo el registro direccionado y resuelvo lo que dispara.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @param  uint8_t Valor a escribir.
+ * @return None.
+ */
+static void EscriboRegistro(mrf24_sim_t * sim, uint8_t valor) {
+
+    uint64_t ahora = sim->medio->tiempo_ns;
+    uint8_t anterior = VACIO;
+
+    if (sim->comando_largo) {
+
+        if (RFSTATE != sim->direccion)
+            sim->largos[sim->direccion] = valor;
+
+        if (SLPCAL2 == sim->direccion && (valor & SLPCALEN)) {
+
+            sim->largos[SLPCAL0] = (uint8_t)sim->slpcal;
+            sim->largos[SLPCAL1] = (uint8_t)(sim->slpcal >> 8);
+            sim->largos[SLPCAL2] = (uint8_t)(sim->slpcal >> 16) & SLPCAL_MSB;
+            sim->slpcal_listo_ns = ahora + PeriodoSleep(sim, SLPCAL_PERIODOS);
+        } else if (MAINCNT3 == sim->direccion && (valor & STARTCNT)) {
+
+            sim->largos[MAINCNT3] = valor & ~STARTCNT;
+            Duermo(sim);
+        }
+        return;
+    }
+
+    anterior = sim->cortos[sim->direccion];
+    sim->cortos[sim->direccion] = valor;
+
+    switch (sim->direccion) {
+
+    case SOFTRST:
+        if (valor & (RSTPWR | RSTBB | RSTMAC)) {
+
+            ReinicioRegistros(sim, ahora + NS_RF_RESET);
+            sim->cortos[SOFTRST] = valor & (RSTPWR | RSTBB | RSTMAC);
+            sim->softrst_hasta_ns = ahora + NS_SOFT_RESET;
+        }
+        break;
+
+    case RXFLUSH:
+        if (valor & RXFLUSH_RESET)
+            sim->rx_ocupado = false;
+        sim->cortos[RXFLUSH] = valor & ~RXFLUSH_RESET;
+        break;
+
+    case TXNCON:
+        sim->cortos[TXNCON] = valor & ~TXNTRIG;
+        if (valor & TXNTRIG)
+            Transmito(sim, valor & TXNACKREQ);
+        break;
+
+    case TXG1CON:
+    case TXG2CON:
+        sim->cortos[sim->direccion] = valor & ~TXGTRIG;
+        if (valor & TXGTRIG) {
+
+            sim->gts_pendientes |= (TXG1CON == sim->direccion) ? TXG1IF : TXG2IF;
+            ProgramoGts(sim);
+        }
+        break;
+
+    case ORDER:
+        if (ORDER_SIN_BEACON == (valor >> SHIFT_ORDER)) {
+
+            sim->supertrama_ns = NUNCA;
+            sim->beacon_ns = NUNCA;
+            sim->gts_pendientes = VACIO;
+
+            if (SIM_TX_ESPERA_SLOT == sim->gts_fase) {
+
+                sim->gts_fase = SIM_TX_LIBRE;
+                sim->gts_evento_ns = NUNCA;
+            }
+        } else if (sim->cortos[RXMCR] & PANCOORD) {
+
+            sim->beacon_ns = ahora;
+        }
+        break;
+
+    case WAKECON:
+        if (sim->dormido && (valor & IMMWAKE) && (valor & REGWAKE) && !(anterior & REGWAKE)) {
+
+            uint16_t wakecnt = ((uint16_t)(sim->cortos[RFCTL] & (WAKECNT8 | WAKECNT7))
+                                << SHIFT_WAKECNT) |
+                               (sim->cortos[SLPACK] & WAKECNT_MASK);
+            sim->despertar_ns = ahora + PeriodoSleep(sim, wakecnt);
+        }
+        break;
+
+    case RFCTL:
+        if (valor & RFRST_HOLD)
+            sim->rf_listo_ns = NUNCA;
+        else if (anterior & RFRST_HOLD)
+            sim->rf_listo_ns = ahora + NS_RF_RESET;
+        break;
+
+    case BBREG1:
+        if ((anterior & RXDECINV) && !(valor & RXDECINV))
+            sim->rx_ocupado = false;
+        break;
+
+    case BBREG6:
+        if (valor & RSSIMODE1) {
+
+            sim->largos[RSSI] = sim->medio->ruido[CANAL(sim) % SIM_CHANNELS];
+            sim->cortos[BBREG6] = (valor & ~RSSIMODE1) | RSSIRDY;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief  Proceso un byte de la transacción SPI en curso.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @param  uint8_t * Byte enviado por el driver, o donde se deja el leído.
+ * @param  bool_t true si el driver está leyendo.
+ * @return None.
+ *
+ * @note   Los primeros bytes forman el comando; los siguientes acceden a
+ *         registros consecutivos, como la ráfaga del módulo con el CS activo.
+ */
+static void ProcesoByte(mrf24_sim_t * sim, uint8_t * dato, bool_t lectura) {
+
+    sim->stats.spi_bytes++;
+    AvanzoHasta(sim->medio, sim->medio->tiempo_ns + sim->medio->spi_ns_por_byte);
+
+    if (!sim->cs_activo || sim->en_reset) {
+
+        if (lectura)
+            *dato = VACIO;
+        return;
+    }
+
+    if (sim->bytes_comando < 2 && !lectura) {
+
+        sim->comando[sim->bytes_comando++] = *dato;
+        sim->comando_largo = sim->comando[0] & LONG_COMMAND;
+
+        if (!sim->comando_largo) {
+
+            sim->direccion = (sim->comando[0] >> 1) & SHORT_MASK;
+            sim->escritura = sim->comando[0] & SHORT_WRITE;
+            sim->bytes_comando = 2;
+        } else if (2 == sim->bytes_comando) {
+
+            sim->direccion = ((uint16_t)(sim->comando[0] & ~LONG_COMMAND) << SHIFT_LONG_HIGH) |
+                             (sim->comando[1] >> SHIFT_LONG_LOW);
+            sim->escritura = sim->comando[1] & LONG_WRITE;
+        }
+        return;
+    }
+
+    if (lectura) {
+
+        *dato = sim->escritura ? VACIO : LeoRegistro(sim);
+    } else if (sim->escritura) {
+
+        EscriboRegistro(sim, *dato);
+    }
+
+    if (sim->comando_largo)
+        sim->direccion = (sim->direccion + 1) % SIM_LONG_REGS;
+    else
+        sim->direccion = (sim->direccion + 1) % SIM_SHORT_REGS;
+}
+
+/**
+ * @brief  Aplico el filtro de recepción del módulo.
+ *
+ * @param  const mrf24_sim_t * Puntero al módulo simulado.
+ * @param  const uint8_t * Trama desde el frame control.
+ * @param  uint8_t Largo de la trama.
+ * @return bool_t true si la trama se acepta.
+ *
+ * @note   En modo promiscuo se acepta todo. Los beacons pasan si el módulo no
+ *         tiene PAN o si coincide; el resto necesita destino propio o broadcast.
+ */
+static bool_t AceptoTrama(const mrf24_sim_t * sim, const uint8_t * trama, uint8_t largo) {
+
+    uint16_t panid = ((uint16_t)sim->cortos[PANIDH] << 8) | sim->cortos[PANIDL];
+    uint16_t corta = ((uint16_t)sim->cortos[SADRH] << 8) | sim->cortos[SADRL];
+    uint16_t destino = VACIO;
+
+    if (sim->cortos[RXMCR] & PROMI)
+        return true;
+
+    if (largo < 5)
+        return false;
+
+    destino = ((uint16_t)trama[4] << 8) | trama[3];
+
+    if (BEACON == (trama[0] & FRAME_TYPE_MASK))
+        return (BROADCAST == panid || destino == panid);
+
+    if (BROADCAST != destino && panid != destino)
+        return false;
+
+    if (SHORT_D_ADD == (trama[1] & ADDR_MODE_MASK) && largo >= 7) {
+
+        destino = ((uint16_t)trama[6] << 8) | trama[5];
+        return (BROADCAST == destino || corta == destino);
+    }
+
+    if (LONG_D_ADD == (trama[1] & ADDR_MODE_MASK) && largo >= 13)
+        return 0 == memcmp(&trama[5], &sim->cortos[EADR0], 8);
+
+    return false;
+}
+
+/**
+ * @brief  Dejo una trama en la FIFO de recepción si el módulo la acepta.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @param  const uint8_t * Trama desde el frame control, sin FCS.
+ * @param  uint8_t Largo de la trama.
+ * @return bool_t true si la trama quedó en la FIFO.
+ *
+ * @note   La FIFO queda como la deja el módulo: largo con FCS, trama, FCS,
+ *         LQI y RSSI. Si hay una trama sin leer la nueva se descarta.
+ */
+static bool_t CargoTramaRx(mrf24_sim_t * sim, const uint8_t * trama, uint8_t largo) {
+
+    uint16_t pos = RX_FIFO;
+
+    if (sim->en_reset || sim->dormido || sim->medio->tiempo_ns < sim->rf_listo_ns)
+        return false;
+
+    if (!AceptoTrama(sim, trama, largo))
+        return false;
+
+    if (sim->rx_ocupado) {
+
+        sim->stats.rx_descartadas++;
+        return false;
+    }
+
+    sim->largos[pos++] = largo + FCS_LENGTH;
+    memcpy(&sim->largos[pos], trama, largo);
+    pos += largo;
+    sim->largos[pos++] = VACIO;
+    sim->largos[pos++] = VACIO;
+    sim->largos[pos++] = sim->medio->lqi;
+    sim->largos[pos] = sim->medio->rssi;
+    sim->rx_ocupado = true;
+    sim->cortos[INTSTAT] |= RXIF;
+    sim->stats.rx_tramas++;
+    return true;
+}
+
+/**
+ * @brief  Adapto un tiempo de la capa física a la velocidad del módulo.
+ *
+ * @param  const mrf24_sim_t * Puntero al módulo simulado.
+ * @param  uint64_t Tiempo a 250 kbps en nanosegundos.
+ * @return uint64_t Tiempo a la velocidad configurada en BBREG0.
+ */
+static uint64_t Escalo(const mrf24_sim_t * sim, uint64_t ns) {
+
+    return (sim->cortos[BBREG0] & TURBO) ? ns * NS_BYTE_TURBO / NS_BYTE_250KBPS : ns;
+}
+
+/**
+ * @brief  Sorteo un número con el generador del medio.
+ *
+ * @param  mrf24_sim_medio_t * Puntero al medio.
+ * @return uint32_t Número pseudoaleatorio (xorshift32).
+ */
+static uint32_t Sorteo(mrf24_sim_medio_t * medio) {
+
+    uint32_t x = medio->semilla;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    medio->semilla = x;
+    return x;
+}
+
+/**
+ * @brief  Veo si dos módulos comparten canal y velocidad.
+ */
+static bool_t MismoCanal(const mrf24_sim_t * a, const mrf24_sim_t * b) {
+
+    return CANAL(a) == CANAL(b) && (a->cortos[BBREG0] & TURBO) == (b->cortos[BBREG0] & TURBO);
+}
+
+/**
+ * @brief  Evalúo el CCA de un módulo.
+ *
+ * @param  const mrf24_sim_t * Puntero al módulo simulado.
+ * @return bool_t true si otro módulo del canal está transmitiendo una trama
+ *         o un ACK.
+ */
+static bool_t CanalOcupado(const mrf24_sim_t * sim) {
+
+    const mrf24_sim_medio_t * medio = sim->medio;
+
+    for (uint16_t i = 0; i < medio->cantidad; i++) {
+
+        const mrf24_sim_t * nodo = medio->nodos[i];
+
+        if (nodo == sim || !MismoCanal(nodo, sim))
+            continue;
+        if (SIM_TX_AIRE == nodo->tx_fase || SIM_TX_AIRE == nodo->gts_fase)
+            return true;
+        if (medio->tiempo_ns >= nodo->ack_desde_ns && medio->tiempo_ns < nodo->ack_hasta_ns)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief  Programo la próxima espera aleatoria del CSMA-CA no ranurado.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @return None.
+ *
+ * @note   El evento cae al final del CCA, después de esperar entre 0 y
+ *         2^BE - 1 períodos de backoff.
+ */
+static void ProgramoBackoff(mrf24_sim_t * sim) {
+
+    uint32_t periodos = Sorteo(sim->medio) & ((1U << sim->csma_be) - 1);
+
+    sim->tx_fase = SIM_TX_BACKOFF;
+    sim->evento_ns = sim->medio->tiempo_ns + Escalo(sim, periodos * NS_BACKOFF + NS_CCA);
+}
+
+/**
+ * @brief  Comienzo un intento de transmisión con el CSMA-CA desde cero.
+ */
+static void ComienzoCsma(mrf24_sim_t * sim) {
+
+    sim->csma_intentos = 0;
+    sim->csma_be = MIN_BE;
+    ProgramoBackoff(sim);
+}
+
+/**
+ * @brief  Termino la transmisión en curso y aviso con TXNIF.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @param  uint8_t Valor de TXSTAT.
+ * @return None.
+ */
+static void TerminoTx(mrf24_sim_t * sim, uint8_t txstat) {
+
+    sim->cortos[TXSTAT] &= TXG2FNT | TXG1FNT | TXG2STAT | TXG1STAT;
+    sim->cortos[TXSTAT] |= txstat;
+    sim->cortos[INTSTAT] |= TXNIF;
+    sim->tx_fase = SIM_TX_LIBRE;
+    sim->evento_ns = NUNCA;
+}
+
+/**
+ * @brief  Calculo cuánto tarda en salir una trama, con preámbulo y FCS.
+ */
+static uint64_t Aire(const mrf24_sim_t * sim, uint8_t largo) {
+
+    return Escalo(sim, (uint64_t)(SHR_PHR_BYTES + largo + FCS_LENGTH) * NS_BYTE_250KBPS);
+}
+
+/**
+ * @brief  Marco como colisionadas las tramas de los otros módulos del canal
+ *         que están en el aire.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo que sale al aire.
+ * @return bool_t true si había alguna, es decir, si la trama que sale también
+ *         colisiona.
+ */
+static bool_t MarcoColisiones(mrf24_sim_t * sim) {
+
+    mrf24_sim_medio_t * medio = sim->medio;
+    bool_t colision = false;
+
+    for (uint16_t i = 0; i < medio->cantidad; i++) {
+
+        mrf24_sim_t * nodo = medio->nodos[i];
+
+        if (nodo == sim || !MismoCanal(nodo, sim))
+            continue;
+
+        if (SIM_TX_AIRE == nodo->tx_fase) {
+
+            nodo->tx_colision = true;
+            colision = true;
+        }
+
+        if (SIM_TX_AIRE == nodo->gts_fase) {
+
+            nodo->gts_colision = true;
+            colision = true;
+        }
+    }
+    return colision;
+}
+
+/**
+ * @brief  Pongo en el aire la trama después de un CCA libre.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @return None.
+ *
+ * @note   Si otro módulo del canal ya está transmitiendo las dos tramas quedan
+ *         marcadas como colisionadas.
+ */
+static void SaloAlAire(mrf24_sim_t * sim) {
+
+    sim->tx_colision = MarcoColisiones(sim);
+    sim->tx_fase = SIM_TX_AIRE;
+    sim->evento_ns = sim->medio->tiempo_ns + Aire(sim, sim->tx_largo);
+}
+
+/**
+ * @brief  Veo si una trama es el comando de pedido de datos.
+ *
+ * @param  const uint8_t * Trama desde el frame control, sin FCS.
+ * @param  uint8_t Largo de la trama.
+ * @return bool_t true si es un pedido de datos.
+ */
+static bool_t PedidoDatos(const uint8_t * trama, uint8_t largo) {
+
+    uint8_t destino = trama[1] & ADDR_MODE_MASK;
+    uint8_t origen = trama[1] & LONG_S_ADD;
+    uint8_t pos = MHR_MIN_LENGTH;
+
+    if (MAC_COMM != (trama[0] & FRAME_TYPE_MASK))
+        return false;
+
+    if (VACIO != destino)
+        pos += 2 + ((LONG_D_ADD == destino) ? 8 : 2);
+
+    if (VACIO != origen && (!(trama[0] & INTRA_PAN) || VACIO == destino))
+        pos += 2;
+
+    if (VACIO != origen)
+        pos += (LONG_S_ADD == origen) ? 8 : 2;
+    return pos < largo && DATA_REQUEST == trama[pos];
+}
+
+/**
+ * @brief  Entrego la trama que terminó de salir al resto del medio.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @param  uint16_t FIFO de la que salió la trama.
+ * @param  uint8_t Largo de la trama, sin FCS.
+ * @param  bool_t true si la trama colisionó.
+ * @return bool_t true si el destino la aceptó y su ACK llega de vuelta.
+ *
+ * @note   Una trama colisionada no llega a nadie. Si no, cada receptor la
+ *         pierde con la probabilidad de su enlace. El ACK sólo se manda para
+ *         una trama unicast que pide ACK y que quedó en la FIFO del destino;
+ *         también puede perderse en el enlace de vuelta, y lleva trama
+ *         pendiente si es de un pedido de datos y el destino tiene DRPACK. Un
+ *         beacon que llega sincroniza la supertrama de quien lo sigue.
+ */
+static bool_t EntregoTrama(mrf24_sim_t * sim, uint16_t fifo, uint8_t largo, bool_t colision) {
+
+    mrf24_sim_medio_t * medio = sim->medio;
+    const uint8_t * trama = &sim->largos[fifo + TX_FIFO_HEADER];
+    bool_t unicast = false;
+    bool_t ack = false;
+
+    unicast = (largo >= 7) && (SHORT_D_ADD == (trama[1] & ADDR_MODE_MASK)) &&
+              (BROADCAST != (((uint16_t)trama[6] << 8) | trama[5]));
+    unicast = unicast || (LONG_D_ADD == (trama[1] & ADDR_MODE_MASK));
+    unicast = unicast && (trama[0] & ACK_REQ);
+    sim->ack_pendiente = false;
+
+    for (uint16_t i = 0; i < medio->cantidad; i++) {
+
+        mrf24_sim_t * nodo = medio->nodos[i];
+
+        if (nodo == sim || !MismoCanal(nodo, sim))
+            continue;
+
+        if (colision) {
+
+            nodo->stats.rx_colisiones++;
+            continue;
+        }
+
+        if (Sorteo(medio) % 100 < medio->perdida[sim->indice][nodo->indice]) {
+
+            nodo->stats.rx_perdidas++;
+            continue;
+        }
+
+        if (BEACON == (trama[0] & FRAME_TYPE_MASK))
+            SigoBeacon(nodo, trama, largo, Aire(sim, largo));
+
+        if (CargoTramaRx(nodo, trama, largo) && unicast &&
+            !(nodo->cortos[RXMCR] & (PROMI | NOACKRSP))) {
+
+            ack = Sorteo(medio) % 100 >= medio->perdida[nodo->indice][sim->indice];
+            sim->ack_pendiente = (nodo->cortos[ACKTMOUT] & DRPACK) && PedidoDatos(trama, largo);
+        }
+    }
+    return ack;
+}
+
+/**
+ * @brief  Dejo el ACK de la trama transmitida en la FIFO de los módulos en modo
+ *         promiscuo.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo que recibió el ACK.
+ * @param  uint16_t FIFO de la trama que se reconoce.
+ * @return None.
+ *
+ * @note   El módulo que responde no se simula como transmisor: el ACK llega
+ *         al terminar, sin colisiones ni pérdidas.
+ */
+static void EntregoAck(mrf24_sim_t * sim, uint16_t fifo) {
+
+    mrf24_sim_medio_t * medio = sim->medio;
+    const uint8_t * trama = &sim->largos[fifo + TX_FIFO_HEADER];
+    const uint8_t ack[ACK_FRAME_LENGTH] = {ACK | (sim->ack_pendiente ? FRAME_PEND : VACIO), VACIO,
+                                           trama[2]};
+
+    for (uint16_t i = 0; i < medio->cantidad; i++) {
+
+        mrf24_sim_t * nodo = medio->nodos[i];
+
+        if (nodo != sim && MismoCanal(nodo, sim) && (nodo->cortos[RXMCR] & PROMI))
+            CargoTramaRx(nodo, ack, ACK_FRAME_LENGTH);
+    }
+}
+
+/**
+ * @brief  Veo si el módulo está dentro de una supertrama: coordinador con
+ *         beacons o siguiendo los de otro, ya sincronizado.
+ */
+static bool_t EnSupertrama(const mrf24_sim_t * sim) {
+
+    return ORDER_SIN_BEACON != (sim->cortos[ORDER] >> SHIFT_ORDER) &&
+           NUNCA != sim->supertrama_ns &&
+           ((sim->cortos[RXMCR] & PANCOORD) || (sim->cortos[TXMCR] & SLOTTED));
+}
+
+/**
+ * @brief  Calculo el intervalo entre beacons, 960 símbolos * 2^BO.
+ */
+static uint64_t Intervalo(const mrf24_sim_t * sim) {
+
+    return Escalo(sim, (uint64_t)NS_SUPERTRAMA << (sim->cortos[ORDER] >> SHIFT_ORDER));
+}
+
+/**
+ * @brief  Calculo el largo de un slot, 60 símbolos * 2^SO.
+ */
+static uint64_t Slot(const mrf24_sim_t * sim) {
+
+    return Escalo(sim, (uint64_t)NS_SLOT << (sim->cortos[ORDER] & NIBBLE));
+}
+
+/**
+ * @brief  Calculo el comienzo de la supertrama en curso.
+ *
+ * @note   Si se perdieron beacons se supone que siguieron llegando a tiempo.
+ */
+static uint64_t InicioSupertrama(const mrf24_sim_t * sim) {
+
+    uint64_t intervalo = Intervalo(sim);
+
+    return sim->supertrama_ns +
+           (sim->medio->tiempo_ns - sim->supertrama_ns) / intervalo * intervalo;
+}
+
+/**
+ * @brief  Leo de ESLOTG el último slot del CAP (numero 0) o de una GTS.
+ */
+static uint8_t FinSlot(const mrf24_sim_t * sim, uint8_t numero) {
+
+    uint8_t reg = (numero < 2) ? ESLOTG1 : (uint8_t)(ESLOTG23 + (numero - 2) / 2);
+
+    return (numero & 1) ? sim->cortos[reg] >> SHIFT_ORDER : sim->cortos[reg] & NIBBLE;
+}
+
+/**
+ * @brief  Veo si la trama de la FIFO normal puede salir ahora dentro del CAP.
+ *
+ * @param  const mrf24_sim_t * Puntero al módulo simulado.
+ * @return uint64_t VACIO si puede salir, o si no hay supertrama; si no, el
+ *         comienzo del próximo CAP.
+ *
+ * @note   La trama, y la espera de su ACK, tienen que terminar antes del final
+ *         del CAP. El CAP empieza después del beacon.
+ */
+static uint64_t ProximoCap(const mrf24_sim_t * sim) {
+
+    if (!EnSupertrama(sim))
+        return VACIO;
+    uint64_t ahora = sim->medio->tiempo_ns;
+    uint64_t inicio = InicioSupertrama(sim);
+    uint64_t cap = inicio + sim->beacon_dur_ns;
+    uint64_t fin = inicio + (FinSlot(sim, 0) + 1) * Slot(sim);
+    uint64_t duracion = Aire(sim, sim->tx_largo) +
+                        (sim->tx_espero_ack ? Escalo(sim, NS_ACK_WAIT) : VACIO);
+
+    if (ahora >= cap && ahora + duracion <= fin)
+        return VACIO;
+    return (ahora < cap) ? cap : cap + Intervalo(sim);
+}
+
+/**
+ * @brief  Sincronizo la supertrama con un beacon recibido.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo que lo recibe.
+ * @param  const uint8_t * Beacon desde el frame control.
+ * @param  uint8_t Largo del beacon.
+ * @param  uint64_t Lo que tardó en salir.
+ * @return None.
+ *
+ * @note   Sólo si el módulo sigue beacons (SLOTTED y ORDER, sin PANCOORD),
+ *         escucha y el beacon pasa su filtro. Una trama que esperaba su GTS
+ *         se vuelve a ubicar con la nueva referencia.
+ */
+static void SigoBeacon(mrf24_sim_t * sim, const uint8_t * trama, uint8_t largo, uint64_t aire) {
+
+    if (sim->en_reset || sim->dormido || sim->medio->tiempo_ns < sim->rf_listo_ns ||
+        (sim->cortos[RXMCR] & PANCOORD) || !(sim->cortos[TXMCR] & SLOTTED) ||
+        ORDER_SIN_BEACON == (sim->cortos[ORDER] >> SHIFT_ORDER) ||
+        !AceptoTrama(sim, trama, largo))
+        return;
+    sim->supertrama_ns = sim->medio->tiempo_ns - aire;
+    sim->beacon_dur_ns = aire;
+
+    if (SIM_TX_ESPERA_SLOT == sim->gts_fase) {
+
+        sim->gts_fase = SIM_TX_LIBRE;
+        sim->gts_evento_ns = NUNCA;
+    }
+    ProgramoGts(sim);
+}
+
+/**
+ * @brief  Comienzo una supertrama del coordinador: el beacon sale de su FIFO
+ *         sin CSMA-CA.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @return None.
+ *
+ * @note   Una trama que esperaba su GTS vuelve a ubicarse cuando termina el
+ *         beacon.
+ */
+static void SaleBeacon(mrf24_sim_t * sim) {
+
+    uint8_t largo = sim->largos[TX_BEACON_FIFO + 1];
+    uint64_t ahora = sim->medio->tiempo_ns;
+
+    sim->supertrama_ns = ahora;
+    sim->beacon_ns = ahora + Intervalo(sim);
+
+    if (SIM_TX_ESPERA_SLOT == sim->gts_fase)
+        sim->gts_fase = SIM_TX_LIBRE;
+
+    if (SIM_TX_LIBRE != sim->gts_fase || sim->dormido)
+        return;
+    sim->gts_fifo = TX_BEACON_FIFO;
+    sim->gts_largo = (largo > MAX_FRAME_LENGTH - FCS_LENGTH) ? MAX_FRAME_LENGTH - FCS_LENGTH
+                                                             : largo;
+    sim->gts_espero_ack = false;
+    sim->beacon_dur_ns = Aire(sim, sim->gts_largo);
+    sim->gts_colision = MarcoColisiones(sim);
+    sim->gts_fase = SIM_TX_AIRE;
+    sim->gts_evento_ns = ahora + sim->beacon_dur_ns;
+    sim->stats.tx_beacons++;
+}
+
+/**
+ * @brief  Ubico en el tiempo la próxima trama que espera su GTS.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @return None.
+ *
+ * @note   La GTS número n de TXGxCON empieza después del último slot de las
+ *         anteriores. Si ya pasó en esta supertrama va en la siguiente. Una
+ *         GTS vacía deja la trama sin lugar.
+ */
+static void ProgramoGts(mrf24_sim_t * sim) {
+
+    if (SIM_TX_LIBRE != sim->gts_fase || VACIO == sim->gts_pendientes || !EnSupertrama(sim))
+        return;
+    bool_t segunda = !(sim->gts_pendientes & TXG1IF);
+    uint8_t txgcon = sim->cortos[segunda ? TXG2CON : TXG1CON];
+    uint8_t numero = (txgcon >> SHIFT_TXGSLOT) & TXGSLOT_MASK;
+    uint16_t fifo = segunda ? TX_GTS2_FIFO : TX_GTS1_FIFO;
+    uint8_t largo = sim->largos[fifo + 1];
+    uint8_t inicio = 0;
+
+    for (uint8_t i = 0; i < numero; i++) {
+
+        if (FinSlot(sim, i) + 1 > inicio)
+            inicio = FinSlot(sim, i) + 1;
+    }
+    uint64_t supertrama = InicioSupertrama(sim);
+    uint64_t desde = supertrama + inicio * Slot(sim);
+
+    if (desde < sim->medio->tiempo_ns) {
+
+        supertrama += Intervalo(sim);
+        desde += Intervalo(sim);
+    }
+    sim->gts_fifo = fifo;
+    sim->gts_largo = (largo > MAX_FRAME_LENGTH - FCS_LENGTH) ? MAX_FRAME_LENGTH - FCS_LENGTH
+                                                             : largo;
+    sim->gts_espero_ack = (txgcon & TXGACKREQ) ? true : false;
+    sim->gts_reintentos = 0;
+    sim->gts_ack_ok = false;
+    sim->gts_fin_ns = (VACIO == numero || FinSlot(sim, numero) < inicio)
+                          ? desde
+                          : supertrama + (FinSlot(sim, numero) + 1) * Slot(sim);
+    sim->gts_fase = SIM_TX_ESPERA_SLOT;
+    sim->gts_evento_ns = desde;
+}
+
+/**
+ * @brief  Termino la transmisión en GTS en curso y aviso con TXGxIF.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @param  bool_t true si falló.
+ * @param  bool_t true si falló porque no entraba en la GTS.
+ * @return None.
+ */
+static void TerminoGts(mrf24_sim_t * sim, bool_t fallo, bool_t sin_lugar) {
+
+    bool_t segunda = (TX_GTS2_FIFO == sim->gts_fifo);
+    uint8_t reg = segunda ? TXG2CON : TXG1CON;
+    uint8_t bandera = segunda ? TXG2IF : TXG1IF;
+
+    sim->cortos[TXSTAT] &= (uint8_t)~(segunda ? TXG2STAT | TXG2FNT : TXG1STAT | TXG1FNT);
+
+    if (fallo)
+        sim->cortos[TXSTAT] |= segunda ? TXG2STAT : TXG1STAT;
+
+    if (sin_lugar)
+        sim->cortos[TXSTAT] |= segunda ? TXG2FNT : TXG1FNT;
+    sim->cortos[reg] = (uint8_t)(sim->cortos[reg] & ~(TXGRETRY1 | TXGRETRY0)) |
+                       (uint8_t)(sim->gts_reintentos << SHIFT_TXGRETRY);
+    sim->cortos[INTSTAT] |= bandera;
+    sim->gts_pendientes &= (uint8_t)~bandera;
+    sim->gts_fase = SIM_TX_LIBRE;
+    sim->gts_evento_ns = NUNCA;
+    ProgramoGts(sim);
+}
+
+/**
+ * @brief  Atiendo el evento pendiente del transmisor de beacons y GTS.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @return None.
+ *
+ * @note   Comienzo de la GTS: la trama sale si ella y la espera del ACK
+ *         entran en lo que queda; si no, TXGxFNT. Los reintentos salen
+ *         enseguida, sin CSMA-CA, mientras sigan entrando.
+ */
+static void AvanzoGts(mrf24_sim_t * sim) {
+
+    uint64_t ahora = sim->medio->tiempo_ns;
+    uint64_t duracion = Aire(sim, sim->gts_largo);
+    uint64_t espera = sim->gts_espero_ack ? Escalo(sim, NS_ACK_WAIT) : VACIO;
+
+    switch (sim->gts_fase) {
+
+    case SIM_TX_ESPERA_SLOT:
+        if (ahora + duracion + espera > sim->gts_fin_ns) {
+
+            TerminoGts(sim, true, true);
+            break;
+        }
+        sim->gts_colision = MarcoColisiones(sim);
+        sim->gts_fase = SIM_TX_AIRE;
+        sim->gts_evento_ns = ahora + duracion;
+        sim->stats.tx_gts++;
+        break;
+
+    case SIM_TX_AIRE:
+        sim->gts_ack_ok = EntregoTrama(sim, sim->gts_fifo, sim->gts_largo, sim->gts_colision);
+
+        if (TX_BEACON_FIFO == sim->gts_fifo) {
+
+            if (!(sim->cortos[TXBCON1] & TXBMSK))
+                sim->cortos[INTSTAT] |= TXNIF;
+            sim->gts_fase = SIM_TX_LIBRE;
+            sim->gts_evento_ns = NUNCA;
+            ProgramoGts(sim);
+        } else if (!sim->gts_espero_ack) {
+
+            TerminoGts(sim, false, false);
+        } else if (sim->gts_ack_ok) {
+
+            sim->ack_desde_ns = ahora + Escalo(sim, NS_TURNAROUND);
+            sim->ack_hasta_ns = sim->ack_desde_ns + Escalo(sim, ACK_BYTES * NS_BYTE_250KBPS);
+            sim->gts_fase = SIM_TX_ESPERA_ACK;
+            sim->gts_evento_ns = sim->ack_hasta_ns;
+        } else {
+
+            sim->gts_fase = SIM_TX_ESPERA_ACK;
+            sim->gts_evento_ns = ahora + espera;
+        }
+        break;
+
+    case SIM_TX_ESPERA_ACK:
+        if (sim->gts_ack_ok) {
+
+            EntregoAck(sim, sim->gts_fifo);
+            TerminoGts(sim, false, false);
+        } else if (sim->gts_reintentos < MAX_FRAME_RETRIES &&
+                   ahora + duracion + espera <= sim->gts_fin_ns) {
+
+            sim->gts_reintentos++;
+            sim->stats.tx_reintentos++;
+            sim->gts_colision = MarcoColisiones(sim);
+            sim->gts_fase = SIM_TX_AIRE;
+            sim->gts_evento_ns = ahora + duracion;
+        } else {
+
+            sim->stats.tx_sin_ack++;
+            TerminoGts(sim, true, false);
+        }
+        break;
+
+    default:
+        sim->gts_evento_ns = NUNCA;
+        break;
+    }
+}
+
+/**
+ * @brief  Paso ciclos del reloj de sleep a nanosegundos.
+ *
+ * @param  const mrf24_sim_t * Puntero al módulo simulado.
+ * @param  uint64_t Cantidad de ciclos.
+ * @return uint64_t Duración con el período que mide la calibración.
+ */
+static uint64_t PeriodoSleep(const mrf24_sim_t * sim, uint64_t ciclos) {
+
+    return ciclos * sim->slpcal * SLPCAL_NS_CICLO / SLPCAL_PERIODOS;
+}
+
+/**
+ * @brief  Duermo al módulo por la cuenta cargada en MAINCNT.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @return None.
+ *
+ * @note   Dormido no recibe, no transmite ni responde ACK, y al despertar la
+ *         radio queda sin recibir hasta que el driver reinicie RF.
+ */
+static void Duermo(mrf24_sim_t * sim) {
+
+    uint64_t ciclos = ((uint64_t)(sim->largos[MAINCNT3] & MAINCNT_MSB) << 24) |
+                      ((uint64_t)sim->largos[MAINCNT2] << 16) |
+                      ((uint64_t)sim->largos[MAINCNT1] << 8) | sim->largos[MAINCNT0];
+
+    if (sim->dormido)
+        return;
+    sim->dormido = true;
+    sim->dormido_desde_ns = sim->medio->tiempo_ns;
+    sim->despertar_ns = sim->medio->tiempo_ns + PeriodoSleep(sim, ciclos);
+    sim->rf_listo_ns = NUNCA;
+    sim->rx_ocupado = false;
+}
+
+/**
+ * @brief  Despierto al módulo y aviso con WAKEIF.
+ */
+static void Despierto(mrf24_sim_t * sim) {
+
+    sim->dormido = false;
+    sim->despertar_ns = NUNCA;
+    sim->stats.despertares++;
+    sim->stats.dormido_ns += sim->medio->tiempo_ns - sim->dormido_desde_ns;
+    sim->cortos[INTSTAT] |= WAKEIF;
+}
+
+/**
+ * @brief  Devuelvo el instante del próximo evento de un módulo: de sus
+ *         transmisiones, el próximo beacon o el fin del sleep.
+ */
+static uint64_t ProximoEvento(const mrf24_sim_t * sim) {
+
+    uint64_t proximo = (sim->despertar_ns < sim->evento_ns) ? sim->despertar_ns : sim->evento_ns;
+
+    if (sim->gts_evento_ns < proximo)
+        proximo = sim->gts_evento_ns;
+    return (sim->beacon_ns < proximo) ? sim->beacon_ns : proximo;
+}
+
+/**
+ * @brief  Atiendo el evento pendiente de la transmisión de un módulo.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @return None.
+ *
+ * @note   Fin del sleep: WAKEIF. Luego el transmisor de GTS, que termina lo
+ *         suyo antes del beacon que comienza la supertrama. Fin del backoff:
+ *         CCA y salida al aire, o un backoff más; con supertrama, si la trama
+ *         no entra en el CAP se espera al próximo. Fin de la trama: entrega y
+ *         espera del ACK. Fin de la espera: resultado o reintento, hasta
+ *         MAX_FRAME_RETRIES.
+ */
+static void AtiendoEvento(mrf24_sim_t * sim) {
+
+    uint64_t ahora = sim->medio->tiempo_ns;
+
+    if (sim->despertar_ns <= ahora) {
+
+        Despierto(sim);
+        return;
+    }
+
+    if (sim->gts_evento_ns <= ahora) {
+
+        AvanzoGts(sim);
+        return;
+    }
+
+    if (sim->beacon_ns <= ahora) {
+
+        SaleBeacon(sim);
+        return;
+    }
+    uint64_t cap = ProximoCap(sim);
+
+    switch (sim->tx_fase) {
+
+    case SIM_TX_BACKOFF:
+        if (VACIO != cap) {
+
+            sim->tx_fase = SIM_TX_ESPERA_SLOT;
+            sim->evento_ns = cap;
+        } else if (!CanalOcupado(sim)) {
+
+            SaloAlAire(sim);
+        } else if (++sim->csma_intentos > MAX_CSMA_BACKOFFS) {
+
+            sim->stats.tx_cca_fallas++;
+            TerminoTx(sim, (uint8_t)(sim->tx_reintentos << SHIFT_TXNRETRY) | CCAFAIL | TXNSTAT);
+        } else {
+
+            sim->csma_be = (sim->csma_be < MAX_BE) ? sim->csma_be + 1 : MAX_BE;
+            ProgramoBackoff(sim);
+        }
+        break;
+
+    case SIM_TX_ESPERA_SLOT:
+        ProgramoBackoff(sim);
+        break;
+
+    case SIM_TX_AIRE:
+        sim->ack_ok = EntregoTrama(sim, TX_FIFO, sim->tx_largo, sim->tx_colision);
+
+        if (!sim->tx_espero_ack) {
+
+            TerminoTx(sim, VACIO);
+        } else if (sim->ack_ok) {
+
+            sim->ack_desde_ns = ahora + Escalo(sim, NS_TURNAROUND);
+            sim->ack_hasta_ns = sim->ack_desde_ns + Escalo(sim, ACK_BYTES * NS_BYTE_250KBPS);
+            sim->tx_fase = SIM_TX_ESPERA_ACK;
+            sim->evento_ns = sim->ack_hasta_ns;
+        } else {
+
+            sim->tx_fase = SIM_TX_ESPERA_ACK;
+            sim->evento_ns = ahora + Escalo(sim, NS_ACK_WAIT);
+        }
+        break;
+
+    case SIM_TX_ESPERA_ACK:
+        if (sim->ack_ok) {
+
+            EntregoAck(sim, TX_FIFO);
+
+            if (sim->ack_pendiente)
+                sim->cortos[TXNCON] |= FPSTAT;
+            TerminoTx(sim, (uint8_t)(sim->tx_reintentos << SHIFT_TXNRETRY));
+        } else if (sim->tx_reintentos < MAX_FRAME_RETRIES) {
+
+            sim->tx_reintentos++;
+            sim->stats.tx_reintentos++;
+            ComienzoCsma(sim);
+        } else {
+
+            sim->stats.tx_sin_ack++;
+            TerminoTx(sim, TXNRETRY1 | TXNRETRY0 | TXNSTAT);
+        }
+        break;
+
+    default:
+        sim->evento_ns = NUNCA;
+        break;
+    }
+}
+
+/**
+ * @brief  Avanzo el reloj del medio atendiendo en orden los eventos que caen
+ *         antes del instante pedido.
+ *
+ * @param  mrf24_sim_medio_t * Puntero al medio.
+ * @param  uint64_t Instante al que se quiere llegar.
+ * @return None.
+ */
+static void AvanzoHasta(mrf24_sim_medio_t * medio, uint64_t hasta) {
+
+    while (true) {
+
+        mrf24_sim_t * proximo = NULL;
+
+        for (uint16_t i = 0; i < medio->cantidad; i++) {
+
+            mrf24_sim_t * nodo = medio->nodos[i];
+
+            if (ProximoEvento(nodo) <= hasta &&
+                (NULL == proximo || ProximoEvento(nodo) < ProximoEvento(proximo)))
+                proximo = nodo;
+        }
+
+        if (NULL == proximo)
+            break;
+        if (ProximoEvento(proximo) > medio->tiempo_ns)
+            medio->tiempo_ns = ProximoEvento(proximo);
+        AtiendoEvento(proximo);
+    }
+
+    if (hasta > medio->tiempo_ns)
+        medio->tiempo_ns = hasta;
+}
+
+/**
+ * @brief  Comienzo la transmisión de la trama cargada en la FIFO normal.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @param  bool_t true si se pidió ACK en TXNCON.
+ * @return None.
+ *
+ * @note   El resultado llega más tarde, cuando el reloj del medio avanza: la
+ *         trama pasa por el CSMA-CA, el aire y la espera del ACK.
+ */
+static void Transmito(mrf24_sim_t * sim, bool_t espero_ack) {
+
+    uint8_t largo = sim->largos[TX_FIFO + 1];
+
+    if (SIM_TX_LIBRE != sim->tx_fase || sim->dormido)
+        return;
+
+    sim->tx_largo = (largo > MAX_FRAME_LENGTH - FCS_LENGTH) ? MAX_FRAME_LENGTH - FCS_LENGTH
+                                                            : largo;
+    sim->tx_espero_ack = espero_ack;
+    sim->tx_reintentos = 0;
+    sim->ack_ok = false;
+    sim->stats.tx_tramas++;
+    ComienzoCsma(sim);
+}
+
+static void SimInitPins(void * ctx) {
+
+    (void)ctx;
+}
+
+static void SimSetCS(void * ctx, bool_t estado) {
+
+    mrf24_sim_t * sim = ctx;
+
+    if (!estado && !sim->cs_activo) {
+
+        sim->stats.spi_transacciones++;
+        sim->bytes_comando = 0;
+    }
+
+    sim->cs_activo = !estado;
+}
+
+static void SimSetWake(void * ctx, bool_t estado) {
+
+    (void)ctx;
+    (void)estado;
+}
+
+static void SimSetReset(void * ctx, bool_t estado) {
+
+    mrf24_sim_t * sim = ctx;
+
+    if (!estado) {
+
+        sim->en_reset = true;
+        ReinicioRegistros(sim, NUNCA);
+    } else if (sim->en_reset) {
+
+        sim->en_reset = false;
+        sim->rf_listo_ns = sim->medio->tiempo_ns + NS_RESET;
+    }
+}
+
+static bool_t SimIsInterrupt(void * ctx) {
+
+    const mrf24_sim_t * sim = ctx;
+
+    return VACIO != (sim->cortos[INTSTAT] & ~sim->cortos[MRFINTCON]);
+}
+
+static spi_state_t SimWriteByte(void * ctx, uint8_t * dato) {
+
+    ProcesoByte(ctx, dato, false);
+    return SPI_COMM_OK;
+}
+
+static spi_state_t SimWrite2Bytes(void * ctx, uint16_t * dato) {
+
+    uint8_t alto = *dato >> SHIFT_BYTE;
+    uint8_t bajo = *dato & 0xFF;
+
+    ProcesoByte(ctx, &alto, false);
+    ProcesoByte(ctx, &bajo, false);
+    return SPI_COMM_OK;
+}
+
+static spi_state_t SimWriteBlock(void * ctx, const uint8_t * datos, uint16_t largo) {
+
+    for (uint16_t i = 0; i < largo; i++) {
+
+        uint8_t dato = datos[i];
+
+        ProcesoByte(ctx, &dato, false);
+    }
+    return SPI_COMM_OK;
+}
+
+static spi_state_t SimReadByte(void * ctx, uint8_t * respuesta) {
+
+    ProcesoByte(ctx, respuesta, true);
+    return SPI_COMM_OK;
+}
+
+static spi_state_t SimReadBlock(void * ctx, uint8_t * datos, uint16_t largo) {
+
+    for (uint16_t i = 0; i < largo; i++)
+        ProcesoByte(ctx, &datos[i], true);
+    return SPI_COMM_OK;
+}
+
+/* === Implementación de funciones públicas =================================== */
+void MRF24SimMedioInit(mrf24_sim_medio_t * medio) {
+
+    memset(medio, 0, sizeof(*medio));
+    medio->spi_ns_por_byte = SIM_SPI_NS_BYTE;
+    medio->semilla = SEMILLA_DEFECTO;
+    medio->rssi = 0x80;
+    medio->lqi = 0xFF;
+}
+
+bool_t MRF24SimInit(mrf24_sim_t * sim, mrf24_sim_medio_t * medio, mrf24_port_t * port) {
+
+    if (medio->cantidad >= SIM_MAX_NODES)
+        return false;
+
+    memset(sim, 0, sizeof(*sim));
+    sim->medio = medio;
+    sim->indice = medio->cantidad;
+    sim->slpcal = SIM_SLPCAL;
+    ReinicioRegistros(sim, medio->tiempo_ns + NS_RESET);
+    medio->nodos[medio->cantidad++] = sim;
+
+    port->ctx = sim;
+    port->init_pins = SimInitPins;
+    port->set_cs = SimSetCS;
+    port->set_wake = SimSetWake;
+    port->set_reset = SimSetReset;
+    port->is_interrupt = SimIsInterrupt;
+    port->write_byte = SimWriteByte;
+    port->write_2_bytes = SimWrite2Bytes;
+    port->write_block = SimWriteBlock;
+    port->read_byte = SimReadByte;
+    port->read_block = SimReadBlock;
+    port->mask_interrupt = NULL; // sin interrupciones reales no hay nada que enmascarar
+    return true;
+}
+
+void MRF24SimAvanzar(mrf24_sim_medio_t * medio, uint32_t us) {
+
+    AvanzoHasta(medio, medio->tiempo_ns + (uint64_t)us * 1000);
+}
+
+void MRF24SimSetSemilla(mrf24_sim_medio_t * medio, uint32_t semilla) {
+
+    medio->semilla = (VACIO != semilla) ? semilla : SEMILLA_DEFECTO;
+}
+
+void MRF24SimSetPerdida(const mrf24_sim_t * origen, const mrf24_sim_t * destino,
+                        uint8_t porcentaje) {
+
+    origen->medio->perdida[origen->indice][destino->indice] = (porcentaje > 100) ? 100 : porcentaje;
+}
+
+uint64_t MRF24SimGetTiempoUs(const mrf24_sim_medio_t * medio) {
+
+    return medio->tiempo_ns / 1000;
+}
+
+bool_t MRF24SimRecibir(mrf24_sim_t * sim, const uint8_t * trama, uint8_t largo) {
+
+    if (largo > MAX_FRAME_LENGTH - FCS_LENGTH)
+        return false;
+
+    return CargoTramaRx(sim, trama, largo);
+}
+
+uint8_t MRF24SimGetShort(const mrf24_sim_t * sim, uint8_t reg) {
+
+    return sim->cortos[reg % SIM_SHORT_REGS];
+}
+
+uint8_t MRF24SimGetLong(const mrf24_sim_t * sim, uint16_t reg) {
+
+    return sim->largos[reg % SIM_LONG_REGS];
+}
@@ -0,0 +1,244 @@
+/**
+ *********************************************************************************
+ * @file    mrf24j40_sim.h
+ * @author  Lcdo. Mariano Ariel Deville
+ * @brief   Modelo del MRF24J40 para correr el driver en la PC
+ *********************************************************************************
+ * @attention Implementa las funciones de drv_MRF24J40_port.h sobre un modelo de
+ *            los registros, las FIFOs y un medio de radio compartido, de modo
+ *            que el driver completo se pueda ejercitar sin hardware.
+ *********************************************************************************
+ */
+#ifndef TEST_SUPPORT_MRF24J40_SIM_H_
+#define TEST_SUPPORT_MRF24J40_SIM_H_
+
+/* === Archivos cabecera ====================================================== */
+#include "drv_MRF24J40_port.h"
+
+/* === Definición de macros públicas ========================================== */
+#define SIM_SHORT_REGS  (0x40)
+#define SIM_LONG_REGS   (0x400)
+#ifndef SIM_MAX_NODES
+#define SIM_MAX_NODES 8
+#endif
+#define SIM_CHANNELS    16
+#define SIM_SPI_NS_BYTE 1000 // 8 MHz de reloj SPI
+#define SIM_SLPCAL      6400 // 16 períodos de 20 us en ciclos de 50 ns
+
+/* === Declaración de tipo de datos públicos ================================== */
+typedef struct mrf24_sim_s mrf24_sim_t;
+
+/**
+ * @brief Fase de la transmisión de un módulo simulado.
+ */
+typedef enum {
+
+    SIM_TX_LIBRE,
+    SIM_TX_BACKOFF,
+    SIM_TX_AIRE,
+    SIM_TX_ESPERA_ACK,
+    SIM_TX_ESPERA_SLOT,
+} mrf24_sim_fase_t;
+
+/**
+ * @brief Contadores de actividad de un módulo simulado.
+ */
+typedef struct {
+
+    uint32_t spi_bytes;
+    uint32_t spi_transacciones;
+    uint32_t tx_tramas;
+    uint32_t tx_reintentos;
+    uint32_t tx_sin_ack;
+    uint32_t tx_cca_fallas;
+    uint32_t rx_tramas;
+    uint32_t rx_descartadas;
+    uint32_t rx_colisiones;
+    uint32_t rx_perdidas;
+    uint32_t despertares;
+    uint64_t dormido_ns;
+    uint32_t tx_beacons;
+    uint32_t tx_gts;
+} mrf24_sim_stats_t;
+
+/**
+ * @brief Medio de radio compartido por los módulos simulados.
+ *
+ * @note  Lleva el reloj virtual: cada byte de SPI lo hace avanzar, y las
+ *        transmisiones ocurren a medida que avanza. ruido es la energía que
+ *        mide el RSSI en cada canal y perdida el porcentaje de tramas que se
+ *        pierden de un módulo (fila) a otro (columna).
+ */
+typedef struct {
+
+    mrf24_sim_t * nodos[SIM_MAX_NODES];
+    uint16_t cantidad;
+    uint64_t tiempo_ns;
+    uint32_t spi_ns_por_byte;
+    uint32_t semilla;
+    uint8_t rssi;
+    uint8_t lqi;
+    uint8_t ruido[SIM_CHANNELS];
+    uint8_t perdida[SIM_MAX_NODES][SIM_MAX_NODES];
+} mrf24_sim_medio_t;
+
+/**
+ * @brief Estado de un módulo simulado.
+ *
+ * @note  slpcal es lo que mide la calibración del reloj de sleep, ciclos de
+ *        50 ns en 16 períodos: SIM_SLPCAL para un reloj exacto. Se puede
+ *        cambiar después de MRF24SimInit para simular un oscilador corrido.
+ *        supertrama_ns es el comienzo de la última supertrama vista: el
+ *        beacon propio en el coordinador, el recibido en quien lo sigue. Las
+ *        FIFO de GTS y la de beacons salen por un segundo transmisor, sin
+ *        CSMA-CA, con sus propios campos gts_*. Al apagar la supertrama se
+ *        olvidan las tramas que esperaban su GTS.
+ */
+struct mrf24_sim_s {
+
+    mrf24_sim_medio_t * medio;
+    uint8_t cortos[SIM_SHORT_REGS];
+    uint8_t largos[SIM_LONG_REGS];
+    bool_t en_reset;
+    bool_t cs_activo;
+    uint8_t comando[2];
+    uint8_t bytes_comando;
+    bool_t comando_largo;
+    bool_t escritura;
+    uint16_t direccion;
+    bool_t rx_ocupado;
+    uint64_t softrst_hasta_ns;
+    uint64_t rf_listo_ns;
+    uint16_t indice;
+    mrf24_sim_fase_t tx_fase;
+    uint64_t evento_ns;
+    uint8_t tx_largo;
+    bool_t tx_espero_ack;
+    bool_t tx_colision;
+    uint8_t tx_reintentos;
+    uint8_t csma_intentos;
+    uint8_t csma_be;
+    bool_t ack_ok;
+    bool_t ack_pendiente;
+    uint64_t ack_desde_ns;
+    uint64_t ack_hasta_ns;
+    uint32_t slpcal;
+    uint64_t slpcal_listo_ns;
+    bool_t dormido;
+    uint64_t dormido_desde_ns;
+    uint64_t despertar_ns;
+    uint64_t supertrama_ns;
+    uint64_t beacon_ns;
+    uint64_t beacon_dur_ns;
+    mrf24_sim_fase_t gts_fase;
+    uint64_t gts_evento_ns;
+    uint64_t gts_fin_ns;
+    uint16_t gts_fifo;
+    uint8_t gts_largo;
+    bool_t gts_espero_ack;
+    bool_t gts_colision;
+    bool_t gts_ack_ok;
+    uint8_t gts_reintentos;
+    uint8_t gts_pendientes;
+    mrf24_sim_stats_t stats;
+};
+
+/* === Declaración de funciones públicas ====================================== */
+/**
+ * @brief  Inicializo el medio de radio.
+ *
+ * @param  mrf24_sim_medio_t * Puntero al medio.
+ * @return None.
+ *
+ * @note   El reloj arranca en cero, sin ruido en ningún canal.
+ */
+void MRF24SimMedioInit(mrf24_sim_medio_t * medio);
+
+/**
+ * @brief  Inicializo un módulo simulado y lo agrego al medio.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @param  mrf24_sim_medio_t * Medio en el que transmite y recibe.
+ * @param  mrf24_port_t * Tabla del port que se completa para el driver.
+ * @return bool_t false si el medio ya tiene SIM_MAX_NODES módulos.
+ *
+ * @note   El módulo queda con los registros en su valor de reset y el pin de
+ *         reset liberado, como recién alimentado.
+ */
+bool_t MRF24SimInit(mrf24_sim_t * sim, mrf24_sim_medio_t * medio, mrf24_port_t * port);
+
+/**
+ * @brief  Hago avanzar el reloj virtual del medio.
+ *
+ * @param  mrf24_sim_medio_t * Puntero al medio.
+ * @param  uint32_t Microsegundos a avanzar.
+ * @return None.
+ *
+ * @note   Las transmisiones en curso avanzan con el reloj: después de disparar
+ *         una trama hay que avanzar para que llegue y para que el módulo
+ *         avise con TXNIF.
+ */
+void MRF24SimAvanzar(mrf24_sim_medio_t * medio, uint32_t us);
+
+/**
+ * @brief  Cambio la semilla del generador que sortea backoffs y pérdidas.
+ *
+ * @param  mrf24_sim_medio_t * Puntero al medio.
+ * @param  uint32_t Semilla, 0 vuelve a la de MRF24SimMedioInit.
+ * @return None.
+ */
+void MRF24SimSetSemilla(mrf24_sim_medio_t * medio, uint32_t semilla);
+
+/**
+ * @brief  Cargo la probabilidad de pérdida del enlace de un módulo a otro.
+ *
+ * @param  const mrf24_sim_t * Módulo que transmite.
+ * @param  const mrf24_sim_t * Módulo que recibe.
+ * @param  uint8_t Porcentaje de tramas perdidas, de 0 a 100.
+ * @return None.
+ *
+ * @note   Afecta a las tramas y a los ACK que van en ese sentido.
+ */
+void MRF24SimSetPerdida(const mrf24_sim_t * origen, const mrf24_sim_t * destino,
+                        uint8_t porcentaje);
+
+/**
+ * @brief  Devuelvo el reloj virtual del medio.
+ *
+ * @param  mrf24_sim_medio_t * Puntero al medio.
+ * @return uint64_t Tiempo transcurrido en microsegundos.
+ */
+uint64_t MRF24SimGetTiempoUs(const mrf24_sim_medio_t * medio);
+
+/**
+ * @brief  Entrego al módulo una trama que llega desde fuera del medio.
+ *
+ * @param  mrf24_sim_t * Puntero al módulo simulado.
+ * @param  const uint8_t * Trama desde el frame control, sin FCS.
+ * @param  uint8_t Largo de la trama.
+ * @return bool_t true si la trama pasó el filtro y quedó en la FIFO de RX.
+ *
+ * @note   Aplica el mismo filtro de direcciones que una trama transmitida por
+ *         otro módulo del medio, pero no responde con ACK.
+ */
+bool_t MRF24SimRecibir(mrf24_sim_t * sim, const uint8_t * trama, uint8_t largo);
+
+/**
+ * @brief  Leo un registro corto sin los efectos de una lectura por SPI.
+ *
+ * @param  const mrf24_sim_t * Puntero al módulo simulado.
+ * @param  uint8_t Dirección del registro.
+ * @return uint8_t Valor del registro.
+ */
+uint8_t MRF24SimGetShort(const mrf24_sim_t * sim, uint8_t reg);
+
+/**
+ * @brief  Leo un registro largo o un byte de las FIFOs.
+ *
+ * @param  const mrf24_sim_t * Puntero al módulo simulado.
+ * @param  uint16_t Dirección del registro.
+ * @return uint8_t Valor del registro.
+ */
+uint8_t MRF24SimGetLong(const mrf24_sim_t * sim, uint16_t reg);
+
+#endif /* TEST_SUPPORT_MRF24J40_SIM_H_ */
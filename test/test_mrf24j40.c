@@ -1,4 +1,5 @@
 #include "unity.h"
+#include <string.h>
 #include "drv_MRF24J40.h"
 #include "drv_MRF24J40_registers.h"
 #include "mock_app_delay_unlock.h"
@@ -11,18 +12,79 @@
 #define SHIFT_LONG_ADDR  (0X05)
 #define SHIFT_SHORT_ADDR (0X01)
 
-extern mrf24_state_t estadoActual;
+extern mrf24_state_t SetShortAddr(mrf24_dev_t * dev, uint8_t reg_address, uint8_t valor);
+extern mrf24_state_t GetShortAddr(mrf24_dev_t * dev, uint8_t reg_address, uint8_t * respuesta);
+extern mrf24_state_t SetLongAddr(mrf24_dev_t * dev, uint16_t reg_address, uint8_t valor);
+extern mrf24_state_t GetLongAddr(mrf24_dev_t * dev, uint16_t reg_address, uint8_t * respuesta);
+extern mrf24_state_t SetLongAddrBlock(mrf24_dev_t * dev, uint16_t reg_address,
+                                      const uint8_t * datos, uint16_t largo);
+extern mrf24_state_t ApplyDeviceAddress(mrf24_dev_t * dev);
+extern mrf24_state_t ApplyChannel(mrf24_dev_t * dev);
+extern void InicializoColas(mrf24_dev_t * dev);
+extern void InvalidoShadow(mrf24_dev_t * dev);
+extern mrf24_state_t RegistroBeacon(mrf24_dev_t * dev, const uint8_t * trama, uint8_t largo);
+extern uint8_t EjecutoScript(mrf24_dev_t * dev, const mrf24_reg_write_t * script, uint8_t largo,
+                             uint8_t * indice);
+extern uint8_t EjecutoPerfil(mrf24_dev_t * dev);
 
-extern mrf24_state_t SetShortAddr(uint8_t reg_address, uint8_t valor);
-extern mrf24_state_t GetShortAddr(uint8_t reg_address, uint8_t * respuesta);
-extern mrf24_state_t SetLongAddr(uint16_t reg_address, uint8_t valor);
-extern mrf24_state_t GetLongAddr(uint16_t reg_address, uint8_t * respuesta);
-extern mrf24_state_t ApplyDeviceAddress(void);
-extern mrf24_state_t ApplyChannel(void);
+static const mrf24_port_t puerto = {
+    .ctx = NULL,
+    .init_pins = InicializoPines,
+    .set_cs = SetCSPin,
+    .set_wake = SetWakePin,
+    .set_reset = SetResetPin,
+    .is_interrupt = IsMRF24Interrup,
+    .write_byte = WriteByteSPIPort,
+    .write_2_bytes = Write2ByteSPIPort,
+    .write_block = WriteBlockSPIPort,
+    .read_byte = ReadByteSPIPort,
+    .read_block = ReadBlockSPIPort,
+};
+static mrf24_dev_t dev;
+
+static uint16_t spi_transacciones;
+static uint16_t spi_bytes;
+static uint8_t bloque_enviado[BUFFER_SIZE];
+static uint8_t largo_enviado;
+static const uint8_t * bloques_enviados[4];
+static uint8_t cantidad_bloques;
+static const uint8_t trama_recibida[] = {0x41, 0x88, 0x07, 0x34, 0x12, 0x01, 0x00, 0x02,
+                                         0x00, 'h',  'o',  'l',  'a',  0xAA, 0xBB, 0xC8, 0x9D};
+static const uint8_t trama_encriptada[] = {0x49, 0x98, 0x07, 0x34, 0x12, 0x01, 0x00, 0x02, 0x00,
+                                           0x05, 0x78, 0x56, 0x34, 0x12, 'h',  'o',  'l',  'a',
+                                           0x11, 0x22, 0x33, 0x44, 0xAA, 0xBB, 0xC8, 0x9D};
+static const uint8_t beacon_corto[] = {0x00, 0x80, 0x01, 0x34, 0x12, 0x05, 0x00, 0xFF, 0xCF,
+                                       0x00, 0x00, 0xAA, 0xBB, 0xC8, 0x50};
+static const uint8_t beacon_largo[] = {0x00, 0xC0, 0x01, 0x78, 0x56, 0x01, 0x02, 0x03, 0x04,
+                                       0x05, 0x06, 0x07, 0x08, 0xFF, 0xCF, 0x00, 0x00, 0xAA,
+                                       0xBB, 0xC8, 0x60};
+static const uint8_t * trama_fifo_rx;
+static uint8_t largo_fifo_rx;
+static uint8_t bytes_escritos[16];
+static uint8_t cantidad_bytes_escritos;
+
+static bool_t ultimo_comando_largo;
+static uint16_t ultima_direccion_larga;
+static uint8_t marca_rx = 'h';
+static uint8_t respuestas_cortas[4];
+static uint8_t cantidad_respuestas_cortas;
+static mrf24_tx_result_t resultado_callback;
+static mrf24_tx_result_t resultados_callback[16];
+static uint8_t llamadas_callback;
+static bool_t softrst_trabado;
+static void * contextos_cs[4];
+static uint8_t cantidad_contextos;
 
 void setUp(void) {
 
-    MRF24SetChannel(CH_11);
+    memset(&dev, 0, sizeof(dev));
+    dev.port = puerto;
+    MRF24SetChannel(&dev, CH_11);
+    InicializoColas(&dev);
+    InvalidoShadow(&dev);
+    MRF24SetTxCallback(&dev, NULL);
+    cantidad_respuestas_cortas = 0;
+    largo_fifo_rx = sizeof(trama_recibida) - 2;
 }
 
 void tearDown(void) {
@@ -48,10 +110,167 @@ uint16_t adaptarDireccionSPI16ReadLong(uint16_t reg_address) {
     return ((reg_address << SHIFT_LONG_ADDR) | READ_16_BITS);
 }
 
+void contarTransaccionSPI(void * ctx, bool_t estado, int llamadas) {
+
+    if (!estado) {
+
+        spi_transacciones++;
+        largo_enviado = 0;
+    }
+}
+
+spi_state_t contarByteSPI(void * ctx, uint8_t * dato, int llamadas) {
+
+    ultimo_comando_largo = false;
+    if (cantidad_bytes_escritos < 16)
+        bytes_escritos[cantidad_bytes_escritos++] = *dato;
+    spi_bytes += _1_BYTE;
+    return SPI_COMM_OK;
+}
+
+spi_state_t contar2BytesSPI(void * ctx, uint16_t * dato, int llamadas) {
+
+    ultimo_comando_largo = true;
+    ultima_direccion_larga = (*dato & (uint16_t)~WRITE_16_BITS) >> SHIFT_LONG_ADDR;
+    spi_bytes += _2_BYTES;
+    return SPI_COMM_OK;
+}
+
+spi_state_t contarBloqueSPI(void * ctx, const uint8_t * datos, uint16_t largo, int llamadas) {
+
+    memcpy(&bloque_enviado[largo_enviado], datos, largo);
+    largo_enviado += largo;
+    if (cantidad_bloques < 4)
+        bloques_enviados[cantidad_bloques++] = datos;
+    spi_bytes += largo;
+    return SPI_COMM_OK;
+}
+
+spi_state_t leerLargoFifoRx(void * ctx, uint8_t * respuesta, int llamadas) {
+
+    // Las lecturas largas son del largo de la FIFO, las cortas de INTSTAT o de
+    // lo que se haya cargado en respuestas_cortas.
+    if (ultimo_comando_largo)
+        *respuesta = largo_fifo_rx;
+    else if (cantidad_respuestas_cortas)
+        *respuesta = respuestas_cortas[--cantidad_respuestas_cortas];
+    else
+        *respuesta = RXIF;
+    spi_bytes += _1_BYTE;
+    return SPI_COMM_OK;
+}
+
+spi_state_t leerBloqueFifoRx(void * ctx, uint8_t * datos, uint16_t largo, int llamadas) {
+
+    TEST_ASSERT_EQUAL(sizeof(trama_recibida), largo);
+    memcpy(datos, trama_recibida, largo);
+    datos[9] = marca_rx;
+    spi_bytes += largo;
+    return SPI_COMM_OK;
+}
+
+spi_state_t leerTramaCargada(void * ctx, uint8_t * datos, uint16_t largo, int llamadas) {
+
+    TEST_ASSERT_EQUAL(largo_fifo_rx + 2, largo);
+    memcpy(datos, trama_fifo_rx, largo);
+    spi_bytes += largo;
+    return SPI_COMM_OK;
+}
+
+spi_state_t leerControlSeguridad(void * ctx, uint8_t * respuesta, int llamadas) {
+
+    // Las lecturas largas son de la trama cargada en la FIFO, la corta de INTSTAT.
+    *respuesta = ultimo_comando_largo ? trama_fifo_rx[ultima_direccion_larga - RX_FIFO - 1] : SECIF;
+    return SPI_COMM_OK;
+}
+
+spi_state_t leerEnergia(void * ctx, uint8_t * respuesta, int llamadas) {
+
+    // Las lecturas cortas son de BBREG6, las largas de RSSI y se repiten 10, 30, 20.
+    static const uint8_t rssi[] = {10, 30, 20};
+    static uint8_t lecturas_rssi;
+    if (ultimo_comando_largo)
+        *respuesta = rssi[lecturas_rssi++ % 3];
+    else
+        *respuesta = RSSIRDY;
+    return SPI_COMM_OK;
+}
+
+bool_t cumplirPermanencia(delayNoBloqueanteData_t * delay, int llamadas) {
+
+    return (2 == llamadas % 3);
+}
+
+void recibirTrama(const uint8_t * trama, uint8_t largo, mrf24_state_t esperado) {
+
+    trama_fifo_rx = trama;
+    largo_fifo_rx = largo - 2;
+    TEST_ASSERT_EQUAL(esperado, MRF24InterruptHandler(&dev));
+}
+
+void guardarResultadoTx(mrf24_dev_t * radio, const mrf24_tx_result_t * resultado) {
+
+    resultado_callback = *resultado;
+    if (llamadas_callback < 16)
+        resultados_callback[llamadas_callback] = *resultado;
+    llamadas_callback++;
+}
+
+void terminarTransmision(uint8_t txstat) {
+
+    // Se cargan en orden inverso: primero se lee INTSTAT y después TXSTAT.
+    respuestas_cortas[0] = txstat;
+    respuestas_cortas[1] = TXNIF;
+    cantidad_respuestas_cortas = 2;
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24InterruptHandler(&dev));
+}
+
+spi_state_t leerRegistrosInicializacion(void * ctx, uint8_t * respuesta, int llamadas) {
+
+    // Las lecturas largas son de RFSTATE, las cortas de SOFTRST o INTSTAT.
+    if (ultimo_comando_largo)
+        *respuesta = RX;
+    else
+        *respuesta = softrst_trabado ? (RSTPWR | RSTBB | RSTMAC) : VACIO;
+    spi_bytes += _1_BYTE;
+    return SPI_COMM_OK;
+}
+
+void guardarContextoCS(void * ctx, bool_t estado, int llamadas) {
+
+    if (!estado && cantidad_contextos < 4)
+        contextos_cs[cantidad_contextos++] = ctx;
+}
+
+void contarTraficoSPI(void) {
+
+    spi_transacciones = 0;
+    spi_bytes = 0;
+    largo_enviado = 0;
+    cantidad_bloques = 0;
+    cantidad_bytes_escritos = 0;
+    SetCSPin_Stub(contarTransaccionSPI);
+    WriteByteSPIPort_Stub(contarByteSPI);
+    Write2ByteSPIPort_Stub(contar2BytesSPI);
+    WriteBlockSPIPort_Stub(contarBloqueSPI);
+}
+
+void prepararInicializacion(bool_t tiempo_cumplido) {
+
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerRegistrosInicializacion);
+    InicializoPines_Ignore();
+    SetResetPin_Ignore();
+    DelayInit_Ignore();
+    DelayWrite_Ignore();
+    DelayReset_Ignore();
+    DelayRead_IgnoreAndReturn(tiempo_cumplido);
+}
+
 // probar de setear un canal de transmision y que la operacion se realice sin errores
 void test_probar_de_setear_un_canal_de_transmision_y_que_la_operacion_se_realice_sin_errores(void) {
 
-    mrf24_state_t respuesta = MRF24SetChannel(CH_11);
+    mrf24_state_t respuesta = MRF24SetChannel(&dev, CH_11);
     TEST_ASSERT_EQUAL(OPERATION_OK, respuesta);
 }
 
@@ -59,10 +278,10 @@ void test_probar_de_setear_un_canal_de_transmision_y_que_la_operacion_se_realice
 void test_probar_de_setear_un_canal_de_transmision_fuera_de_los_rangos_y_comprobar_que_devuelve_un_error(
     void) {
 
-    mrf24_state_t respuesta = MRF24SetChannel(CH_11 - 1);
+    mrf24_state_t respuesta = MRF24SetChannel(&dev, CH_11 - 1);
     TEST_ASSERT_EQUAL(INVALID_VALUE, respuesta);
 
-    respuesta = MRF24SetChannel(CH_26 + 1);
+    respuesta = MRF24SetChannel(&dev, CH_26 + 1);
     TEST_ASSERT_EQUAL(INVALID_VALUE, respuesta);
 }
 
@@ -73,15 +292,36 @@ void test_comprobar_que_se_envia_una_direccionde_1_byte_y_un_dato_por_SPI_sin_er
     uint8_t val = 0x20;
     uint8_t reg_address = adaptarDireccionSPI8WriteShort(reg);
     // Secuencia esperada
-    SetCSPin_Expect(false);
-    WriteByteSPIPort_ExpectAndReturn(&reg_address, SPI_COMM_OK);
-    WriteByteSPIPort_ExpectAndReturn(&val, SPI_COMM_OK);
-    SetCSPin_Expect(true);
+    SetCSPin_Expect(NULL, false);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_OK);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &val, SPI_COMM_OK);
+    SetCSPin_Expect(NULL, true);
     // retorno esperado
-    mrf24_state_t respuesta = SetShortAddr(reg, val);
+    mrf24_state_t respuesta = SetShortAddr(&dev, reg, val);
     TEST_ASSERT_EQUAL(OPERATION_OK, respuesta);
 }
 
+// comprobar que con mask_interrupt la interrupcion queda enmascarada durante toda la transaccion
+void test_comprobar_que_con_mask_interrupt_la_interrupcion_queda_enmascarada_durante_la_transaccion(
+    void) {
+
+    uint8_t reg = 0x03;
+    uint8_t val = 0x20;
+    uint8_t reg_address = adaptarDireccionSPI8WriteShort(reg);
+    dev.port.mask_interrupt = MaskMRF24Interrup;
+    // Secuencia esperada
+    MaskMRF24Interrup_Expect(NULL, true);
+    SetCSPin_Expect(NULL, false);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_OK);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &val, SPI_COMM_OK);
+    SetCSPin_Expect(NULL, true);
+    MaskMRF24Interrup_Expect(NULL, false);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, SetShortAddr(&dev, reg, val));
+    // El valor ya está en la copia: no hay transacción ni se toca la interrupción.
+    TEST_ASSERT_EQUAL(OPERATION_OK, SetShortAddr(&dev, reg, val));
+}
+
 // comprobar que se envía una direccion de 1 byte y un dato por SPI con errores de comunicación
 void test_comprobar_que_se_envia_una_direccionde_1_byte_y_un_dato_por_SPI_con_errores_de_comunicacion(
     void) {
@@ -90,12 +330,12 @@ void test_comprobar_que_se_envia_una_direccionde_1_byte_y_un_dato_por_SPI_con_er
     uint8_t val = 0x20;
     uint8_t reg_address = adaptarDireccionSPI8WriteShort(reg);
     // Secuencia esperada
-    SetCSPin_Expect(false);
-    WriteByteSPIPort_ExpectAndReturn(&reg_address, SPI_COMM_ERROR);
-    WriteByteSPIPort_ExpectAndReturn(&val, SPI_COMM_OK);
-    SetCSPin_Expect(true);
+    SetCSPin_Expect(NULL, false);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_ERROR);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &val, SPI_COMM_OK);
+    SetCSPin_Expect(NULL, true);
     // retorno esperado
-    mrf24_state_t respuesta = SetShortAddr(reg, val);
+    mrf24_state_t respuesta = SetShortAddr(&dev, reg, val);
     TEST_ASSERT_EQUAL(OPERATION_FAIL, respuesta);
 }
 
@@ -108,13 +348,13 @@ void test_comprobar_que_se_lee_un_valor_al_consultar_una_direccionde_1_byte_por_
     uint8_t reg_address = adaptarDireccionSPI8ReadShort(reg);
     uint8_t resultado;
     // Secuencia esperada
-    SetCSPin_Expect(false);
-    WriteByteSPIPort_ExpectAndReturn(&reg_address, SPI_COMM_OK);
-    ReadByteSPIPort_ExpectAndReturn(&resultado, SPI_COMM_OK);
+    SetCSPin_Expect(NULL, false);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_OK);
+    ReadByteSPIPort_ExpectAndReturn(NULL, &resultado, SPI_COMM_OK);
     ReadByteSPIPort_ReturnThruPtr_respuesta(&valor_esperado);
-    SetCSPin_Expect(true);
+    SetCSPin_Expect(NULL, true);
     // retorno esperado
-    mrf24_state_t respuesta = GetShortAddr(reg, &resultado);
+    mrf24_state_t respuesta = GetShortAddr(&dev, reg, &resultado);
     TEST_ASSERT_EQUAL_HEX8(valor_esperado, resultado);
     TEST_ASSERT_EQUAL(OPERATION_OK, respuesta);
 }
@@ -129,13 +369,13 @@ void test_comprobar_que_se_lee_un_valor_al_consultar_una_direccionde_1_byte_por_
     uint8_t reg_address = adaptarDireccionSPI8ReadShort(reg);
     uint8_t resultado;
     // Secuencia esperada
-    SetCSPin_Expect(false);
-    WriteByteSPIPort_ExpectAndReturn(&reg_address, SPI_COMM_ERROR);
-    ReadByteSPIPort_ExpectAndReturn(&resultado, SPI_COMM_OK);
+    SetCSPin_Expect(NULL, false);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_ERROR);
+    ReadByteSPIPort_ExpectAndReturn(NULL, &resultado, SPI_COMM_OK);
     ReadByteSPIPort_ReturnThruPtr_respuesta(&valor_esperado);
-    SetCSPin_Expect(true);
+    SetCSPin_Expect(NULL, true);
     // retorno esperado
-    mrf24_state_t respuesta = GetShortAddr(reg, &resultado);
+    mrf24_state_t respuesta = GetShortAddr(&dev, reg, &resultado);
     TEST_ASSERT_EQUAL_HEX8(valor_esperado, resultado);
     TEST_ASSERT_EQUAL(OPERATION_FAIL, respuesta);
 }
@@ -150,13 +390,13 @@ void test_comprobar_que_se_lee_un_valor_al_consultar_una_direccionde_1_byte_por_
     uint8_t reg_address = adaptarDireccionSPI8ReadShort(reg);
     uint8_t resultado;
     // Secuencia esperada
-    SetCSPin_Expect(false);
-    WriteByteSPIPort_ExpectAndReturn(&reg_address, SPI_COMM_OK);
-    ReadByteSPIPort_ExpectAndReturn(&resultado, SPI_COMM_ERROR);
+    SetCSPin_Expect(NULL, false);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_OK);
+    ReadByteSPIPort_ExpectAndReturn(NULL, &resultado, SPI_COMM_ERROR);
     ReadByteSPIPort_ReturnThruPtr_respuesta(&valor_esperado);
-    SetCSPin_Expect(true);
+    SetCSPin_Expect(NULL, true);
     // retorno esperado
-    mrf24_state_t respuesta = GetShortAddr(reg, &resultado);
+    mrf24_state_t respuesta = GetShortAddr(&dev, reg, &resultado);
     TEST_ASSERT_EQUAL_HEX8(valor_esperado, resultado);
     TEST_ASSERT_EQUAL(OPERATION_FAIL, respuesta);
 }
@@ -167,7 +407,7 @@ void test_comprobar_que_se_lee_un_valor_al_consultar_una_direccionde_1_byte_por_
 
     uint8_t reg = 0x33;
     // retorno esperado
-    mrf24_state_t respuesta = GetShortAddr(reg, NULL);
+    mrf24_state_t respuesta = GetShortAddr(&dev, reg, NULL);
     TEST_ASSERT_EQUAL(INVALID_VALUE, respuesta);
 }
 
@@ -178,12 +418,12 @@ void test_comprobar_que_se_envia_una_direccionde_2_bytes_y_un_dato_por_SPI_sin_e
     uint8_t val = 0x11;
     uint16_t reg_address = adaptarDireccionSPI16WriteLong(reg);
     // Secuencia esperada
-    SetCSPin_Expect(false);
-    Write2ByteSPIPort_ExpectAndReturn(&reg_address, SPI_COMM_OK);
-    WriteByteSPIPort_ExpectAndReturn(&val, SPI_COMM_OK);
-    SetCSPin_Expect(true);
+    SetCSPin_Expect(NULL, false);
+    Write2ByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_OK);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &val, SPI_COMM_OK);
+    SetCSPin_Expect(NULL, true);
     // retorno esperado
-    mrf24_state_t estado = SetLongAddr(reg, val);
+    mrf24_state_t estado = SetLongAddr(&dev, reg, val);
     TEST_ASSERT_EQUAL_HEX8(OPERATION_OK, estado);
 }
 
@@ -195,12 +435,12 @@ void test_comprobar_que_se_envia_una_direccionde_2_bytes_y_un_dato_por_SPI_con_e
     uint8_t val = 0x13;
     uint16_t reg_address = adaptarDireccionSPI16WriteLong(reg);
     // Secuencia esperada
-    SetCSPin_Expect(false);
-    Write2ByteSPIPort_ExpectAndReturn(&reg_address, SPI_COMM_ERROR);
-    WriteByteSPIPort_ExpectAndReturn(&val, SPI_COMM_OK);
-    SetCSPin_Expect(true);
+    SetCSPin_Expect(NULL, false);
+    Write2ByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_ERROR);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &val, SPI_COMM_OK);
+    SetCSPin_Expect(NULL, true);
     // retorno esperado
-    mrf24_state_t estado = SetLongAddr(reg, val);
+    mrf24_state_t estado = SetLongAddr(&dev, reg, val);
     TEST_ASSERT_EQUAL_HEX8(OPERATION_FAIL, estado);
 }
 
@@ -212,12 +452,12 @@ void test_comprobar_que_se_envia_una_direccionde_2_bytes_y_un_dato_por_SPI_con_e
     uint8_t val = 0x99;
     uint16_t reg_address = adaptarDireccionSPI16WriteLong(reg);
     // Secuencia esperada
-    SetCSPin_Expect(false);
-    Write2ByteSPIPort_ExpectAndReturn(&reg_address, SPI_COMM_OK);
-    WriteByteSPIPort_ExpectAndReturn(&val, SPI_COMM_ERROR);
-    SetCSPin_Expect(true);
+    SetCSPin_Expect(NULL, false);
+    Write2ByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_OK);
+    WriteByteSPIPort_ExpectAndReturn(NULL, &val, SPI_COMM_ERROR);
+    SetCSPin_Expect(NULL, true);
     // retorno esperado
-    mrf24_state_t estado = SetLongAddr(reg, val);
+    mrf24_state_t estado = SetLongAddr(&dev, reg, val);
     TEST_ASSERT_EQUAL_HEX8(OPERATION_FAIL, estado);
 }
 
@@ -230,13 +470,13 @@ void test_comprobar_que_se_lee_un_valor_al_consultar_una_direccionde_2_bytes_por
     uint16_t reg_address = adaptarDireccionSPI16ReadLong(reg);
     uint8_t resultado = 0;
     // Secuencia esperada
-    SetCSPin_Expect(false);
-    Write2ByteSPIPort_ExpectAndReturn(&reg_address, SPI_COMM_OK);
-    ReadByteSPIPort_ExpectAndReturn(&resultado, SPI_COMM_OK);
+    SetCSPin_Expect(NULL, false);
+    Write2ByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_OK);
+    ReadByteSPIPort_ExpectAndReturn(NULL, &resultado, SPI_COMM_OK);
     ReadByteSPIPort_ReturnThruPtr_respuesta(&valor_esperado);
-    SetCSPin_Expect(true);
+    SetCSPin_Expect(NULL, true);
     // retorno esperado
-    mrf24_state_t estado = GetLongAddr(reg, &resultado);
+    mrf24_state_t estado = GetLongAddr(&dev, reg, &resultado);
     TEST_ASSERT_EQUAL_HEX8(valor_esperado, resultado);
     TEST_ASSERT_EQUAL_HEX8(OPERATION_OK, estado);
 }
@@ -251,13 +491,13 @@ void test_comprobar_que_se_lee_un_valor_al_consultar_una_direccionde_2_bytes_por
     uint16_t reg_address = adaptarDireccionSPI16ReadLong(reg);
     uint8_t resultado = 0;
     // Secuencia esperada
-    SetCSPin_Expect(false);
-    Write2ByteSPIPort_ExpectAndReturn(&reg_address, SPI_COMM_ERROR);
-    ReadByteSPIPort_ExpectAndReturn(&resultado, SPI_COMM_OK);
+    SetCSPin_Expect(NULL, false);
+    Write2ByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_ERROR);
+    ReadByteSPIPort_ExpectAndReturn(NULL, &resultado, SPI_COMM_OK);
     ReadByteSPIPort_ReturnThruPtr_respuesta(&valor_esperado);
-    SetCSPin_Expect(true);
+    SetCSPin_Expect(NULL, true);
     // retorno esperado
-    mrf24_state_t estado = GetLongAddr(reg, &resultado);
+    mrf24_state_t estado = GetLongAddr(&dev, reg, &resultado);
     TEST_ASSERT_EQUAL_HEX8(valor_esperado, resultado);
     TEST_ASSERT_EQUAL_HEX8(OPERATION_FAIL, estado);
 }
@@ -272,13 +512,13 @@ void test_comprobar_que_se_lee_un_valor_al_consultar_una_direccionde_2_bytes_por
     uint16_t reg_address = adaptarDireccionSPI16ReadLong(reg);
     uint8_t resultado = 0;
     // Secuencia esperada
-    SetCSPin_Expect(false);
-    Write2ByteSPIPort_ExpectAndReturn(&reg_address, SPI_COMM_OK);
-    ReadByteSPIPort_ExpectAndReturn(&resultado, SPI_COMM_ERROR);
+    SetCSPin_Expect(NULL, false);
+    Write2ByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_OK);
+    ReadByteSPIPort_ExpectAndReturn(NULL, &resultado, SPI_COMM_ERROR);
     ReadByteSPIPort_ReturnThruPtr_respuesta(&valor_esperado);
-    SetCSPin_Expect(true);
+    SetCSPin_Expect(NULL, true);
     // retorno esperado
-    mrf24_state_t estado = GetLongAddr(reg, &resultado);
+    mrf24_state_t estado = GetLongAddr(&dev, reg, &resultado);
     TEST_ASSERT_EQUAL_HEX8(valor_esperado, resultado);
     TEST_ASSERT_EQUAL_HEX8(OPERATION_FAIL, estado);
 }
@@ -290,7 +530,7 @@ void test_comprobar_que_se_lee_un_valor_al_consultar_una_direccionde_2_bytes_por
 
     uint16_t reg = 0x0222;
     // retorno esperado
-    mrf24_state_t estado = GetLongAddr(reg, NULL);
+    mrf24_state_t estado = GetLongAddr(&dev, reg, NULL);
     TEST_ASSERT_EQUAL_HEX8(INVALID_VALUE, estado);
 }
 
@@ -301,17 +541,17 @@ void test_ApplyChannel_devuelve_fail_si_SetLongAddr_falla(void) {
     WriteByteSPIPort_IgnoreAndReturn(SPI_COMM_OK);
     Write2ByteSPIPort_IgnoreAndReturn(SPI_COMM_ERROR);
     // retorno esperado
-    mrf24_state_t respuesta = ApplyChannel();
+    mrf24_state_t respuesta = ApplyChannel(&dev);
     TEST_ASSERT_EQUAL(OPERATION_FAIL, respuesta);
 }
 
 // probar que MRF24IsNewMsg devuelve UNEXPECTED_ERROR si estadoActual no esta inicializado
 void test_MRF24IsNewMsg_devuelve_UNEXPECTED_ERROR_si_estadoActual_no_esta_inicializado(void) {
 
-    estadoActual = INIT_FAIL;
+    dev.estado = INIT_FAIL;
     IsMRF24Interrup_IgnoreAndReturn(true);
     // retorno esperado
-    mrf24_state_t respuesta = MRF24IsNewMsg();
+    mrf24_state_t respuesta = MRF24IsNewMsg(&dev);
     TEST_ASSERT_EQUAL(UNEXPECTED_ERROR, respuesta);
 }
 
@@ -319,19 +559,1056 @@ void test_MRF24IsNewMsg_devuelve_UNEXPECTED_ERROR_si_estadoActual_no_esta_inicia
 void test_MRF24IsNewMsg_devuelve_MSG_PRESENT_si_la_bandera_de_mensaje_pendiente_esta_levantada(
     void) {
 
-    estadoActual = INIT_OK;
+    dev.estado = INIT_OK;
     IsMRF24Interrup_IgnoreAndReturn(true);
     // retorno esperado
-    mrf24_state_t respuesta = MRF24IsNewMsg();
+    mrf24_state_t respuesta = MRF24IsNewMsg(&dev);
     TEST_ASSERT_EQUAL(MSG_PRESENT, respuesta);
 }
 
 // probar que MRF24IsNewMsg devuelve MSG_PRESENT si la bandera de mensaje pendiente esta baja
 void test_MRF24IsNewMsg_devuelve_MSG_PRESENT_si_la_bandera_de_mensaje_pendiente_esta_baja(void) {
 
-    estadoActual = INIT_OK;
+    dev.estado = INIT_OK;
     IsMRF24Interrup_IgnoreAndReturn(false);
     // retorno esperado
-    mrf24_state_t respuesta = MRF24IsNewMsg();
+    mrf24_state_t respuesta = MRF24IsNewMsg(&dev);
     TEST_ASSERT_EQUAL(BUFFER_EMPTY, respuesta);
 }
+
+// comprobar que se envía una direccion de 2 bytes y un bloque de datos en una sola transaccion SPI
+void test_comprobar_que_se_envia_una_direccion_de_2_bytes_y_un_bloque_de_datos_en_una_sola_transaccion_SPI(
+    void) {
+
+    uint16_t reg = 0x0000;
+    uint8_t datos[] = {0x09, 0x0C, 0x61, 0x88};
+    uint16_t reg_address = adaptarDireccionSPI16WriteLong(reg);
+    // Secuencia esperada
+    SetCSPin_Expect(NULL, false);
+    Write2ByteSPIPort_ExpectAndReturn(NULL, &reg_address, SPI_COMM_OK);
+    WriteBlockSPIPort_ExpectAndReturn(NULL, datos, sizeof(datos), SPI_COMM_OK);
+    SetCSPin_Expect(NULL, true);
+    // retorno esperado
+    mrf24_state_t estado = SetLongAddrBlock(&dev, reg, datos, sizeof(datos));
+    TEST_ASSERT_EQUAL(OPERATION_OK, estado);
+}
+
+// comprobar que una trama de 116 bytes se carga en la FIFO con una sola transaccion SPI
+void test_comprobar_que_una_trama_de_116_bytes_se_carga_en_la_FIFO_con_una_sola_transaccion_SPI(
+    void) {
+
+    mrf24_data_out_t data_out = {.dest_panid = 0x1234, .dest_address = 0x0002};
+    data_out.origin_address = 0x0001;
+    data_out.buffer_size = MAX_PAYLOAD_SIZE;
+    memset(data_out.buffer, 0x5A, MAX_PAYLOAD_SIZE);
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    // retorno esperado
+    mrf24_state_t respuesta = MRF24TransmitirDato(&dev, &data_out);
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, respuesta);
+    // Antes: 128 escrituras de 3 bytes (cabecera, datos y relleno) más TXNCON, 129
+    // transacciones y 386 bytes. Ahora: la FIFO en una transacción más TXNCON.
+    TEST_ASSERT_EQUAL(2, spi_transacciones);
+    TEST_ASSERT_EQUAL(_2_BYTES + 2 + 9 + MAX_PAYLOAD_SIZE + _2_BYTES, spi_bytes);
+    TEST_ASSERT_EQUAL_HEX8(9, bloque_enviado[0]);
+    TEST_ASSERT_EQUAL_HEX8(9 + MAX_PAYLOAD_SIZE, bloque_enviado[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x34, bloque_enviado[5]);
+    TEST_ASSERT_EQUAL_HEX8(0x12, bloque_enviado[6]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, bloque_enviado[7]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, bloque_enviado[9]);
+    TEST_ASSERT_EQUAL_HEX8(0x5A, bloque_enviado[11 + MAX_PAYLOAD_SIZE - 1]);
+}
+
+// probar que MRF24TransmitirDato rechaza datos que no entran en una trama
+void test_probar_que_MRF24TransmitirDato_rechaza_datos_que_no_entran_en_una_trama(void) {
+
+    mrf24_data_out_t data_out = {.dest_address = 0x0002, .buffer_size = MAX_PAYLOAD_SIZE + 1};
+    dev.estado = INIT_OK;
+    // retorno esperado
+    mrf24_state_t respuesta = MRF24TransmitirDato(&dev, &data_out);
+    TEST_ASSERT_EQUAL(TO_LONG_MSG, respuesta);
+}
+
+// comprobar que una trama recibida se lee de la FIFO junto con el LQI y el RSSI en una sola
+// transaccion SPI
+void test_comprobar_que_una_trama_recibida_se_lee_de_la_FIFO_junto_con_el_LQI_y_el_RSSI_en_una_sola_transaccion_SPI(
+    void) {
+
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    ReadBlockSPIPort_Stub(leerBloqueFifoRx);
+    // retorno esperado
+    mrf24_state_t respuesta = MRF24ReciboPaquete(&dev);
+    TEST_ASSERT_EQUAL(MSG_READ, respuesta);
+    // Lectura de INTSTAT, bloqueo de recepción, lectura de la FIFO y desbloqueo.
+    TEST_ASSERT_EQUAL(4, spi_transacciones);
+    mrf24_data_in_t * data_in = MRF24GetDataIn(&dev);
+    TEST_ASSERT_NOT_NULL(data_in);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, data_in->panid);
+    TEST_ASSERT_EQUAL_HEX16(0x0002, data_in->address);
+    TEST_ASSERT_EQUAL(4, data_in->buffer_size);
+    TEST_ASSERT_EQUAL_MEMORY("hola", data_in->buffer, 4);
+    TEST_ASSERT_EQUAL_HEX8(0xC8, data_in->lqi);
+    TEST_ASSERT_EQUAL_HEX8(0x9D, data_in->rssi);
+}
+
+// probar que MRF24ReciboPaquete descarta una trama con un largo invalido
+void test_probar_que_MRF24ReciboPaquete_descarta_una_trama_con_un_largo_invalido(void) {
+
+    uint8_t intstat = RXIF;
+    uint8_t largo_invalido = 0x03;
+    dev.estado = INIT_OK;
+    SetCSPin_Ignore();
+    WriteByteSPIPort_IgnoreAndReturn(SPI_COMM_OK);
+    Write2ByteSPIPort_IgnoreAndReturn(SPI_COMM_OK);
+    ReadByteSPIPort_ExpectAnyArgsAndReturn(SPI_COMM_OK);
+    ReadByteSPIPort_ReturnThruPtr_respuesta(&intstat);
+    ReadByteSPIPort_ExpectAnyArgsAndReturn(SPI_COMM_OK);
+    ReadByteSPIPort_ReturnThruPtr_respuesta(&largo_invalido);
+    // retorno esperado
+    mrf24_state_t respuesta = MRF24ReciboPaquete(&dev);
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, respuesta);
+    TEST_ASSERT_NULL(MRF24GetDataIn(&dev));
+}
+
+// probar que MRF24InterruptHandler no lee la FIFO si la interrupcion no es de recepcion
+void test_probar_que_MRF24InterruptHandler_no_lee_la_FIFO_si_la_interrupcion_no_es_de_recepcion(
+    void) {
+
+    uint8_t intstat = WAKEIF;
+    dev.estado = INIT_OK;
+    SetCSPin_Ignore();
+    WriteByteSPIPort_IgnoreAndReturn(SPI_COMM_OK);
+    ReadByteSPIPort_ExpectAnyArgsAndReturn(SPI_COMM_OK);
+    ReadByteSPIPort_ReturnThruPtr_respuesta(&intstat);
+    // retorno esperado
+    mrf24_state_t respuesta = MRF24InterruptHandler(&dev);
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, respuesta);
+}
+
+// probar que las tramas se guardan en orden en el buffer de recepcion y que al llenarse se cuentan
+// los overruns
+void test_probar_que_las_tramas_se_guardan_en_orden_en_el_buffer_de_recepcion_y_que_al_llenarse_se_cuentan_los_overruns(
+    void) {
+
+    mrf24_rx_stats_t antes;
+    mrf24_rx_stats_t despues;
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    ReadBlockSPIPort_Stub(leerBloqueFifoRx);
+    MRF24GetRxStats(&dev, &antes);
+
+    for (marca_rx = 0; marca_rx < RX_RING_SIZE; marca_rx++) {
+
+        TEST_ASSERT_EQUAL(MSG_READ, MRF24InterruptHandler(&dev));
+    }
+    TEST_ASSERT_EQUAL(BUFFER_FULL, MRF24InterruptHandler(&dev));
+    MRF24GetRxStats(&dev, &despues);
+    TEST_ASSERT_EQUAL(RX_RING_SIZE, despues.received - antes.received);
+    TEST_ASSERT_EQUAL(1, despues.overruns - antes.overruns);
+    TEST_ASSERT_EQUAL(MSG_PRESENT, MRF24IsNewMsg(&dev));
+
+    for (uint8_t i = 0; i < RX_RING_SIZE; i++) {
+
+        TEST_ASSERT_EQUAL(i, MRF24GetDataIn(&dev)->buffer[0]);
+        TEST_ASSERT_EQUAL(OPERATION_OK, MRF24ReleaseDataIn(&dev));
+    }
+    TEST_ASSERT_NULL(MRF24GetDataIn(&dev));
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, MRF24ReleaseDataIn(&dev));
+    marca_rx = 'h';
+}
+
+// comprobar que los segmentos se envian a la FIFO desde donde estan, sin copias y en una sola
+// transaccion SPI
+void test_comprobar_que_los_segmentos_se_envian_a_la_FIFO_desde_donde_estan_sin_copias_y_en_una_sola_transaccion_SPI(
+    void) {
+
+    const uint8_t cabecera_app[] = {0xA1, 0x02};
+    const uint8_t sensores[] = {0x10, 0x20, 0x30, 0x40, 0x50};
+    mrf24_segment_t segmentos[] = {{cabecera_app, sizeof(cabecera_app)},
+                                   {sensores, sizeof(sensores)}};
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    // retorno esperado
+    mrf24_state_t respuesta = MRF24TransmitirSegmentos(&dev, 0x1234, 0x0002, segmentos, 2);
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, respuesta);
+    TEST_ASSERT_EQUAL(2, spi_transacciones);
+    TEST_ASSERT_EQUAL(3, cantidad_bloques);
+    TEST_ASSERT_EQUAL_PTR(cabecera_app, bloques_enviados[1]);
+    TEST_ASSERT_EQUAL_PTR(sensores, bloques_enviados[2]);
+    TEST_ASSERT_EQUAL_HEX8(9 + sizeof(cabecera_app) + sizeof(sensores), bloque_enviado[1]);
+    TEST_ASSERT_EQUAL_MEMORY(cabecera_app, &bloque_enviado[11], sizeof(cabecera_app));
+    TEST_ASSERT_EQUAL_MEMORY(sensores, &bloque_enviado[13], sizeof(sensores));
+}
+
+// probar que MRF24TransmitirSegmentos rechaza segmentos que en total no entran en una trama
+void test_probar_que_MRF24TransmitirSegmentos_rechaza_segmentos_que_en_total_no_entran_en_una_trama(
+    void) {
+
+    uint8_t datos[MAX_PAYLOAD_SIZE] = {0};
+    mrf24_segment_t segmentos[] = {{datos, MAX_PAYLOAD_SIZE}, {datos, 1}};
+    dev.estado = INIT_OK;
+    // retorno esperado
+    TEST_ASSERT_EQUAL(TO_LONG_MSG, MRF24TransmitirSegmentos(&dev, 0x1234, 0x0002, segmentos, 2));
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, MRF24TransmitirSegmentos(&dev, 0x1234, 0x0002, segmentos, 0));
+    TEST_ASSERT_EQUAL(DIRECTION_EMPTY, MRF24TransmitirSegmentos(&dev, 0x1234, VACIO, segmentos, 1));
+}
+
+// probar que una trama a BROADCAST no pide ACK y una unicast si, en la cabecera y en TXNCON
+void test_probar_que_una_trama_a_BROADCAST_no_pide_ACK_y_una_unicast_si(void) {
+
+    mrf24_data_out_t data_out = {.dest_panid = 0x1234, .dest_address = BROADCAST, .buffer_size = 1};
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    // retorno esperado
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24TransmitirDato(&dev, &data_out));
+    TEST_ASSERT_EQUAL_HEX8(DATA | INTRA_PAN, bloque_enviado[2]);
+    TEST_ASSERT_EQUAL_HEX8(adaptarDireccionSPI8WriteShort(TXNCON), bytes_escritos[0]);
+    TEST_ASSERT_EQUAL_HEX8(TXNTRIG, bytes_escritos[1]);
+
+    dev.tx_en_curso = VACIO;
+    data_out.dest_address = 0x0002;
+    contarTraficoSPI();
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24TransmitirDato(&dev, &data_out));
+    TEST_ASSERT_EQUAL_HEX8(DATA | ACK_REQ | INTRA_PAN, bloque_enviado[2]);
+    TEST_ASSERT_EQUAL_HEX8(TXNACKREQ | TXNTRIG, bytes_escritos[1]);
+}
+
+// comprobar que MRF24TransmitirTrama arma la cabecera con el direccionamiento pedido y calcula su
+// largo
+void test_comprobar_que_MRF24TransmitirTrama_arma_la_cabecera_con_el_direccionamiento_pedido_y_calcula_su_largo(
+    void) {
+
+    const uint8_t destino[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    const uint8_t esperada[] = {17, 17 + 4, DATA, LONG_D_ADD | SHORT_S_ADD, 0x00, 0x78, 0x56,
+                                0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x34, 0x12,
+                                0x01, 0x00};
+    mrf24_frame_opts_t opciones = {.type = FRAME_DATA, .dest_mode = ADDR_LONG,
+                                   .src_mode = ADDR_SHORT, .dest_panid = 0x5678,
+                                   .src_address = 0x0001};
+    mrf24_segment_t segmento = {(const uint8_t *)"hola", 4};
+    memcpy(opciones.dest_long, destino, sizeof(destino));
+    dev.estado = INIT_OK;
+    dev.config.panid = 0x1234;
+    contarTraficoSPI();
+    // retorno esperado
+    TEST_ASSERT_EQUAL(17, MRF24LargoCabecera(&opciones));
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24TransmitirTrama(&dev, &opciones, &segmento, 1));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(esperada, bloque_enviado, sizeof(esperada));
+    TEST_ASSERT_EQUAL_MEMORY("hola", &bloque_enviado[sizeof(esperada)], 4);
+    TEST_ASSERT_EQUAL_HEX8(TXNTRIG, bytes_escritos[1]);
+
+    dev.tx_en_curso = VACIO;
+    opciones.ack = true;
+    opciones.pan_compression = true;
+    opciones.src_mode = ADDR_LONG;
+    contarTraficoSPI();
+    TEST_ASSERT_EQUAL(21, MRF24LargoCabecera(&opciones));
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24TransmitirTrama(&dev, &opciones, &segmento, 1));
+    TEST_ASSERT_EQUAL_HEX8(DATA | ACK_REQ | INTRA_PAN, bloque_enviado[2]);
+    TEST_ASSERT_EQUAL_HEX8(LONG_D_ADD | LONG_S_ADD, bloque_enviado[3]);
+    TEST_ASSERT_EQUAL_MEMORY(dev.config.mac, &bloque_enviado[15], LARGE_MAC_SIZE);
+    TEST_ASSERT_EQUAL_HEX8(TXNACKREQ | TXNTRIG, bytes_escritos[1]);
+}
+
+// probar que MRF24TransmitirTrama rechaza opciones imposibles y datos que no entran con la
+// cabecera elegida
+void test_probar_que_MRF24TransmitirTrama_rechaza_opciones_imposibles_y_datos_que_no_entran(void) {
+
+    uint8_t datos[MAX_PAYLOAD_SIZE] = {0};
+    mrf24_segment_t segmento = {datos, MAX_PAYLOAD_SIZE};
+    mrf24_frame_opts_t opciones = {.type = FRAME_DATA, .dest_mode = ADDR_LONG,
+                                   .src_mode = ADDR_LONG};
+    dev.estado = INIT_OK;
+    // retorno esperado
+    TEST_ASSERT_EQUAL(TO_LONG_MSG, MRF24TransmitirTrama(&dev, &opciones, &segmento, 1));
+    opciones.dest_mode = ADDR_NONE;
+    opciones.src_mode = ADDR_NONE;
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24TransmitirTrama(&dev, &opciones, &segmento, 1));
+    opciones.src_mode = ADDR_SHORT;
+    opciones.pan_compression = true;
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24TransmitirTrama(&dev, &opciones, &segmento, 1));
+    opciones.pan_compression = false;
+    opciones.dest_mode = (mrf24_addr_mode_t)1;
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24TransmitirTrama(&dev, &opciones, &segmento, 1));
+    opciones.dest_mode = ADDR_SHORT;
+    TEST_ASSERT_EQUAL(DIRECTION_EMPTY, MRF24TransmitirTrama(&dev, &opciones, &segmento, 1));
+    opciones.type = (mrf24_frame_type_t)ACK;
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24TransmitirTrama(&dev, &opciones, &segmento, 1));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24TransmitirTrama(&dev, NULL, &segmento, 1));
+}
+
+// comprobar que una trama recibida con origen largo y de otro PAN se decodifica y que una con un
+// modo de direccionamiento reservado se descarta
+void test_comprobar_que_una_trama_con_origen_largo_de_otro_PAN_se_decodifica_y_una_con_modo_reservado_se_descarta(
+    void) {
+
+    const uint8_t trama_larga[] = {0x01, 0xC8, 0x07, 0x34, 0x12, 0x02, 0x00, 0x78, 0x56,
+                                   0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 'h',
+                                   'o',  'l',  'a',  0xAA, 0xBB, 0xC8, 0x9D};
+    const uint8_t trama_reservada[] = {0x41, 0x84, 0x07, 0x34, 0x12, 0x02, 0x00,
+                                       'h',  0xAA, 0xBB, 0xC8, 0x9D};
+    mrf24_rx_stats_t stats;
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    ReadBlockSPIPort_Stub(leerTramaCargada);
+    // retorno esperado
+    recibirTrama(trama_larga, sizeof(trama_larga), MSG_READ);
+    mrf24_data_in_t * data_in = MRF24GetDataIn(&dev);
+    TEST_ASSERT_NOT_NULL(data_in);
+    TEST_ASSERT_EQUAL_HEX16(0x5678, data_in->panid);
+    TEST_ASSERT_EQUAL_HEX16(NO_SHORT_ADDRESS, data_in->address);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&trama_larga[9], data_in->long_address, LARGE_MAC_SIZE);
+    TEST_ASSERT_EQUAL(4, data_in->buffer_size);
+    TEST_ASSERT_EQUAL_MEMORY("hola", data_in->buffer, 4);
+    MRF24ReleaseDataIn(&dev);
+
+    recibirTrama(trama_reservada, sizeof(trama_reservada), OPERATION_FAIL);
+    TEST_ASSERT_NULL(MRF24GetDataIn(&dev));
+    MRF24GetRxStats(&dev, &stats);
+    TEST_ASSERT_EQUAL(1, stats.errors);
+}
+
+// comprobar que una trama con la cabecera mas corta y sin datos se entrega en lugar de descartarse
+void test_comprobar_que_una_trama_con_la_cabecera_mas_corta_y_sin_datos_se_entrega(void) {
+
+    const uint8_t trama_corta[] = {0x41, 0x08, 0x07, 0x34, 0x12, 0x01,
+                                   0x00, 0xAA, 0xBB, 0xC8, 0x9D};
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    ReadBlockSPIPort_Stub(leerTramaCargada);
+    // retorno esperado
+    recibirTrama(trama_corta, sizeof(trama_corta), MSG_READ);
+    mrf24_data_in_t * data_in = MRF24GetDataIn(&dev);
+    TEST_ASSERT_NOT_NULL(data_in);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, data_in->panid);
+    TEST_ASSERT_EQUAL(0, data_in->buffer_size);
+}
+
+// probar que una transmision asincronica queda pendiente hasta que el modulo avisa con TXNIF
+void test_probar_que_una_transmision_asincronica_queda_pendiente_hasta_que_el_modulo_avisa_con_TXNIF(
+    void) {
+
+    mrf24_data_out_t data_out = {.dest_address = 0x0002, .buffer_size = 1};
+    mrf24_tx_handle_t handle = VACIO;
+    mrf24_tx_handle_t otro_handle = VACIO;
+    mrf24_tx_result_t resultado;
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    llamadas_callback = 0;
+    MRF24SetTxCallback(&dev, guardarResultadoTx);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&dev, &data_out, &handle));
+    TEST_ASSERT_NOT_EQUAL(VACIO, handle);
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24GetTxStatus(&dev, handle, &resultado));
+    TEST_ASSERT_EQUAL(TX_PENDING, resultado.status);
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24TransmitirAsync(&dev, &data_out, &otro_handle));
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24TransmitirDato(&dev, &data_out));
+    TEST_ASSERT_EQUAL(0, llamadas_callback);
+
+    terminarTransmision(TXNRETRY0);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetTxStatus(&dev, handle, &resultado));
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    TEST_ASSERT_EQUAL(1, resultado.retries);
+    TEST_ASSERT_EQUAL(1, llamadas_callback);
+    TEST_ASSERT_EQUAL(handle, resultado_callback.handle);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&dev, &data_out, &otro_handle));
+    TEST_ASSERT_NOT_EQUAL(handle, otro_handle);
+}
+
+// probar que TXSTAT se informa como falta de ACK o canal ocupado segun corresponda
+void test_probar_que_TXSTAT_se_informa_como_falta_de_ACK_o_canal_ocupado_segun_corresponda(void) {
+
+    mrf24_data_out_t data_out = {.dest_address = 0x0002, .buffer_size = 1};
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    // retorno esperado
+    MRF24TransmitirAsync(&dev, &data_out, &handle);
+    terminarTransmision(TXNRETRY1 | TXNRETRY0 | TXNSTAT);
+    MRF24GetTxStatus(&dev, handle, &resultado);
+    TEST_ASSERT_EQUAL(TX_NO_ACK, resultado.status);
+    TEST_ASSERT_EQUAL(3, resultado.retries);
+
+    MRF24TransmitirAsync(&dev, &data_out, &handle);
+    terminarTransmision(CCAFAIL | TXNSTAT);
+    MRF24GetTxStatus(&dev, handle, &resultado);
+    TEST_ASSERT_EQUAL(TX_CHANNEL_BUSY, resultado.status);
+    TEST_ASSERT_EQUAL(0, resultado.retries);
+}
+
+// probar que la cola de transmision atiende los destinos por turno y dispara la siguiente trama al
+// terminar la anterior
+void test_probar_que_la_cola_de_transmision_atiende_los_destinos_por_turno_y_dispara_la_siguiente_trama_al_terminar_la_anterior(
+    void) {
+
+    mrf24_data_out_t para_a = {.dest_address = 0x000A, .buffer_size = 1};
+    mrf24_data_out_t para_b = {.dest_address = 0x000B, .buffer_size = 1};
+    mrf24_tx_handle_t a1, a2, b1;
+    mrf24_tx_result_t resultado;
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    llamadas_callback = 0;
+    MRF24SetTxCallback(&dev, guardarResultadoTx);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&dev, &para_a, &a1));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&dev, &para_a, &a2));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&dev, &para_b, &b1));
+    // La primera sale apenas se encola, las otras esperan en la cola.
+    TEST_ASSERT_EQUAL_HEX8(0x0A, bloque_enviado[7]);
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24GetTxStatus(&dev, a2, &resultado));
+    TEST_ASSERT_EQUAL(TX_PENDING, resultado.status);
+
+    terminarTransmision(VACIO);
+    TEST_ASSERT_EQUAL_HEX8(0x0B, bloque_enviado[7]);
+    terminarTransmision(VACIO);
+    TEST_ASSERT_EQUAL_HEX8(0x0A, bloque_enviado[7]);
+    terminarTransmision(VACIO);
+    TEST_ASSERT_EQUAL(3, llamadas_callback);
+    TEST_ASSERT_EQUAL(a1, resultados_callback[0].handle);
+    TEST_ASSERT_EQUAL(b1, resultados_callback[1].handle);
+    TEST_ASSERT_EQUAL(a2, resultados_callback[2].handle);
+    // Los resultados de toda la tanda siguen disponibles.
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetTxStatus(&dev, a1, &resultado));
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetTxStatus(&dev, b1, &resultado));
+    TEST_ASSERT_EQUAL(b1, resultado.handle);
+}
+
+// probar que un destino que no responde no bloquea a los demas y sus tramas se descartan tras
+// varios fallos seguidos
+void test_probar_que_un_destino_que_no_responde_no_bloquea_a_los_demas_y_sus_tramas_se_descartan_tras_varios_fallos_seguidos(
+    void) {
+
+    mrf24_data_out_t para_a = {.dest_address = 0x000A, .buffer_size = 1};
+    mrf24_data_out_t para_b = {.dest_address = 0x000B, .buffer_size = 1};
+    mrf24_tx_handle_t handle;
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    llamadas_callback = 0;
+    MRF24SetTxCallback(&dev, guardarResultadoTx);
+
+    for (uint8_t i = 0; i < TX_QUEUE_MAX_FAILS + 2; i++) {
+
+        TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&dev, &para_a, &handle));
+    }
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&dev, &para_b, &handle));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&dev, &para_b, &handle));
+    // retorno esperado
+    uint8_t tramas_a_b = 0;
+
+    for (uint8_t i = 0; i < TX_QUEUE_MAX_FAILS + 2; i++) {
+
+        if (0x0B == bloque_enviado[7])
+            tramas_a_b++;
+        terminarTransmision((0x0A == bloque_enviado[7]) ? (TXNRETRY1 | TXNRETRY0 | TXNSTAT)
+                                                        : VACIO);
+    }
+    TEST_ASSERT_EQUAL(2, tramas_a_b);
+    TEST_ASSERT_EQUAL(TX_QUEUE_MAX_FAILS + 4, llamadas_callback);
+    TEST_ASSERT_EQUAL(TX_DROPPED, resultados_callback[llamadas_callback - 1].status);
+    TEST_ASSERT_EQUAL(TX_DROPPED, resultados_callback[llamadas_callback - 2].status);
+}
+
+// probar que el fin de una trama sin identificador, como el beacon request de un escaneo, no
+// borra los fallos seguidos del ultimo destino
+void test_probar_que_el_fin_de_una_trama_sin_identificador_no_borra_los_fallos_del_ultimo_destino(
+    void) {
+
+    mrf24_data_out_t para_a = {.dest_address = 0x000A, .buffer_size = 1};
+    mrf24_tx_handle_t handle;
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    llamadas_callback = 0;
+    MRF24SetTxCallback(&dev, guardarResultadoTx);
+
+    for (uint8_t i = 0; i < TX_QUEUE_MAX_FAILS - 1; i++) {
+
+        TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&dev, &para_a, &handle));
+        terminarTransmision(TXNRETRY1 | TXNRETRY0 | TXNSTAT);
+    }
+    // retorno esperado
+    terminarTransmision(VACIO);
+    TEST_ASSERT_EQUAL(TX_QUEUE_MAX_FAILS - 1, llamadas_callback);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&dev, &para_a, &handle));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&dev, &para_a, &handle));
+    terminarTransmision(TXNRETRY1 | TXNRETRY0 | TXNSTAT);
+    TEST_ASSERT_EQUAL(TX_QUEUE_MAX_FAILS + 1, llamadas_callback);
+    TEST_ASSERT_EQUAL(handle, resultados_callback[llamadas_callback - 1].handle);
+    TEST_ASSERT_EQUAL(TX_DROPPED, resultados_callback[llamadas_callback - 1].status);
+}
+
+// probar que la cola de transmision avisa cuando no hay lugar
+void test_probar_que_la_cola_de_transmision_avisa_cuando_no_hay_lugar(void) {
+
+    mrf24_data_out_t data_out = {.dest_address = 0x000A, .buffer_size = 1};
+    mrf24_tx_handle_t handle;
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    // retorno esperado
+    for (uint8_t i = 0; i < TX_QUEUE_SIZE; i++) {
+
+        TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&dev, &data_out, &handle));
+    }
+    // Una trama ya está en el aire, así que entra una más.
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&dev, &data_out, &handle));
+    TEST_ASSERT_EQUAL(BUFFER_FULL, MRF24EncolarDato(&dev, &data_out, &handle));
+
+    for (uint8_t i = 0; i < TX_QUEUE_DESTINATIONS; i++) {
+
+        data_out.dest_address = 0x0100 + i;
+        MRF24EncolarDato(&dev, &data_out, &handle);
+    }
+    TEST_ASSERT_EQUAL(BUFFER_FULL, MRF24EncolarDato(&dev, &data_out, &handle));
+}
+
+// probar que MRF24J40Init no bloquea y que la inicializacion termina llamando a MRF24Poll
+void test_probar_que_MRF24J40Init_no_bloquea_y_que_la_inicializacion_termina_llamando_a_MRF24Poll(
+    void) {
+
+    uint8_t llamadas = 0;
+    softrst_trabado = false;
+    prepararInicializacion(true);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INIT_IN_PROGRESS, MRF24J40Init(&dev, &puerto));
+    TEST_ASSERT_EQUAL(INIT_STEP_RESET_PIN, MRF24GetInitStep(&dev));
+
+    while (INIT_IN_PROGRESS == MRF24Poll(&dev) && llamadas < 20)
+        llamadas++;
+    TEST_ASSERT_EQUAL(INIT_OK, dev.estado);
+    TEST_ASSERT_EQUAL(INIT_STEP_DONE, MRF24GetInitStep(&dev));
+    TEST_ASSERT_EQUAL(INIT_STEP_DONE - INIT_STEP_RESET_PIN - 1, llamadas);
+}
+
+// probar que la inicializacion no avanza mientras no se cumple la espera del reset
+void test_probar_que_la_inicializacion_no_avanza_mientras_no_se_cumple_la_espera_del_reset(void) {
+
+    softrst_trabado = false;
+    prepararInicializacion(false);
+    MRF24J40Init(&dev, &puerto);
+    // retorno esperado
+    for (uint8_t i = 0; i < 5; i++) {
+
+        TEST_ASSERT_EQUAL(INIT_IN_PROGRESS, MRF24Poll(&dev));
+    }
+    TEST_ASSERT_EQUAL(INIT_STEP_RESET_PIN, MRF24GetInitStep(&dev));
+    TEST_ASSERT_EQUAL(0, spi_transacciones);
+}
+
+// probar que la inicializacion informa time out si el reset por software no termina
+void test_probar_que_la_inicializacion_informa_time_out_si_el_reset_por_software_no_termina(
+    void) {
+
+    uint8_t llamadas = 0;
+    softrst_trabado = true;
+    prepararInicializacion(true);
+    MRF24J40Init(&dev, &puerto);
+    // retorno esperado
+    while (INIT_IN_PROGRESS == MRF24Poll(&dev) && llamadas < 20)
+        llamadas++;
+    TEST_ASSERT_EQUAL(TIME_OUT_OCURRED, dev.estado);
+    TEST_ASSERT_EQUAL(INIT_STEP_FAILED, MRF24GetInitStep(&dev));
+}
+
+// comprobar que escribir un registro con el valor que ya tiene no genera trafico SPI
+void test_comprobar_que_escribir_un_registro_con_el_valor_que_ya_tiene_no_genera_trafico_SPI(
+    void) {
+
+    contarTraficoSPI();
+    TEST_ASSERT_EQUAL(OPERATION_OK, SetShortAddr(&dev, PACON2, FIFOEN));
+    TEST_ASSERT_EQUAL(OPERATION_OK, SetLongAddr(&dev, RFCON1, VCOOPT1));
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, SetShortAddr(&dev, PACON2, FIFOEN));
+    TEST_ASSERT_EQUAL(OPERATION_OK, SetLongAddr(&dev, RFCON1, VCOOPT1));
+    TEST_ASSERT_EQUAL(2, spi_transacciones);
+    TEST_ASSERT_EQUAL(OPERATION_OK, SetShortAddr(&dev, PACON2, VACIO));
+    TEST_ASSERT_EQUAL(3, spi_transacciones);
+}
+
+// comprobar que los registros de control se leen de la copia y los de estado siempre del modulo
+void test_comprobar_que_los_registros_de_control_se_leen_de_la_copia_y_los_de_estado_siempre_del_modulo(
+    void) {
+
+    uint8_t lectura = VACIO;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    SetShortAddr(&dev, BBREG2, CCA_MODE_1);
+    SetLongAddr(&dev, RFCON0, CH_11);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, GetShortAddr(&dev, BBREG2, &lectura));
+    TEST_ASSERT_EQUAL(CCA_MODE_1, lectura);
+    TEST_ASSERT_EQUAL(OPERATION_OK, GetLongAddr(&dev, RFCON0, &lectura));
+    TEST_ASSERT_EQUAL(CH_11, lectura);
+    TEST_ASSERT_EQUAL(2, spi_transacciones);
+    GetShortAddr(&dev, INTSTAT, &lectura);
+    GetShortAddr(&dev, INTSTAT, &lectura);
+    GetLongAddr(&dev, RFSTATE, &lectura);
+    TEST_ASSERT_EQUAL(5, spi_transacciones);
+}
+
+// comprobar que el reset por software descarta la copia de los registros
+void test_comprobar_que_el_reset_por_software_descarta_la_copia_de_los_registros(void) {
+
+    contarTraficoSPI();
+    SetShortAddr(&dev, PACON2, FIFOEN);
+    SetShortAddr(&dev, SOFTRST, RSTPWR | RSTBB | RSTMAC);
+    // retorno esperado
+    SetShortAddr(&dev, PACON2, FIFOEN);
+    TEST_ASSERT_EQUAL(3, spi_transacciones);
+}
+
+// comprobar que si falla la escritura el registro se vuelve a escribir
+void test_comprobar_que_si_falla_la_escritura_el_registro_se_vuelve_a_escribir(void) {
+
+    SetCSPin_Ignore();
+    WriteByteSPIPort_IgnoreAndReturn(SPI_COMM_ERROR);
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, SetShortAddr(&dev, PACON2, FIFOEN));
+    contarTraficoSPI();
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, SetShortAddr(&dev, PACON2, FIFOEN));
+    TEST_ASSERT_EQUAL(1, spi_transacciones);
+}
+
+// comprobar que volver a aplicar la misma direccion no genera trafico SPI
+void test_comprobar_que_volver_a_aplicar_la_misma_direccion_no_genera_trafico_SPI(void) {
+
+    contarTraficoSPI();
+    TEST_ASSERT_EQUAL(OPERATION_OK, ApplyDeviceAddress(&dev));
+    TEST_ASSERT_EQUAL(4, spi_transacciones);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, ApplyDeviceAddress(&dev));
+    TEST_ASSERT_EQUAL(4, spi_transacciones);
+}
+
+// comprobar que el script de inicializacion escribe los registros largos consecutivos en una sola
+// transaccion SPI
+void test_comprobar_que_el_script_de_inicializacion_escribe_los_registros_largos_consecutivos_en_una_sola_transaccion_SPI(
+    void) {
+
+    uint8_t indice = 0;
+    contarTraficoSPI();
+    // retorno esperado
+    TEST_ASSERT_EQUAL(
+        0, EjecutoScript(&dev, mrf24_profile_ma.script, mrf24_profile_ma.length, &indice));
+    TEST_ASSERT_EQUAL(mrf24_profile_ma.length, indice);
+    TEST_ASSERT_EQUAL(mrf24_profile_ma.length - 4, spi_transacciones);
+    // Solo se repiten los registros que no se copian (RXFLUSH y BBREG6).
+    indice = 0;
+    contarTraficoSPI();
+    EjecutoScript(&dev, mrf24_profile_ma.script, mrf24_profile_ma.length, &indice);
+    TEST_ASSERT_EQUAL(2, spi_transacciones);
+}
+
+// comprobar que el script de inicializacion se detiene en las entradas con espera
+void test_comprobar_que_el_script_de_inicializacion_se_detiene_en_las_entradas_con_espera(void) {
+
+    const mrf24_reg_write_t script[] = {
+        {MRF24_LONG_WRITE(RFCON1), VCOOPT1, 0},
+        {MRF24_LONG_WRITE(RFCON2), PLLEN, 5},
+        {MRF24_LONG_WRITE(RFCON3), P0dBm, 0},
+    };
+    uint8_t indice = 0;
+    contarTraficoSPI();
+    // retorno esperado
+    TEST_ASSERT_EQUAL(5, EjecutoScript(&dev, script, 3, &indice));
+    TEST_ASSERT_EQUAL(2, indice);
+    TEST_ASSERT_EQUAL(1, spi_transacciones);
+    TEST_ASSERT_EQUAL(0, EjecutoScript(&dev, script, 3, &indice));
+    TEST_ASSERT_EQUAL(3, indice);
+    TEST_ASSERT_EQUAL(2, spi_transacciones);
+}
+
+// comprobar que el perfil del MRF24J40MB ejecuta el script del MRF24J40MA y despues el suyo
+void test_comprobar_que_el_perfil_del_MRF24J40MB_ejecuta_el_script_del_MRF24J40MA_y_despues_el_suyo(
+    void) {
+
+    const mrf24_reg_write_t base[] = {
+        {MRF24_SHORT_WRITE(RXFLUSH), RXFLUSH_RESET, 0},
+        {MRF24_LONG_WRITE(RFCON2), PLLEN, 5},
+    };
+    const mrf24_reg_write_t extra[] = {
+        {MRF24_SHORT_WRITE(GPIO), VACIO, 0},
+    };
+    const mrf24_init_profile_t perfil = {base, 2, extra, 1};
+    contarTraficoSPI();
+    dev.init_perfil = &mrf24_profile_mb;
+    dev.init_script_indice = 0;
+    // retorno esperado
+    TEST_ASSERT_EQUAL_PTR(mrf24_profile_ma.script, mrf24_profile_mb.script);
+    TEST_ASSERT_EQUAL(0, EjecutoPerfil(&dev));
+    TEST_ASSERT_EQUAL(mrf24_profile_ma.length + mrf24_profile_mb.extra_length,
+                      dev.init_script_indice);
+    TEST_ASSERT_EQUAL(mrf24_profile_ma.length - 4 + mrf24_profile_mb.extra_length,
+                      spi_transacciones);
+    // Una espera en el script principal retoma en el adicional.
+    dev.init_perfil = &perfil;
+    dev.init_script_indice = 0;
+    TEST_ASSERT_EQUAL(5, EjecutoPerfil(&dev));
+    TEST_ASSERT_EQUAL(2, dev.init_script_indice);
+    TEST_ASSERT_EQUAL(0, EjecutoPerfil(&dev));
+    TEST_ASSERT_EQUAL(3, dev.init_script_indice);
+}
+
+// probar que MRF24SetInitProfile rechaza un perfil sin script
+void test_probar_que_MRF24SetInitProfile_rechaza_un_perfil_sin_script(void) {
+
+    const mrf24_init_profile_t perfil = {NULL, 3, NULL, 0};
+    const mrf24_init_profile_t sin_extra = {mrf24_profile_ma.script, 1, NULL, 2};
+    dev.estado = INIT_OK;
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetInitProfile(&dev, &perfil));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetInitProfile(&dev, &sin_extra));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetInitProfile(&dev, &mrf24_profile_mb));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetInitProfile(&dev, NULL));
+}
+
+// comprobar que cada modulo usa su propio port y su propia copia de los registros
+void test_comprobar_que_cada_modulo_usa_su_propio_port_y_su_propia_copia_de_los_registros(void) {
+
+    static mrf24_dev_t otro;
+    uint8_t ctx_otro = 0;
+    memset(&otro, 0, sizeof(otro));
+    otro.port = puerto;
+    otro.port.ctx = &ctx_otro;
+    cantidad_contextos = 0;
+    WriteByteSPIPort_IgnoreAndReturn(SPI_COMM_OK);
+    SetCSPin_Stub(guardarContextoCS);
+    // retorno esperado
+    SetShortAddr(&dev, PACON2, FIFOEN);
+    SetShortAddr(&otro, PACON2, FIFOEN);
+    SetShortAddr(&dev, PACON2, FIFOEN);
+    TEST_ASSERT_EQUAL(2, cantidad_contextos);
+    TEST_ASSERT_NULL(contextos_cs[0]);
+    TEST_ASSERT_EQUAL_PTR(&ctx_otro, contextos_cs[1]);
+}
+
+// probar que MRF24J40Init rechaza un port incompleto
+void test_probar_que_MRF24J40Init_rechaza_un_port_incompleto(void) {
+
+    mrf24_port_t incompleto = puerto;
+    incompleto.write_block = NULL;
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24J40Init(&dev, &incompleto));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24J40Init(&dev, NULL));
+    TEST_ASSERT_EQUAL(INIT_FAIL, dev.estado);
+}
+
+// comprobar que una trama encriptada lleva la cabecera auxiliar de seguridad y que se habilita el
+// cifrado antes de disparar la transmision
+void test_comprobar_que_una_trama_encriptada_lleva_la_cabecera_auxiliar_y_se_habilita_el_cifrado_antes_de_transmitir(
+    void) {
+
+    mrf24_data_out_t data_out = {.dest_panid = 0x1234, .dest_address = 0x0002, .buffer_size = 4};
+    memcpy(data_out.buffer, "hola", 4);
+    dev.estado = INIT_OK;
+    MRF24SetSecurityLevel(&dev, SEC_ENC_MIC_32);
+    MRF24SetFrameCounter(&dev, 0x01020304);
+    contarTraficoSPI();
+    // retorno esperado
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24TransmitirDatoEncriptado(&dev, &data_out));
+    TEST_ASSERT_EQUAL(3, spi_transacciones);
+    TEST_ASSERT_EQUAL_HEX8(9 + 5, bloque_enviado[0]);
+    TEST_ASSERT_EQUAL_HEX8(9 + 5 + 4 + 4, bloque_enviado[1]);
+    TEST_ASSERT_EQUAL_HEX8(DATA | SECURITY | ACK_REQ | INTRA_PAN, bloque_enviado[2]);
+    TEST_ASSERT_EQUAL_HEX8(SHORT_S_ADD | FRAME_V2006 | SHORT_D_ADD, bloque_enviado[3]);
+    TEST_ASSERT_EQUAL_HEX8(SEC_ENC_MIC_32, bloque_enviado[11]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, bloque_enviado[12]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, bloque_enviado[15]);
+    TEST_ASSERT_EQUAL_MEMORY("hola", &bloque_enviado[16], 4);
+    TEST_ASSERT_EQUAL_HEX8(adaptarDireccionSPI8WriteShort(SECCON0), bytes_escritos[0]);
+    TEST_ASSERT_EQUAL_HEX8(RX_AES_CCM_32 | TX_AES_CCM_32, bytes_escritos[1]);
+    TEST_ASSERT_EQUAL_HEX8(adaptarDireccionSPI8WriteShort(TXNCON), bytes_escritos[2]);
+    TEST_ASSERT_EQUAL_HEX8(TXNACKREQ | TXNTRIG | TXNSECEN, bytes_escritos[3]);
+    TEST_ASSERT_EQUAL_HEX32(0x01020305, MRF24GetFrameCounter(&dev));
+}
+
+// probar que MRF24TransmitirDatoEncriptado rechaza la transmision sin nivel de seguridad, con el
+// contador agotado o con datos que no entran junto al MIC
+void test_probar_que_MRF24TransmitirDatoEncriptado_rechaza_la_transmision_sin_nivel_con_el_contador_agotado_o_con_datos_muy_largos(
+    void) {
+
+    mrf24_data_out_t data_out = {.dest_address = 0x0002, .buffer_size = MAX_PAYLOAD_SIZE - 20};
+    dev.estado = INIT_OK;
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24TransmitirDatoEncriptado(&dev, &data_out));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetSecurityLevel(&dev, (mrf24_sec_level_t)4));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetSecurityLevel(&dev, SEC_ENC_MIC_128));
+    TEST_ASSERT_EQUAL(TO_LONG_MSG, MRF24TransmitirDatoEncriptado(&dev, &data_out));
+    MRF24SetFrameCounter(&dev, 0xFFFFFFFF);
+    data_out.buffer_size = 1;
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24TransmitirDatoEncriptado(&dev, &data_out));
+}
+
+// comprobar que al avisar SECIF se arranca el descifrado con el cifrado del nivel de la trama, o
+// se ignora si la seguridad no esta habilitada
+void test_comprobar_que_al_avisar_SECIF_se_arranca_el_descifrado_o_se_ignora_si_la_seguridad_no_esta_habilitada(
+    void) {
+
+    dev.estado = INIT_OK;
+    trama_fifo_rx = trama_encriptada;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerControlSeguridad);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, MRF24InterruptHandler(&dev));
+    TEST_ASSERT_EQUAL_HEX8(adaptarDireccionSPI8WriteShort(SECCON0), bytes_escritos[1]);
+    TEST_ASSERT_EQUAL_HEX8(SECIGNORE, bytes_escritos[2]);
+    MRF24SetSecurityLevel(&dev, SEC_ENC_MIC_64);
+    cantidad_bytes_escritos = 0;
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, MRF24InterruptHandler(&dev));
+    TEST_ASSERT_EQUAL_HEX8(RX_AES_CCM_32 | SECSTART, bytes_escritos[2]);
+}
+
+// comprobar que al avisar SECIF el nivel de seguridad se lee detras de una cabecera con origen
+// largo y sin compresion de PAN
+void test_comprobar_que_al_avisar_SECIF_el_nivel_se_lee_detras_de_una_cabecera_con_origen_largo(
+    void) {
+
+    const uint8_t trama_origen_largo[] = {0x09, 0xD8, 0x07, 0x34, 0x12, 0x01, 0x00, 0x34,
+                                          0x12, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                                          0x08, 0x06, 0x78, 0x56, 0x34, 0x12, 'h'};
+    dev.estado = INIT_OK;
+    trama_fifo_rx = trama_origen_largo;
+    MRF24SetSecurityLevel(&dev, SEC_ENC_MIC_32);
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerControlSeguridad);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, MRF24InterruptHandler(&dev));
+    TEST_ASSERT_EQUAL_HEX8(adaptarDireccionSPI8WriteShort(SECCON0), bytes_escritos[1]);
+    TEST_ASSERT_EQUAL_HEX8(RX_AES_CCM_64 | SECSTART, bytes_escritos[2]);
+}
+
+// probar que una trama encriptada que no se pudo descifrar se descarta y se cuenta, y que una
+// descifrada se entrega sin la cabecera auxiliar ni el MIC
+void test_probar_que_una_trama_que_no_se_pudo_descifrar_se_descarta_y_una_descifrada_se_entrega_sin_cabecera_auxiliar_ni_MIC(
+    void) {
+
+    mrf24_rx_stats_t stats;
+    dev.estado = INIT_OK;
+    MRF24SetSecurityLevel(&dev, SEC_ENC_MIC_32);
+    trama_fifo_rx = trama_encriptada;
+    largo_fifo_rx = sizeof(trama_encriptada) - 2;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    ReadBlockSPIPort_Stub(leerTramaCargada);
+    // Se cargan en orden inverso: primero se lee INTSTAT y después RXSR.
+    respuestas_cortas[0] = SECDECERR;
+    respuestas_cortas[1] = RXIF;
+    cantidad_respuestas_cortas = 2;
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, MRF24InterruptHandler(&dev));
+    TEST_ASSERT_NULL(MRF24GetDataIn(&dev));
+    MRF24GetRxStats(&dev, &stats);
+    TEST_ASSERT_EQUAL(1, stats.sec_errors);
+    TEST_ASSERT_EQUAL(0, stats.errors);
+
+    respuestas_cortas[0] = VACIO;
+    respuestas_cortas[1] = RXIF;
+    cantidad_respuestas_cortas = 2;
+    TEST_ASSERT_EQUAL(MSG_READ, MRF24InterruptHandler(&dev));
+    mrf24_data_in_t * data_in = MRF24GetDataIn(&dev);
+    TEST_ASSERT_NOT_NULL(data_in);
+    TEST_ASSERT_TRUE(data_in->secured);
+    TEST_ASSERT_EQUAL_HEX32(0x12345678, data_in->frame_counter);
+    TEST_ASSERT_EQUAL(4, data_in->buffer_size);
+    TEST_ASSERT_EQUAL_MEMORY("hola", data_in->buffer, 4);
+    TEST_ASSERT_EQUAL_HEX8(0xC8, data_in->lqi);
+}
+
+// comprobar que el escaneo de energia recorre los 16 canales sin esperas entre ellos y arma la
+// tabla con el maximo y el promedio de cada canal
+void test_comprobar_que_el_escaneo_de_energia_recorre_los_16_canales_y_arma_la_tabla_con_el_maximo_y_el_promedio(
+    void) {
+
+    mrf24_ed_result_t tabla[CHANNEL_COUNT];
+    mrf24_data_out_t data_out = {.dest_address = 0x0002, .buffer_size = 1};
+    uint16_t llamadas = 0;
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerEnergia);
+    DelayWrite_Ignore();
+    DelayReset_Ignore();
+    DelayRead_Stub(cumplirPermanencia);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(SCAN_IN_PROGRESS, MRF24EscanearEnergia(&dev, 10));
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24GetEnergia(&dev, tabla));
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, MRF24TransmitirDato(&dev, &data_out));
+
+    while (SCAN_IN_PROGRESS == MRF24Poll(&dev) && llamadas < 100)
+        llamadas++;
+    // Tres lecturas por canal, la última cumple la permanencia.
+    TEST_ASSERT_EQUAL(3 * CHANNEL_COUNT - 1, llamadas);
+    TEST_ASSERT_EQUAL(INIT_OK, dev.estado);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetEnergia(&dev, tabla));
+
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+
+        TEST_ASSERT_EQUAL_HEX8(CH_11 + 0x10 * i, tabla[i].channel);
+        TEST_ASSERT_EQUAL(3, tabla[i].samples);
+        TEST_ASSERT_EQUAL(30, tabla[i].max);
+        TEST_ASSERT_EQUAL(20, tabla[i].average);
+    }
+}
+
+// probar que el escaneo de energia solo comienza con el modulo inicializado, sin transmisiones en
+// curso y con una permanencia valida
+void test_probar_que_el_escaneo_de_energia_solo_comienza_con_el_modulo_libre_y_una_permanencia_valida(
+    void) {
+
+    mrf24_ed_result_t tabla[CHANNEL_COUNT];
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, MRF24EscanearEnergia(&dev, 10));
+    dev.estado = INIT_OK;
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24EscanearEnergia(&dev, 0));
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, MRF24GetEnergia(&dev, tabla));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24GetEnergia(&dev, NULL));
+    dev.tx_en_curso = 1;
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24EscanearEnergia(&dev, 10));
+}
+
+// comprobar que la busqueda activa envia un beacon request por canal y registra los beacons que
+// llegan en la tabla de vecinos, descartando las demas tramas
+void test_comprobar_que_la_busqueda_activa_envia_un_beacon_request_por_canal_y_registra_los_beacons_en_la_tabla_de_vecinos(
+    void) {
+
+    uint8_t mac[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    uint8_t llamadas = 0;
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    ReadByteSPIPort_Stub(leerLargoFifoRx);
+    ReadBlockSPIPort_Stub(leerTramaCargada);
+    DelayWrite_Ignore();
+    DelayReset_Ignore();
+    DelayRead_IgnoreAndReturn(false);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(SCAN_IN_PROGRESS, MRF24BuscarDispositivos(&dev, 20));
+    TEST_ASSERT_EQUAL_HEX8(7, bloque_enviado[0]);
+    TEST_ASSERT_EQUAL_HEX8(8, bloque_enviado[1]);
+    TEST_ASSERT_EQUAL_HEX8(MAC_COMM, bloque_enviado[2]);
+    TEST_ASSERT_EQUAL_HEX8(SHORT_D_ADD, bloque_enviado[3]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, bloque_enviado[7]);
+    TEST_ASSERT_EQUAL_HEX8(0x07, bloque_enviado[9]);
+
+    recibirTrama(beacon_corto, sizeof(beacon_corto), OPERATION_OK);
+    recibirTrama(beacon_corto, sizeof(beacon_corto), OPERATION_OK);
+    recibirTrama(beacon_largo, sizeof(beacon_largo), OPERATION_OK);
+    recibirTrama(trama_recibida, sizeof(trama_recibida), OPERATION_OK);
+    TEST_ASSERT_NULL(MRF24GetDataIn(&dev));
+    TEST_ASSERT_EQUAL(2, MRF24GetCantidadVecinos(&dev));
+
+    DelayRead_IgnoreAndReturn(true);
+    while (SCAN_IN_PROGRESS == MRF24Poll(&dev) && llamadas < 100)
+        llamadas++;
+    TEST_ASSERT_EQUAL(CHANNEL_COUNT - 1, llamadas);
+    TEST_ASSERT_EQUAL(INIT_OK, dev.estado);
+    const MRF24_discover_nearby_t * vecino = MRF24BuscarVecino(&dev, 0x1234, 0x0005, NULL);
+    TEST_ASSERT_NOT_NULL(vecino);
+    TEST_ASSERT_EQUAL_HEX8(CH_11, vecino->channel);
+    TEST_ASSERT_EQUAL_HEX8(0x50, vecino->rssi);
+    vecino = MRF24BuscarVecino(&dev, 0x5678, NO_SHORT_ADDRESS, mac);
+    TEST_ASSERT_NOT_NULL(vecino);
+    TEST_ASSERT_EQUAL_HEX8(0x60, vecino->rssi);
+    TEST_ASSERT_NULL(MRF24BuscarVecino(&dev, 0x1234, 0x0006, NULL));
+}
+
+// probar que la tabla de vecinos encuentra a cada uno de muchos vecinos, actualiza los repetidos y
+// descarta los nuevos cuando esta llena
+void test_probar_que_la_tabla_de_vecinos_encuentra_a_cada_vecino_actualiza_los_repetidos_y_descarta_los_nuevos_al_llenarse(
+    void) {
+
+    uint8_t beacon[sizeof(beacon_corto)];
+    memcpy(beacon, beacon_corto, sizeof(beacon));
+    dev.estado = INIT_OK;
+    // retorno esperado
+    for (uint16_t i = 0; i < NEIGHBOR_TABLE_SIZE; i++) {
+
+        beacon[5] = (uint8_t)i;
+        beacon[6] = (uint8_t)(i >> 8);
+        TEST_ASSERT_EQUAL(OPERATION_OK, RegistroBeacon(&dev, beacon, sizeof(beacon) - 2));
+    }
+    TEST_ASSERT_EQUAL(OPERATION_OK, RegistroBeacon(&dev, beacon, sizeof(beacon) - 2));
+    TEST_ASSERT_EQUAL(NEIGHBOR_TABLE_SIZE, MRF24GetCantidadVecinos(&dev));
+
+    for (uint16_t i = 0; i < NEIGHBOR_TABLE_SIZE; i++) {
+
+        const MRF24_discover_nearby_t * vecino = MRF24BuscarVecino(&dev, 0x1234, i, NULL);
+        TEST_ASSERT_NOT_NULL(vecino);
+        TEST_ASSERT_EQUAL_HEX16(i, vecino->short_address);
+    }
+    beacon[6] = 0x7F;
+    TEST_ASSERT_EQUAL(BUFFER_FULL, RegistroBeacon(&dev, beacon, sizeof(beacon) - 2));
+    TEST_ASSERT_EQUAL(NEIGHBOR_TABLE_SIZE, MRF24GetCantidadVecinos(&dev));
+}
+
+// comprobar que el modo turbo se aplica con el modulo inicializado y que se puede volver al modo
+// estandar
+void test_comprobar_que_el_modo_turbo_se_aplica_con_el_modulo_inicializado_y_que_se_puede_volver_al_modo_estandar(
+    void) {
+
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetPhyMode(&dev, PHY_TURBO_625KBPS));
+    TEST_ASSERT_EQUAL(PHY_TURBO_625KBPS, MRF24GetPhyMode(&dev));
+    TEST_ASSERT_EQUAL_HEX8(adaptarDireccionSPI8WriteShort(BBREG0), bytes_escritos[0]);
+    TEST_ASSERT_EQUAL_HEX8(TURBO, bytes_escritos[1]);
+    TEST_ASSERT_EQUAL_HEX8(TURBO_MODE | PREDETTH2, bytes_escritos[3]);
+    TEST_ASSERT_EQUAL_HEX8(TURBO_625KBPS | PRECNT2 | PRECNT1 | PRECNT0, bytes_escritos[5]);
+    TEST_ASSERT_EQUAL_HEX8(adaptarDireccionSPI8WriteShort(RFCTL), bytes_escritos[10]);
+    TEST_ASSERT_EQUAL_HEX8(RFRST_HOLD, bytes_escritos[11]);
+    TEST_ASSERT_EQUAL_HEX8(VACIO, bytes_escritos[13]);
+
+    cantidad_bytes_escritos = 0;
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetPhyMode(&dev, PHY_250KBPS));
+    TEST_ASSERT_EQUAL_HEX8(adaptarDireccionSPI8WriteShort(BBREG0), bytes_escritos[0]);
+    TEST_ASSERT_EQUAL_HEX8(VACIO, bytes_escritos[1]);
+    TEST_ASSERT_EQUAL_HEX8(IEEE_802_15_4 | PREDETTH2, bytes_escritos[3]);
+    TEST_ASSERT_EQUAL_HEX8(IEEE_250KBPS | PRECNT2 | PRECNT1 | PRECNT0, bytes_escritos[5]);
+}
+
+// probar que el cambio de modo informa un error de comunicacion y no reinicia RF
+void test_probar_que_el_cambio_de_modo_informa_un_error_de_comunicacion_y_no_reinicia_RF(void) {
+
+    dev.estado = INIT_OK;
+    contarTraficoSPI();
+    WriteByteSPIPort_StubWithCallback(NULL);
+    WriteByteSPIPort_ExpectAnyArgsAndReturn(SPI_COMM_ERROR);
+    WriteByteSPIPort_ExpectAnyArgsAndReturn(SPI_COMM_OK);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, MRF24SetPhyMode(&dev, PHY_TURBO_625KBPS));
+    TEST_ASSERT_EQUAL(1, spi_transacciones);
+}
+
+// probar que el modo elegido antes de MRF24J40Init se aplica durante la inicializacion y que no se
+// puede cambiar mientras esta en curso
+void test_probar_que_el_modo_elegido_antes_de_la_inicializacion_se_aplica_durante_la_misma(void) {
+
+    uint8_t bbreg0 = VACIO;
+    uint8_t llamadas = 0;
+    softrst_trabado = false;
+    prepararInicializacion(true);
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetPhyMode(&dev, (mrf24_phy_mode_t)2));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetPhyMode(&dev, PHY_TURBO_625KBPS));
+    TEST_ASSERT_EQUAL(INIT_IN_PROGRESS, MRF24J40Init(&dev, &puerto));
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24SetPhyMode(&dev, PHY_250KBPS));
+
+    while (INIT_IN_PROGRESS == MRF24Poll(&dev) && llamadas < 20)
+        llamadas++;
+    TEST_ASSERT_EQUAL(INIT_OK, dev.estado);
+    TEST_ASSERT_EQUAL(PHY_TURBO_625KBPS, MRF24GetPhyMode(&dev));
+    // La copia de BBREG0 quedó con el valor escrito durante la inicialización.
+    spi_transacciones = 0;
+    TEST_ASSERT_EQUAL(OPERATION_OK, GetShortAddr(&dev, BBREG0, &bbreg0));
+    TEST_ASSERT_EQUAL_HEX8(TURBO, bbreg0);
+    TEST_ASSERT_EQUAL(0, spi_transacciones);
+}
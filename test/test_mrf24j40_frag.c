@@ -0,0 +1,277 @@
+#include "unity.h"
+#include <string.h>
+#include "drv_MRF24J40.h"
+#include "drv_MRF24J40_frag.h"
+#include "mrf24j40_sim.h"
+#include "mrf24j40_fixture.h"
+
+TEST_SOURCE_FILE("mrf24j40_sim.c")
+TEST_SOURCE_FILE("mrf24j40_fixture.c")
+
+#define DIRECCION_A    (0x0001)
+#define DIRECCION_B    (0x0002)
+#define PASO_US        1000
+#define PASO_AIRE_US   100
+#define MAX_VUELTAS_TX 5000
+#define LARGO_MENSAJE  1000
+#define FRAGMENTOS     ((LARGO_MENSAJE + FRAG_DATA_SIZE - 1) / FRAG_DATA_SIZE)
+
+static mrf24_sim_medio_t medio;
+static mrf24_sim_t sim_a;
+static mrf24_sim_t sim_b;
+static mrf24_dev_t nodo_a;
+static mrf24_dev_t nodo_b;
+static mrf24_frag_t frag_a;
+static mrf24_frag_t frag_b;
+static uint8_t mensaje[LARGO_MENSAJE];
+
+// Atiende las interrupciones de los dos nodos y pasa a B lo recibido
+static void atenderRadios(void) {
+
+    mrf24_data_in_t * recibido = NULL;
+
+    if (MSG_PRESENT == MRF24IsNewMsg(&nodo_a))
+        MRF24ReciboPaquete(&nodo_a);
+
+    if (MSG_PRESENT == MRF24IsNewMsg(&nodo_b))
+        MRF24ReciboPaquete(&nodo_b);
+
+    while (NULL != (recibido = MRF24GetDataIn(&nodo_b))) {
+
+        MRF24FragRecibir(&frag_b, recibido);
+        MRF24ReleaseDataIn(&nodo_b);
+    }
+}
+
+static mrf24_state_t enviarMensaje(void) {
+
+    mrf24_state_t estado = TRANS_IN_PROGRESS;
+
+    for (uint16_t i = 0; i < MAX_VUELTAS_TX && TRANS_IN_PROGRESS == estado; i++) {
+
+        atenderRadios();
+        estado = MRF24FragPoll(&frag_a);
+        MRF24SimAvanzar(&medio, PASO_AIRE_US);
+    }
+    atenderRadios();
+    return estado;
+}
+
+static void cargarFragmento(mrf24_data_in_t * trama, uint8_t etiqueta, uint8_t indice,
+                            uint8_t ultimo, uint8_t largo) {
+
+    memset(trama, 0, sizeof(*trama));
+    trama->address = DIRECCION_A;
+    trama->buffer[0] = FRAG_DISPATCH;
+    trama->buffer[1] = etiqueta;
+    trama->buffer[2] = indice;
+    trama->buffer[3] = ultimo;
+    memcpy(&trama->buffer[FRAG_HEADER_SIZE], &mensaje[indice * FRAG_DATA_SIZE], largo);
+    trama->buffer_size = FRAG_HEADER_SIZE + largo;
+}
+
+void setUp(void) {
+
+    MRF24FixtureInit(&medio);
+    MRF24FixturePrepararNodo(&nodo_a, &sim_a, DIRECCION_A, NULL);
+    MRF24FixturePrepararNodo(&nodo_b, &sim_b, DIRECCION_B, NULL);
+    MRF24FragInit(&frag_a, &nodo_a);
+    MRF24FragInit(&frag_b, &nodo_b);
+
+    for (uint16_t i = 0; i < LARGO_MENSAJE; i++)
+        mensaje[i] = (uint8_t)(i * 7 + 3);
+}
+
+void tearDown(void) {
+}
+
+// Un mensaje de varias tramas llega completo e intacto al otro nodo
+void test_un_mensaje_de_varias_tramas_llega_completo_al_otro_nodo(void) {
+
+    mrf24_frag_msg_t * recibido = NULL;
+    mrf24_frag_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK,
+                      MRF24FragEnviar(&frag_a, DIRECCION_B, mensaje, LARGO_MENSAJE));
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, enviarMensaje());
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24FragPoll(&frag_a));
+    recibido = MRF24FragGetMensaje(&frag_b);
+    TEST_ASSERT_NOT_NULL(recibido);
+    TEST_ASSERT_EQUAL_HEX16(DIRECCION_A, recibido->address);
+    TEST_ASSERT_EQUAL(LARGO_MENSAJE, recibido->length);
+    TEST_ASSERT_EQUAL_MEMORY(mensaje, recibido->data, LARGO_MENSAJE);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24FragReleaseMensaje(&frag_b));
+    TEST_ASSERT_NULL(MRF24FragGetMensaje(&frag_b));
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, MRF24FragReleaseMensaje(&frag_b));
+    MRF24FragGetStats(&frag_a, &stats);
+    TEST_ASSERT_EQUAL(1, stats.tx_messages);
+    TEST_ASSERT_EQUAL(FRAGMENTOS, stats.tx_fragments);
+    TEST_ASSERT_EQUAL(0, stats.tx_resent);
+}
+
+// Los fragmentos encolados salen uno tras otro con sólo atender las interrupciones
+void test_los_fragmentos_salen_seguidos_sin_pasar_por_la_aplicacion(void) {
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK,
+                      MRF24FragEnviar(&frag_a, DIRECCION_B, mensaje, LARGO_MENSAJE));
+
+    for (uint16_t i = 0; i < MAX_VUELTAS_TX; i++) {
+
+        atenderRadios();
+        MRF24SimAvanzar(&medio, PASO_AIRE_US);
+    }
+    TEST_ASSERT_EQUAL(TX_QUEUE_SIZE, sim_b.stats.rx_tramas);
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24FragPoll(&frag_a));
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, enviarMensaje());
+    TEST_ASSERT_NOT_NULL(MRF24FragGetMensaje(&frag_b));
+}
+
+// Los fragmentos se reensamblan aunque lleguen desordenados y repetidos
+void test_los_fragmentos_se_reensamblan_desordenados_y_repetidos(void) {
+
+    mrf24_data_in_t trama;
+    mrf24_frag_msg_t * recibido = NULL;
+    mrf24_frag_stats_t stats;
+
+    // retorno esperado
+    cargarFragmento(&trama, 5, 2, 2, 10);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24FragRecibir(&frag_b, &trama));
+    cargarFragmento(&trama, 5, 0, 2, FRAG_DATA_SIZE);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24FragRecibir(&frag_b, &trama));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24FragRecibir(&frag_b, &trama));
+    TEST_ASSERT_NULL(MRF24FragGetMensaje(&frag_b));
+    cargarFragmento(&trama, 5, 1, 2, FRAG_DATA_SIZE);
+    TEST_ASSERT_EQUAL(MSG_READ, MRF24FragRecibir(&frag_b, &trama));
+    recibido = MRF24FragGetMensaje(&frag_b);
+    TEST_ASSERT_NOT_NULL(recibido);
+    TEST_ASSERT_EQUAL(2 * FRAG_DATA_SIZE + 10, recibido->length);
+    TEST_ASSERT_EQUAL_MEMORY(mensaje, recibido->data, recibido->length);
+    MRF24FragGetStats(&frag_b, &stats);
+    TEST_ASSERT_EQUAL(1, stats.rx_duplicates);
+    TEST_ASSERT_EQUAL(1, stats.rx_messages);
+}
+
+// Un mensaje incompleto se descarta al vencer su tiempo y libera el lugar
+void test_un_mensaje_incompleto_se_descarta_al_vencer_su_tiempo(void) {
+
+    mrf24_data_in_t trama;
+    mrf24_frag_stats_t stats;
+
+    cargarFragmento(&trama, 1, 0, 1, FRAG_DATA_SIZE);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24FragRecibir(&frag_b, &trama));
+    MRF24SimAvanzar(&medio, FRAG_RX_TIMEOUT * 1000 - PASO_US);
+    MRF24FragPoll(&frag_b);
+    TEST_ASSERT_EQUAL(FRAG_RX_ARMANDO, frag_b.rx[0].estado);
+
+    // retorno esperado
+    MRF24SimAvanzar(&medio, PASO_US);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24FragPoll(&frag_b));
+    TEST_ASSERT_EQUAL(FRAG_RX_LIBRE, frag_b.rx[0].estado);
+    cargarFragmento(&trama, 1, 1, 1, 10);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24FragRecibir(&frag_b, &trama));
+    MRF24FragGetStats(&frag_b, &stats);
+    TEST_ASSERT_EQUAL(1, stats.rx_timeouts);
+    TEST_ASSERT_EQUAL(0, stats.rx_messages);
+}
+
+// Sin lugar para un mensaje nuevo, o con un mensaje que no entra, el fragmento se rechaza
+void test_sin_lugar_o_con_un_mensaje_demasiado_largo_el_fragmento_se_rechaza(void) {
+
+    mrf24_data_in_t trama;
+    mrf24_frag_stats_t stats;
+
+    for (uint8_t i = 0; i < FRAG_RX_SLOTS; i++) {
+
+        cargarFragmento(&trama, i, 0, 1, FRAG_DATA_SIZE);
+        TEST_ASSERT_EQUAL(OPERATION_OK, MRF24FragRecibir(&frag_b, &trama));
+    }
+
+    // retorno esperado
+    cargarFragmento(&trama, FRAG_RX_SLOTS, 0, 1, FRAG_DATA_SIZE);
+    TEST_ASSERT_EQUAL(BUFFER_FULL, MRF24FragRecibir(&frag_b, &trama));
+    cargarFragmento(&trama, 0, 0, FRAG_RX_MESSAGE_SIZE / FRAG_DATA_SIZE + 1, FRAG_DATA_SIZE);
+    TEST_ASSERT_EQUAL(TO_LONG_MSG, MRF24FragRecibir(&frag_b, &trama));
+    MRF24FragGetStats(&frag_b, &stats);
+    TEST_ASSERT_EQUAL(2, stats.rx_no_slot);
+}
+
+// Las tramas que no son fragmentos se devuelven a la aplicación y las cabeceras imposibles se
+// rechazan
+void test_las_tramas_que_no_son_fragmentos_quedan_para_la_aplicacion(void) {
+
+    mrf24_data_in_t trama;
+    mrf24_frag_stats_t stats;
+
+    memset(&trama, 0, sizeof(trama));
+    trama.buffer_size = 8;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24FragRecibir(&frag_b, &trama));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24FragRecibir(&frag_b, NULL));
+    cargarFragmento(&trama, 1, 2, 1, 10);
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, MRF24FragRecibir(&frag_b, &trama));
+    cargarFragmento(&trama, 1, 0, 1, 10);
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, MRF24FragRecibir(&frag_b, &trama));
+    MRF24FragGetStats(&frag_b, &stats);
+    TEST_ASSERT_EQUAL(2, stats.rx_invalid);
+    TEST_ASSERT_EQUAL(0, stats.rx_duplicates);
+}
+
+// Con pérdidas en el enlace los fragmentos que fallan se reenvían y el mensaje se completa
+void test_con_perdidas_en_el_enlace_los_fragmentos_se_reenvian(void) {
+
+    mrf24_frag_msg_t * recibido = NULL;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    MRF24SimSetPerdida(&sim_a, &sim_b, 80);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK,
+                      MRF24FragEnviar(&frag_a, DIRECCION_B, mensaje, LARGO_MENSAJE));
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, enviarMensaje());
+    recibido = MRF24FragGetMensaje(&frag_b);
+    TEST_ASSERT_NOT_NULL(recibido);
+    TEST_ASSERT_EQUAL_MEMORY(mensaje, recibido->data, LARGO_MENSAJE);
+    TEST_ASSERT_GREATER_THAN(0, frag_a.stats.tx_resent);
+}
+
+// Sin nadie que responda el envío se abandona tras varios fallos seguidos
+void test_sin_respuesta_el_envio_se_abandona_tras_varios_fallos(void) {
+
+    mrf24_frag_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    MRF24SimSetPerdida(&sim_a, &sim_b, 100);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK,
+                      MRF24FragEnviar(&frag_a, DIRECCION_B, mensaje, LARGO_MENSAJE));
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, enviarMensaje());
+    MRF24FragGetStats(&frag_a, &stats);
+    TEST_ASSERT_EQUAL(1, stats.tx_failed);
+    TEST_ASSERT_EQUAL(0, stats.tx_messages);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24FragEnviar(&frag_a, DIRECCION_B, mensaje, 10));
+}
+
+// El envío valida los argumentos y no acepta un mensaje mientras hay otro en curso
+void test_el_envio_valida_los_argumentos(void) {
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24FragInit(NULL, &nodo_a));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24FragEnviar(&frag_a, DIRECCION_B, NULL, 10));
+    TEST_ASSERT_EQUAL(DIRECTION_EMPTY, MRF24FragEnviar(&frag_a, VACIO, mensaje, 10));
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, MRF24FragEnviar(&frag_a, DIRECCION_B, mensaje, 0));
+    TEST_ASSERT_EQUAL(TO_LONG_MSG,
+                      MRF24FragEnviar(&frag_a, DIRECCION_B, mensaje, FRAG_MAX_LENGTH + 1));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24FragEnviar(&frag_a, DIRECCION_B, mensaje, 10));
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24FragEnviar(&frag_a, DIRECCION_B, mensaje, 10));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24FragGetStats(&frag_a, NULL));
+}
@@ -0,0 +1,414 @@
+#include "unity.h"
+#include <string.h>
+#include "drv_MRF24J40.h"
+#include "drv_MRF24J40_registers.h"
+#include "mrf24j40_sim.h"
+#include "mrf24j40_fixture.h"
+
+TEST_SOURCE_FILE("mrf24j40_sim.c")
+TEST_SOURCE_FILE("mrf24j40_fixture.c")
+
+#define COORDINADOR       0
+#define ALARMA            1
+#define NODOS             5
+#define DIRECCION_NADIE   (0x0009)
+#define PASO_AIRE_US      100
+#define US_POR_MS         1000
+#define BO_ALARMA         3
+#define SO_ALARMA         3
+#define INTERVALO_US      122880 // 15,36 ms * 2^3
+#define SLOT_US           7680   // 0,96 ms * 2^3
+#define INTERVALO_BO2_US  61440  // 15,36 ms * 2^2
+#define ORDEN_MAXIMO      14
+#define ALARMAS           5
+#define DESFASE_US        37000
+#define LARGO_SATURACION  100
+#define POS_SUPERTRAMA    (TX_BEACON_FIFO + 9)
+
+static mrf24_sim_medio_t medio;
+static mrf24_sim_t sims[NODOS];
+static mrf24_dev_t nodos[NODOS];
+static mrf24_data_out_t alarma;
+static const mrf24_superframe_config_t config = {BO_ALARMA, SO_ALARMA};
+static bool_t saturar;
+static uint16_t alarmas_recibidas;
+static uint64_t alarma_us;
+static uint16_t recibidos_alarma;
+static mrf24_tx_result_t ultimo_resultado;
+
+static void guardarResultado(mrf24_dev_t * dev, const mrf24_tx_result_t * resultado) {
+
+    memcpy(&ultimo_resultado, resultado, sizeof(ultimo_resultado));
+}
+
+static uint16_t direccion(uint8_t i) {
+
+    return (uint16_t)(i + 1);
+}
+
+static void configurarCoordinador(mrf24_dev_t * nodo) {
+
+    MRF24SetSuperframe(nodo, &config);
+}
+
+static void configurarDispositivo(mrf24_dev_t * nodo) {
+
+    MRF24SeguirBeacons(nodo, true);
+}
+
+// Mantiene llena la cola de un nodo que satura el CAP con tramas largas al coordinador
+static void saturarCap(uint8_t i) {
+
+    mrf24_data_out_t salida;
+    mrf24_tx_handle_t handle;
+
+    memset(&salida, 0, sizeof(salida));
+    salida.dest_panid = FIXTURE_PANID;
+    salida.dest_address = direccion(COORDINADOR);
+    salida.buffer_size = LARGO_SATURACION;
+
+    while (OPERATION_OK == MRF24EncolarDato(&nodos[i], &salida, &handle)) {
+    }
+}
+
+// Atiende las interrupciones y el lazo principal de todos los nodos y anota las alarmas
+static void correr(uint32_t duracion_us) {
+
+    for (uint32_t t = 0; t < duracion_us; t += PASO_AIRE_US) {
+
+        for (uint8_t i = 0; i < NODOS; i++) {
+
+            mrf24_data_in_t * trama;
+
+            if (MSG_PRESENT == MRF24IsNewMsg(&nodos[i]))
+                MRF24ReciboPaquete(&nodos[i]);
+
+            while (NULL != (trama = MRF24GetDataIn(&nodos[i]))) {
+
+                if (6 == trama->buffer_size && 0 == memcmp(trama->buffer, "alarma", 6)) {
+
+                    if (COORDINADOR == i && direccion(ALARMA) == trama->address) {
+
+                        alarmas_recibidas++;
+                        alarma_us = MRF24SimGetTiempoUs(&medio);
+                    } else if (ALARMA == i) {
+
+                        recibidos_alarma++;
+                    }
+                }
+                MRF24ReleaseDataIn(&nodos[i]);
+            }
+
+            if (saturar && COORDINADOR != i && ALARMA != i)
+                saturarCap(i);
+            MRF24Poll(&nodos[i]);
+        }
+        MRF24SimAvanzar(&medio, PASO_AIRE_US);
+    }
+}
+
+// Corre hasta que termine la transmisión y devuelve cuánto tardó
+static uint32_t esperarResultado(mrf24_dev_t * nodo, mrf24_tx_handle_t handle,
+                                 mrf24_tx_result_t * resultado) {
+
+    uint64_t inicio = MRF24SimGetTiempoUs(&medio);
+
+    for (uint32_t t = 0; t < 1000 * US_POR_MS; t += PASO_AIRE_US) {
+
+        if (OPERATION_OK == MRF24GetTxStatus(nodo, handle, resultado))
+            break;
+        correr(PASO_AIRE_US);
+    }
+    return (uint32_t)(MRF24SimGetTiempoUs(&medio) - inicio);
+}
+
+void setUp(void) {
+
+    MRF24FixtureInit(&medio);
+
+    for (uint8_t i = 0; i < NODOS; i++)
+        MRF24FixturePrepararNodo(&nodos[i], &sims[i], direccion(i),
+                                 (COORDINADOR == i) ? configurarCoordinador
+                                                    : configurarDispositivo);
+
+    memset(&alarma, 0, sizeof(alarma));
+    alarma.dest_panid = FIXTURE_PANID;
+    alarma.dest_address = direccion(COORDINADOR);
+    memcpy(alarma.buffer, "alarma", 6);
+    alarma.buffer_size = 6;
+    saturar = false;
+    alarmas_recibidas = 0;
+    alarma_us = 0;
+    recibidos_alarma = 0;
+    memset(&ultimo_resultado, 0, sizeof(ultimo_resultado));
+}
+
+void tearDown(void) {
+}
+
+// Los órdenes de la supertrama se validan y los papeles de coordinador y dispositivo se excluyen
+void test_la_configuracion_de_la_supertrama_se_valida(void) {
+
+    mrf24_superframe_config_t sin_beacons = {15, 0};
+    mrf24_superframe_config_t activa_larga = {2, 3};
+    mrf24_lpl_config_t lpl = {100, 10};
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetSuperframe(&nodos[COORDINADOR], &sin_beacons));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetSuperframe(&nodos[COORDINADOR], &activa_larga));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetSuperframe(&nodos[ALARMA], &config));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SeguirBeacons(&nodos[COORDINADOR], true));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetLowPower(&nodos[COORDINADOR], &lpl));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetLowPower(&nodos[ALARMA], &lpl));
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, MRF24AsignarGts(&nodos[ALARMA], direccion(2), 1,
+                                                      GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, MRF24LiberarGts(&nodos[ALARMA], direccion(2),
+                                                      GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24GetSuperframe(&nodos[COORDINADOR], NULL));
+}
+
+// Al inicializar, el coordinador carga el beacon y lo envía al comienzo de cada supertrama
+void test_el_coordinador_envia_un_beacon_por_intervalo(void) {
+
+    mrf24_superframe_t sf;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL_HEX8(PANCOORD, MRF24SimGetShort(&sims[COORDINADOR], RXMCR) & PANCOORD);
+    TEST_ASSERT_EQUAL_HEX8(SLOTTED, MRF24SimGetShort(&sims[COORDINADOR], TXMCR) & SLOTTED);
+    TEST_ASSERT_EQUAL_HEX8(0x33, MRF24SimGetShort(&sims[COORDINADOR], ORDER));
+    TEST_ASSERT_EQUAL_HEX8(TXBMSK, MRF24SimGetShort(&sims[COORDINADOR], TXBCON1) & TXBMSK);
+    TEST_ASSERT_EQUAL_HEX8(0x0F, MRF24SimGetShort(&sims[COORDINADOR], ESLOTG1));
+    TEST_ASSERT_EQUAL(11, MRF24SimGetLong(&sims[COORDINADOR], TX_BEACON_FIFO + 1));
+    TEST_ASSERT_EQUAL_HEX8(0x33, MRF24SimGetLong(&sims[COORDINADOR], POS_SUPERTRAMA));
+    TEST_ASSERT_EQUAL_HEX8(0x4F, MRF24SimGetLong(&sims[COORDINADOR], POS_SUPERTRAMA + 1));
+    TEST_ASSERT_EQUAL_HEX8(0x80, MRF24SimGetLong(&sims[COORDINADOR], POS_SUPERTRAMA + 2));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetSuperframe(&nodos[COORDINADOR], &sf));
+    TEST_ASSERT_EQUAL(SF_ROLE_COORDINATOR, sf.role);
+    TEST_ASSERT_TRUE(sf.synced);
+    TEST_ASSERT_EQUAL(15, sf.cap_end);
+
+    uint32_t beacons = sims[COORDINADOR].stats.tx_beacons;
+    correr(8 * INTERVALO_US);
+    TEST_ASSERT_UINT32_WITHIN(1, 8, sims[COORDINADOR].stats.tx_beacons - beacons);
+}
+
+// Las GTS se ubican al final de la supertrama y el CAP no baja de aMinCAPLength
+void test_las_gts_achican_el_cap_hasta_su_largo_minimo(void) {
+
+    mrf24_superframe_config_t so_cero = {4, 0};
+    mrf24_superframe_t sf;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetSuperframe(&nodos[COORDINADOR], &so_cero));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24AsignarGts(&nodos[COORDINADOR], 0x10, 3,
+                                                    GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24AsignarGts(&nodos[COORDINADOR], 0x11, 4,
+                                                    GTS_DIR_RECEIVE));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24AsignarGts(&nodos[COORDINADOR], 0x10, 1,
+                                                     GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24AsignarGts(&nodos[COORDINADOR], BROADCAST, 1,
+                                                     GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL(BUFFER_FULL, MRF24AsignarGts(&nodos[COORDINADOR], 0x12, 2,
+                                                   GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24AsignarGts(&nodos[COORDINADOR], 0x12, 1,
+                                                    GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL_HEX8(0x87, MRF24SimGetShort(&sims[COORDINADOR], ESLOTG1));
+    TEST_ASSERT_EQUAL_HEX8(0xFC, MRF24SimGetShort(&sims[COORDINADOR], ESLOTG23));
+    TEST_ASSERT_EQUAL_HEX8(GTSON, MRF24SimGetShort(&sims[COORDINADOR], GATECLK));
+    TEST_ASSERT_EQUAL_HEX8(0x83, MRF24SimGetLong(&sims[COORDINADOR], POS_SUPERTRAMA + 2));
+    TEST_ASSERT_EQUAL_HEX8(0x02, MRF24SimGetLong(&sims[COORDINADOR], POS_SUPERTRAMA + 3));
+
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24LiberarGts(&nodos[COORDINADOR], 0x11,
+                                                     GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24LiberarGts(&nodos[COORDINADOR], 0x11, GTS_DIR_RECEIVE));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetSuperframe(&nodos[COORDINADOR], &sf));
+    TEST_ASSERT_EQUAL(2, sf.gts_count);
+    TEST_ASSERT_EQUAL(11, sf.cap_end);
+    TEST_ASSERT_EQUAL(12, sf.gts[0].start_slot);
+    TEST_ASSERT_EQUAL(13, sf.gts[1].start_slot);
+    TEST_ASSERT_EQUAL_HEX8(0xCB, MRF24SimGetShort(&sims[COORDINADOR], ESLOTG1));
+    TEST_ASSERT_EQUAL_HEX8(0x0F, MRF24SimGetShort(&sims[COORDINADOR], ESLOTG23));
+
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetSuperframe(&nodos[COORDINADOR], &config));
+
+    for (uint8_t i = 0; i < SF_MAX_GTS; i++)
+        TEST_ASSERT_EQUAL(OPERATION_OK, MRF24AsignarGts(&nodos[COORDINADOR], 0x20 + i, 1,
+                                                        GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL(BUFFER_FULL, MRF24AsignarGts(&nodos[COORDINADOR], 0x30, 1,
+                                                   GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetSuperframe(&nodos[COORDINADOR], &sf));
+    TEST_ASSERT_EQUAL(8, sf.cap_end);
+}
+
+// Con el mayor orden de supertrama un solo slot ya cubre aMinCAPLength
+void test_con_el_mayor_orden_de_supertrama_las_gts_dejan_un_slot_de_cap(void) {
+
+    mrf24_superframe_config_t maximo = {ORDEN_MAXIMO, ORDEN_MAXIMO};
+    mrf24_superframe_t sf;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetSuperframe(&nodos[COORDINADOR], &maximo));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24AsignarGts(&nodos[COORDINADOR], 0x10, 15,
+                                                    GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL(BUFFER_FULL, MRF24AsignarGts(&nodos[COORDINADOR], 0x11, 1,
+                                                   GTS_DIR_TRANSMIT));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetSuperframe(&nodos[COORDINADOR], &sf));
+    TEST_ASSERT_EQUAL(0, sf.cap_end);
+    TEST_ASSERT_EQUAL(1, sf.gts[0].start_slot);
+}
+
+// Los dispositivos toman la supertrama y las GTS del beacon y programan sus registros
+void test_los_dispositivos_se_sincronizan_con_los_beacons(void) {
+
+    mrf24_superframe_t sf;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetSuperframe(&nodos[ALARMA], &sf));
+    TEST_ASSERT_FALSE(sf.synced);
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24TransmitirGts(&nodos[ALARMA], &alarma,
+                                                        &ultimo_resultado.handle));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24AsignarGts(&nodos[COORDINADOR], direccion(ALARMA), 1,
+                                                    GTS_DIR_TRANSMIT));
+
+    // retorno esperado
+    correr(2 * INTERVALO_US);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetSuperframe(&nodos[ALARMA], &sf));
+    TEST_ASSERT_EQUAL(SF_ROLE_DEVICE, sf.role);
+    TEST_ASSERT_TRUE(sf.synced);
+    TEST_ASSERT_EQUAL(BO_ALARMA, sf.beacon_order);
+    TEST_ASSERT_EQUAL(SO_ALARMA, sf.superframe_order);
+    TEST_ASSERT_EQUAL(14, sf.cap_end);
+    TEST_ASSERT_EQUAL(1, sf.gts_count);
+    TEST_ASSERT_EQUAL_HEX16(direccion(ALARMA), sf.gts[0].address);
+    TEST_ASSERT_EQUAL(15, sf.gts[0].start_slot);
+    TEST_ASSERT_EQUAL(GTS_DIR_TRANSMIT, sf.gts[0].direction);
+    TEST_ASSERT_EQUAL_HEX8(0x33, MRF24SimGetShort(&sims[ALARMA], ORDER));
+    TEST_ASSERT_EQUAL_HEX8(SLOTTED, MRF24SimGetShort(&sims[ALARMA], TXMCR) & SLOTTED);
+    TEST_ASSERT_EQUAL_HEX8(0xFE, MRF24SimGetShort(&sims[ALARMA], ESLOTG1));
+    TEST_ASSERT_EQUAL_HEX8(0, MRF24SimGetShort(&sims[ALARMA], RXMCR) & PANCOORD);
+    TEST_ASSERT_TRUE(0 != sims[ALARMA].supertrama_ns);
+}
+
+// Con el CAP saturado, cada alarma llega en su GTS antes de un intervalo de beacon y un slot
+void test_la_alarma_llega_en_su_gts_aunque_el_cap_este_saturado(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24AsignarGts(&nodos[COORDINADOR], direccion(ALARMA), 1,
+                                                    GTS_DIR_TRANSMIT));
+    correr(2 * INTERVALO_US);
+    saturar = true;
+    correr(2 * INTERVALO_US);
+
+    // retorno esperado
+    for (uint8_t i = 0; i < ALARMAS; i++) {
+
+        correr(DESFASE_US * (i + 1));
+        uint16_t antes = alarmas_recibidas;
+        uint64_t inicio = MRF24SimGetTiempoUs(&medio);
+        TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirGts(&nodos[ALARMA], &alarma, &handle));
+        esperarResultado(&nodos[ALARMA], handle, &resultado);
+        TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+        TEST_ASSERT_EQUAL(antes + 1, alarmas_recibidas);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(INTERVALO_US + SLOT_US, alarma_us - inicio);
+    }
+    uint32_t fallas = 0;
+
+    for (uint8_t i = ALARMA + 1; i < NODOS; i++)
+        fallas += sims[i].stats.tx_cca_fallas + sims[i].stats.tx_reintentos;
+    TEST_ASSERT_GREATER_THAN_UINT32(0, fallas);
+    TEST_ASSERT_EQUAL_UINT32(ALARMAS, sims[ALARMA].stats.tx_gts);
+}
+
+// Una trama que no entra en lo que dura la GTS no sale y se informa como descartada
+void test_una_trama_que_no_entra_en_la_gts_se_descarta(void) {
+
+    mrf24_superframe_config_t so_cero = {2, 0};
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetSuperframe(&nodos[COORDINADOR], &so_cero));
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24AsignarGts(&nodos[COORDINADOR], direccion(ALARMA), 2,
+                                                    GTS_DIR_TRANSMIT));
+    correr(3 * INTERVALO_BO2_US);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirGts(&nodos[ALARMA], &alarma, &handle));
+    esperarResultado(&nodos[ALARMA], handle, &resultado);
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    TEST_ASSERT_EQUAL(1, alarmas_recibidas);
+
+    alarma.buffer_size = LARGO_SATURACION;
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirGts(&nodos[ALARMA], &alarma, &handle));
+    esperarResultado(&nodos[ALARMA], handle, &resultado);
+    TEST_ASSERT_EQUAL(TX_DROPPED, resultado.status);
+    TEST_ASSERT_EQUAL_HEX8(TXG1FNT | TXG1STAT,
+                           MRF24SimGetShort(&sims[ALARMA], TXSTAT) & (TXG1FNT | TXG1STAT));
+    TEST_ASSERT_EQUAL_UINT32(1, sims[ALARMA].stats.tx_gts);
+}
+
+// El coordinador transmite al dispositivo en la GTS de recepción de ese dispositivo
+void test_el_coordinador_transmite_en_la_gts_de_recepcion(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24AsignarGts(&nodos[COORDINADOR], direccion(ALARMA), 1,
+                                                    GTS_DIR_RECEIVE));
+    correr(2 * INTERVALO_US);
+    alarma.dest_address = DIRECCION_NADIE;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24TransmitirGts(&nodos[COORDINADOR], &alarma, &handle));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24TransmitirGts(&nodos[ALARMA], &alarma, &handle));
+    alarma.dest_address = direccion(ALARMA);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirGts(&nodos[COORDINADOR], &alarma, &handle));
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS,
+                      MRF24AsignarGts(&nodos[COORDINADOR], 0x20, 1, GTS_DIR_TRANSMIT));
+    uint32_t demora = esperarResultado(&nodos[COORDINADOR], handle, &resultado);
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(INTERVALO_US + SLOT_US, demora);
+    TEST_ASSERT_EQUAL(1, recibidos_alarma);
+}
+
+// Al apagar la supertrama dejan de salir beacons y la trama que esperaba su GTS se descarta
+void test_al_apagar_la_supertrama_se_descartan_las_tramas_en_espera(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24AsignarGts(&nodos[COORDINADOR], direccion(ALARMA), 1,
+                                                    GTS_DIR_RECEIVE));
+    correr(INTERVALO_US / 2);
+    alarma.dest_address = direccion(ALARMA);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirGts(&nodos[COORDINADOR], &alarma, &handle));
+    MRF24SetTxCallback(&nodos[COORDINADOR], guardarResultado);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetSuperframe(&nodos[COORDINADOR], NULL));
+    TEST_ASSERT_EQUAL(handle, ultimo_resultado.handle);
+    TEST_ASSERT_EQUAL(TX_DROPPED, ultimo_resultado.status);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetTxStatus(&nodos[COORDINADOR], handle, &resultado));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, MRF24SimGetShort(&sims[COORDINADOR], ORDER));
+    TEST_ASSERT_EQUAL_HEX8(0, MRF24SimGetShort(&sims[COORDINADOR], RXMCR) & PANCOORD);
+    TEST_ASSERT_EQUAL_HEX8(0, MRF24SimGetShort(&sims[COORDINADOR], TXMCR) & SLOTTED);
+    uint32_t beacons = sims[COORDINADOR].stats.tx_beacons;
+    correr(2 * INTERVALO_US);
+    TEST_ASSERT_EQUAL_UINT32(beacons, sims[COORDINADOR].stats.tx_beacons);
+    TEST_ASSERT_EQUAL(0, recibidos_alarma);
+
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SeguirBeacons(&nodos[ALARMA], false));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, MRF24SimGetShort(&sims[ALARMA], ORDER));
+    TEST_ASSERT_EQUAL_HEX8(0, MRF24SimGetShort(&sims[ALARMA], TXMCR) & SLOTTED);
+}
@@ -0,0 +1,384 @@
+#include "unity.h"
+#include <string.h>
+#include "drv_MRF24J40.h"
+#include "drv_MRF24J40_registers.h"
+#include "mrf24j40_sim.h"
+#include "mrf24j40_fixture.h"
+
+TEST_SOURCE_FILE("mrf24j40_sim.c")
+TEST_SOURCE_FILE("mrf24j40_fixture.c")
+
+#define COORDINADOR     0
+#define DORMIDO         1
+#define DESPIERTO       2
+#define NODOS           3
+#define PASO_AIRE_US    100
+#define US_POR_MS       1000
+#define LATENCIA_MS     500
+#define ESCUCHA_MS      20
+#define PERSISTENCIA_MS 50
+#define DATA_REQUEST    (0x04)
+
+static mrf24_sim_medio_t medio;
+static mrf24_sim_t sims[NODOS];
+static mrf24_dev_t nodos[NODOS];
+static mrf24_data_out_t salida;
+static const mrf24_lpl_config_t config = {LATENCIA_MS, ESCUCHA_MS};
+static uint16_t recibidos[NODOS];
+static mrf24_tx_result_t ultimo_resultado;
+
+static void guardarResultado(mrf24_dev_t * dev, const mrf24_tx_result_t * resultado) {
+
+    memcpy(&ultimo_resultado, resultado, sizeof(ultimo_resultado));
+}
+
+static uint16_t direccion(uint8_t i) {
+
+    return (uint16_t)(i + 1);
+}
+
+static void configurarBajoConsumo(mrf24_dev_t * nodo) {
+
+    MRF24SetLowPower(nodo, &config);
+}
+
+// Atiende las interrupciones y el lazo principal de todos los nodos y cuenta lo recibido
+static void correr(uint32_t duracion_us) {
+
+    for (uint32_t t = 0; t < duracion_us; t += PASO_AIRE_US) {
+
+        for (uint8_t i = 0; i < NODOS; i++) {
+
+            if (MSG_PRESENT == MRF24IsNewMsg(&nodos[i]))
+                MRF24ReciboPaquete(&nodos[i]);
+
+            while (NULL != MRF24GetDataIn(&nodos[i])) {
+
+                recibidos[i]++;
+                MRF24ReleaseDataIn(&nodos[i]);
+            }
+            MRF24Poll(&nodos[i]);
+        }
+        MRF24SimAvanzar(&medio, PASO_AIRE_US);
+    }
+}
+
+// Corre hasta que el nodo llegue al paso pedido, devuelve false si no llega en un segundo
+static bool_t esperarPaso(mrf24_dev_t * nodo, mrf24_lpl_step_t paso) {
+
+    for (uint32_t t = 0; t < 1000 * US_POR_MS; t += PASO_AIRE_US) {
+
+        if (paso == MRF24GetLowPowerStep(nodo))
+            return true;
+        correr(PASO_AIRE_US);
+    }
+    return false;
+}
+
+// Manda el pedido de datos, despertando al módulo si hace falta
+static mrf24_state_t pedir(uint8_t i, mrf24_tx_handle_t * handle) {
+
+    mrf24_state_t estado = TRANS_IN_PROGRESS;
+
+    for (uint32_t t = 0; t < 1000 * US_POR_MS && TRANS_IN_PROGRESS == estado; t += PASO_AIRE_US) {
+
+        estado = MRF24PedirDatos(&nodos[i], direccion(COORDINADOR), handle);
+
+        if (TRANS_IN_PROGRESS == estado)
+            correr(PASO_AIRE_US);
+    }
+    return estado;
+}
+
+// Corre hasta que termine la transmisión y devuelve cuánto tardó
+static uint32_t esperarResultado(mrf24_dev_t * nodo, mrf24_tx_handle_t handle,
+                                 mrf24_tx_result_t * resultado) {
+
+    uint64_t inicio = MRF24SimGetTiempoUs(&medio);
+
+    for (uint32_t t = 0; t < 1000 * US_POR_MS; t += PASO_AIRE_US) {
+
+        if (OPERATION_OK == MRF24GetTxStatus(nodo, handle, resultado) &&
+            TX_PENDING != resultado->status)
+            break;
+        correr(PASO_AIRE_US);
+    }
+    return (uint32_t)(MRF24SimGetTiempoUs(&medio) - inicio);
+}
+
+void setUp(void) {
+
+    MRF24FixtureInit(&medio);
+
+    for (uint8_t i = 0; i < NODOS; i++) {
+
+        MRF24FixturePrepararNodo(&nodos[i], &sims[i], direccion(i),
+                                 (DORMIDO == i) ? configurarBajoConsumo : NULL);
+        recibidos[i] = 0;
+    }
+
+    memset(&salida, 0, sizeof(salida));
+    salida.dest_panid = FIXTURE_PANID;
+    salida.dest_address = direccion(DORMIDO);
+    memcpy(salida.buffer, "hola", 4);
+    salida.buffer_size = 4;
+    memset(&ultimo_resultado, 0, sizeof(ultimo_resultado));
+}
+
+void tearDown(void) {
+}
+
+// Las tramas indirectas van a un solo destino y entran en la tabla mientras haya lugar
+void test_la_transmision_indirecta_valida_sus_parametros(void) {
+
+    mrf24_tx_handle_t handle;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, MRF24PedirDatos(&nodos[DORMIDO], 1, &handle));
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL(INVALID_VALUE,
+                      MRF24EncolarIndirecto(&nodos[COORDINADOR], &salida, VACIO, NULL));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24PedirDatos(&nodos[DORMIDO], BROADCAST, &handle));
+    TEST_ASSERT_EQUAL(DIRECTION_EMPTY, MRF24PedirDatos(&nodos[DORMIDO], VACIO, &handle));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24GetIndirectStats(&nodos[COORDINADOR], NULL));
+    salida.dest_address = BROADCAST;
+    TEST_ASSERT_EQUAL(INVALID_VALUE,
+                      MRF24EncolarIndirecto(&nodos[COORDINADOR], &salida, VACIO, &handle));
+    salida.dest_address = direccion(DORMIDO);
+
+    for (uint8_t i = 0; i < INDIRECT_TABLE_SIZE; i++) {
+
+        TEST_ASSERT_EQUAL(OPERATION_OK,
+                          MRF24EncolarIndirecto(&nodos[COORDINADOR], &salida, VACIO, &handle));
+    }
+    TEST_ASSERT_EQUAL(BUFFER_FULL,
+                      MRF24EncolarIndirecto(&nodos[COORDINADOR], &salida, VACIO, &handle));
+}
+
+// La trama guardada no sale hasta que el destino la pide y llega con un solo pedido
+void test_la_trama_guardada_sale_cuando_el_destino_la_pide(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_handle_t pedido;
+    mrf24_tx_result_t resultado;
+    mrf24_indirect_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL_HEX8(0, MRF24SimGetShort(&sims[COORDINADOR], ACKTMOUT) & DRPACK);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK,
+                      MRF24EncolarIndirecto(&nodos[COORDINADOR], &salida, VACIO, &handle));
+    TEST_ASSERT_EQUAL_HEX8(DRPACK, MRF24SimGetShort(&sims[COORDINADOR], ACKTMOUT) & DRPACK);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetPhyMode(&nodos[COORDINADOR], PHY_250KBPS));
+    TEST_ASSERT_EQUAL_HEX8(DRPACK, MRF24SimGetShort(&sims[COORDINADOR], ACKTMOUT) & DRPACK);
+    correr(2 * LATENCIA_MS * US_POR_MS);
+    TEST_ASSERT_EQUAL(0, recibidos[DORMIDO]);
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS,
+                      MRF24GetTxStatus(&nodos[COORDINADOR], handle, &resultado));
+    TEST_ASSERT_EQUAL(TX_PENDING, resultado.status);
+
+    TEST_ASSERT_EQUAL(OPERATION_OK, pedir(DORMIDO, &pedido));
+    esperarResultado(&nodos[DORMIDO], pedido, &resultado);
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    esperarResultado(&nodos[COORDINADOR], handle, &resultado);
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    TEST_ASSERT_EQUAL(1, recibidos[DORMIDO]);
+    TEST_ASSERT_EQUAL_HEX8(0, MRF24SimGetShort(&sims[COORDINADOR], ACKTMOUT) & DRPACK);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetIndirectStats(&nodos[COORDINADOR], &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.requests);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.delivered);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetIndirectStats(&nodos[DORMIDO], &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.polls);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.pending);
+}
+
+// Con más de una trama guardada la primera avisa que hay otra y el destino vuelve a pedir
+void test_con_varias_tramas_guardadas_el_destino_repite_el_pedido(void) {
+
+    mrf24_tx_handle_t handle[3];
+    mrf24_tx_handle_t pedido;
+    mrf24_tx_result_t resultado;
+    mrf24_indirect_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    for (uint8_t i = 0; i < 3; i++) {
+
+        TEST_ASSERT_EQUAL(OPERATION_OK,
+                          MRF24EncolarIndirecto(&nodos[COORDINADOR], &salida, VACIO, &handle[i]));
+    }
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, pedir(DORMIDO, &pedido));
+    esperarResultado(&nodos[COORDINADOR], handle[2], &resultado);
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    TEST_ASSERT_EQUAL(3, recibidos[DORMIDO]);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetIndirectStats(&nodos[DORMIDO], &stats));
+    TEST_ASSERT_EQUAL_UINT32(3, stats.polls);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetIndirectStats(&nodos[COORDINADOR], &stats));
+    TEST_ASSERT_EQUAL_UINT32(3, stats.delivered);
+    correr(LATENCIA_MS * US_POR_MS);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetIndirectStats(&nodos[DORMIDO], &stats));
+    TEST_ASSERT_EQUAL_UINT32(3, stats.polls);
+}
+
+// Si el ACK del pedido no trae trama pendiente el módulo vuelve a dormir sin esperar la ventana
+void test_sin_tramas_pendientes_el_modulo_vuelve_a_dormir_enseguida(void) {
+
+    mrf24_tx_handle_t pedido;
+    mrf24_tx_result_t resultado;
+    mrf24_indirect_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_TRUE(esperarPaso(&nodos[DORMIDO], LPL_STEP_SLEEP));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, pedir(DORMIDO, &pedido));
+    esperarResultado(&nodos[DORMIDO], pedido, &resultado);
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    uint64_t inicio = MRF24SimGetTiempoUs(&medio);
+    TEST_ASSERT_TRUE(esperarPaso(&nodos[DORMIDO], LPL_STEP_SLEEP));
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(ESCUCHA_MS * US_POR_MS / 4,
+                                     MRF24SimGetTiempoUs(&medio) - inicio);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetIndirectStats(&nodos[DORMIDO], &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pending);
+}
+
+// Una trama que nadie pide vence, se informa TX_EXPIRED y se deja de reconocer con pendiente
+void test_una_trama_que_nadie_pide_vence_al_cumplirse_el_plazo(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+    mrf24_indirect_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetTxCallback(&nodos[COORDINADOR], guardarResultado));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarIndirecto(&nodos[COORDINADOR], &salida,
+                                                          PERSISTENCIA_MS, &handle));
+    uint32_t demora = esperarResultado(&nodos[COORDINADOR], handle, &resultado);
+    TEST_ASSERT_EQUAL(TX_EXPIRED, resultado.status);
+    TEST_ASSERT_UINT32_WITHIN(2 * US_POR_MS, PERSISTENCIA_MS * US_POR_MS, demora);
+    TEST_ASSERT_EQUAL(handle, ultimo_resultado.handle);
+    TEST_ASSERT_EQUAL(TX_EXPIRED, ultimo_resultado.status);
+    TEST_ASSERT_EQUAL_HEX8(0, MRF24SimGetShort(&sims[COORDINADOR], ACKTMOUT) & DRPACK);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetIndirectStats(&nodos[COORDINADOR], &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.expired);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.delivered);
+}
+
+// Cada pedido se atiende con las tramas de quien lo manda, aunque el ACK avise por todos
+void test_el_pedido_de_un_dispositivo_no_entrega_las_tramas_de_otro(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_handle_t pedido;
+    mrf24_tx_result_t resultado;
+    mrf24_indirect_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    salida.dest_address = direccion(DESPIERTO);
+    TEST_ASSERT_EQUAL(OPERATION_OK,
+                      MRF24EncolarIndirecto(&nodos[COORDINADOR], &salida, VACIO, &handle));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, pedir(DORMIDO, &pedido));
+    esperarResultado(&nodos[DORMIDO], pedido, &resultado);
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    correr(ESCUCHA_MS * US_POR_MS);
+    TEST_ASSERT_EQUAL(0, recibidos[DORMIDO]);
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS,
+                      MRF24GetTxStatus(&nodos[COORDINADOR], handle, &resultado));
+    TEST_ASSERT_EQUAL(TX_PENDING, resultado.status);
+
+    TEST_ASSERT_EQUAL(OPERATION_OK, pedir(DESPIERTO, &pedido));
+    esperarResultado(&nodos[COORDINADOR], handle, &resultado);
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    TEST_ASSERT_EQUAL(1, recibidos[DESPIERTO]);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetIndirectStats(&nodos[COORDINADOR], &stats));
+    TEST_ASSERT_EQUAL_UINT32(2, stats.requests);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.delivered);
+}
+
+// Un pedido de datos con origen largo, de un dispositivo sin dirección corta, va a la aplicación
+void test_un_pedido_de_datos_con_origen_largo_queda_para_la_aplicacion(void) {
+
+    const uint8_t comando = DATA_REQUEST;
+    mrf24_segment_t segmento = {&comando, sizeof(comando)};
+    mrf24_frame_opts_t opciones = {FRAME_COMMAND, true, true, ADDR_SHORT, ADDR_LONG,
+                                   VACIO, direccion(COORDINADOR), VACIO, {0}};
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+    mrf24_indirect_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    salida.dest_address = NO_SHORT_ADDRESS;
+    TEST_ASSERT_EQUAL(INVALID_VALUE,
+                      MRF24EncolarIndirecto(&nodos[COORDINADOR], &salida, VACIO, &handle));
+    salida.dest_address = direccion(DESPIERTO);
+    TEST_ASSERT_EQUAL(OPERATION_OK,
+                      MRF24EncolarIndirecto(&nodos[COORDINADOR], &salida, VACIO, &handle));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24TransmitirTrama(&nodos[DESPIERTO], &opciones,
+                                                            &segmento, 1));
+    correr(ESCUCHA_MS * US_POR_MS);
+    TEST_ASSERT_EQUAL(1, recibidos[COORDINADOR]);
+    TEST_ASSERT_EQUAL(0, recibidos[DESPIERTO]);
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS,
+                      MRF24GetTxStatus(&nodos[COORDINADOR], handle, &resultado));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetIndirectStats(&nodos[COORDINADOR], &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.requests);
+}
+
+// Un dispositivo dormido que consulta en cada despertar pasa dormido casi todo el tiempo
+void test_consultando_en_cada_despertar_el_modulo_duerme_la_mayor_parte_del_tiempo(void) {
+
+    mrf24_tx_handle_t pedido;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_TRUE(esperarPaso(&nodos[DORMIDO], LPL_STEP_SLEEP));
+    uint64_t dormido_ns = sims[DORMIDO].stats.dormido_ns;
+    uint64_t inicio = MRF24SimGetTiempoUs(&medio);
+
+    // retorno esperado
+    for (uint8_t i = 0; i < 4; i++) {
+
+        TEST_ASSERT_TRUE(esperarPaso(&nodos[DORMIDO], LPL_STEP_LISTEN));
+        TEST_ASSERT_EQUAL(OPERATION_OK, pedir(DORMIDO, &pedido));
+        TEST_ASSERT_TRUE(esperarPaso(&nodos[DORMIDO], LPL_STEP_SLEEP));
+    }
+    uint64_t total_us = MRF24SimGetTiempoUs(&medio) - inicio;
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32((uint32_t)(total_us * 99 / 100),
+                                        (sims[DORMIDO].stats.dormido_ns - dormido_ns) / 1000);
+}
+
+// Al dar la vuelta el contador de identificadores no repite el de una trama guardada
+void test_al_dar_la_vuelta_los_identificadores_no_repiten_el_de_una_trama_guardada(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_handle_t directa;
+    mrf24_tx_result_t resultado;
+    mrf24_indirect_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL(OPERATION_OK,
+                      MRF24EncolarIndirecto(&nodos[COORDINADOR], &salida, VACIO, &handle));
+    salida.dest_address = direccion(DESPIERTO);
+
+    // retorno esperado
+    for (uint16_t i = 0; i < UINT8_MAX; i++) {
+
+        TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&nodos[COORDINADOR], &salida, &directa));
+        TEST_ASSERT_NOT_EQUAL(handle, directa);
+        esperarResultado(&nodos[COORDINADOR], directa, &resultado);
+        TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    }
+    TEST_ASSERT_EQUAL(UINT8_MAX, recibidos[DESPIERTO]);
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS,
+                      MRF24GetTxStatus(&nodos[COORDINADOR], handle, &resultado));
+    TEST_ASSERT_EQUAL(TX_PENDING, resultado.status);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetIndirectStats(&nodos[COORDINADOR], &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.delivered);
+}
@@ -0,0 +1,290 @@
+#include "unity.h"
+#include <string.h>
+#include "drv_MRF24J40.h"
+#include "drv_MRF24J40_lowpan.h"
+#include "mrf24j40_sim.h"
+#include "mrf24j40_fixture.h"
+
+TEST_SOURCE_FILE("mrf24j40_sim.c")
+TEST_SOURCE_FILE("mrf24j40_fixture.c")
+
+#define DIRECCION_A   (0x0001)
+#define DIRECCION_B   (0x0002)
+#define AIRE_US       20000
+#define LARGO_DATOS   20
+#define LARGO_UDP     (LOWPAN_UDP_HEADER + LARGO_DATOS)
+#define LARGO_PAQUETE (LOWPAN_IPV6_HEADER + LARGO_UDP)
+#define NEXT_ICMPV6   58
+
+static mrf24_sim_medio_t medio;
+static mrf24_sim_t sim_a;
+static mrf24_sim_t sim_b;
+static mrf24_dev_t nodo_a;
+static mrf24_dev_t nodo_b;
+static uint8_t paquete[LARGO_PAQUETE];
+static uint8_t cabecera[LOWPAN_MAX_HEADER];
+static uint8_t reconstruido[BUFFER_SIZE + LOWPAN_MAX_HEADER];
+static uint8_t trama[BUFFER_SIZE];
+
+// Dirección link-local con la IID que sale de una dirección corta
+static void cargarLocal(uint8_t * ip, uint16_t corta) {
+
+    memset(ip, 0, LOWPAN_IPV6_ADDRESS);
+    ip[0] = 0xFE;
+    ip[1] = 0x80;
+    ip[11] = 0xFF;
+    ip[12] = 0xFE;
+    ip[14] = (uint8_t)(corta >> 8);
+    ip[15] = (uint8_t)corta;
+}
+
+// Paquete UDP de A a B, link-local, sin clase de tráfico ni flow label
+static void cargarPaquete(void) {
+
+    memset(paquete, 0, sizeof(paquete));
+    paquete[0] = 0x60;
+    paquete[5] = LARGO_UDP;
+    paquete[6] = LOWPAN_NEXT_UDP;
+    paquete[7] = 64;
+    cargarLocal(&paquete[8], DIRECCION_A);
+    cargarLocal(&paquete[24], DIRECCION_B);
+    paquete[40] = 0xF0;
+    paquete[41] = 0xB1;
+    paquete[42] = 0xF0;
+    paquete[43] = 0xB2;
+    paquete[45] = LARGO_UDP;
+    paquete[46] = 0xCA;
+    paquete[47] = 0xFE;
+
+    for (uint8_t i = 0; i < LARGO_DATOS; i++)
+        paquete[LOWPAN_IPV6_HEADER + LOWPAN_UDP_HEADER + i] = (uint8_t)(i * 5 + 1);
+}
+
+// Comprime el paquete, arma la trama y la vuelve a descomprimir
+static mrf24_state_t idaYVuelta(uint16_t origen, uint16_t destino, uint8_t * largo_cabecera,
+                                uint16_t * largo) {
+
+    uint16_t consumidos = 0;
+    mrf24_state_t estado = MRF24LowpanComprimir(paquete, sizeof(paquete), origen, destino,
+                                                cabecera, largo_cabecera, &consumidos);
+
+    if (OPERATION_OK != estado)
+        return estado;
+    memcpy(trama, cabecera, *largo_cabecera);
+    memcpy(&trama[*largo_cabecera], &paquete[consumidos], sizeof(paquete) - consumidos);
+
+    return MRF24LowpanDescomprimir(trama, (uint8_t)(*largo_cabecera + sizeof(paquete) - consumidos),
+                                   origen, destino, reconstruido, sizeof(reconstruido), largo);
+}
+
+void setUp(void) {
+
+    MRF24FixtureInit(&medio);
+    MRF24FixturePrepararNodo(&nodo_a, &sim_a, DIRECCION_A, NULL);
+    MRF24FixturePrepararNodo(&nodo_b, &sim_b, DIRECCION_B, NULL);
+    cargarPaquete();
+}
+
+void tearDown(void) {
+}
+
+// Entre dos direcciones link-local de direcciones cortas la cabecera IPv6 y UDP queda en 6 bytes
+void test_udp_link_local_entre_direcciones_cortas_se_comprime_a_seis_bytes(void) {
+
+    uint8_t largo_cabecera = 0;
+    uint16_t consumidos = 0;
+    const uint8_t esperado[] = {0x7E, 0x33, 0xF3, 0x12, 0xCA, 0xFE};
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK,
+                      MRF24LowpanComprimir(paquete, sizeof(paquete), DIRECCION_A, DIRECCION_B,
+                                           cabecera, &largo_cabecera, &consumidos));
+    TEST_ASSERT_EQUAL(sizeof(esperado), largo_cabecera);
+    TEST_ASSERT_EQUAL(LOWPAN_IPV6_HEADER + LOWPAN_UDP_HEADER, consumidos);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(esperado, cabecera, sizeof(esperado));
+}
+
+// La descompresión devuelve el paquete original, con los largos recalculados
+void test_la_descompresion_devuelve_el_paquete_original(void) {
+
+    uint8_t largo_cabecera = 0;
+    uint16_t largo = 0;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, idaYVuelta(DIRECCION_A, DIRECCION_B, &largo_cabecera, &largo));
+    TEST_ASSERT_EQUAL(sizeof(paquete), largo);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(paquete, reconstruido, sizeof(paquete));
+}
+
+// Las IID que no salen de la dirección corta de la trama van en 16 o 64 bits
+void test_las_iid_que_no_coinciden_con_la_trama_van_en_linea(void) {
+
+    uint8_t largo_cabecera = 0;
+    uint16_t largo = 0;
+
+    paquete[38] = 0x02;
+    paquete[39] = 0x04;
+    memcpy(&paquete[16], "\x02\x11\x22\x33\x44\x55\x66\x77", 8);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, idaYVuelta(DIRECCION_A, DIRECCION_B, &largo_cabecera, &largo));
+    TEST_ASSERT_EQUAL_HEX8(0x12, cabecera[1]);
+    TEST_ASSERT_EQUAL(6 + 8 + 2, largo_cabecera);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(paquete, reconstruido, sizeof(paquete));
+}
+
+// Clase de tráfico, flow label, hop limit y next header que no es UDP viajan en línea
+void test_campos_sin_compresion_posible_viajan_en_linea(void) {
+
+    uint8_t largo_cabecera = 0;
+    uint16_t largo = 0;
+    const uint8_t global[LOWPAN_IPV6_ADDRESS] = {0x20, 0x01, 0x0D, 0xB8, [15] = 0x09};
+
+    paquete[0] = 0x6B;
+    paquete[1] = 0x9A;
+    paquete[2] = 0xBC;
+    paquete[3] = 0xDE;
+    paquete[6] = NEXT_ICMPV6;
+    paquete[7] = 17;
+    memcpy(&paquete[8], global, sizeof(global));
+    memcpy(&paquete[24], global, sizeof(global));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, idaYVuelta(DIRECCION_A, DIRECCION_B, &largo_cabecera, &largo));
+    TEST_ASSERT_EQUAL_HEX8(0x60, cabecera[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, cabecera[1]);
+    TEST_ASSERT_EQUAL(2 + 4 + 1 + 1 + 16 + 16, largo_cabecera);
+    TEST_ASSERT_EQUAL(sizeof(paquete), largo);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(paquete, reconstruido, sizeof(paquete));
+}
+
+// El multicast a todos los nodos va en un byte y el origen no especificado no ocupa nada
+void test_multicast_a_todos_los_nodos_y_origen_no_especificado(void) {
+
+    uint8_t largo_cabecera = 0;
+    uint16_t largo = 0;
+
+    memset(&paquete[8], 0, LOWPAN_IPV6_ADDRESS);
+    memset(&paquete[24], 0, LOWPAN_IPV6_ADDRESS);
+    paquete[24] = 0xFF;
+    paquete[25] = 0x02;
+    paquete[39] = 0x01;
+    paquete[7] = 255;
+    paquete[43] = 0x33;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, idaYVuelta(DIRECCION_A, BROADCAST, &largo_cabecera, &largo));
+    TEST_ASSERT_EQUAL_HEX8(0x7F, cabecera[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x4B, cabecera[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, cabecera[2]);
+    TEST_ASSERT_EQUAL_HEX8(0xF1, cabecera[3]);
+    TEST_ASSERT_EQUAL(2 + 1 + 1 + 3 + 2, largo_cabecera);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(paquete, reconstruido, sizeof(paquete));
+}
+
+// Con la trama a BROADCAST la IID de un destino unicast no se puede elidir
+void test_con_destino_broadcast_la_iid_unicast_no_se_elide(void) {
+
+    uint8_t largo_cabecera = 0;
+    uint16_t largo = 0;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, idaYVuelta(DIRECCION_A, BROADCAST, &largo_cabecera, &largo));
+    TEST_ASSERT_EQUAL_HEX8(0x32, cabecera[1]);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(paquete, reconstruido, sizeof(paquete));
+}
+
+// Paquetes que no son IPv6 o tramas que no son IPHC se rechazan
+void test_paquetes_y_tramas_invalidos_se_rechazan(void) {
+
+    uint8_t largo_cabecera = 0;
+    uint16_t consumidos = 0;
+    uint16_t largo = 0;
+    const uint8_t fragmento[] = {0xF0, 0x01, 0x00, 0x03};
+    const uint8_t con_contexto[] = {0x7B, 0xB3};
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INVALID_VALUE,
+                      MRF24LowpanComprimir(paquete, sizeof(paquete) - 1, DIRECCION_A, DIRECCION_B,
+                                           cabecera, &largo_cabecera, &consumidos));
+    paquete[0] = 0x45;
+    TEST_ASSERT_EQUAL(INVALID_VALUE,
+                      MRF24LowpanComprimir(paquete, sizeof(paquete), DIRECCION_A, DIRECCION_B,
+                                           cabecera, &largo_cabecera, &consumidos));
+    TEST_ASSERT_EQUAL(INVALID_VALUE,
+                      MRF24LowpanDescomprimir(fragmento, sizeof(fragmento), DIRECCION_A,
+                                              DIRECCION_B, reconstruido, sizeof(reconstruido),
+                                              &largo));
+    TEST_ASSERT_EQUAL(OPERATION_FAIL,
+                      MRF24LowpanDescomprimir(con_contexto, sizeof(con_contexto), DIRECCION_A,
+                                              DIRECCION_B, reconstruido, sizeof(reconstruido),
+                                              &largo));
+}
+
+// Una trama truncada falla y un buffer chico no se desborda
+void test_trama_truncada_y_buffer_chico(void) {
+
+    uint8_t largo_cabecera = 0;
+    uint16_t consumidos = 0;
+    uint16_t largo = 0;
+
+    MRF24LowpanComprimir(paquete, sizeof(paquete), DIRECCION_A, DIRECCION_B, cabecera,
+                         &largo_cabecera, &consumidos);
+    memcpy(trama, cabecera, largo_cabecera);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_FAIL,
+                      MRF24LowpanDescomprimir(trama, largo_cabecera - 1, DIRECCION_A, DIRECCION_B,
+                                              reconstruido, sizeof(reconstruido), &largo));
+    TEST_ASSERT_EQUAL(BUFFER_FULL,
+                      MRF24LowpanDescomprimir(trama, largo_cabecera, DIRECCION_A, DIRECCION_B,
+                                              reconstruido, LOWPAN_IPV6_HEADER, &largo));
+    TEST_ASSERT_EQUAL(OPERATION_OK,
+                      MRF24LowpanDescomprimir(trama, largo_cabecera, DIRECCION_A, DIRECCION_B,
+                                              reconstruido, sizeof(reconstruido), &largo));
+    TEST_ASSERT_EQUAL(LOWPAN_IPV6_HEADER + LOWPAN_UDP_HEADER, largo);
+}
+
+// La dirección link-local sale de la dirección corta o de la MAC con el bit U/L invertido
+void test_la_direccion_local_sale_de_la_corta_o_de_la_mac(void) {
+
+    uint8_t direccion[LOWPAN_IPV6_ADDRESS];
+    uint8_t esperada[LOWPAN_IPV6_ADDRESS];
+    uint8_t mac[8] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    const uint8_t iid[8] = {0x0A, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01};
+
+    MRF24SetMAC(&nodo_a, mac);
+    cargarLocal(esperada, DIRECCION_A);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24LowpanDireccionLocal(&nodo_a, false, direccion));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(esperada, direccion, sizeof(direccion));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24LowpanDireccionLocal(&nodo_a, true, direccion));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(esperada, direccion, 8);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(iid, &direccion[8], sizeof(iid));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24LowpanDireccionLocal(&nodo_a, false, NULL));
+}
+
+// Un paquete enviado por un nodo se reconstruye igual en el otro
+void test_un_paquete_enviado_se_reconstruye_en_el_otro_nodo(void) {
+
+    mrf24_data_in_t * recibido = NULL;
+    uint16_t largo = 0;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED,
+                      MRF24LowpanEnviar(&nodo_a, DIRECCION_B, paquete, sizeof(paquete)));
+    MRF24SimAvanzar(&medio, AIRE_US);
+    TEST_ASSERT_EQUAL(MSG_PRESENT, MRF24IsNewMsg(&nodo_b));
+    MRF24ReciboPaquete(&nodo_b);
+    recibido = MRF24GetDataIn(&nodo_b);
+    TEST_ASSERT_NOT_NULL(recibido);
+    TEST_ASSERT_EQUAL(6 + LARGO_DATOS, recibido->buffer_size);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24LowpanRecibir(&nodo_b, recibido, reconstruido,
+                                                       sizeof(reconstruido), &largo));
+    TEST_ASSERT_EQUAL(sizeof(paquete), largo);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(paquete, reconstruido, sizeof(paquete));
+    MRF24ReleaseDataIn(&nodo_b);
+}
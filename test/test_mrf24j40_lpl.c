@@ -0,0 +1,286 @@
+#include "unity.h"
+#include <string.h>
+#include "drv_MRF24J40.h"
+#include "drv_MRF24J40_registers.h"
+#include "mrf24j40_sim.h"
+#include "mrf24j40_fixture.h"
+
+TEST_SOURCE_FILE("mrf24j40_sim.c")
+TEST_SOURCE_FILE("mrf24j40_fixture.c")
+
+#define DIRECCION_A     (0x0001)
+#define DIRECCION_B     (0x0002)
+#define DIRECCION_NADIE (0x0009)
+#define PASO_AIRE_US    100
+#define LATENCIA_MS     100
+#define ESCUCHA_MS      10
+#define US_POR_MS       1000
+#define NS_POR_US       1000
+#define ENVIOS          12
+#define DESFASE_US      13700
+#define DESPERTAR_US    3000
+
+static mrf24_sim_medio_t medio;
+static mrf24_sim_t sim_a;
+static mrf24_sim_t sim_b;
+static mrf24_dev_t nodo_a;
+static mrf24_dev_t nodo_b;
+static mrf24_data_out_t salida;
+static const mrf24_lpl_config_t config = {LATENCIA_MS, ESCUCHA_MS};
+static uint16_t recibidos;
+
+static void configurarBajoConsumo(mrf24_dev_t * nodo) {
+
+    MRF24SetLowPower(nodo, &config);
+}
+
+// Atiende las interrupciones y el lazo principal de los dos nodos y cuenta lo que recibe B
+static void correr(uint32_t duracion_us) {
+
+    for (uint32_t t = 0; t < duracion_us; t += PASO_AIRE_US) {
+
+        if (MSG_PRESENT == MRF24IsNewMsg(&nodo_a))
+            MRF24ReciboPaquete(&nodo_a);
+
+        if (MSG_PRESENT == MRF24IsNewMsg(&nodo_b))
+            MRF24ReciboPaquete(&nodo_b);
+
+        while (NULL != MRF24GetDataIn(&nodo_a))
+            MRF24ReleaseDataIn(&nodo_a);
+
+        while (NULL != MRF24GetDataIn(&nodo_b)) {
+
+            recibidos++;
+            MRF24ReleaseDataIn(&nodo_b);
+        }
+        MRF24Poll(&nodo_a);
+        MRF24Poll(&nodo_b);
+        MRF24SimAvanzar(&medio, PASO_AIRE_US);
+    }
+}
+
+// Corre hasta que el nodo llegue al paso pedido, devuelve false si no llega en un segundo
+static bool_t esperarPaso(mrf24_dev_t * nodo, mrf24_lpl_step_t paso) {
+
+    for (uint32_t t = 0; t < 1000 * US_POR_MS; t += PASO_AIRE_US) {
+
+        if (paso == MRF24GetLowPowerStep(nodo))
+            return true;
+        correr(PASO_AIRE_US);
+    }
+    return false;
+}
+
+// Corre hasta que termine la transmisión y devuelve cuánto tardó
+static uint32_t esperarResultado(mrf24_tx_handle_t handle, mrf24_tx_result_t * resultado) {
+
+    uint64_t inicio = MRF24SimGetTiempoUs(&medio);
+
+    for (uint32_t t = 0; t < 1000 * US_POR_MS; t += PASO_AIRE_US) {
+
+        if (OPERATION_OK == MRF24GetTxStatus(&nodo_a, handle, resultado) &&
+            TX_PENDING != resultado->status)
+            break;
+        correr(PASO_AIRE_US);
+    }
+    return (uint32_t)(MRF24SimGetTiempoUs(&medio) - inicio);
+}
+
+void setUp(void) {
+
+    MRF24FixtureInit(&medio);
+    MRF24FixturePrepararNodo(&nodo_a, &sim_a, DIRECCION_A, configurarBajoConsumo);
+    MRF24FixturePrepararNodo(&nodo_b, &sim_b, DIRECCION_B, configurarBajoConsumo);
+
+    memset(&salida, 0, sizeof(salida));
+    salida.dest_panid = FIXTURE_PANID;
+    salida.dest_address = DIRECCION_B;
+    salida.origin_address = DIRECCION_A;
+    memcpy(salida.buffer, "hola", 4);
+    salida.buffer_size = 4;
+    recibidos = 0;
+}
+
+void tearDown(void) {
+}
+
+// La ventana de escucha tiene un mínimo y tiene que ser menor que el ciclo
+void test_la_configuracion_de_bajo_consumo_se_valida(void) {
+
+    mrf24_lpl_config_t corta = {LATENCIA_MS, LPL_MIN_LISTEN - 1};
+    mrf24_lpl_config_t larga = {LATENCIA_MS, LATENCIA_MS};
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetLowPower(&nodo_a, &corta));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetLowPower(&nodo_a, &larga));
+    TEST_ASSERT_EQUAL(LPL_STEP_OFF, MRF24GetLowPowerStep(&nodo_a));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24GetLowPowerStats(&nodo_a, NULL));
+}
+
+// Configurada antes de inicializar, la escucha arranca calibrando y habilita WAKEIF
+void test_la_escucha_de_bajo_consumo_arranca_al_inicializar(void) {
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(LPL_STEP_CALIBRATE, MRF24GetLowPowerStep(&nodo_a));
+    TEST_ASSERT_EQUAL_HEX8(0, MRF24SimGetShort(&sim_a, MRFINTCON) & WAKEIE_DIS);
+    TEST_ASSERT_EQUAL_HEX8(IMMWAKE, MRF24SimGetShort(&sim_a, WAKECON));
+    TEST_ASSERT_TRUE(esperarPaso(&nodo_a, LPL_STEP_LISTEN));
+    TEST_ASSERT_EQUAL_UINT32(SIM_SLPCAL, nodo_a.lpl_slpcal);
+    TEST_ASSERT_TRUE(esperarPaso(&nodo_a, LPL_STEP_SLEEP));
+    TEST_ASSERT_TRUE(sim_a.dormido);
+}
+
+// Con el oscilador de sleep un 10 % lento, la calibración deja el sueño en su duración
+void test_la_calibracion_corrige_el_error_del_reloj_de_sleep(void) {
+
+    uint32_t maincnt = 0;
+
+    sim_b.slpcal = SIM_SLPCAL + SIM_SLPCAL / 10;
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    TEST_ASSERT_TRUE(esperarPaso(&nodo_b, LPL_STEP_SLEEP));
+    TEST_ASSERT_EQUAL_UINT32(sim_b.slpcal, nodo_b.lpl_slpcal);
+
+    for (uint8_t i = 0; i < 4; i++)
+        maincnt |= (uint32_t)MRF24SimGetLong(&sim_b, MAINCNT0 + i) << (8 * i);
+    TEST_ASSERT_EQUAL_UINT32(4090, maincnt);
+    uint64_t dormido_ns = sim_b.stats.dormido_ns;
+    TEST_ASSERT_TRUE(esperarPaso(&nodo_b, LPL_STEP_LISTEN));
+    TEST_ASSERT_UINT32_WITHIN(50, (LATENCIA_MS - ESCUCHA_MS) * US_POR_MS,
+                              (sim_b.stats.dormido_ns - dormido_ns) / NS_POR_US);
+}
+
+// Sin tráfico el módulo pasa dormido nueve de cada diez milisegundos
+void test_sin_trafico_el_modulo_duerme_la_mayor_parte_del_tiempo(void) {
+
+    mrf24_lpl_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_TRUE(esperarPaso(&nodo_b, LPL_STEP_SLEEP));
+    uint64_t dormido_ns = sim_b.stats.dormido_ns;
+    uint32_t despertares = sim_b.stats.despertares;
+
+    // retorno esperado
+    correr(2000 * US_POR_MS);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(1760 * US_POR_MS,
+                                        (sim_b.stats.dormido_ns - dormido_ns) / NS_POR_US);
+    TEST_ASSERT_UINT32_WITHIN(1, 20, sim_b.stats.despertares - despertares);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetLowPowerStats(&nodo_b, &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.early_wakes);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.strobes);
+}
+
+// Cada trama llega a un módulo dormido antes de la latencia máxima, una sola vez y con ACK
+void test_una_trama_llega_a_un_modulo_dormido_dentro_de_la_latencia_maxima(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+    mrf24_lpl_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_TRUE(esperarPaso(&nodo_b, LPL_STEP_SLEEP));
+
+    // retorno esperado
+    for (uint8_t i = 0; i < ENVIOS; i++) {
+
+        correr(DESFASE_US * (i + 1));
+        uint16_t antes = recibidos;
+        uint64_t inicio = MRF24SimGetTiempoUs(&medio);
+        TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&nodo_a, &salida, &handle));
+
+        while (antes == recibidos && MRF24SimGetTiempoUs(&medio) - inicio < 2 * LATENCIA_MS * 1000)
+            correr(PASO_AIRE_US);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(LATENCIA_MS * US_POR_MS,
+                                         MRF24SimGetTiempoUs(&medio) - inicio);
+        esperarResultado(handle, &resultado);
+        TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    }
+    correr(LATENCIA_MS * US_POR_MS);
+    TEST_ASSERT_EQUAL(ENVIOS, recibidos);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetLowPowerStats(&nodo_a, &stats));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.strobes);
+}
+
+// Un broadcast se repite durante todo el ciclo y el receptor descarta las copias
+void test_un_broadcast_llega_una_sola_vez_aunque_se_repita(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+    mrf24_lpl_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_TRUE(esperarPaso(&nodo_b, LPL_STEP_SLEEP));
+    salida.dest_address = BROADCAST;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&nodo_a, &salida, &handle));
+    uint32_t demora = esperarResultado(handle, &resultado);
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(LATENCIA_MS * US_POR_MS, demora);
+    TEST_ASSERT_EQUAL(1, recibidos);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetLowPowerStats(&nodo_a, &stats));
+    TEST_ASSERT_GREATER_THAN_UINT32(1, stats.strobes);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetLowPowerStats(&nodo_b, &stats));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.duplicates);
+}
+
+// Sin nadie que conteste, la trama se repite hasta el plazo y termina sin ACK
+void test_sin_ack_la_trama_se_repite_hasta_el_plazo_y_falla(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+    mrf24_lpl_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    salida.dest_address = DIRECCION_NADIE;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&nodo_a, &salida, &handle));
+    uint32_t demora = esperarResultado(handle, &resultado);
+    TEST_ASSERT_EQUAL(TX_NO_ACK, resultado.status);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32((LATENCIA_MS + ESCUCHA_MS - 1) * US_POR_MS, demora);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetLowPowerStats(&nodo_a, &stats));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.strobes);
+    TEST_ASSERT_EQUAL(0, recibidos);
+}
+
+// Transmitir con el módulo dormido lo despierta y la trama sale cuando avisa WAKEIF
+void test_con_el_modulo_dormido_transmitir_lo_despierta_antes_de_tiempo(void) {
+
+    mrf24_lpl_stats_t stats;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_TRUE(esperarPaso(&nodo_a, LPL_STEP_SLEEP));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24TransmitirDato(&nodo_a, &salida));
+    TEST_ASSERT_EQUAL(LPL_STEP_WAKE, MRF24GetLowPowerStep(&nodo_a));
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24TransmitirDato(&nodo_a, &salida));
+    correr(DESPERTAR_US);
+    TEST_ASSERT_EQUAL(LPL_STEP_LISTEN, MRF24GetLowPowerStep(&nodo_a));
+    TEST_ASSERT_FALSE(sim_a.dormido);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetLowPowerStats(&nodo_a, &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.early_wakes);
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24TransmitirDato(&nodo_a, &salida));
+}
+
+// Al desactivarla con el módulo dormido se lo despierta y queda escuchando siempre
+void test_al_desactivar_la_escucha_de_bajo_consumo_el_modulo_queda_despierto(void) {
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_TRUE(esperarPaso(&nodo_a, LPL_STEP_SLEEP));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetLowPower(&nodo_a, NULL));
+    TEST_ASSERT_EQUAL(LPL_STEP_WAKE, MRF24GetLowPowerStep(&nodo_a));
+    correr(DESPERTAR_US);
+    TEST_ASSERT_EQUAL(LPL_STEP_OFF, MRF24GetLowPowerStep(&nodo_a));
+    TEST_ASSERT_EQUAL_HEX8(WAKEIE_DIS, MRF24SimGetShort(&sim_a, MRFINTCON) & WAKEIE_DIS);
+    uint32_t despertares = sim_a.stats.despertares;
+    correr(500 * US_POR_MS);
+    TEST_ASSERT_FALSE(sim_a.dormido);
+    TEST_ASSERT_EQUAL_UINT32(despertares, sim_a.stats.despertares);
+}
@@ -0,0 +1,347 @@
+#include "unity.h"
+#include <string.h>
+#include "drv_MRF24J40.h"
+#include "drv_MRF24J40_pcap.h"
+#include "drv_MRF24J40_registers.h"
+#include "mrf24j40_sim.h"
+#include "mrf24j40_fixture.h"
+
+TEST_SOURCE_FILE("mrf24j40_sim.c")
+TEST_SOURCE_FILE("mrf24j40_fixture.c")
+
+#define DIRECCION_A     (0x0001)
+#define DIRECCION_B     (0x0002)
+#define DIRECCION_S     (0x00FE)
+#define MAX_VUELTAS     500
+#define PASO_US         1000
+#define PASO_AIRE_US    100
+#define DURACION_US     2000000
+#define ARCHIVO_SIZE    (3 * PCAP_BUFFER_SIZE)
+#define LARGO_ACK       5
+#define LARGO_MHR       9
+#define LARGO_FCS       2
+#define POS_TIMESTAMP   (PCAP_GLOBAL_HEADER)
+#define POS_TAP         (PCAP_GLOBAL_HEADER + PCAP_RECORD_HEADER)
+#define POS_TRAMA       (POS_TAP + PCAP_TAP_HEADER)
+
+static mrf24_sim_medio_t medio;
+static mrf24_sim_t sim_a;
+static mrf24_sim_t sim_b;
+static mrf24_sim_t sim_s;
+static mrf24_dev_t nodo_a;
+static mrf24_dev_t nodo_b;
+static mrf24_dev_t nodo_s;
+static mrf24_pcap_t pcap;
+static uint8_t archivo[ARCHIVO_SIZE];
+static uint32_t archivo_largo;
+static uint32_t archivo_bytes;
+static bool_t falla_escritura;
+
+static uint32_t leerRelojUs(void) {
+
+    return (uint32_t)MRF24SimGetTiempoUs(&medio);
+}
+
+static void configurarSniffer(mrf24_dev_t * nodo) {
+
+    MRF24SetSniffer(nodo, true, false);
+    MRF24SetRxClock(nodo, leerRelojUs);
+}
+
+// Guarda lo escrito mientras entre y cuenta todos los bytes
+static bool_t escribirArchivo(void * ctx, const uint8_t * datos, uint16_t largo) {
+
+    if (falla_escritura)
+        return false;
+
+    if (archivo_largo + largo <= ARCHIVO_SIZE) {
+
+        memcpy(&archivo[archivo_largo], datos, largo);
+        archivo_largo += largo;
+    }
+    archivo_bytes += largo;
+    return true;
+}
+
+static uint32_t leerU32(const uint8_t * datos) {
+
+    return datos[0] | (datos[1] << 8) | ((uint32_t)datos[2] << 16) | ((uint32_t)datos[3] << 24);
+}
+
+// Atiende las interrupciones de los tres nodos y pasa a la captura lo que oyó el sniffer
+static void atenderRadios(void) {
+
+    mrf24_data_in_t * recibido = NULL;
+
+    if (MSG_PRESENT == MRF24IsNewMsg(&nodo_a))
+        MRF24ReciboPaquete(&nodo_a);
+
+    if (MSG_PRESENT == MRF24IsNewMsg(&nodo_b))
+        MRF24ReciboPaquete(&nodo_b);
+
+    if (MSG_PRESENT == MRF24IsNewMsg(&nodo_s))
+        MRF24ReciboPaquete(&nodo_s);
+
+    while (NULL != MRF24GetDataIn(&nodo_b))
+        MRF24ReleaseDataIn(&nodo_b);
+
+    while (NULL != (recibido = MRF24GetDataIn(&nodo_s))) {
+
+        MRF24PcapAgregar(&pcap, recibido);
+        MRF24ReleaseDataIn(&nodo_s);
+    }
+    MRF24PcapVolcar(&pcap, false);
+}
+
+static void cargarSalida(mrf24_data_out_t * salida, uint16_t destino, uint8_t largo) {
+
+    memset(salida, 0, sizeof(*salida));
+    salida->dest_panid = FIXTURE_PANID;
+    salida->dest_address = destino;
+    salida->origin_address = DIRECCION_A;
+    salida->buffer_size = largo;
+
+    for (uint8_t i = 0; i < largo; i++)
+        salida->buffer[i] = (char)(i + largo);
+}
+
+static void cargarTrama(mrf24_data_in_t * trama, uint8_t largo, uint32_t timestamp) {
+
+    memset(trama, 0, sizeof(*trama));
+    trama->buffer_size = largo;
+    trama->timestamp = timestamp;
+    trama->rssi = 255;
+    trama->lqi = 0x80;
+
+    for (uint8_t i = 0; i < largo; i++)
+        trama->buffer[i] = i;
+}
+
+void setUp(void) {
+
+    MRF24FixtureInit(&medio);
+    MRF24FixturePrepararNodo(&nodo_a, &sim_a, DIRECCION_A, NULL);
+    MRF24FixturePrepararNodo(&nodo_b, &sim_b, DIRECCION_B, NULL);
+    MRF24FixturePrepararNodo(&nodo_s, &sim_s, DIRECCION_S, configurarSniffer);
+    MRF24PcapInit(&pcap, CH_15, escribirArchivo, NULL);
+    archivo_largo = 0;
+    archivo_bytes = 0;
+    falla_escritura = false;
+}
+
+void tearDown(void) {
+}
+
+// El modo sniffer pone PROMI y NOACKRSP en RXMCR, ERRPKT si se pide, y se puede apagar
+void test_el_modo_sniffer_configura_el_filtro_de_recepcion(void) {
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL_HEX8(PROMI | NOACKRSP, MRF24SimGetShort(&sim_s, RXMCR));
+    TEST_ASSERT_EQUAL_HEX8(VACIO, MRF24SimGetShort(&sim_a, RXMCR));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetSniffer(&nodo_s, true, true));
+    TEST_ASSERT_EQUAL_HEX8(PROMI | NOACKRSP | ERRPKT, MRF24SimGetShort(&sim_s, RXMCR));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24SetSniffer(&nodo_s, false, true));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24SetSniffer(&nodo_s, false, false));
+    TEST_ASSERT_EQUAL_HEX8(VACIO, MRF24SimGetShort(&sim_s, RXMCR));
+}
+
+// Después de una búsqueda de dispositivos el sniffer sigue en modo promiscuo
+void test_el_modo_sniffer_sigue_despues_de_buscar_dispositivos(void) {
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(SCAN_IN_PROGRESS, MRF24BuscarDispositivos(&nodo_s, 1));
+    TEST_ASSERT_EQUAL(TRANS_IN_PROGRESS, MRF24SetSniffer(&nodo_s, false, false));
+
+    for (uint16_t i = 0; i < MAX_VUELTAS && SCAN_IN_PROGRESS == MRF24Poll(&nodo_s); i++)
+        MRF24SimAvanzar(&medio, PASO_US);
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24Poll(&nodo_s));
+    TEST_ASSERT_EQUAL_HEX8(PROMI | NOACKRSP, MRF24SimGetShort(&sim_s, RXMCR));
+}
+
+// El sniffer recibe crudas la trama de A para B y su ACK, con RSSI, LQI y marca de tiempo
+void test_el_sniffer_recibe_crudas_la_trama_entre_otros_dos_nodos_y_su_ack(void) {
+
+    mrf24_data_out_t salida;
+    mrf24_data_in_t * recibido = NULL;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    MRF24SetSniffer(&nodo_s, true, false);
+    cargarSalida(&salida, DIRECCION_B, 10);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24TransmitirDato(&nodo_a, &salida));
+
+    for (uint16_t i = 0; i < MAX_VUELTAS; i++) {
+
+        if (MSG_PRESENT == MRF24IsNewMsg(&nodo_s))
+            MRF24ReciboPaquete(&nodo_s);
+        MRF24SimAvanzar(&medio, PASO_AIRE_US);
+    }
+    recibido = MRF24GetDataIn(&nodo_s);
+    TEST_ASSERT_NOT_NULL(recibido);
+    TEST_ASSERT_EQUAL(LARGO_MHR + 10 + LARGO_FCS, recibido->buffer_size);
+    TEST_ASSERT_EQUAL_HEX8(DIRECCION_B, recibido->buffer[5]);
+    TEST_ASSERT_EQUAL_MEMORY(salida.buffer, &recibido->buffer[LARGO_MHR], 10);
+    TEST_ASSERT_EQUAL_HEX16(NO_SHORT_ADDRESS, recibido->address);
+    TEST_ASSERT_EQUAL(medio.lqi, recibido->lqi);
+    TEST_ASSERT_EQUAL(medio.rssi, recibido->rssi);
+    TEST_ASSERT_GREATER_THAN(0, recibido->timestamp);
+    MRF24ReleaseDataIn(&nodo_s);
+    recibido = MRF24GetDataIn(&nodo_s);
+    TEST_ASSERT_NOT_NULL(recibido);
+    TEST_ASSERT_EQUAL(LARGO_ACK, recibido->buffer_size);
+    TEST_ASSERT_EQUAL_HEX8(ACK, recibido->buffer[0]);
+    TEST_ASSERT_EQUAL_HEX8(nodo_a.config.sequence_number - 1, recibido->buffer[2]);
+}
+
+// La captura empieza con la cabecera global de pcap y el link type de 802.15.4 con TAP
+void test_la_captura_empieza_con_la_cabecera_global(void) {
+
+    static const uint8_t cabecera[PCAP_GLOBAL_HEADER] = {
+        0xD4, 0xC3, 0xB2, 0xA1, 0x02, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0xA3, 0x00, 0x00, 0x00, 0x1B, 0x01, 0x00, 0x00,
+    };
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, MRF24PcapVolcar(&pcap, false));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24PcapVolcar(&pcap, true));
+    TEST_ASSERT_EQUAL(PCAP_GLOBAL_HEADER, archivo_largo);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(cabecera, archivo, PCAP_GLOBAL_HEADER);
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, MRF24PcapVolcar(&pcap, true));
+    TEST_ASSERT_EQUAL(INVALID_VALUE,
+                      MRF24PcapInit(&pcap, (channel_list_t)(CH_11 - 1), escribirArchivo, NULL));
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24PcapInit(&pcap, CH_15, NULL, NULL));
+}
+
+// Cada trama lleva su marca de tiempo, la cabecera TAP con FCS, RSS, canal y LQI, y el FCS
+void test_cada_trama_lleva_marca_de_tiempo_cabecera_tap_y_fcs(void) {
+
+    static const uint8_t tap[PCAP_TAP_HEADER] = {
+        0x00, 0x00, 0x24, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00,
+        0x01, 0x00, 0x04, 0x00, 0x00, 0x00, 0xA0, 0xC1, 0x03, 0x00, 0x03, 0x00,
+        0x0F, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x01, 0x00, 0x80, 0x00, 0x00, 0x00,
+    };
+    mrf24_data_in_t trama;
+
+    cargarTrama(&trama, LARGO_ACK, 2500001);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24PcapAgregar(&pcap, &trama));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24PcapVolcar(&pcap, true));
+    TEST_ASSERT_EQUAL(POS_TRAMA + LARGO_ACK, archivo_largo);
+    TEST_ASSERT_EQUAL(2, leerU32(&archivo[POS_TIMESTAMP]));
+    TEST_ASSERT_EQUAL(500001, leerU32(&archivo[POS_TIMESTAMP + 4]));
+    TEST_ASSERT_EQUAL(PCAP_TAP_HEADER + LARGO_ACK, leerU32(&archivo[POS_TIMESTAMP + 8]));
+    TEST_ASSERT_EQUAL(PCAP_TAP_HEADER + LARGO_ACK, leerU32(&archivo[POS_TIMESTAMP + 12]));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(tap, &archivo[POS_TAP], PCAP_TAP_HEADER);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(trama.buffer, &archivo[POS_TRAMA], LARGO_ACK);
+}
+
+// La marca de tiempo sigue creciendo cuando el reloj de 32 bits da la vuelta
+void test_la_marca_de_tiempo_sigue_despues_de_la_vuelta_del_reloj(void) {
+
+    mrf24_data_in_t trama;
+    uint32_t segundo = POS_TIMESTAMP + PCAP_RECORD_HEADER + PCAP_TAP_HEADER + LARGO_ACK;
+
+    cargarTrama(&trama, LARGO_ACK, 0xFFFFFFF0);
+    MRF24PcapAgregar(&pcap, &trama);
+    trama.timestamp = 0x10;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24PcapAgregar(&pcap, &trama));
+    MRF24PcapVolcar(&pcap, true);
+    TEST_ASSERT_EQUAL(4294, leerU32(&archivo[segundo]));
+    TEST_ASSERT_EQUAL(967312, leerU32(&archivo[segundo + 4]));
+}
+
+// Con los dos buffers llenos la trama se descarta y se cuenta, y al escribir uno vuelve a haber
+// lugar
+void test_con_los_dos_buffers_llenos_la_trama_se_descarta(void) {
+
+    mrf24_data_in_t trama;
+    mrf24_pcap_stats_t stats;
+    uint32_t agregadas = 0;
+
+    cargarTrama(&trama, PCAP_MAX_FRAME, 1000);
+
+    while (OPERATION_OK == MRF24PcapAgregar(&pcap, &trama))
+        agregadas++;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(2 * PCAP_BUFFER_SIZE / PCAP_MAX_RECORD, agregadas);
+    TEST_ASSERT_EQUAL(BUFFER_FULL, MRF24PcapAgregar(&pcap, &trama));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24PcapVolcar(&pcap, false));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24PcapAgregar(&pcap, &trama));
+    MRF24PcapGetStats(&pcap, &stats);
+    TEST_ASSERT_EQUAL(agregadas + 1, stats.frames);
+    TEST_ASSERT_EQUAL(2, stats.dropped);
+    TEST_ASSERT_EQUAL(1, stats.flushes);
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24PcapGetStats(&pcap, NULL));
+    trama.buffer_size = PCAP_MAX_FRAME + 1;
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24PcapAgregar(&pcap, &trama));
+}
+
+// Una escritura que falla se cuenta, el buffer se descarta y la captura sigue
+void test_una_escritura_fallida_se_cuenta_y_la_captura_sigue(void) {
+
+    mrf24_data_in_t trama;
+    mrf24_pcap_stats_t stats;
+
+    cargarTrama(&trama, LARGO_ACK, 1000);
+    MRF24PcapAgregar(&pcap, &trama);
+    falla_escritura = true;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, MRF24PcapVolcar(&pcap, true));
+    TEST_ASSERT_EQUAL(BUFFER_EMPTY, MRF24PcapVolcar(&pcap, true));
+    falla_escritura = false;
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24PcapAgregar(&pcap, &trama));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24PcapVolcar(&pcap, true));
+    MRF24PcapGetStats(&pcap, &stats);
+    TEST_ASSERT_EQUAL(1, stats.write_errors);
+    TEST_ASSERT_EQUAL(1, stats.flushes);
+    TEST_ASSERT_EQUAL(PCAP_RECORD_HEADER + PCAP_TAP_HEADER + LARGO_ACK, stats.bytes);
+}
+
+// Con el canal saturado de tramas y ACKs el sniffer las captura todas, sin descartar ninguna
+void test_el_sniffer_captura_sin_perdidas_el_canal_saturado(void) {
+
+    mrf24_data_out_t salida;
+    mrf24_tx_handle_t handle;
+    mrf24_rx_stats_t rx_stats;
+    mrf24_pcap_stats_t stats;
+    uint32_t encoladas = 0;
+    uint8_t largo = 1;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    for (uint32_t t = 0; t < DURACION_US; t += PASO_AIRE_US) {
+
+        cargarSalida(&salida, (encoladas % 4) ? DIRECCION_B : BROADCAST, largo);
+
+        if (OPERATION_OK == MRF24EncolarDato(&nodo_a, &salida, &handle)) {
+
+            encoladas++;
+            largo = (largo * 37 + 11) % MAX_PAYLOAD_SIZE + 1;
+        }
+        atenderRadios();
+        MRF24SimAvanzar(&medio, PASO_AIRE_US);
+    }
+    atenderRadios();
+    MRF24PcapVolcar(&pcap, true);
+    MRF24PcapGetStats(&pcap, &stats);
+    MRF24GetRxStats(&nodo_s, &rx_stats);
+    TEST_ASSERT_GREATER_THAN(DURACION_US / 10000, sim_a.stats.tx_tramas);
+    TEST_ASSERT_EQUAL(0, sim_s.stats.rx_descartadas);
+    TEST_ASSERT_EQUAL(0, rx_stats.overruns);
+    TEST_ASSERT_EQUAL(0, rx_stats.errors);
+    TEST_ASSERT_EQUAL(sim_s.stats.rx_tramas, stats.frames);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+    TEST_ASSERT_EQUAL(archivo_bytes, stats.bytes);
+    TEST_ASSERT_GREATER_THAN(sim_a.stats.tx_tramas, stats.frames);
+}
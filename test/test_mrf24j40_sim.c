@@ -0,0 +1,340 @@
+#include "unity.h"
+#include <string.h>
+#include "drv_MRF24J40.h"
+#include "drv_MRF24J40_registers.h"
+#include "mrf24j40_sim.h"
+#include "mrf24j40_fixture.h"
+
+TEST_SOURCE_FILE("mrf24j40_sim.c")
+TEST_SOURCE_FILE("mrf24j40_fixture.c")
+
+#define DIRECCION_A     (0x0001)
+#define DIRECCION_B     (0x0002)
+#define AIRE_US         20000 // alcanza para cuatro intentos con CSMA-CA y espera del ACK
+#define BYTES_TX_HOLA   (2 + 2 + 9 + 4 + 2) // FIFO: comando, cabecera, MHR, datos; TXNCON
+#define PERMANENCIA_MS  2
+#define PASO_US         1000
+
+static mrf24_sim_medio_t medio;
+static mrf24_sim_t sim_a;
+static mrf24_sim_t sim_b;
+static mrf24_dev_t nodo_a;
+static mrf24_dev_t nodo_b;
+static mrf24_data_out_t salida;
+static tick_t reloj_perf;
+
+static tick_t leerRelojPerf(void) {
+
+    return reloj_perf;
+}
+
+static void esperarAire(void) {
+
+    MRF24SimAvanzar(&medio, AIRE_US);
+}
+
+// Atiende el escaneo de A sin atender sus interrupciones, devuelve false si no termina
+static bool_t terminarEscaneo(void) {
+
+    for (uint16_t vuelta = 0; vuelta < FIXTURE_MAX_VUELTAS; vuelta++) {
+
+        if (SCAN_IN_PROGRESS != MRF24Poll(&nodo_a))
+            return true;
+        MRF24SimAvanzar(&medio, PASO_US);
+    }
+    return false;
+}
+
+void setUp(void) {
+
+    MRF24FixtureInit(&medio);
+    MRF24FixturePrepararNodo(&nodo_a, &sim_a, DIRECCION_A, NULL);
+    MRF24FixturePrepararNodo(&nodo_b, &sim_b, DIRECCION_B, NULL);
+
+    memset(&salida, 0, sizeof(salida));
+    salida.dest_panid = FIXTURE_PANID;
+    salida.dest_address = DIRECCION_B;
+    salida.origin_address = DIRECCION_A;
+    memcpy(salida.buffer, "hola", 4);
+    salida.buffer_size = 4;
+    reloj_perf = 0;
+}
+
+void tearDown(void) {
+}
+
+// El driver completa la inicialización sobre el módulo simulado y deja la configuración cargada
+void test_el_driver_inicializa_el_modulo_simulado_y_carga_la_configuracion(void) {
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    TEST_ASSERT_EQUAL_HEX8(0x34, MRF24SimGetShort(&sim_a, PANIDL));
+    TEST_ASSERT_EQUAL_HEX8(0x12, MRF24SimGetShort(&sim_a, PANIDH));
+    TEST_ASSERT_EQUAL_HEX8(DIRECCION_B, MRF24SimGetShort(&sim_b, SADRL));
+    TEST_ASSERT_EQUAL_HEX8(CH_15, MRF24SimGetLong(&sim_a, RFCON0));
+    TEST_ASSERT_FALSE(nodo_a.port.is_interrupt(nodo_a.port.ctx));
+}
+
+// Una trama enviada por un nodo llega al otro con el ACK y los datos intactos
+void test_una_trama_enviada_por_un_nodo_llega_al_otro_con_ack(void) {
+
+    mrf24_data_in_t * recibido = NULL;
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&nodo_a, &salida, &handle));
+    TEST_ASSERT_FALSE(nodo_b.port.is_interrupt(nodo_b.port.ctx));
+    esperarAire();
+    TEST_ASSERT_TRUE(nodo_b.port.is_interrupt(nodo_b.port.ctx));
+    TEST_ASSERT_EQUAL(MSG_READ, MRF24InterruptHandler(&nodo_b));
+    recibido = MRF24GetDataIn(&nodo_b);
+    TEST_ASSERT_NOT_NULL(recibido);
+    TEST_ASSERT_EQUAL_HEX16(DIRECCION_A, recibido->address);
+    TEST_ASSERT_EQUAL(4, recibido->buffer_size);
+    TEST_ASSERT_EQUAL_MEMORY("hola", recibido->buffer, 4);
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24InterruptHandler(&nodo_a));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetTxStatus(&nodo_a, handle, &resultado));
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+}
+
+// Sin un nodo con la dirección de destino la transmisión termina sin ACK
+void test_sin_destino_en_el_aire_la_transmision_termina_sin_ack(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    salida.dest_address = 0x0003;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&nodo_a, &salida, &handle));
+    esperarAire();
+    TEST_ASSERT_FALSE(nodo_b.port.is_interrupt(nodo_b.port.ctx));
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24InterruptHandler(&nodo_a));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetTxStatus(&nodo_a, handle, &resultado));
+    TEST_ASSERT_EQUAL(TX_NO_ACK, resultado.status);
+    TEST_ASSERT_EQUAL(3, resultado.retries);
+    TEST_ASSERT_EQUAL(1, sim_a.stats.tx_sin_ack);
+    TEST_ASSERT_EQUAL(3, sim_a.stats.tx_reintentos);
+}
+
+// Un broadcast sale una sola vez, sin esperar un ACK que nadie manda
+void test_un_broadcast_sale_una_vez_sin_esperar_ack(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    salida.dest_address = BROADCAST;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&nodo_a, &salida, &handle));
+    esperarAire();
+    TEST_ASSERT_EQUAL(MSG_READ, MRF24InterruptHandler(&nodo_b));
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24InterruptHandler(&nodo_a));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetTxStatus(&nodo_a, handle, &resultado));
+    TEST_ASSERT_EQUAL(TX_OK, resultado.status);
+    TEST_ASSERT_EQUAL(0, resultado.retries);
+    TEST_ASSERT_EQUAL(0, sim_a.stats.tx_reintentos);
+    TEST_ASSERT_EQUAL(1, sim_b.stats.rx_tramas);
+}
+
+// Los contadores del módulo simulado miden el tráfico SPI de una transmisión
+void test_el_simulador_cuenta_el_trafico_spi_de_una_transmision(void) {
+
+    mrf24_tx_handle_t handle;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    memset(&sim_a.stats, 0, sizeof(sim_a.stats));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&nodo_a, &salida, &handle));
+    TEST_ASSERT_EQUAL(2, sim_a.stats.spi_transacciones);
+    TEST_ASSERT_EQUAL(BYTES_TX_HOLA, sim_a.stats.spi_bytes);
+    TEST_ASSERT_EQUAL(1, sim_a.stats.tx_tramas);
+}
+
+// Con una trama sin leer en la FIFO la siguiente se descarta
+void test_con_la_fifo_de_recepcion_ocupada_la_trama_siguiente_se_descarta(void) {
+
+    mrf24_tx_handle_t handle;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&nodo_a, &salida, &handle));
+    esperarAire();
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24InterruptHandler(&nodo_a));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&nodo_a, &salida, &handle));
+    esperarAire();
+    TEST_ASSERT_EQUAL(1, sim_b.stats.rx_tramas);
+    TEST_ASSERT_EQUAL(4, sim_b.stats.rx_descartadas); // la trama y sus tres reintentos
+    TEST_ASSERT_EQUAL(1, sim_a.stats.tx_sin_ack);
+}
+
+// Los contadores del driver reparten el tráfico SPI por API y coinciden con lo que ve el módulo
+void test_los_contadores_de_rendimiento_reparten_el_trafico_spi_por_api(void) {
+
+    mrf24_perf_t perf;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    MRF24GetPerf(&nodo_a, &perf);
+    TEST_ASSERT_EQUAL(sim_a.stats.spi_transacciones, perf.spi_transactions[PERF_API_INIT]);
+    TEST_ASSERT_EQUAL(sim_a.stats.spi_bytes, perf.spi_bytes[PERF_API_INIT]);
+    MRF24ResetPerf(&nodo_a);
+    MRF24ResetPerf(&nodo_b);
+    memset(&sim_a.stats, 0, sizeof(sim_a.stats));
+    memset(&sim_b.stats, 0, sizeof(sim_b.stats));
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24TransmitirDato(&nodo_a, &salida));
+    esperarAire();
+    TEST_ASSERT_EQUAL(MSG_READ, MRF24ReciboPaquete(&nodo_b));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetPerf(&nodo_a, &perf));
+    TEST_ASSERT_EQUAL(2, perf.spi_transactions[PERF_API_TX]);
+    TEST_ASSERT_EQUAL(BYTES_TX_HOLA, perf.spi_bytes[PERF_API_TX]);
+    TEST_ASSERT_EQUAL(0, perf.spi_transactions[PERF_API_OTHER]);
+    MRF24GetPerf(&nodo_b, &perf);
+    TEST_ASSERT_EQUAL(sim_b.stats.spi_transacciones, perf.spi_transactions[PERF_API_RX]);
+    TEST_ASSERT_EQUAL(sim_b.stats.spi_bytes, perf.spi_bytes[PERF_API_RX]);
+    TEST_ASSERT_EQUAL(1, perf.rx_frames);
+    TEST_ASSERT_EQUAL(INVALID_VALUE, MRF24GetPerf(&nodo_b, NULL));
+}
+
+// Las latencias de transmisión y de recepción caen en el casillero de su potencia de 2
+void test_las_latencias_se_acumulan_en_los_histogramas(void) {
+
+    mrf24_perf_t perf;
+    mrf24_tx_handle_t handle;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    MRF24SetPerfClock(&nodo_a, leerRelojPerf);
+    MRF24SetPerfClock(&nodo_b, leerRelojPerf);
+    reloj_perf = 10;
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&nodo_a, &salida, &handle));
+    esperarAire();
+    reloj_perf = 20;
+    TEST_ASSERT_EQUAL(MSG_PRESENT, MRF24IsNewMsg(&nodo_b));
+    reloj_perf = 25;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(MSG_READ, MRF24InterruptHandler(&nodo_b));
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24InterruptHandler(&nodo_a));
+    MRF24GetPerf(&nodo_a, &perf);
+    TEST_ASSERT_EQUAL(1, perf.tx_frames);
+    TEST_ASSERT_EQUAL(0, perf.retries);
+    TEST_ASSERT_EQUAL(1, perf.tx_latency[4]); // 15 ticks
+    MRF24GetPerf(&nodo_b, &perf);
+    TEST_ASSERT_EQUAL(1, perf.rx_latency[3]); // 5 ticks
+}
+
+// Una transmisión sin ACK suma los reintentos del módulo
+void test_los_contadores_de_rendimiento_suman_los_reintentos(void) {
+
+    mrf24_perf_t perf;
+    mrf24_tx_handle_t handle;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    MRF24SetPerfClock(&nodo_a, leerRelojPerf);
+    salida.dest_address = 0x0003;
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24EncolarDato(&nodo_a, &salida, &handle));
+    esperarAire();
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24InterruptHandler(&nodo_a));
+    MRF24GetPerf(&nodo_a, &perf);
+    TEST_ASSERT_EQUAL(1, perf.tx_frames);
+    TEST_ASSERT_EQUAL(3, perf.retries);
+    TEST_ASSERT_EQUAL(0, perf.cca_failures);
+    TEST_ASSERT_EQUAL(1, perf.tx_latency[0]);
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24ResetPerf(&nodo_a));
+    MRF24GetPerf(&nodo_a, &perf);
+    TEST_ASSERT_EQUAL(0, perf.tx_frames);
+}
+
+// Con el enlace perdiendo todo, la trama y sus reintentos no llegan y la transmisión falla
+void test_un_enlace_con_perdida_total_no_entrega_la_trama(void) {
+
+    mrf24_tx_handle_t handle;
+    mrf24_tx_result_t resultado;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    MRF24SimSetPerdida(&sim_a, &sim_b, 100);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&nodo_a, &salida, &handle));
+    esperarAire();
+    TEST_ASSERT_FALSE(nodo_b.port.is_interrupt(nodo_b.port.ctx));
+    TEST_ASSERT_EQUAL(4, sim_b.stats.rx_perdidas);
+    TEST_ASSERT_EQUAL(TRANS_COMPLETED, MRF24InterruptHandler(&nodo_a));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24GetTxStatus(&nodo_a, handle, &resultado));
+    TEST_ASSERT_EQUAL(TX_NO_ACK, resultado.status);
+}
+
+// Con el ACK perdido en la vuelta el destino recibe la trama repetida en cada reintento
+void test_con_el_ack_perdido_el_destino_recibe_los_reintentos(void) {
+
+    mrf24_tx_handle_t handle;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    MRF24SimSetPerdida(&sim_b, &sim_a, 100);
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&nodo_a, &salida, &handle));
+    esperarAire();
+    TEST_ASSERT_EQUAL(1, sim_b.stats.rx_tramas);
+    TEST_ASSERT_EQUAL(3, sim_b.stats.rx_descartadas);
+    TEST_ASSERT_EQUAL(1, sim_a.stats.tx_sin_ack);
+}
+
+// Dos nodos que transmiten a la vez se ordenan con el CCA y las dos tramas llegan
+void test_dos_transmisiones_simultaneas_se_ordenan_con_el_cca(void) {
+
+    mrf24_tx_handle_t handle_a;
+    mrf24_tx_handle_t handle_b;
+    mrf24_data_out_t respuesta = salida;
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+    respuesta.dest_address = DIRECCION_A;
+    respuesta.origin_address = DIRECCION_B;
+
+    // retorno esperado
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&nodo_a, &salida, &handle_a));
+    TEST_ASSERT_EQUAL(OPERATION_OK, MRF24TransmitirAsync(&nodo_b, &respuesta, &handle_b));
+    esperarAire();
+    TEST_ASSERT_EQUAL(1, sim_a.stats.rx_tramas);
+    TEST_ASSERT_EQUAL(1, sim_b.stats.rx_tramas);
+    TEST_ASSERT_EQUAL(0, sim_a.stats.rx_colisiones + sim_b.stats.rx_colisiones);
+    TEST_ASSERT_EQUAL(0, sim_a.stats.tx_sin_ack + sim_b.stats.tx_sin_ack);
+}
+
+// Un escaneo de energía descarta lo recibido sin dejar la interrupción activa ni un RXIF viejo
+void test_un_escaneo_de_energia_descarta_lo_recibido_sin_dejar_la_interrupcion_activa(void) {
+
+    // Broadcast de datos con PAN comprimido, de B, con "hola".
+    const uint8_t trama[] = {0x41, 0x88, 0x01, 0x34, 0x12, 0xFF, 0xFF, 0x02, 0x00,
+                             'h',  'o',  'l',  'a'};
+
+    TEST_ASSERT_EQUAL(INIT_OK, MRF24FixtureEsperarInicio());
+
+    // retorno esperado
+    // Una trama que nadie atiende antes del final del escaneo no deja RXIF pendiente.
+    TEST_ASSERT_EQUAL(SCAN_IN_PROGRESS, MRF24EscanearEnergia(&nodo_a, PERMANENCIA_MS));
+    MRF24SimAvanzar(&medio, PASO_US);
+    TEST_ASSERT_TRUE(MRF24SimRecibir(&sim_a, trama, sizeof(trama)));
+    TEST_ASSERT_TRUE(nodo_a.port.is_interrupt(nodo_a.port.ctx));
+    TEST_ASSERT_TRUE(terminarEscaneo());
+    TEST_ASSERT_FALSE(nodo_a.port.is_interrupt(nodo_a.port.ctx));
+
+    // Atendida durante el escaneo, la interrupción se libera y la trama se descarta.
+    TEST_ASSERT_EQUAL(SCAN_IN_PROGRESS, MRF24EscanearEnergia(&nodo_a, PERMANENCIA_MS));
+    MRF24SimAvanzar(&medio, PASO_US);
+    TEST_ASSERT_TRUE(MRF24SimRecibir(&sim_a, trama, sizeof(trama)));
+    TEST_ASSERT_EQUAL(OPERATION_FAIL, MRF24InterruptHandler(&nodo_a));
+    TEST_ASSERT_FALSE(nodo_a.port.is_interrupt(nodo_a.port.ctx));
+    TEST_ASSERT_TRUE(terminarEscaneo());
+    TEST_ASSERT_NULL(MRF24GetDataIn(&nodo_a));
+}